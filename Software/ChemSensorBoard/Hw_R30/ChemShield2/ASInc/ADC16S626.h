@@ -25,12 +25,16 @@
 #ifndef ADC16S626_H
 #define	ADC16S626_H
 
+#include <stdint.h>
+
 class ADC16S626 {
 public:
     ADC16S626(const unsigned char csPin);
     virtual ~ADC16S626();
     
     unsigned short getSample() const;
+    unsigned short decodeSample(uint32_t rxData) const;
+    inline unsigned char getCsPin() const { return m_csPin; }
     
     double getVoltage(unsigned short linearSample, double vRefm, double vRefAD) const;
 
@@ -0,0 +1,78 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu, 
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and 
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *			European Commission - Joint Research Centre, 
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#ifndef ADCSCANNER_H
+#define	ADCSCANNER_H
+
+#include <stdint.h>
+
+#define ADCSCANNER_MAX_ADCS     4
+#define ADCSCANNER_TIMEOUT      2       /* Timer ticks before aborting a stuck scan */
+
+class ADC16S626;
+
+/* Captures all the ADC16S626 devices back to back, one after the other,
+   when triggered from the timer interrupt. SPI transfers are interrupt driven
+   and results are stored into a double buffer so the main loop always
+   reads a complete and time aligned set of samples.
+   Each scan is numbered when it starts. A scan requested while another one is 
+   in progress is chained to it, so a sample requested with getNextFrame() is 
+   never satisfied by a scan started before the request.
+*/
+class ADCScanner {
+    
+public:
+    ADCScanner(const ADC16S626* adcList, unsigned char numOfADCs);
+    virtual ~ADCScanner();
+    
+    void timerTick(bool requestScan);
+    void onTransferCompleted();
+    
+    unsigned long getNextFrame() const;
+    bool getSample(unsigned char adc, unsigned long minFrame, unsigned short* sample) const;
+
+private:
+    void startScan();
+    void startTransfer();
+    void endTransfer();
+    
+private:
+    const ADC16S626* const adcList;                         // The ADC devices to be scanned
+    const unsigned char numOfADCs;                          // Number of ADC devices in the list
+    
+    unsigned short buffer[2][ADCSCANNER_MAX_ADCS];          // Double buffer for scanned samples
+    volatile unsigned char frontBuffer;                     // The buffer with the last complete scan
+    volatile unsigned long frameCounter;                    // Number of the last completed scan
+    volatile unsigned long scanCounter;                     // Number of the last started scan
+    
+    volatile bool scanning;                                 // A scan is in progress
+    volatile bool scanPending;                              // A scan has to be started as soon as possible
+    volatile unsigned char currentADC;                      // The ADC currently addressed
+    unsigned char scanTimer;                                // Scan timeout counter
+    
+    uint32_t txDummy;                                       // SPI transmit buffer
+    uint32_t rxData;                                        // SPI receive buffer
+};
+
+#endif	/* ADCSCANNER_H */
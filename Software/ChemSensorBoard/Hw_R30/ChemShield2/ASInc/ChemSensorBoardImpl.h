@@ -33,6 +33,8 @@
  	void uart2Interrupt(unsigned char halfBuffer);
  	void uart1Error();
  	void uart2Error();
+ 	void spi1Interrupt();
+ 	void spi1Error();
  	void usbRxCallback(unsigned char* buffer, long bufferLen);
 	void timerInterrupt();
 	void setup_impl();
@@ -27,12 +27,12 @@
 #define	CHEMSENSORSAMPLER_H
 
 #include "Sampler.h"
-#include "ADC16S626.h"
+#include "ADCScanner.h"
 
 class ChemSensorSampler : public Sampler {
     
 public:
-    ChemSensorSampler(const ADC16S626& adc);
+    ChemSensorSampler(const ADCScanner& scanner, unsigned char adcChannel);
     virtual ~ChemSensorSampler();
     
     virtual bool sampleTick();
@@ -42,7 +42,9 @@ public:
     virtual double evaluateMeasurement(unsigned short lastSample) const;
 
 private:
-    const ADC16S626 &sensor;            // the reference to the sensor's ADC
+    const ADCScanner &scanner;          // the scanner sampling all the sensor's ADCs
+    const unsigned char adcChannel;     // the sensor's ADC position in the scanner
+    volatile unsigned long requestedFrame;  // the first scan valid for the pending sample
 };
 
 #endif	/* CHEMSENSORSAMPLER_H */
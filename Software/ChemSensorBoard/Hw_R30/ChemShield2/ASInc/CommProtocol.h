@@ -62,6 +62,8 @@
 #define COMMPROTOCOL_READ_BOARDTYPE		'c'
 #define COMMPROTOCOL_WRITE_CHANENABLE	'd'
 #define COMMPROTOCOL_READ_CHANENABLE	'e'
+#define COMMPROTOCOL_SET_CICORDER		's'
+#define COMMPROTOCOL_GET_CICORDER		't'
 
 #define MAX_SERIAL_BUFLENGTH			 64							// Stack temporary buffer size
 #define MAX_INQUIRY_BUFLENGTH            MAX_SERIAL_BUFLENGTH		// Maximum preset/channel name
@@ -109,6 +111,8 @@ private:
     static bool getSamplePostscaler(CommProtocol* context, unsigned char cmdOffset);
     static bool setSampleDecimation(CommProtocol* context, unsigned char cmdOffset);
     static bool getSampleDecimation(CommProtocol* context, unsigned char cmdOffset);
+    static bool setSampleCICOrder(CommProtocol* context, unsigned char cmdOffset);
+    static bool getSampleCICOrder(CommProtocol* context, unsigned char cmdOffset);
     static bool setSampleIIRDenominators(CommProtocol* context, unsigned char cmdOffset);
     static bool getSampleIIRDenominators(CommProtocol* context, unsigned char cmdOffset);
     static bool getFreeMemory(CommProtocol* context, unsigned char cmdOffset);
@@ -76,15 +76,15 @@ extern "C" {
 //#define LMP9100_PRESETNAME(a)       (((a) - AFE_1_ENPIN + 1) << 4)
 //#define LMP9100_PRESETNAME_LENGTH   8
     
-// 60 - 64 -> Sampler preset 1
-// 70 - 74 -> Sampler preset 2
-// 80 - 84 -> Sampler preset 3
-// 90 - 94 -> Sampler preset 4
-// A0 - A4 -> Sampler preset 5
-// B0 - B4 -> Sampler preset 6
-// C0 - C4 -> Sampler preset 7
-// D0 - D4 -> Sampler preset 8
-// E0 - E4 -> Sampler preset 9
+// 60 - 65 -> Sampler preset 1
+// 70 - 75 -> Sampler preset 2
+// 80 - 85 -> Sampler preset 3
+// 90 - 95 -> Sampler preset 4
+// A0 - A5 -> Sampler preset 5
+// B0 - B5 -> Sampler preset 6
+// C0 - C5 -> Sampler preset 7
+// D0 - D5 -> Sampler preset 8
+// E0 - E5 -> Sampler preset 9
 #define SAMPLER_PRESET_BASE(a)     ((((a) + 1) << 4) + 0x50)
     
 #define SAMPLER_PRESET_PRESCALER(a)     SAMPLER_PRESET_BASE(a)
@@ -92,6 +92,7 @@ extern "C" {
 #define SAMPLER_PRESET_IIR1DENOM(a)     (SAMPLER_PRESET_BASE(a) + 2)
 #define SAMPLER_PRESET_IIR2DENOM(a)     (SAMPLER_PRESET_BASE(a) + 3)
 #define SAMPLER_PRESET_CHENABLED(a)		(SAMPLER_PRESET_BASE(a) + 4)
+#define SAMPLER_PRESET_CICORDER(a)		(SAMPLER_PRESET_BASE(a) + 5)
     
 // F0 - D9 -> Averager presets
 #define AVERAGER_PRESET_BUFSIZE(a)      (0xF0 + (a))
@@ -26,8 +26,10 @@
 #define SPIHELPER_H_
 
 #include "stm32f0xx_hal.h"
+#include "SPIBurstHelper.h"
 
-class SPIHelper {
+// Burst transfers are made of 16 bits data frames, as set by the current SPI configuration.
+class SPIHelper : public SPIBurstHelper {
 private:
 	SPIHelper();
 
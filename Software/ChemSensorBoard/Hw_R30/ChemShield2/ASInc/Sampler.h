@@ -28,10 +28,16 @@
 #define IIR1    0
 #define IIR2    1
 
+// CIC decimation filter order: 1 is integrate and dump, 2 is for stronger anti-aliasing
+#define CIC_MIN_ORDER           1
+#define CIC_MAX_ORDER           2
+
 class DitherTool;
 
 /* This is the base class for a sampler unit. 
-   A sampler unit implements a basic sampler with prescaler, IIR and decimation timing option 
+   A sampler unit implements a basic sampler with prescaler, IIR and decimation timing option.
+   Decimation is performed by a CIC (integrate and dump when first order) filter 
+   so all the incoming samples contribute to the decimated one
 */
 class Sampler {
     
@@ -46,6 +52,10 @@ public:
     
     virtual void setDecimation(unsigned char value);
     virtual unsigned char getDecimation();
+    virtual unsigned short getDecimationRatio();
+    
+    virtual void setCICOrder(unsigned char value);
+    virtual unsigned char getCICOrder();
     
     virtual void setIIRDenom(unsigned char iIRID, unsigned char value);
     virtual unsigned char getIIRDenom(unsigned char iIRID);
@@ -73,6 +83,9 @@ protected:
     virtual bool applyDecimationFilter();
     virtual void applyIIRFilter(unsigned char iiRID);
     virtual void onReadSample(unsigned short newSample);
+
+private:
+    void resetDecimationFilter();
     
 protected:
     volatile bool  go;                   // it's time for a new sample (shared info from interrupt)
@@ -82,6 +95,9 @@ protected:
     
     unsigned char  decimation;           // decimation filter length
     unsigned char  decimationTimer;      // this is the decimation counter
+    unsigned char  cicOrder;             // CIC decimation filter order
+    unsigned long  cicIntegrator[CIC_MAX_ORDER];    // CIC integrators (input rate, modulo 2^32)
+    unsigned long  cicComb[CIC_MAX_ORDER];          // CIC comb delay elements (output rate)
     unsigned short workSample;           // working register for FIR filtering
     unsigned short lastSample;           // last valid sample read
 
@@ -27,6 +27,7 @@
 #define	SENSORSARRAY_H
 
 #include "ADC16S626.h"
+#include "ADCScanner.h"
 #include "SHT31.h"
 #include "BMP280.h"
 #include "DitherTool.h"
@@ -70,6 +71,8 @@ public:
     bool getSamplePostscaler(unsigned char channel, unsigned char* postscaler);
     unsigned char setSampleDecimation(unsigned char channel, unsigned char decimation);
     bool getSampleDecimation(unsigned char channel, unsigned char* decimation);
+    unsigned char setSampleCICOrder(unsigned char channel, unsigned char order);
+    bool getSampleCICOrder(unsigned char channel, unsigned char* order);
     bool setSampleIIRDenominators(unsigned char channel, unsigned char iirDen1, unsigned char iirDen2);
     bool getSampleIIRDenominators(unsigned char channel, unsigned char *iirDen1, unsigned char *iirDen2);
     
@@ -101,12 +104,14 @@ public:
 
     bool timerTick();
     bool loop();
+    void onADCTransferCompleted();
 
 private:
     unsigned short twoComplement(unsigned short sample);
 
 private:
     static const ADC16S626 ADCList[NUM_OF_CHEM_SENSORS];    // The ADC devices for chemical sensors
+    static ADCScanner adcScanner;                           // Timer triggered scanner for the chemical sensors ADCs
 
     static SHT31 sht31i;                                    // Onboard Temperature and humidity sensor
     static SHT31 sht31e;                                    // Flyboard Temperature and humidity sensor
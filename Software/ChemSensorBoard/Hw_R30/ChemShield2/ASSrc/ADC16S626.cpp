@@ -41,6 +41,12 @@ unsigned short ADC16S626::getSample() const {
     rxData = AS_SPI.transfer(txDummy);
     AS_GPIO.digitalWrite(m_csPin, HIGH);
     
+    return decodeSample(rxData);
+}
+
+// Convert the raw two words read from the ADC into a linear sample
+unsigned short ADC16S626::decodeSample(uint32_t rxData) const {
+
     unsigned short result = ((rxData & 0x3FFF) << 2) | ((rxData >> 30) & 0x0003);
     result = toLinear(result);
     
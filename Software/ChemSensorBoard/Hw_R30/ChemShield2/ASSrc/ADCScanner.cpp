@@ -0,0 +1,151 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu, 
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and 
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *			European Commission - Joint Research Centre, 
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#include "ADCScanner.h"
+#include "ADC16S626.h"
+#include "GPIOHelper.h"
+#include "SPIHelper.h"
+
+#include <string.h>
+
+ADCScanner::ADCScanner(const ADC16S626* _adcList, unsigned char _numOfADCs) : adcList(_adcList),
+            numOfADCs((_numOfADCs > ADCSCANNER_MAX_ADCS)? ADCSCANNER_MAX_ADCS : _numOfADCs), 
+            frontBuffer(0), frameCounter(0), scanCounter(0), scanning(false), scanPending(false), 
+            currentADC(0), scanTimer(0), 
+            txDummy(0), rxData(0) {
+
+    memset(buffer, 0, sizeof(buffer));
+}
+
+ADCScanner::~ADCScanner() {
+}
+
+// Called from the timer interrupt on each tick. Scans are started
+// here so that they are aligned with the sampling timebase.
+void ADCScanner::timerTick(bool requestScan) {
+    
+    if (requestScan) {
+        scanPending = true;
+    }
+    
+    if (scanning) {
+        
+        // The request will be served by a new scan chained to this one
+        if (scanTimer < ADCSCANNER_TIMEOUT) {
+            scanTimer++;
+            return;
+        }
+        
+        // Recover from a scan that never completed and start it again
+        AS_SPI.abortBurst();
+        endTransfer();
+        scanning = false;
+        scanPending = true;
+    }
+    
+    if (scanPending) {
+        startScan();
+    }
+}
+
+// Called from the SPI interrupt at the end of each ADC transfer
+void ADCScanner::onTransferCompleted() {
+    
+    if (!scanning) {
+        return;
+    }
+    
+    endTransfer();
+    
+    if (!AS_SPI.burstSucceeded()) {
+        
+        // Drop the whole scan and retry on next timer tick. 
+        // The front buffer is still valid.
+        scanning = false;
+        scanPending = true;
+        return;
+    }
+    
+    unsigned char backBuffer = frontBuffer ^ 0x01;
+    buffer[backBuffer][currentADC] = adcList[currentADC].decodeSample(rxData);
+    
+    currentADC++;
+    if (currentADC < numOfADCs) {
+        startTransfer();
+        return;
+    }
+
+    // Scan completed: swap the buffers
+    frontBuffer = backBuffer;
+    frameCounter = scanCounter;
+    scanning = false;
+    
+    // Serve the requests received while scanning
+    if (scanPending) {
+        startScan();
+    }
+}
+
+// Return the number of the first scan that will be started from now on.
+// Samples requested now must be taken from this scan or a later one.
+unsigned long ADCScanner::getNextFrame() const {
+    return scanCounter + 1;
+}
+// Read the sample for an ADC from the last complete scan, 
+// only if the scan is not older than minFrame
+bool ADCScanner::getSample(unsigned char adc, unsigned long minFrame, unsigned short* sample) const {
+    
+    if ((adc >= numOfADCs) || ((long)(frameCounter - minFrame) < 0)) {
+        return false;
+    }
+    
+    *sample = buffer[frontBuffer][adc];
+    return true;
+}
+
+void ADCScanner::startScan() {
+    
+    scanPending = false;
+    scanning = true;
+    scanTimer = 0;
+    currentADC = 0;
+    scanCounter++;
+    startTransfer();
+}
+
+void ADCScanner::startTransfer() {
+    
+    AS_GPIO.digitalWrite(adcList[currentADC].getCsPin(), LOW);
+    if (!AS_SPI.startBurst((uint8_t*)&txDummy, (uint8_t*)&rxData, 2)) {
+        
+        // Retry on next timer tick
+        endTransfer();
+        scanning = false;
+        scanPending = true;
+    }
+}
+
+void ADCScanner::endTransfer() {
+    AS_GPIO.digitalWrite(adcList[currentADC].getCsPin(), HIGH);
+}
@@ -30,6 +30,7 @@
 #include "ChemSensorBoardImpl.h"
 #include "GlobalHalHandlers.h"
 #include "GPIOHelper.h"
+#include "SPIHelper.h"
 #include "SerialAHelper.h"
 #include "SerialBHelper.h"
 #include "SerialUSBHelper.h"
@@ -74,6 +75,20 @@ void uart2Error() {
 	SerialB.onErrorCallback();
 }
 
+void spi1Interrupt() {
+	AS_SPI.onBurstCompleted(true);
+	if (sensorBoard) {
+		sensorBoard->onADCTransferCompleted();
+	}
+}
+
+void spi1Error() {
+	AS_SPI.onBurstCompleted(false);
+	if (sensorBoard) {
+		sensorBoard->onADCTransferCompleted();
+	}
+}
+
 void usbRxCallback(unsigned char* buffer, long bufferLen) {
 	((SerialUSBHelper*)SerialUSBHelper::getInstance())->onDataRx(buffer, bufferLen);
 	LEDs.pulse(LEDsHelper::RXDATA);
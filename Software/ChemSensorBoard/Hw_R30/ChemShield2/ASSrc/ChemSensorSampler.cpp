@@ -24,7 +24,8 @@
 
 #include "ChemSensorSampler.h"
 
-ChemSensorSampler::ChemSensorSampler(const ADC16S626& adc) : sensor(adc) {
+ChemSensorSampler::ChemSensorSampler(const ADCScanner& _scanner, unsigned char _adcChannel) : 
+                    scanner(_scanner), adcChannel(_adcChannel), requestedFrame(0) {
 }
 
 ChemSensorSampler::~ChemSensorSampler() {
@@ -34,8 +35,10 @@ bool ChemSensorSampler::sampleTick() {
 
     if (timer == prescaler) {
         
-        // It's time for a new sample
+        // It's time for a new sample. It will be taken
+        // by the ADC scan started with this timer tick
         timer = 0;
+        requestedFrame = scanner.getNextFrame();
         go = true;
         return true;
     }
@@ -48,7 +51,13 @@ bool ChemSensorSampler::sampleLoop() {
 
     // Take the new sample if channel is enabled
     if (enabled && go) {
-        onReadSample(sensor.getSample());
+        unsigned short sample;
+        if (!scanner.getSample(adcChannel, requestedFrame, &sample)) {
+            
+            // The scan is still in progress
+            return false;
+        }
+        onReadSample(sample);
         go = false;
         
         // Filter with two cascade single pole IIRs
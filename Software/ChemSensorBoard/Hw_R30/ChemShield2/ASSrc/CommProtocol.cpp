@@ -66,7 +66,9 @@ const CommProtocol::commandinfo CommProtocol::validCommands[] = {
 	{ COMMPROTOCOL_READ_UNITS, 1, &CommProtocol::readUnits },
 	{ COMMPROTOCOL_READ_BOARDTYPE, 1, &CommProtocol::readBoardType },
 	{ COMMPROTOCOL_WRITE_CHANENABLE, 1, &CommProtocol::writeChannelEnable },
-	{ COMMPROTOCOL_READ_CHANENABLE, 1, &CommProtocol::readChannelEnable }
+	{ COMMPROTOCOL_READ_CHANENABLE, 1, &CommProtocol::readChannelEnable },
+	{ COMMPROTOCOL_SET_CICORDER, 2, &CommProtocol::setSampleCICOrder },
+	{ COMMPROTOCOL_GET_CICORDER, 1, &CommProtocol::getSampleCICOrder }
 };
 
 const char CommProtocol::commProtocolErrorString[] = { COMMPROTOCOL_ERROR };
@@ -240,8 +242,9 @@ void CommProtocol::writeValue(unsigned long value, bool last) {
 
 void CommProtocol::writeValue(float value, bool last) {
 
-    unsigned long iValue = *((unsigned long*)&value);
-    writeValue(iValue, last);
+    uint32_t iValue;
+    memcpy(&iValue, &value, sizeof(iValue));
+    writeValue((unsigned long)iValue, last);
 }
 
 void CommProtocol::writeString(unsigned char* value, bool last) {
@@ -375,6 +378,35 @@ bool CommProtocol::getSampleDecimation(CommProtocol* context, unsigned char cmdO
     return true;
 }
 
+// Function handler: set sampler decimation CIC filter order
+bool CommProtocol::setSampleCICOrder(CommProtocol* context, unsigned char cmdOffset) {
+    
+    unsigned char channel = context->getParameter(0);
+    unsigned char order = context->getParameter(1);    
+    if (context->sensorsArray->setSampleCICOrder(channel, order)) {
+        return context->renderOKAnswer(cmdOffset, channel);
+    }
+    return false;
+}
+
+// Function handler: get sampler decimation CIC filter order
+bool CommProtocol::getSampleCICOrder(CommProtocol* context, unsigned char cmdOffset) {
+
+    unsigned char channel = context->getParameter(0);
+    unsigned char order;
+    if (!context->sensorsArray->getSampleCICOrder(channel, &order)) {
+        return false;
+    }
+
+    context->buffer[0] = COMMPROTOCOL_HEADER;
+    context->buffer[1] = validCommands[cmdOffset].commandID;
+    context->buffer[2] = 0;
+    context->writeValue(channel, false);
+    context->writeValue(order, true);
+
+    return true;
+}
+
 // Function handler: retrieve the IIR denominator values for a specific channel
 bool CommProtocol::getSampleIIRDenominators(CommProtocol* context, unsigned char cmdOffset) {
 
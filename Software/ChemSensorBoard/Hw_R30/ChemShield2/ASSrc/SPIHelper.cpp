@@ -32,7 +32,7 @@
 // Singleton SPIHelper instance
 const SPIHelper SPIHelper::instance;
 
-SPIHelper::SPIHelper() {
+SPIHelper::SPIHelper() : SPIBurstHelper(&hspi1) {
 }
 
 SPIHelper::~SPIHelper() {
@@ -42,6 +42,8 @@ Sampler::Sampler() {
     blankTimer = DEFAULT_BLANK_TIMER_PERIOD;
     workSample = 0; 
     lastSample = 0;
+    cicOrder = CIC_MIN_ORDER;
+    resetDecimationFilter();
     iIRDenum[0] = 0;
     iIRDenum[1] = 0;
     iIRAccumulator[0] = 0;
@@ -54,6 +56,7 @@ void Sampler::onStartSampling() {
 	blankTimer = DEFAULT_BLANK_TIMER_PERIOD;
     workSample = 0;
     lastSample = 0;
+    resetDecimationFilter();
     iIRAccumulator[0] = 0;
     iIRAccumulator[1] = 0;
 }
@@ -71,20 +74,62 @@ void Sampler::setDecimation(unsigned char value) {
     decimation = value; 
     decimationTimer = 0;
     blankTimer = DEFAULT_BLANK_TIMER_PERIOD;
+    resetDecimationFilter();
 }
 
 unsigned char Sampler::getDecimation() {
     return decimation;
 }
 
+unsigned short Sampler::getDecimationRatio() {
+    return (unsigned short)decimation + 1;
+}
+
+// Values out of range select the integrate and dump filter, so the
+// erased EEPROM content of presets saved before CIC support loads as first order
+void Sampler::setCICOrder(unsigned char value) {
+    cicOrder = ((value < CIC_MIN_ORDER) || (value > CIC_MAX_ORDER))? CIC_MIN_ORDER : value;
+    decimationTimer = 0;
+    blankTimer = DEFAULT_BLANK_TIMER_PERIOD;
+    resetDecimationFilter();
+}
+
+unsigned char Sampler::getCICOrder() {
+    return cicOrder;
+}
+
 unsigned short Sampler::getLastSample() {
     return lastSample;
 }
 
+// Apply the CIC decimation filter. Input is from workSample, output to lastSample.
+// Integrators run at the input rate and combs at the output rate; the unsigned
+// modulo 2^32 arithmetic makes integrators wrap-around harmless. The output
+// range (ratio^order * 65535) fits 32 bits up to the maximum ratio of 256.
 bool Sampler::applyDecimationFilter() {
     
-    if (decimationTimer == decimation) {
+    unsigned char order = cicOrder;
+    unsigned short ratio = getDecimationRatio();
+    
+    unsigned long value = workSample;
+    for (unsigned char n = 0; n < order; n++) {
+        cicIntegrator[n] += value;
+        value = cicIntegrator[n];
+    }
+    
+    if (decimationTimer == (ratio - 1)) {
         decimationTimer = 0;
+        
+        for (unsigned char n = 0; n < order; n++) {
+            unsigned long delayed = cicComb[n];
+            cicComb[n] = value;
+            value = value - delayed;
+        }
+        
+        // Remove the filter gain (ratio^order) and keep the fractional part by dithering
+        double gain = (order == 2)? ((double)ratio * ratio) : (double)ratio;
+        double result = ditherTool->applyDithering((double)value / gain);
+        workSample = (result > 65535.0)? 65535 : (unsigned short)result;
 
         // Update the lastSample only after
         // elapsed blank period
@@ -100,6 +145,14 @@ bool Sampler::applyDecimationFilter() {
     return ((decimationTimer == 0) || (blankTimer != 0));
 }
 
+void Sampler::resetDecimationFilter() {
+    
+    for (unsigned char n = 0; n < CIC_MAX_ORDER; n++) {
+        cicIntegrator[n] = 0;
+        cicComb[n] = 0;
+    }
+}
+
 unsigned char Sampler::getIIRDenom(unsigned char iIRID) {
 
     if (iIRID > 1)
@@ -158,10 +211,12 @@ bool Sampler::loadPreset(unsigned char myID) {
     unsigned char iir1Denom = EEPROM.read(SAMPLER_PRESET_IIR1DENOM(myID));
     unsigned char iiR2Denom = EEPROM.read(SAMPLER_PRESET_IIR2DENOM(myID));
     unsigned char enabled = EEPROM.read(SAMPLER_PRESET_CHENABLED(myID));
+    unsigned char cicOrderVal = EEPROM.read(SAMPLER_PRESET_CICORDER(myID));
 
     // Apply
     setPreScaler(prescVal);
     setDecimation(decimVal);
+    setCICOrder(cicOrderVal);
     setIIRDenom(0, iir1Denom);
     setIIRDenom(1, iiR2Denom);
     setEnableChannel(enabled);
@@ -177,6 +232,7 @@ bool Sampler::savePreset(unsigned char myID) {
     EEPROM.write(SAMPLER_PRESET_IIR1DENOM(myID), getIIRDenom(0));
     EEPROM.write(SAMPLER_PRESET_IIR2DENOM(myID), getIIRDenom(1));
     EEPROM.write(SAMPLER_PRESET_CHENABLED(myID), (enabled)?1:0);
+    EEPROM.write(SAMPLER_PRESET_CICORDER(myID), getCICOrder());
     
     return true;
 }
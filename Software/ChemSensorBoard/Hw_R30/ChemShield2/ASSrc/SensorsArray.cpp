@@ -32,18 +32,86 @@
 #include "PressSensorSampler.h"
 #include "Persistence.h"
 #include "EEPROMHelper.h"
+#include "StaticBoard.h"
 #include <string.h>
 
 
 #define BOARD_TYPE_CHEMICALSENSORSHIELD		0x01
 
 const ADC16S626 SensorsArray::ADCList[NUM_OF_CHEM_SENSORS] = { ADC16S626(ADC_1_CSPIN), ADC16S626(ADC_2_CSPIN), ADC16S626(ADC_3_CSPIN), ADC16S626(ADC_4_CSPIN) };
+ADCScanner SensorsArray::adcScanner = ADCScanner(ADCList, NUM_OF_CHEM_SENSORS);
 SHT31 SensorsArray::sht31i = SHT31(true);
 SHT31 SensorsArray::sht31e = SHT31(false);
 BMP280 SensorsArray::bmp280 = BMP280();
 DitherTool SensorsArray::ditherTool = DitherTool();
 
+// Board description. Frontends, DACs, samplers and averagers concrete types are listed in channel order.
+// Each physical channel has its own sampler, so the channel map is the identity.
+struct ChemShieldTwoBoard {
+	typedef TypeList<LMP91000Eval, LMP91000Eval, LMP91000Eval, LMP91000Eval> afes;
+	typedef TypeList<AD5694REval, AD5694REval, AD5694REval, AD5694REval> dacs;
+	typedef TypeList<ChemSensorSampler, ChemSensorSampler, ChemSensorSampler, ChemSensorSampler,
+					 PressSensorSampler, TempSensorSampler, HumSensorSampler, TempSensorSampler, HumSensorSampler> samplers;
+	typedef TypeList<SamplesAverager, SamplesAverager, SamplesAverager, SamplesAverager,
+					 SamplesAverager, SamplesAverager, SamplesAverager, SamplesAverager, SamplesAverager> averagers;
+};
+
+// Hot loops operations. Each object is reached with a qualified, non virtual,
+// call bound at compile time to its concrete type (see StaticBoard.h)
+struct SamplerTick {
+	Sampler* const* samplers;
+	bool chemSample;
+	bool result;
+
+	template <class T, unsigned char N> void visit() {
+		bool newSample = static_cast<T*>(samplers[N])->T::sampleTick();
+		if (N < NUM_OF_CHEM_SENSORS) {
+			chemSample |= newSample;
+		}
+		result |= newSample;
+	}
+};
+
+struct SamplerLoop {
+	Sampler* const* samplers;
+	SamplesAverager* const* averagers;
+	unsigned long timestamp;
+	bool result;
+
+	template <class T, unsigned char N> void visit() {
+		T* sampler = static_cast<T*>(samplers[N]);
+		if (sampler->T::sampleLoop()) {
+
+			// A new sample is ready to be averaged
+			result |= averagers[N]->SamplesAverager::collectSample(sampler->T::getLastSample(), timestamp);
+		}
+	}
+};
+
+struct AveragerConstruct {
+	SamplesAverager** averagers;
+
+	template <class T, unsigned char N> void visit() {
+		averagers[N] = constructStatic<ChemShieldTwoBoard::averagers, N>();
+	}
+};
+
+// Objects are placement constructed into static storage, with the types in the board description
+#define AFE(n, ...)			constructStatic<ChemShieldTwoBoard::afes, n>(__VA_ARGS__)
+#define DAC(n, ...)			constructStatic<ChemShieldTwoBoard::dacs, n>(__VA_ARGS__)
+#define SAMPLER(n, ...)		constructStatic<ChemShieldTwoBoard::samplers, n>(__VA_ARGS__)
+
 SensorsArray::SensorsArray() : samplingEnabled(false), timestamp(0) {
+
+    // Chemical sensors channels are used as index for the ADC, AFE and DAC lists
+    static_assert((CHEMSENSOR_1 == 0) && (CHEMSENSOR_2 == (CHEMSENSOR_1 + 1)) && (CHEMSENSOR_3 == (CHEMSENSOR_2 + 1)) &&
+                  (CHEMSENSOR_4 == (CHEMSENSOR_3 + 1)) && (CHEMSENSOR_4 == (NUM_OF_CHEM_SENSORS - 1)), "Chemical sensors channels mismatch");
+    static_assert((PRESSENSOR_1 > CHEMSENSOR_4) && (TEMPSENSOR_1 > CHEMSENSOR_4) && (HUMSENSOR_1 > CHEMSENSOR_4) &&
+                  (TEMPSENSOR_2 > CHEMSENSOR_4) && (HUMSENSOR_2 < NUM_OF_TOTAL_SENSORS), "Environmental sensors channels mismatch");
+    static_assert((TypeListSize<ChemShieldTwoBoard::afes>::value == NUM_OF_CHEM_SENSORS) &&
+                  (TypeListSize<ChemShieldTwoBoard::dacs>::value == NUM_OF_CHEM_SENSORS) &&
+                  (TypeListSize<ChemShieldTwoBoard::samplers>::value == NUM_OF_TOTAL_SENSORS) &&
+                  (TypeListSize<ChemShieldTwoBoard::averagers>::value == NUM_OF_TOTAL_SENSORS), "Malformed board description");
     
     // Initialize the internal coefficients for the pressure sensor
     bmp280.begin();
@@ -52,43 +120,36 @@ SensorsArray::SensorsArray() : samplingEnabled(false), timestamp(0) {
     sht31i.begin();
     sht31e.begin();
     
-    // Initialize the samplers and averagers array (yes, I know, this could be skipped but it's done for safety reasons)
-    memset(AFEList, 0, sizeof(AFEList));
-    memset(DACList, 0, sizeof(DACList));
-    memset(samplers, 0, sizeof(samplers));
-    memset(averagers, 0, sizeof(averagers));
-    
     // Initialize the AFEList
-    AFEList[CHEMSENSOR_1] = new LMP91000Eval(AFE_1_ENPIN);
-    AFEList[CHEMSENSOR_2] = new LMP91000Eval(AFE_2_ENPIN);
-    AFEList[CHEMSENSOR_3] = new LMP91000Eval(AFE_3_ENPIN);
-    AFEList[CHEMSENSOR_4] = new LMP91000Eval(AFE_4_ENPIN);
+    AFEList[CHEMSENSOR_1] = AFE(CHEMSENSOR_1, AFE_1_ENPIN);
+    AFEList[CHEMSENSOR_2] = AFE(CHEMSENSOR_2, AFE_2_ENPIN);
+    AFEList[CHEMSENSOR_3] = AFE(CHEMSENSOR_3, AFE_3_ENPIN);
+    AFEList[CHEMSENSOR_4] = AFE(CHEMSENSOR_4, AFE_4_ENPIN);
 
     // Initialize the DACList
-    DACList[CHEMSENSOR_1] = new AD5694REval(DAC_1_GAINPIN, AD5694_SLAVE_1);
-    DACList[CHEMSENSOR_2] = new AD5694REval(DAC_2_GAINPIN, AD5694_SLAVE_2);
-    DACList[CHEMSENSOR_3] = new AD5694REval(DAC_3_GAINPIN, AD5694_SLAVE_3);
-    DACList[CHEMSENSOR_4] = new AD5694REval(DAC_4_GAINPIN, AD5694_SLAVE_4);
+    DACList[CHEMSENSOR_1] = DAC(CHEMSENSOR_1, DAC_1_GAINPIN, AD5694_SLAVE_1);
+    DACList[CHEMSENSOR_2] = DAC(CHEMSENSOR_2, DAC_2_GAINPIN, AD5694_SLAVE_2);
+    DACList[CHEMSENSOR_3] = DAC(CHEMSENSOR_3, DAC_3_GAINPIN, AD5694_SLAVE_3);
+    DACList[CHEMSENSOR_4] = DAC(CHEMSENSOR_4, DAC_4_GAINPIN, AD5694_SLAVE_4);
 
     // Initialize the sampler units
-    samplers[CHEMSENSOR_1] = new ChemSensorSampler(ADCList[CHEMSENSOR_1]);
-    samplers[CHEMSENSOR_2] = new ChemSensorSampler(ADCList[CHEMSENSOR_2]);
-    samplers[CHEMSENSOR_3] = new ChemSensorSampler(ADCList[CHEMSENSOR_3]);
-    samplers[CHEMSENSOR_4] = new ChemSensorSampler(ADCList[CHEMSENSOR_4]);
-    samplers[PRESSENSOR_1] = new PressSensorSampler(bmp280);
-    samplers[TEMPSENSOR_1] = new TempSensorSampler(sht31e);
-    samplers[HUMSENSOR_1] = new HumSensorSampler((TempSensorSampler*)samplers[TEMPSENSOR_1]);
-    samplers[TEMPSENSOR_2] = new TempSensorSampler(sht31i);
-    samplers[HUMSENSOR_2] = new HumSensorSampler((TempSensorSampler*)samplers[TEMPSENSOR_2]);
+    samplers[CHEMSENSOR_1] = SAMPLER(CHEMSENSOR_1, adcScanner, CHEMSENSOR_1);
+    samplers[CHEMSENSOR_2] = SAMPLER(CHEMSENSOR_2, adcScanner, CHEMSENSOR_2);
+    samplers[CHEMSENSOR_3] = SAMPLER(CHEMSENSOR_3, adcScanner, CHEMSENSOR_3);
+    samplers[CHEMSENSOR_4] = SAMPLER(CHEMSENSOR_4, adcScanner, CHEMSENSOR_4);
+    samplers[PRESSENSOR_1] = SAMPLER(PRESSENSOR_1, bmp280);
+    samplers[TEMPSENSOR_1] = SAMPLER(TEMPSENSOR_1, sht31e);
+    samplers[HUMSENSOR_1] = SAMPLER(HUMSENSOR_1, (TempSensorSampler*)samplers[TEMPSENSOR_1]);
+    samplers[TEMPSENSOR_2] = SAMPLER(TEMPSENSOR_2, sht31i);
+    samplers[HUMSENSOR_2] = SAMPLER(HUMSENSOR_2, (TempSensorSampler*)samplers[TEMPSENSOR_2]);
     
     // Set the dithering tool. Being a static variable, all object share it so 
     // is possible to initialize only one sampler object.
     samplers[CHEMSENSOR_1]->setDitherTool(&ditherTool);
     
     // Create the averagers
-    for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
-        averagers[n] = new SamplesAverager();
-    }
+    AveragerConstruct averagerConstruct = { averagers };
+    StaticForEach<ChemShieldTwoBoard::averagers>::apply(averagerConstruct);
     
     // Set the dithering tool. See the above comment.
     averagers[CHEMSENSOR_1]->setDitherTool(&ditherTool);
@@ -104,42 +165,33 @@ SensorsArray::SensorsArray() : samplingEnabled(false), timestamp(0) {
     }
 }
 
+// Objects live in static storage and are only destroyed
 SensorsArray::~SensorsArray() {
 
 	for (unsigned char n = 0; n < NUM_OF_CHEM_SENSORS; n++) {
-		if (AFEList[n]) {
-			delete AFEList[n];
-		}
-		if (DACList[n]) {
-			delete DACList[n];
-		}
+		AFEList[n]->~LMP91000Eval();
+		DACList[n]->~AD5694REval();
 	}
     for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
-        if (samplers[n]) {
-            delete samplers[n];
-        }
-        if (averagers[n]) {
-        	delete averagers[n];
-        }
+    	samplers[n]->~Sampler();
+    	averagers[n]->~SamplesAverager();
     }
 }
 
 
 bool SensorsArray::timerTick() {
     
-    bool result = false;
-
     // Loop on each sensor samplers
-    for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
-        if (samplers[n] != 0) {
-            result |= samplers[n]->sampleTick();
-        }
-    }
+    SamplerTick samplerTick = { samplers, false, false };
+    StaticForEach<ChemShieldTwoBoard::samplers>::apply(samplerTick);
+    
+    // Capture all the chemical sensors at once, in the timer context
+    adcScanner.timerTick(samplingEnabled && samplerTick.chemSample);
     
     // Increase the internal timestamp
     timestamp++;
     
-    return result;
+    return samplerTick.result;
 }
 
 bool SensorsArray::loop() {
@@ -150,18 +202,15 @@ bool SensorsArray::loop() {
     }
     
     // Otherwise loop on each sensor sampler and averager
-    bool result = false;
-    for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
-        if (samplers[n] != 0) {
-            if (samplers[n]->sampleLoop()) {
-                
-                // A new sample is ready to be averaged
-                result |= averagers[n]->collectSample(samplers[n]->getLastSample(), timestamp);
-            };
-        }
-    }
+    SamplerLoop samplerLoop = { samplers, averagers, timestamp, false };
+    StaticForEach<ChemShieldTwoBoard::samplers>::apply(samplerLoop);
     
-    return result;
+    return samplerLoop.result;
+}
+
+// Called from the SPI interrupt
+void SensorsArray::onADCTransferCompleted() {
+    adcScanner.onTransferCompleted();
 }
 
 bool SensorsArray::getIsFlyboardReady() {
@@ -223,6 +272,23 @@ bool SensorsArray::getSampleDecimation(unsigned char channel, unsigned char* dec
     return true;
 }
 
+unsigned char SensorsArray::setSampleCICOrder(unsigned char channel, unsigned char order) {
+    if ((channel >= NUM_OF_TOTAL_SENSORS) || (samplers[channel] == 0))
+        return 0;
+
+    samplers[channel]->setCICOrder(order);
+    return 1;
+}
+
+bool SensorsArray::getSampleCICOrder(unsigned char channel, unsigned char* order) {
+    if ((channel >= NUM_OF_TOTAL_SENSORS) || (samplers[channel] == 0))
+        return false;
+
+    *order = samplers[channel]->getCICOrder();
+    
+    return true;
+}
+
 bool SensorsArray::getSampleIIRDenominators(unsigned char channel, unsigned char* iirDen1, unsigned char* iirDen2) {
     if ((channel >= NUM_OF_TOTAL_SENSORS) || (samplers[channel] == 0))
         return false;
@@ -520,7 +586,7 @@ bool SensorsArray::readChannelSamplePeriod(unsigned char channel, unsigned long
     }
 
 	*samplePeriod = (averagers[channel]->getBufferSize() + 1) *
-					(samplers[channel]->getDecimation() + 1) *
+					samplers[channel]->getDecimationRatio() *
 					(samplers[channel]->getPrescaler() + 1) * 10;
 
 	return true;
@@ -134,6 +134,8 @@ int main(void)
   MX_CRC_Init();
 
   /* USER CODE BEGIN 2 */
+  HAL_NVIC_SetPriority(SPI1_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(SPI1_IRQn);
   setup_impl();
   /* USER CODE END 2 */
 
@@ -583,6 +585,22 @@ void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
 	}
 }
 
+void SPI1_IRQHandler(void) {
+	HAL_SPI_IRQHandler(&hspi1);
+}
+
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi) {
+	if (hspi->Instance == SPI1) {
+		spi1Interrupt();
+	}
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+	if (hspi->Instance == SPI1) {
+		spi1Error();
+	}
+}
+
 
 /* USER CODE END 4 */
 
@@ -0,0 +1,95 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *			European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#ifndef SPIBURSTHELPER_H_
+#define SPIBURSTHELPER_H_
+
+#include "stm32f0xx_hal.h"
+
+/* Non blocking, interrupt driven, full duplex SPI burst transfers.
+   Shared by the boards SPIHelper singletons, which inherit from it and bind
+   it to their own SPI handle. The HAL SPI callbacks must forward the transfer
+   completion (or error) to onBurstCompleted().
+   The data frame size (8 or 16 bits) is the one of the current SPI configuration.
+*/
+class SPIBurstHelper {
+protected:
+	SPIBurstHelper(SPI_HandleTypeDef* _hspi) : hspi(_hspi), burstStatus(BURST_IDLE) {}
+
+public:
+	virtual ~SPIBurstHelper() {}
+
+	// Start a transfer of len data frames.
+	// The caller is in charge of the chip select line for the whole burst
+	// and must keep both buffers valid until burstRunning() returns false.
+	bool startBurst(uint8_t* txBuffer, uint8_t* rxBuffer, uint16_t len) const {
+
+		if (burstStatus == BURST_RUNNING) {
+			return false;
+		}
+
+		burstStatus = BURST_RUNNING;
+		if (HAL_SPI_TransmitReceive_IT(hspi, txBuffer, rxBuffer, len) != HAL_OK) {
+			burstStatus = BURST_ERROR;
+			return false;
+		}
+
+		return true;
+	}
+
+	bool burstRunning() const {
+		return (burstStatus == BURST_RUNNING);
+	}
+
+	bool burstSucceeded() const {
+		return (burstStatus == BURST_DONE);
+	}
+
+	void abortBurst() const {
+
+		if (burstStatus == BURST_RUNNING) {
+			HAL_SPI_Abort(hspi);
+			burstStatus = BURST_ERROR;
+		}
+	}
+
+	// Called by the HAL SPI callbacks (interrupt context)
+	void onBurstCompleted(bool success) const {
+		burstStatus = (success)? BURST_DONE : BURST_ERROR;
+	}
+
+private:
+	typedef enum _burststatus {
+		BURST_IDLE,
+		BURST_RUNNING,
+		BURST_DONE,
+		BURST_ERROR,
+	} burststatus;
+
+private:
+	SPI_HandleTypeDef* const hspi;
+	mutable volatile burststatus burstStatus;
+};
+
+#endif /* SPIBURSTHELPER_H_ */
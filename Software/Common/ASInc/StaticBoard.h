@@ -0,0 +1,153 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *			European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#ifndef STATICBOARD_H_
+#define STATICBOARD_H_
+
+#include <new>
+#include <utility>
+
+/* Compile time board description toolset, shared by the boards SensorsArray.
+   Each board lists the concrete types of its devices, samplers and averagers
+   (in sensor order) and the subchannels exported by each sensor. From that:
+   - objects are placement constructed into static storage (no heap),
+   - the hot loops visit each object with a non virtual, qualified, call,
+   - the logical channels to sensor subchannels map is generated.
+*/
+
+// Ordered list of concrete types
+template <class... Types> struct TypeList {};
+
+template <class List> struct TypeListSize;
+template <class... Types> struct TypeListSize< TypeList<Types...> > {
+	static const unsigned char value = sizeof...(Types);
+};
+
+// N-th type of a list
+template <class List, unsigned char N> struct TypeAt;
+template <class Type, class... Rest> struct TypeAt<TypeList<Type, Rest...>, 0> {
+	typedef Type type;
+};
+template <class Type, class... Rest, unsigned char N> struct TypeAt<TypeList<Type, Rest...>, N> {
+	typedef typename TypeAt<TypeList<Rest...>, N - 1>::type type;
+};
+
+// Call op.visit<Type, Index>() for each type of the list, in index order.
+// Loops are unrolled at compile time so each call is bound to its own type.
+template <class List, unsigned char Index = 0> struct StaticForEach;
+template <unsigned char Index> struct StaticForEach<TypeList<>, Index> {
+	template <class Op> static inline void apply(Op& op) {}
+};
+template <class Type, class... Rest, unsigned char Index> struct StaticForEach<TypeList<Type, Rest...>, Index> {
+	template <class Op> static inline void apply(Op& op) {
+		op.template visit<Type, Index>();
+		StaticForEach<TypeList<Rest...>, Index + 1>::apply(op);
+	}
+};
+
+// Storage for one object, placement constructed at run time (i.e. after the HAL
+// initialization) instead of being allocated on the heap
+template <class T> class StaticInstance {
+public:
+	// Arguments are forwarded as they are: constructors taking a reference
+	// bind to the caller's object, not to a copy
+	template <class... Args> T* construct(Args&&... args) {
+		return new (storage) T(std::forward<Args>(args)...);
+	}
+
+	T* get() {
+		return reinterpret_cast<T*>(storage);
+	}
+
+	void destroy() {
+		get()->~T();
+	}
+
+private:
+	alignas(T) unsigned char storage[sizeof(T)];
+};
+
+// Construct the N-th object of a board list into its own static storage.
+// Types are taken from the list, so the hot loops casts are always consistent.
+template <class List, unsigned char N, class... Args>
+typename TypeAt<List, N>::type* constructStatic(Args&&... args) {
+	static StaticInstance<typename TypeAt<List, N>::type> instance;
+	return instance.construct(std::forward<Args>(args)...);
+}
+
+// Logical channel to sensor subchannel map entry
+typedef struct _channeltosamplersubchannel {
+	unsigned char sampler;
+	unsigned char subchannel;
+	bool firstChannelForSampler;
+} channeltosamplersubchannel;
+
+// Subchannels set for a sensor description
+#define SUBCHANNEL(a)				(1ULL << (a))
+#define SUBCHANNELS_RANGE(num)		(((num) >= 64)? ~0ULL : (SUBCHANNEL(num) - 1))
+
+constexpr unsigned char countSubchannels(unsigned long long subchannels) {
+	return (subchannels == 0)? 0 : ((subchannels & 1) + countSubchannels(subchannels >> 1));
+}
+
+// Position of the n-th subchannel in the set
+constexpr unsigned char nthSubchannel(unsigned long long subchannels, unsigned char n, unsigned char position = 0) {
+	return (subchannels & 1)?
+				((n == 0)? position : nthSubchannel(subchannels >> 1, n - 1, position + 1)) :
+				nthSubchannel(subchannels >> 1, n, position + 1);
+}
+
+// Total number of logical channels exported by the first numSensors sensors
+constexpr unsigned char countChannels(const unsigned long long* subchannels, unsigned char numSensors) {
+	return (numSensors == 0)? 0 : (countSubchannels(subchannels[numSensors - 1]) + countChannels(subchannels, numSensors - 1));
+}
+
+// Map entry for a logical channel, searched from the given sensor
+constexpr channeltosamplersubchannel channelMapEntry(const unsigned long long* subchannels, unsigned char channel, unsigned char sensor = 0) {
+	return (channel < countSubchannels(subchannels[sensor]))?
+				channeltosamplersubchannel{ sensor, nthSubchannel(subchannels[sensor], channel), (channel == 0) } :
+				channelMapEntry(subchannels, channel - countSubchannels(subchannels[sensor]), sensor + 1);
+}
+
+template <unsigned char... Channels> struct ChannelIndices {};
+
+template <unsigned char N, unsigned char... Channels> struct MakeChannelIndices {
+	typedef typename MakeChannelIndices<N - 1, N - 1, Channels...>::type type;
+};
+template <unsigned char... Channels> struct MakeChannelIndices<0, Channels...> {
+	typedef ChannelIndices<Channels...> type;
+};
+
+// Channel map generated from the Board::subchannels description
+template <class Board, class Indices> struct GeneratedChannelMap;
+template <class Board, unsigned char... Channels> struct GeneratedChannelMap<Board, ChannelIndices<Channels...> > {
+	static constexpr channeltosamplersubchannel map[sizeof...(Channels)] = { channelMapEntry(Board::subchannels, Channels)... };
+};
+template <class Board, unsigned char... Channels>
+constexpr channeltosamplersubchannel GeneratedChannelMap<Board, ChannelIndices<Channels...> >::map[sizeof...(Channels)];
+
+template <class Board, unsigned char NumChannels> struct ChannelMap :
+	public GeneratedChannelMap<Board, typename MakeChannelIndices<NumChannels>::type> {};
+
+#endif /* STATICBOARD_H_ */
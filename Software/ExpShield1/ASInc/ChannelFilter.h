@@ -0,0 +1,73 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *			European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#ifndef CHANNELFILTER_H_
+#define CHANNELFILTER_H_
+
+#define CHANNELFILTER_MAX_MEDIAN	5
+
+/* Per channel filter stages applied to each sample before decimation and averaging:
+ * a spike rejecting moving median followed by a single pole IIR.
+ * All the state is preallocated; integer only arithmetic for unsigned short samples.
+ * A channel is expected to be fed with a single sample format.
+ */
+class ChannelFilter {
+public:
+	ChannelFilter();
+	virtual ~ChannelFilter();
+
+	void reset();
+	unsigned short apply(unsigned short sample);
+	float apply(float sample);
+
+	bool setMedianLength(unsigned char length);
+	unsigned char getMedianLength() const;
+	void setIIRDenom(unsigned char denom);
+	unsigned char getIIRDenom() const;
+
+private:
+	unsigned short applyMedian(unsigned short sample);
+	unsigned short applyIIR(unsigned short sample);
+	float applyMedian(float sample);
+	float applyIIR(float sample);
+	void pushMedian();
+
+private:
+	unsigned char medianLength;								// Median window length (1 = disabled)
+	unsigned char medianCount;								// Samples currently in the median window
+	unsigned char medianOffset;								// Next sample position in the median window
+	union {
+		unsigned short u16[CHANNELFILTER_MAX_MEDIAN];
+		float f[CHANNELFILTER_MAX_MEDIAN];
+	} medianBuffer;											// Median window
+
+	unsigned char iIRDenom;									// IIR denominator (0 = disabled)
+	bool iIRValid;											// IIR accumulator has been initialized
+	union {
+		unsigned long q8;
+		float f;
+	} iIRAccumulator;										// IIR accumulator (Q8 or float)
+};
+
+#endif /* CHANNELFILTER_H_ */
@@ -56,6 +56,9 @@
 #define COMMPROTOCOL_READ_BOARDTYPE		'c'
 #define COMMPROTOCOL_WRITE_CHANENABLE	'd'
 #define COMMPROTOCOL_READ_CHANENABLE	'e'
+#define COMMPROTOCOL_WRITE_CHANFILTER	'h'
+#define COMMPROTOCOL_READ_CHANFILTER	'i'
+#define COMMPROTOCOL_READ_SENSORSTATUS	'j'
 
 #define MAX_SERIAL_BUFLENGTH			 64							// Stack temporary buffer size
 #define MAX_INQUIRY_BUFLENGTH            MAX_SERIAL_BUFLENGTH		// Maximum preset/channel name
@@ -118,6 +121,9 @@ private:
     static bool readBoardType(CommProtocol* context, unsigned char cmdOffset);
     static bool writeChannelEnable(CommProtocol* context, unsigned char cmdOffset);
     static bool readChannelEnable(CommProtocol* context, unsigned char cmdOffset);
+    static bool writeChannelFilter(CommProtocol* context, unsigned char cmdOffset);
+    static bool readChannelFilter(CommProtocol* context, unsigned char cmdOffset);
+    static bool readSensorStatus(CommProtocol* context, unsigned char cmdOffset);
     
 private:
     
@@ -37,6 +37,8 @@
  	void uart2Error();
  	void uart3Error();
  	void uart4Error();
+ 	void spi1Interrupt();
+ 	void spi1Error();
  	void usbRxCallback(unsigned char* buffer, long bufferLen);
 	void timerInterrupt();
 	void setup_impl();
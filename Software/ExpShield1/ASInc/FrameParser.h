@@ -0,0 +1,95 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *			European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#ifndef FRAMEPARSER_H_
+#define FRAMEPARSER_H_
+
+class SerialHelper;
+
+#define FRAMEPARSER_MAX_HEADER		2
+#define FRAMEPARSER_BUFFER_SIZE		40
+
+/* Table driven frame synchronizer for UART sensors.
+ * Each device declares its frame layout with a descriptor (header bytes,
+ * length rule, checksum algorithm, endianness); the parser hunts the header,
+ * collects the frame and validates the checksum. consume() drains the serial
+ * ring until a full valid frame has been collected.
+ */
+class FrameParser {
+public:
+	typedef enum _lengthrule {
+		LENGTH_FIXED,			// Frame length is frameBase bytes
+		LENGTH_FIELD8,			// frameBase + 8 bit length field at lengthOffset
+		LENGTH_FIELD16,			// frameBase + 16 bit length field at lengthOffset
+		LENGTH_TABLE			// frameBase + length found in lengthTable for the byte at lengthOffset
+	} lengthrule;
+
+	typedef enum _checksumtype {
+		CHECKSUM_NONE,
+		CHECKSUM_SUM8_INV,		// 0xFF - sum of bytes (8 bit)
+		CHECKSUM_SUM8_NEG,		// 0x100 - sum of bytes (8 bit)
+		CHECKSUM_SUM16			// sum of bytes (16 bit, frame endianness)
+	} checksumtype;
+
+	typedef struct _lengthentry {
+		unsigned char key;		// Command/identifier byte
+		unsigned char length;	// Variable part length for that key
+	} lengthentry;
+
+	typedef struct _descriptor {
+		unsigned char headerLen;						// Number of header bytes
+		unsigned char header[FRAMEPARSER_MAX_HEADER];	// Header bytes, fixed at the frame start
+		lengthrule lengthRule;
+		unsigned char lengthOffset;						// Position of the length field/key byte
+		unsigned char frameBase;						// Frame bytes not accounted by the length rule (header and checksum included)
+		const lengthentry* lengthTable;					// Only for LENGTH_TABLE
+		unsigned char lengthTableSize;
+		checksumtype checksumType;
+		unsigned char checksumStart;					// First byte covered by the checksum
+		bool bigEndian;									// Multibyte fields endianness
+	} descriptor;
+
+public:
+	FrameParser(const descriptor& frameDescriptor);
+	virtual ~FrameParser();
+
+	void reset();
+	bool consume(SerialHelper& serial);
+	bool feed(unsigned char pivotChar);
+
+	unsigned char getByte(unsigned char position) const;
+	unsigned short getWord(unsigned char position) const;
+
+private:
+	bool evaluateLength();
+	bool checkChecksum() const;
+
+private:
+	const descriptor& desc;
+	unsigned char buffer[FRAMEPARSER_BUFFER_SIZE];
+	unsigned char offset;								// Bytes collected so far
+	unsigned char frameLength;							// Expected frame length (0 = still unknown)
+};
+
+#endif /* FRAMEPARSER_H_ */
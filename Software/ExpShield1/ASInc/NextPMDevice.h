@@ -23,6 +23,7 @@
  */
 
 #include "SensorDevice.h"
+#include "FrameParser.h"
 
 #ifndef NEXTPMDEVICE_H_
 #define NEXTPMDEVICE_H_
@@ -55,6 +56,8 @@ class NextPMDevice : public SensorDevice {
 		virtual void setLowPowerMode(bool lowPower);
 		virtual void loop();
 		virtual void tick();
+		virtual void bringUp();
+		virtual void restartBringUp();
 		virtual const char* getSerial() const;
 		virtual bool setChannelName(unsigned char channel, const char* name);
 		virtual const char* getChannelName(unsigned char channel) const;
@@ -69,56 +72,24 @@ class NextPMDevice : public SensorDevice {
 		void enterSleepMode();
 		void exitSleepMode();
 
-		unsigned char checkSum();
 		void requestData(unsigned char command);
-		void onDataReceived(unsigned char pivotChar);
 		void evaluateRxBuffer();
 		bool evaluateState(unsigned char state);
 
-	private:
-		typedef enum _rxstate {
-			RX_IDLE,
-			RX_STARTFOUND,
-			RX_COMMANDFOUND,
-			RX_WAITING_PARAMETERS,
-			RX_WAITING_CRC
-		} rxstate;
-
-		typedef struct _datastruct {
-			unsigned char command;
-			unsigned char state;
-
-			union _data {
-				unsigned char buffer[NEXTPM_DATABUFFERSZ];
-				struct _decodedpm {
-					unsigned short pm1pcs;
-					unsigned short pm25pcs;
-					unsigned short pm10pcs;
-					unsigned short pm1ug;
-					unsigned short pm25ug;
-					unsigned short pm10ug;
-				} decodedpm;
-				struct _dedodedth {
-					unsigned short temperature;
-					unsigned short humidity;
-				} decodedth;
-			} data;
-		} datastruct;
-
 	private:
 		static const char* const channelNames[];
 		static const char* const channelMeasurementUnits[];
 		static double const evaluationFactors[];
+		static const FrameParser::lengthentry frameLengths[];
+		static const FrameParser::descriptor frameDescriptor;
 
 	private:
-		bool deviceFound;
+		bool discoveryRequested;
+		unsigned short discoveryTimer;
 		bool samplingOn;
 		bool go;
 
-		datastruct dataStruct;
-		rxstate curStatus;
-		unsigned char expectedDataSize;
-		unsigned char curRxOffset;
+		FrameParser frameParser;
 };
 
 #endif /* NEXTPMDEVICE_H_ */
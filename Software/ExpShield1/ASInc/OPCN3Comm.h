@@ -104,6 +104,8 @@ private:
 	typedef enum _smstatus {
 		IDLE,
 		WAITING_READY,
+		RECEIVING,
+		BYTE_GAP,
 		EVALUATE,
 	} smstatus;
 
@@ -114,7 +116,9 @@ private:
 		unsigned char retry;
 		unsigned char currRxDataOffset;
 		unsigned char currTxDataOffset;
+		unsigned long byteTime;
 		unsigned char buffer[OPCN3_RXBUFFER];
+		unsigned char txBuffer[OPCN3_RXBUFFER];
 	} smdata;
 
 	typedef enum _opcn3command {
@@ -138,6 +142,9 @@ private:
 private:
 	void resetStateMachine();
 	unsigned char write(unsigned char data);
+	bool startReceiving();
+	bool receiveNextByte();
+	static unsigned long coreCycles();
 	unsigned short CalcCRC(unsigned char data[], unsigned char nbrOfBytes);
 
 private:
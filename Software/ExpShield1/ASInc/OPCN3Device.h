@@ -81,6 +81,8 @@ public:
 	virtual void setLowPowerMode(bool lowPower);
 	virtual void loop();
 	virtual void tick();
+	virtual void bringUp();
+	virtual void restartBringUp();
 
 	virtual const char* getSerial() const;
 
@@ -119,7 +121,6 @@ private:
 private:
 	static const char* const channelNames[];
 	static const char* const channelMeasurementUnits[];
-	static double const evaluationFactors[];
 
 private:
 	bool lowPowerMode;
@@ -129,6 +130,7 @@ private:
 	bool isOPCN2Unit;
 	char serialNumber[OPCN3_SERIAL_NUMBER_MAXLENGTH];
 	volatile unsigned char timer;
+	volatile unsigned short discoveryTimer;
 };
 
 #endif /* OPCN3DEVICE_H_ */
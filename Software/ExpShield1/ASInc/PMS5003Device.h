@@ -26,6 +26,7 @@
 #define PMS5003DEVICE_H_
 
 #include "SensorDevice.h"
+#include "FrameParser.h"
 
 #define PMS5300_PM1CONC_ST		0x00
 #define PMS5300_PM25CONC_ST		0x01
@@ -59,37 +60,14 @@ public:
 	virtual float evaluateMeasurement(unsigned char channel, float value) const;
 
 private:
-	typedef struct _datastruct {
-		unsigned short length;
-		unsigned short pm1concSt;
-		unsigned short pm25concSt;
-		unsigned short pm10concSt;
-		unsigned short pm1concAt;
-		unsigned short pm25concAt;
-		unsigned short pm10concAt;
-		unsigned short part03;
-		unsigned short part05;
-		unsigned short part10;
-		unsigned short part25;
-		unsigned short part50;
-		unsigned short part100;
-		unsigned short reserved;
-		unsigned short check;
-	} datastruct;
-
-	datastruct dataStruct;
-	unsigned char curOffset;
-	unsigned short startCharacter;
-	bool validFrame;
+	FrameParser frameParser;
 
 private:
 	static const char* const channelNames[];
 	static const char* const channelMeasurementUnits[];
+	static const FrameParser::descriptor frameDescriptor;
 
 private:
-	void onDataReceived(unsigned char pivotChar);
-	bool checkCRC();
-	void swapEndianess();
 	void evaluateFrame();
 };
 
@@ -107,6 +107,17 @@ extern "C" {
 // b: relative channel
 #define SAMPLER_CHANNEL_ENABLED_PRESET(a,b)	((0x1100 + (((unsigned short)(a))<<8)) + (b))
 
+// 1140 - 1140 -> Channel 0 median filter length, Sampler 0
+// 1141 - 1141 -> Channel 1 median filter length, Sampler 0
+// ...
+// 1180 - 1180 -> Channel 0 IIR filter denominator, Sampler 0
+// 1181 - 1181 -> Channel 1 IIR filter denominator, Sampler 0
+// ...
+// a: sampler
+// b: relative channel
+#define SAMPLER_CHANNEL_MEDIAN_PRESET(a,b)		(SAMPLER_CHANNEL_ENABLED_PRESET(a,b) + 0x40)
+#define SAMPLER_CHANNEL_IIRDENOM_PRESET(a,b)	(SAMPLER_CHANNEL_ENABLED_PRESET(a,b) + 0x80)
+
 
 // 7FF0 - Board serial number
 #define BOARD_SERIAL_NUMBER             0x7FF0
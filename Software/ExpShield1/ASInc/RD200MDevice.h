@@ -26,6 +26,7 @@
 #define RD200MDEVICE_H_
 
 #include "SensorDevice.h"
+#include "FrameParser.h"
 
 class RD200MDevice : public SensorDevice {
 public:
@@ -47,39 +48,14 @@ public:
 	static const unsigned char defaultDecimationValue();
 
 private:
-	unsigned char checkSum();
 	void requestData(unsigned char command);
-	void onDataReceived(unsigned char pivotChar);
 	void evaluateRxBuffer();
 	bool evaluateReset();
 
 private:
+	static const FrameParser::descriptor frameDescriptor;
 
-	typedef enum _rxstate {
-		RX_IDLE,
-		RX_STARTFOUND,
-		RX_COMMANDFOUND,
-		RX_WAITING_PARAMETERS,
-		RX_WAITING_CRC
-	} rxstate;
-
-	typedef struct _datastruct {
-		unsigned char command;
-		unsigned char dataSize;
-		union _data {
-			unsigned char buffer[4];
-			struct _decoded {
-				unsigned char status;
-				unsigned char minutes;
-				unsigned char unit;
-				unsigned char cents;
-			} decoded;
-		} data;
-	} datastruct;
-
-	datastruct dataStruct;
-	rxstate curStatus;
-	unsigned char curRxOffset;
+	FrameParser frameParser;
 	bool needsReset;
 };
 
@@ -26,8 +26,11 @@
 #define SPIHELPER_H_
 
 #include "stm32f0xx_hal.h"
+#include "SPIBurstHelper.h"
 
-class SPIHelper {
+// Burst transfers are made of bytes. They are clocked back to back so the
+// inter-byte period is set by the SPI baud rate prescaler (8 SCK periods per byte).
+class SPIHelper : public SPIBurstHelper {
 private:
 	SPIHelper();
 
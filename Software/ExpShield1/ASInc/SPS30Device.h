@@ -52,6 +52,8 @@ public:
 	virtual void setLowPowerMode(bool lowPower);
 	virtual void loop();
 	virtual void tick();
+	virtual void bringUp();
+	virtual void restartBringUp();
 
 	virtual const char* getSerial() const;
 
@@ -77,14 +79,14 @@ private:
 private:
 	static const char* const channelNames[];
 	static const char* const channelMeasurementUnits[];
-	static float const multiplierFactors[];
-	static double const evaluationFactors[];
 
 private:
 	bool go;
 	unsigned short blankTimer;
-	bool deviceReady;
+	bool samplingOn;
 	unsigned char maxCheckReady;
+	unsigned char discoveryRetry;
+	unsigned char discoveryTimer;
 	char serialNumber[SPS30_SERIAL_NUMBER_MAXLENGTH];
 };
 
@@ -25,10 +25,14 @@
 #ifndef SAMPLER_H
 #define	SAMPLER_H
 
+#define SAMPLER_MAX_CHANNELS	0x40	/* See the EEPROM map in Persistence.h */
+
 class SensorDevice;
+class ChannelFilter;
 
 /* This is the base class for a sampler unit. 
-   A sampler unit implements a basic multichannel aware sampler with prescaler and decimation timing option
+   A sampler unit implements a basic multichannel aware sampler with prescaler and decimation timing option.
+   Each channel is filtered through its own median and IIR stages before decimation.
 */
 class Sampler {
     
@@ -58,11 +62,17 @@ public:
 	virtual bool setEnableChannel(unsigned char channel, unsigned char enabled);
 	virtual bool getChannelIsEnabled(unsigned char channel, unsigned char* enabled);
 
+	virtual bool setChannelFilter(unsigned char channel, unsigned char medianLength, unsigned char iirDenom);
+	virtual bool getChannelFilter(unsigned char channel, unsigned char* medianLength, unsigned char* iirDenom);
+
     virtual unsigned short getLastSample(unsigned char channel);
+    virtual float getLastFloatSample(unsigned char channel);
+    bool hasFloatSamples() const;
     
 protected:
     virtual bool applyDecimationFilter();
     virtual void onReadSample(unsigned char channel, unsigned short newSample);
+    virtual void onReadSample(unsigned char channel, float newSample);
     SensorDevice* getSensor();
     
     virtual bool atLeastOneChannelEnabled();
@@ -77,7 +87,9 @@ protected:
 
     unsigned char  numChannels;			 // Number of channels the sampler is valid to handle
     unsigned short *lastSample;          // last valid sample read buffers
+    float *lastFloatSample;				 // last valid sample read buffers (float sample format devices)
     bool *enabled;						 // channels enabled/disabled status
+    ChannelFilter *filters;				 // channels median and IIR filters
 
     SensorDevice *sensor;				// The sensor associated to this sampler
 };
@@ -25,15 +25,28 @@
 #ifndef SAMPLESAVERAGER_H
 #define	SAMPLESAVERAGER_H
 
+// Averager channel modes. They follow the meaning of each channel (i.e. a volume
+// is cumulated, a status is reported as is) so they are fixed by the board
+// setup, not exposed to the host nor persisted as the channel filters are.
+#define AVERAGER_MODE_AVERAGE	0x00	/* Moving average, latched at each buffer completion */
+#define AVERAGER_MODE_SUM		0x01	/* Sum of the samples in the buffer */
+#define AVERAGER_MODE_LATEST	0x02	/* Latest sample only, not buffered */
+
+#define AVERAGER_NOT_BUFFERED	0xFF
+
+#include "SensorDevice.h"
+
 class DitherTool;
 
 class SamplesAverager {
 public:
-    SamplesAverager(unsigned char channels);
+    SamplesAverager(unsigned char channels, unsigned char format = SAMPLE_FORMAT_UINT16);
     virtual ~SamplesAverager();
     
+    bool setChannelMode(unsigned char channel, unsigned char mode);
     virtual unsigned char init(unsigned char size);
     virtual bool collectSample(unsigned char channel, unsigned short sample, unsigned long _timestamp);
+    virtual bool collectSample(unsigned char channel, float sample, unsigned long _timestamp);
     unsigned char getBufferSize();
     
     virtual void setDitherTool(DitherTool* tool);    
@@ -42,26 +55,34 @@ public:
     bool loadPreset(unsigned char myID);
     
     virtual unsigned short lastAveragedValue(unsigned char channel);
+    virtual float lastAveragedFloatValue(unsigned char channel);
+    bool hasFloatSamples() const;
     unsigned long lastTimeStamp();
     
-protected:
-    unsigned long* getAccumulators() const;
-
 private:
     void reset();
     
 private:
     const unsigned char channels;
+    const unsigned char sampleFormat;
     unsigned char bufferSize;
     unsigned char* sampleOffsets;
+    unsigned char* modes;
+    unsigned char* bufferRows;
     unsigned short* dataBuffer;
     
     unsigned long* accumulators;
     unsigned short* lastAverageSamples;
+
+    // Float sample format buffers (the unsigned short ones are not allocated)
+    float* floatDataBuffer;
+    float* floatAccumulators;
+    float* lastAverageFloatSamples;
     
     unsigned long timestamp;
     
     bool consolidated;
+    bool periodTerminated;
     
     static DitherTool* ditherTool;       // A static pointer to a singleton dithering tool object    
 };
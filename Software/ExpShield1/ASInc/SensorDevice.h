@@ -25,10 +25,22 @@
 #ifndef SENSORDEVICE_H_
 #define SENSORDEVICE_H_
 
+// Sample formats. Float samples are carried natively through samplers and averagers.
+#define SAMPLE_FORMAT_UINT16	0x00
+#define SAMPLE_FORMAT_FLOAT		0x01
+
 // Basic sensor device, multiple channel capable
 class SensorDevice {
 public:
-	SensorDevice(const unsigned char reqChannels);
+	// Device bring-up (discovery) status
+	typedef enum _bringupstatus {
+		BRINGUP_PENDING,
+		BRINGUP_READY,
+		BRINGUP_ABSENT
+	} bringupstatus;
+
+public:
+	SensorDevice(const unsigned char reqChannels, const unsigned char format = SAMPLE_FORMAT_UINT16);
 	virtual ~SensorDevice();
 
 	virtual void onStartSampling();
@@ -37,9 +49,16 @@ public:
 	virtual void loop() = 0;
 	virtual void tick() = 0;
 
+	// Non blocking discovery step. It's called from the superloop until the bring-up terminates.
+	virtual void bringUp();
+	virtual void restartBringUp();
+	bringupstatus getBringUpStatus() const;
+	bool isReady() const;
+
 	virtual const char* getSerial() const = 0;
 
 	virtual const unsigned char getNumChannels() const;
+	unsigned char getSampleFormat() const;
 	virtual const char* getChannelName(unsigned char channel) const = 0;
 	virtual bool setChannelName(unsigned char channel, const char* name) = 0;
 	virtual const char* getMeasurementUnit(unsigned char channel) const = 0;
@@ -48,14 +67,20 @@ public:
 	virtual void triggerSample();
 	virtual bool sampleAvailable();
 	virtual unsigned short getSample(unsigned char channel);
+	virtual float getFloatSample(unsigned char channel);
 
 protected:
 	void setSample(unsigned char channel, unsigned short sample);
+	void setFloatSample(unsigned char channel, float sample);
+	void setBringUpStatus(bringupstatus status);
 
 private:
+	volatile bringupstatus bringUpStatus;
 	volatile bool sampleReady;
 	const unsigned char numChannels;
+	const unsigned char sampleFormat;
 	unsigned short *lastSamples;
+	float *lastFloatSamples;
 };
 
 
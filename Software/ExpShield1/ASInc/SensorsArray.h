@@ -27,6 +27,7 @@
 #define	SENSORSARRAY_H
 
 #include "DitherTool.h"
+#include "StaticBoard.h"
 #include "SamplesAverager.h"
 #include "OPCN3Device.h"
 #include "SPS30Device.h"
@@ -104,8 +105,11 @@ public:
     bool getUnitForChannel(unsigned char channel, unsigned char* buffer, unsigned char buffSize);
     bool setEnableChannel(unsigned char channel, unsigned char enabled);
     bool getChannelIsEnabled(unsigned char channel, unsigned char *enabled);
+    bool setChannelFilter(unsigned char channel, unsigned char medianLength, unsigned char iirDenom);
+    bool getChannelFilter(unsigned char channel, unsigned char *medianLength, unsigned char *iirDenom);
 
     bool enableSampling(bool enable);
+    bool getSensorStatus(unsigned char sensor, unsigned short* readyMap, unsigned short* pendingMap, unsigned short* reconnects, unsigned short* dropouts);
 
     bool saveBoardSerialNumber(unsigned char* buffer, unsigned char buffSize);
     bool readBoardSerialNumber(unsigned char* buffer, unsigned char buffSize);
@@ -115,18 +119,11 @@ public:
     bool timerTick();
     bool loop();
 
-private:
-    typedef struct _channeltosamplersubchannel {
-    		unsigned char sampler;
-    		unsigned char subchannel;
-    		bool firstChannelForSampler;
-    } channeltosamplersubchannel;
-
 private:
     static DitherTool ditherTool;                           		// Dithering toolset
     
-    // A suitable channel To Subchannel array to speedup access
-    static const channeltosamplersubchannel chToSamplerSubChannel[NUM_OF_TOTAL_CHANNELS];
+    // A suitable channel To Subchannel array to speedup access (generated from the board description)
+    static const channeltosamplersubchannel* const chToSamplerSubChannel;
 
     SensorDevice* sensors[NUM_OF_TOTAL_SENSORS];			   		// Physical sensor units
     Sampler* samplers[NUM_OF_TOTAL_SAMPLERS];               		// Sampler units for all channels
@@ -135,11 +132,23 @@ private:
     bool samplingEnabled;                                   		// Sampling is default disabled
     unsigned long timestamp;                                		// Internal timestamp timer (in 0.01s)
     unsigned char globalPrescaler;						   		// Global sampling prescaler
+    volatile unsigned char powerUpTimer;							// Power supply stabilization timer (in 0.01s)
+    volatile unsigned short reprobeTimer;							// Absent devices re-probe timer (in 0.01s)
+    unsigned char reprobeNext;										// Next device to be checked for re-probe
+    unsigned short readyMap;										// Currently ready devices bitmap
+    unsigned short discoveredMap;									// Devices found at least once bitmap
+    unsigned short reconnectCount[NUM_OF_TOTAL_SENSORS];			// Devices reconnection events
+    unsigned short dropoutCount[NUM_OF_TOTAL_SENSORS];				// Devices disconnection events
 
 private:
     void powerUp5V(bool enable);
     void powerUp3V3(bool enable);
     void powerUp12V(bool enable);
+    void checkReadiness();
+    void reprobeAbsentDevice();
+
+    // Compile time checks for the channel map consistency
+    static constexpr bool mapsTo(unsigned char channel, unsigned char sensor, unsigned char subchannel);
 };
 
 #endif	/* SENSORSARRAY_H */
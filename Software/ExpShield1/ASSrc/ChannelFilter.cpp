@@ -0,0 +1,186 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *			European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#include "ChannelFilter.h"
+#include <string.h>
+
+#define IIR_FRACTIONAL_BITS		8
+
+ChannelFilter::ChannelFilter() : medianLength(1), iIRDenom(0) {
+	reset();
+}
+
+ChannelFilter::~ChannelFilter() {
+}
+
+void ChannelFilter::reset() {
+
+	medianCount = 0;
+	medianOffset = 0;
+	memset(&medianBuffer, 0, sizeof(medianBuffer));
+
+	iIRValid = false;
+	iIRAccumulator.q8 = 0;
+}
+
+unsigned short ChannelFilter::apply(unsigned short sample) {
+
+	sample = applyMedian(sample);
+	return applyIIR(sample);
+}
+
+float ChannelFilter::apply(float sample) {
+
+	sample = applyMedian(sample);
+	return applyIIR(sample);
+}
+
+// Valid lengths are odd values up to CHANNELFILTER_MAX_MEDIAN. 0 and 0xFF (blank EEPROM) disable the filter
+bool ChannelFilter::setMedianLength(unsigned char length) {
+
+	if ((length == 0) || (length == 0xFF)) {
+		length = 1;
+	}
+
+	if ((length > CHANNELFILTER_MAX_MEDIAN) || ((length & 0x01) == 0)) {
+		return false;
+	}
+
+	medianLength = length;
+	reset();
+
+	return true;
+}
+
+unsigned char ChannelFilter::getMedianLength() const {
+	return medianLength;
+}
+
+// A null denominator disables the filter. 0xFF (blank EEPROM) is treated as null.
+void ChannelFilter::setIIRDenom(unsigned char denom) {
+
+	if (denom == 0xFF) {
+		denom = 0;
+	}
+
+	iIRDenom = denom;
+	iIRValid = false;
+}
+
+unsigned char ChannelFilter::getIIRDenom() const {
+	return iIRDenom;
+}
+
+// Advance the median window position
+void ChannelFilter::pushMedian() {
+
+	medianOffset++;
+	if (medianOffset == medianLength) {
+		medianOffset = 0;
+	}
+	if (medianCount < medianLength) {
+		medianCount++;
+	}
+}
+
+unsigned short ChannelFilter::applyMedian(unsigned short sample) {
+
+	if (medianLength == 1) {
+		return sample;
+	}
+
+	medianBuffer.u16[medianOffset] = sample;
+	pushMedian();
+
+	// Insertion sort on a copy of the (small) window
+	unsigned short sorted[CHANNELFILTER_MAX_MEDIAN];
+	for (unsigned char n = 0; n < medianCount; n++) {
+		unsigned short value = medianBuffer.u16[n];
+		unsigned char m = n;
+		for (; (m > 0) && (sorted[m-1] > value); m--) {
+			sorted[m] = sorted[m-1];
+		}
+		sorted[m] = value;
+	}
+
+	return sorted[medianCount >> 1];
+}
+
+float ChannelFilter::applyMedian(float sample) {
+
+	if (medianLength == 1) {
+		return sample;
+	}
+
+	medianBuffer.f[medianOffset] = sample;
+	pushMedian();
+
+	float sorted[CHANNELFILTER_MAX_MEDIAN];
+	for (unsigned char n = 0; n < medianCount; n++) {
+		float value = medianBuffer.f[n];
+		unsigned char m = n;
+		for (; (m > 0) && (sorted[m-1] > value); m--) {
+			sorted[m] = sorted[m-1];
+		}
+		sorted[m] = value;
+	}
+
+	return sorted[medianCount >> 1];
+}
+
+// S(n) = S(n-1) + 1/den * (I(n) - S(n-1))
+unsigned short ChannelFilter::applyIIR(unsigned short sample) {
+
+	if (iIRDenom == 0) {
+		return sample;
+	}
+
+	long input = ((long)sample) << IIR_FRACTIONAL_BITS;
+	if (!iIRValid) {
+		iIRAccumulator.q8 = input;
+		iIRValid = true;
+	} else {
+		long accumulator = (long)iIRAccumulator.q8;
+		accumulator = accumulator + (input - accumulator)/iIRDenom;
+		iIRAccumulator.q8 = accumulator;
+	}
+
+	return (unsigned short)((iIRAccumulator.q8 + (1 << (IIR_FRACTIONAL_BITS - 1))) >> IIR_FRACTIONAL_BITS);
+}
+
+float ChannelFilter::applyIIR(float sample) {
+
+	if (iIRDenom == 0) {
+		return sample;
+	}
+
+	if (!iIRValid) {
+		iIRAccumulator.f = sample;
+		iIRValid = true;
+	} else {
+		iIRAccumulator.f = iIRAccumulator.f + (sample - iIRAccumulator.f)/iIRDenom;
+	}
+
+	return iIRAccumulator.f;
+}
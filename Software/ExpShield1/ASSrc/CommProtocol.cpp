@@ -60,7 +60,10 @@ const CommProtocol::commandinfo CommProtocol::validCommands[] = {
 	{ COMMPROTOCOL_READ_UNITS, 1, &CommProtocol::readUnits },
 	{ COMMPROTOCOL_READ_BOARDTYPE, 1, &CommProtocol::readBoardType },
 	{ COMMPROTOCOL_WRITE_CHANENABLE, 1, &CommProtocol::writeChannelEnable },
-	{ COMMPROTOCOL_READ_CHANENABLE, 1, &CommProtocol::readChannelEnable }
+	{ COMMPROTOCOL_READ_CHANENABLE, 1, &CommProtocol::readChannelEnable },
+	{ COMMPROTOCOL_WRITE_CHANFILTER, 3, &CommProtocol::writeChannelFilter },
+	{ COMMPROTOCOL_READ_CHANFILTER, 1, &CommProtocol::readChannelFilter },
+	{ COMMPROTOCOL_READ_SENSORSTATUS, 1, &CommProtocol::readSensorStatus }
 };
 
 const char CommProtocol::commProtocolErrorString[] = { COMMPROTOCOL_ERROR };
@@ -643,3 +646,58 @@ bool CommProtocol::readChannelEnable(CommProtocol* context, unsigned char cmdOff
     return true;
 }
 
+// Function handler: set median and IIR filters for a specified channel.
+// The averager consolidation mode is fixed by the board setup and not set here
+bool CommProtocol::writeChannelFilter(CommProtocol* context, unsigned char cmdOffset) {
+
+    unsigned char channel = context->getParameter(0);
+    unsigned char medianLength = context->getParameter(1);
+    unsigned char iirDenom = context->getParameter(2);
+
+    if (context->sensorsArray->setChannelFilter(channel, medianLength, iirDenom)) {
+        return context->renderOKAnswer(cmdOffset, channel);
+    }
+    return false;
+}
+
+// Function handler: inquiry for median and IIR filters for a specified channel
+bool CommProtocol::readChannelFilter(CommProtocol* context, unsigned char cmdOffset) {
+
+    unsigned char channel = context->getParameter(0);
+    unsigned char medianLength;
+    unsigned char iirDenom;
+    if (!context->sensorsArray->getChannelFilter(channel, &medianLength, &iirDenom)) {
+        return false;
+    }
+
+    context->buffer[0] = COMMPROTOCOL_HEADER;
+    context->buffer[1] = validCommands[cmdOffset].commandID;
+    context->buffer[2] = 0;
+    context->writeValue(channel, false);
+    context->writeValue(medianLength, false);
+    context->writeValue(iirDenom, true);
+
+    return true;
+}
+
+// Function handler: read the ready and pending devices bitmaps and the reconnection
+// and disconnection events counters for a specified physical device
+bool CommProtocol::readSensorStatus(CommProtocol* context, unsigned char cmdOffset) {
+
+    unsigned char sensor = context->getParameter(0);
+    unsigned short readyMap, pendingMap, reconnects, dropouts;
+    if (!context->sensorsArray->getSensorStatus(sensor, &readyMap, &pendingMap, &reconnects, &dropouts)) {
+        return false;
+    }
+
+    context->buffer[0] = COMMPROTOCOL_HEADER;
+    context->buffer[1] = validCommands[cmdOffset].commandID;
+    context->buffer[2] = 0;
+    context->writeValue(sensor, false);
+    context->writeValue(readyMap, false);
+    context->writeValue(pendingMap, false);
+    context->writeValue(reconnects, false);
+    context->writeValue(dropouts, true);
+
+    return true;
+}
@@ -29,6 +29,7 @@
 #include <GPIOHelper.h>
 #include <LEDsHelper.h>
 #include <SensorBusWrapper.h>
+#include <SPIHelper.h>
 #include <SerialAHelper.h>
 #include <SerialBHelper.h>
 #include <SerialCHelper.h>
@@ -91,6 +92,14 @@ void uart4Error() {
 	SerialD.onErrorCallback();
 }
 
+void spi1Interrupt() {
+	AS_SPI.onBurstCompleted(true);
+}
+
+void spi1Error() {
+	AS_SPI.onBurstCompleted(false);
+}
+
 
 void usbRxCallback(unsigned char* buffer, long bufferLen) {
 	((SerialUSBHelper*)SerialUSBHelper::getInstance())->onDataRx(buffer, bufferLen);
@@ -99,16 +108,14 @@ void usbRxCallback(unsigned char* buffer, long bufferLen) {
 
 void setup_impl() {
 
-    // Wait for hardware stabilization
-    HAL_Delay(500);
-
     // Initialize LEDs
 	LEDs.init();
 
     // Initialize the serial line for sensor bus
     SerialB.init();
 
-    // Instantiate and initialize the main objects
+    // Instantiate and initialize the main objects. Sensor devices bring-up
+    // runs asynchronously in the main loop.
     sensorBoard = new SensorsArray();
     commProtocol = new CommProtocol(sensorBoard);
     sensorBusProtocol = new SensorBusWrapper(commProtocol);
@@ -0,0 +1,184 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *			European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#include "FrameParser.h"
+#include "SerialHelper.h"
+
+FrameParser::FrameParser(const descriptor& frameDescriptor) : desc(frameDescriptor), offset(0), frameLength(0) {
+}
+
+FrameParser::~FrameParser() {
+}
+
+void FrameParser::reset() {
+	offset = 0;
+	frameLength = 0;
+}
+
+// Drain the serial ring until a full valid frame has been collected.
+// Remaining bytes are left in the ring for the next call
+bool FrameParser::consume(SerialHelper& serial) {
+
+	// available() also recovers the serial line from errors
+	if (!serial.available()) {
+		return false;
+	}
+
+	while (serial.dataReady()) {
+		if (feed(serial.getByte())) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Return true when pivotChar terminates a valid frame
+bool FrameParser::feed(unsigned char pivotChar) {
+
+	// Hunt for the header. A mismatching byte could be the start of a new header
+	if (offset < desc.headerLen) {
+		if (pivotChar != desc.header[offset]) {
+			offset = 0;
+			if (pivotChar != desc.header[0]) {
+				return false;
+			}
+		}
+		buffer[offset++] = pivotChar;
+
+		return false;
+	}
+
+	buffer[offset++] = pivotChar;
+
+	// Evaluate the frame length as soon as the length information is available
+	if ((frameLength == 0) && !evaluateLength()) {
+		return false;
+	}
+
+	if (offset < frameLength) {
+		return false;
+	}
+
+	// Full frame received. Its content remains available until the next header
+	bool valid = checkChecksum();
+	reset();
+
+	return valid;
+}
+
+unsigned char FrameParser::getByte(unsigned char position) const {
+	return (position < FRAMEPARSER_BUFFER_SIZE)? buffer[position] : 0;
+}
+
+unsigned short FrameParser::getWord(unsigned char position) const {
+
+	if (position >= FRAMEPARSER_BUFFER_SIZE-1) {
+		return 0;
+	}
+
+	if (desc.bigEndian) {
+		return (((unsigned short)buffer[position]) << 8) | buffer[position+1];
+	}
+
+	return (((unsigned short)buffer[position+1]) << 8) | buffer[position];
+}
+
+// Return true if the frame length is known. Invalid lengths restart the header hunting
+bool FrameParser::evaluateLength() {
+
+	unsigned short length = 0;
+	switch (desc.lengthRule) {
+		case LENGTH_FIXED:
+			break;
+
+		case LENGTH_FIELD8:
+			if (offset <= desc.lengthOffset) {
+				return false;
+			}
+			length = buffer[desc.lengthOffset];
+			break;
+
+		case LENGTH_FIELD16:
+			if (offset <= desc.lengthOffset + 1) {
+				return false;
+			}
+			length = getWord(desc.lengthOffset);
+			break;
+
+		case LENGTH_TABLE: {
+			if (offset <= desc.lengthOffset) {
+				return false;
+			}
+			unsigned char n = 0;
+			while ((n < desc.lengthTableSize) && (desc.lengthTable[n].key != buffer[desc.lengthOffset])) {
+				n++;
+			}
+			if (n == desc.lengthTableSize) {
+				reset();
+				return false;
+			}
+			length = desc.lengthTable[n].length;
+		}
+			break;
+	}
+
+	length += desc.frameBase;
+	if ((length > FRAMEPARSER_BUFFER_SIZE) || (length < offset)) {
+		reset();
+		return false;
+	}
+
+	frameLength = length;
+
+	return true;
+}
+
+bool FrameParser::checkChecksum() const {
+
+	unsigned char checksumSize = (desc.checksumType == CHECKSUM_NONE)? 0 :
+									(desc.checksumType == CHECKSUM_SUM16)? 2 : 1;
+	unsigned char checksumOffset = frameLength - checksumSize;
+
+	unsigned short sum = 0;
+	for (unsigned char n = desc.checksumStart; n < checksumOffset; n++) {
+		sum += buffer[n];
+	}
+
+	switch (desc.checksumType) {
+		case CHECKSUM_SUM8_INV:
+			return ((unsigned char)(0xFF - sum)) == buffer[checksumOffset];
+
+		case CHECKSUM_SUM8_NEG:
+			return ((unsigned char)(0x100 - sum)) == buffer[checksumOffset];
+
+		case CHECKSUM_SUM16:
+			return sum == getWord(checksumOffset);
+
+		default:
+			break;
+	}
+
+	return true;
+}
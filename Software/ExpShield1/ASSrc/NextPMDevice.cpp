@@ -49,7 +49,13 @@
 #define CALC_CRC_FOR_CMD(cmd) (((NEXTPM_CRC_SEED - NEXTPM_DEFAULT_ADDRESS - (cmd))) & 0xFF)
 #define CALC_CRC_FOR_CMD_WITH_PAR(cmd,par) (((NEXTPM_CRC_SEED - NEXTPM_DEFAULT_ADDRESS - (cmd) - (par))) & 0xFF)
 
-#define SWAP_ENDIANESS(a) ((a)>>8) + (((a)&0xFF)<<8)
+/* Answer frame layout */
+#define NEXTPM_FRAME_COMMAND		1
+#define NEXTPM_FRAME_STATE			2
+#define NEXTPM_FRAME_DATA			3
+#define NEXTPM_FRAME_DATA_WORD(a)	(NEXTPM_FRAME_DATA + ((a)<<1))
+
+#define NEXTPM_DISCOVERY_TIMEOUT			300		// 3 seconds to answer the first read status command (one sampletick = 0.01s)
 
 #define NEXTPM_DEFAULT_SAMPLERATE			0		// 1 seconds each sample
 #define NEXTPM_DEFAULT_DECIMATIONVALUE		0		// 1 seconds each sample
@@ -73,6 +79,24 @@ double const NextPMDevice::evaluationFactors[] = {
 };
 
 
+// Data length for each answer
+const FrameParser::lengthentry NextPMDevice::frameLengths[] = {
+		{ READ_CONV_AVG10_1S, NEXTPM_DATABUFFERSZ },
+		{ READ_CONC_AVG60_10S, NEXTPM_DATABUFFERSZ },
+		{ READ_CONC_AVG900_60S, NEXTPM_DATABUFFERSZ },
+		{ READ_TEMP_HUMIDITY, NEXTPM_DATABUFFERSZ_TEMPHUMID },
+		{ REQ_POWER_ON_SLEEP, 0 },
+		{ READ_SENSOR_STATE, 0 }
+};
+
+// Address, command, state, big endian data words, 0x100 - sum of all previous bytes
+const FrameParser::descriptor NextPMDevice::frameDescriptor = {
+		1, { NEXTPM_DEFAULT_ADDRESS, 0 },
+		FrameParser::LENGTH_TABLE, NEXTPM_FRAME_COMMAND, 4,
+		frameLengths, sizeof(frameLengths)/sizeof(FrameParser::lengthentry),
+		FrameParser::CHECKSUM_SUM8_NEG, 0, true
+};
+
 const unsigned char NextPMDevice::defaultSampleRate() {
 	return NEXTPM_DEFAULT_SAMPLERATE;
 }
@@ -83,14 +107,10 @@ const unsigned char NextPMDevice::defaultDecimationValue() {
 
 
 NextPMDevice::NextPMDevice() : SensorDevice(NEXTPM_NUM_CHANNELS),
-		deviceFound(false), samplingOn(false), go(false), curStatus(RX_IDLE), expectedDataSize(0), curRxOffset(0) {
+		discoveryRequested(false), discoveryTimer(0), samplingOn(false), go(false), frameParser(frameDescriptor) {
 
 	// Initialize the serial communication peripheral
 	SerialA.init();
-
-	// Entering in sleep mode by triggering a read status command
-	char data[3] = { NEXTPM_DEFAULT_ADDRESS, READ_SENSOR_STATE, CALC_CRC_FOR_CMD(READ_SENSOR_STATE) };
-	SerialA.write(data, 3);
 }
 
 NextPMDevice::~NextPMDevice() {
@@ -130,13 +150,38 @@ void NextPMDevice::loop() {
 	}
 
     // Handle the serial line A
-    if (SerialA.available()) {
-    		unsigned char val = SerialA.read();
-    		onDataReceived(val);
+    if (frameParser.consume(SerialA)) {
+    		evaluateRxBuffer();
     }
 }
 
 void NextPMDevice::tick() {
+
+	if (discoveryRequested && (discoveryTimer < NEXTPM_DISCOVERY_TIMEOUT)) {
+		discoveryTimer++;
+	}
+}
+
+void NextPMDevice::restartBringUp() {
+
+	discoveryRequested = false;
+	discoveryTimer = 0;
+	SensorDevice::restartBringUp();
+}
+
+void NextPMDevice::bringUp() {
+
+	// Probe the device and enter in sleep mode by triggering a read status command.
+	// The bring-up terminates when the answer is evaluated by the loop.
+	if (!discoveryRequested) {
+		discoveryRequested = true;
+		requestData(READ_SENSOR_STATE);
+		return;
+	}
+
+	if (discoveryTimer >= NEXTPM_DISCOVERY_TIMEOUT) {
+		setBringUpStatus(BRINGUP_ABSENT);
+	}
 }
 
 const char* NextPMDevice::getSerial() const {
@@ -175,7 +220,7 @@ float NextPMDevice::evaluateMeasurement(unsigned char channel, float value) cons
 void NextPMDevice::triggerSample() {
 	SensorDevice::triggerSample();
 
-	if (deviceFound && samplingOn) {
+	if (isReady() && samplingOn) {
 		go = true;
 	}
 }
@@ -187,102 +232,22 @@ void NextPMDevice::requestData(unsigned char command) {
 }
 
 
-void NextPMDevice::onDataReceived(unsigned char pivotChar) {
-
-	switch (curStatus) {
-
-		case RX_IDLE: {
-			if (pivotChar == NEXTPM_DEFAULT_ADDRESS) {
-				curStatus = RX_STARTFOUND;
-			}
-		}
-		break;
-
-		case RX_STARTFOUND: {
-			if ((pivotChar >= READ_CONV_AVG10_1S) &&
-					(pivotChar <= READ_SENSOR_STATE)) {
-
-			if ((pivotChar == READ_CONV_AVG10_1S) ||
-				(pivotChar == READ_CONC_AVG60_10S) ||
-				(pivotChar == READ_CONC_AVG900_60S) ) {
-					expectedDataSize = NEXTPM_DATABUFFERSZ;
-				} else if (pivotChar == READ_TEMP_HUMIDITY) {
-					expectedDataSize = NEXTPM_DATABUFFERSZ_TEMPHUMID;
-				} else {
-					expectedDataSize = 0;
-				}
-
-			dataStruct.command = pivotChar;
-			curStatus = RX_COMMANDFOUND;
-
-			} else  {
-				curStatus = RX_IDLE;
-			}
-		}
-		break;
-
-		case RX_COMMANDFOUND: {
-
-			dataStruct.state = pivotChar;
-			curStatus = (expectedDataSize == 0)? RX_WAITING_CRC : RX_WAITING_PARAMETERS;
-			curRxOffset = 0;
-		}
-		break;
-
-		case RX_WAITING_PARAMETERS: {
-			dataStruct.data.buffer[curRxOffset] = pivotChar;
-			curRxOffset++;
-			if (curRxOffset == expectedDataSize) {
-				curStatus = RX_WAITING_CRC;
-			}
-		}
-		break;
-
-		case RX_WAITING_CRC: {
-			unsigned char calcChecksum = checkSum();
-			if (calcChecksum == pivotChar) {
-				evaluateRxBuffer();
-			}
-			curStatus = RX_IDLE;
-		}
-		break;
-
-		default:
-			curStatus = RX_IDLE;
-			break;
-	}
-}
-
-unsigned char NextPMDevice::checkSum() {
-
-	unsigned char crc = (NEXTPM_CRC_SEED - NEXTPM_DEFAULT_ADDRESS);
-
-	crc -= dataStruct.command;
-	crc -= dataStruct.state;
-	for (unsigned char n = 0; n < expectedDataSize; n++) {
-		crc -= dataStruct.data.buffer[n];
-	}
-
-	return crc;
-}
-
 void NextPMDevice::evaluateRxBuffer() {
 
-	switch (dataStruct.command) {
+	unsigned char state = frameParser.getByte(NEXTPM_FRAME_STATE);
+
+	switch (frameParser.getByte(NEXTPM_FRAME_COMMAND)) {
 
 		case READ_CONV_AVG10_1S:
 		case READ_CONC_AVG60_10S:
 		case READ_CONC_AVG900_60S: {
 
-			if (evaluateState(dataStruct.state)) {
+			if (evaluateState(state)) {
 
-				setSample(NEXTPM_PM1PCS, SWAP_ENDIANESS(dataStruct.data.decodedpm.pm1pcs));
-				setSample(NEXTPM_PM25PCS, SWAP_ENDIANESS(dataStruct.data.decodedpm.pm25pcs));
-				setSample(NEXTPM_PM10PCS, SWAP_ENDIANESS(dataStruct.data.decodedpm.pm10pcs));
-				setSample(NEXTPM_PM1CONC, SWAP_ENDIANESS(dataStruct.data.decodedpm.pm1ug));
-				setSample(NEXTPM_PM25CONC, SWAP_ENDIANESS(dataStruct.data.decodedpm.pm25ug));
-				setSample(NEXTPM_PM10CONC, SWAP_ENDIANESS(dataStruct.data.decodedpm.pm10ug));
-				setSample(NEXTPM_STATUS, dataStruct.state);
+				for (unsigned char channel = NEXTPM_PM1PCS; channel <= NEXTPM_PM10CONC; channel++) {
+					setSample(channel, frameParser.getWord(NEXTPM_FRAME_DATA_WORD(channel)));
+				}
+				setSample(NEXTPM_STATUS, state);
 
 				// It's time to ask for temperature and humidity
 				requestData(READ_TEMP_HUMIDITY);
@@ -292,13 +257,13 @@ void NextPMDevice::evaluateRxBuffer() {
 
 		case READ_TEMP_HUMIDITY: {
 
-			setSample(NEXTPM_TEMPERATURE, SWAP_ENDIANESS(dataStruct.data.decodedth.temperature));
-			setSample(NEXTPM_HUMIDITY, SWAP_ENDIANESS(dataStruct.data.decodedth.humidity));
+			setSample(NEXTPM_TEMPERATURE, frameParser.getWord(NEXTPM_FRAME_DATA_WORD(0)));
+			setSample(NEXTPM_HUMIDITY, frameParser.getWord(NEXTPM_FRAME_DATA_WORD(1)));
 		}
 		break;
 
 		case READ_SENSOR_STATE: {
-			evaluateState(dataStruct.state);
+			evaluateState(state);
 		}
 
 		default:
@@ -319,7 +284,7 @@ bool NextPMDevice::evaluateState(unsigned char state) {
 	}
 
 	// Flag we found a device communicating with the proper protocol
-	deviceFound = true;
+	setBringUpStatus(BRINGUP_READY);
 
 	return true;
 }
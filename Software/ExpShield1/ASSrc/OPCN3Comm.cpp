@@ -27,10 +27,13 @@
 #include "OPCN3Comm.h"
 #include "GPIOHelper.h"
 #include "SPIHelper.h"
+#include "stm32f0xx_hal.h"
 
 #define OPC_RES_BUSY			0x31
 #define OPC_RES_READY		0xF3
 #define POLYNOMIAL 			0xA001 //Generator polynomial for CRC
+#define OPC_BYTE_TIMEOUT	5		/* 50ms. A single byte takes about 21us */
+#define OPC_BYTE_GAP_US		20		/* The OPC-N3 needs at least 10us between bytes */
 
 const OPCN3Comm::cmdinfo OPCN3Comm::cmdInfoList[]  = {
 		{ W_PERIPH_POWER_STATUS, 0x00, 0x01, IDLE, 0x02 }, /* Set Fan Dig Pot Off */
@@ -72,11 +75,10 @@ void OPCN3Comm::loop() {
 			if (rxData == OPC_RES_READY) {
 
 				if (cmdInfoList[smData.currCmdOffset].rxLength != 0) {
-					smData.currRxDataOffset = 0;
-					while (smData.currRxDataOffset < cmdInfoList[smData.currCmdOffset].rxLength) {
-						smData.buffer[smData.currRxDataOffset] = write(cmdInfoList[smData.currCmdOffset].cmdStatement);
-						smData.currRxDataOffset++;
+					if (!startReceiving()) {
+						resetStateMachine();
 					}
+					break;
 				} else {
 					smData.currTxDataOffset = 0;
 					if (write(cmdInfoList[smData.currCmdOffset].data) == OPC_RES_BUSY) {
@@ -102,6 +104,48 @@ void OPCN3Comm::loop() {
 	}
 	break;
 
+	case RECEIVING: {
+
+		if (AS_SPI.burstRunning()) {
+			if (smData.timer > OPC_BYTE_TIMEOUT) {
+				AS_SPI.abortBurst();
+				AS_GPIO.digitalWrite(OPC_SS, true);
+				resetStateMachine();
+			}
+			break;
+		}
+
+		if (!AS_SPI.burstSucceeded()) {
+			AS_GPIO.digitalWrite(OPC_SS, true);
+			resetStateMachine();
+			break;
+		}
+
+		smData.currRxDataOffset++;
+		if (smData.currRxDataOffset >= cmdInfoList[smData.currCmdOffset].rxLength) {
+			AS_GPIO.digitalWrite(OPC_SS, true);
+			smData.status = cmdInfoList[smData.currCmdOffset].fallbackStatus;
+		} else {
+			smData.byteTime = coreCycles();
+			smData.status = BYTE_GAP;
+		}
+	}
+	break;
+
+	case BYTE_GAP: {
+
+		// Give the OPC the time to load the next byte
+		if ((coreCycles() - smData.byteTime) < ((SystemCoreClock / 1000000) * OPC_BYTE_GAP_US)) {
+			break;
+		}
+
+		if (!receiveNextByte()) {
+			AS_GPIO.digitalWrite(OPC_SS, true);
+			resetStateMachine();
+		}
+	}
+	break;
+
 	default:
 		resetStateMachine();
 		break;
@@ -138,6 +182,7 @@ void OPCN3Comm::resetStateMachine() {
 	smData.retry = 0;
 	smData.currRxDataOffset = 0;
 	smData.currTxDataOffset = 0;
+	smData.byteTime = 0;
 }
 
 unsigned char OPCN3Comm::write(unsigned char data) {
@@ -151,6 +196,51 @@ unsigned char OPCN3Comm::write(unsigned char data) {
     return result;
 }
 
+// Read the command payload keeping SS low. The OPC keeps clocking out
+// data while it receives the command statement. Bytes are transferred
+// one at a time, in interrupt, and spaced by OPC_BYTE_GAP_US from the loop.
+bool OPCN3Comm::startReceiving() {
+
+	unsigned char rxLength = cmdInfoList[smData.currCmdOffset].rxLength;
+	memset(smData.txBuffer, cmdInfoList[smData.currCmdOffset].cmdStatement, rxLength);
+
+	smData.currRxDataOffset = 0;
+
+	AS_GPIO.digitalWrite(OPC_SS, false);
+	if (!receiveNextByte()) {
+		AS_GPIO.digitalWrite(OPC_SS, true);
+		return false;
+	}
+
+	return true;
+}
+
+bool OPCN3Comm::receiveNextByte() {
+
+	unsigned char offset = smData.currRxDataOffset;
+	if (!AS_SPI.startBurst(&smData.txBuffer[offset], &smData.buffer[offset], 1)) {
+		return false;
+	}
+
+	smData.timer = 0;
+	smData.status = RECEIVING;
+	return true;
+}
+
+// Current time in core clock cycles. It wraps after 2^32 cycles
+// but differences between two readings are still valid.
+unsigned long OPCN3Comm::coreCycles() {
+
+	unsigned long ms, val;
+	do {
+		ms = HAL_GetTick();
+		val = SysTick->VAL;
+	} while (ms != HAL_GetTick());
+
+	unsigned long load = SysTick->LOAD;
+	return (ms * (load + 1)) + (load - val);
+}
+
 OPCN3Comm::histogram* OPCN3Comm::getLastHistogram() {
 
 	if ((smData.status == EVALUATE) && (smData.currCmdOffset == READ_HISTOGRAM)) {
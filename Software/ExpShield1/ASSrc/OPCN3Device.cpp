@@ -32,11 +32,7 @@
 #define OPCN3_WAIT_SERIALSTRING_TIME	29 /* 30ms */
 #define OPCN3_WAIT_FAN_TIME				249	/* 2.5 seconds */
 #define OPCN3_WAIT_LASER_TIME			149 /* 1.5 seconds */
-#define OPC_BINS_MULTIPLIER				32.0f	/* Max 2048 count/ml with 1/32 resolution */
-#define OPC_PM_MULTIPLIER				32.0f	/* Max 2048 ug/m3 with 1/32 resolution */
-#define OPC_VOLUME_MULTIPLIER			64.0f	/* Max 1024 ml with 1/64 resolution */
-#define OPC_TEMP_MULTIPLIER				1000.0f
-#define OPC_HUM_MULTIPLIER				1000.0f
+#define OPCN3_DISCOVERY_TIMEOUT			999	/* 10 seconds, longer than one complete communication retry cycle */
 
 #define LASER_CURRENT_THRESHOLD	300	/* We experienced a working laser is associated to the surrounding of 600 */
 
@@ -60,18 +56,8 @@ const char* const OPCN3Device::channelMeasurementUnits[] = {
 	"ms", "ml/s", "ticks",
 };
 
-double const OPCN3Device::evaluationFactors[] = {
-	(1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER),
-	(1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER),
-	(1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER),
-	(1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER), (1/OPC_BINS_MULTIPLIER),
-	(1/OPC_PM_MULTIPLIER), (1/OPC_PM_MULTIPLIER), (1/OPC_PM_MULTIPLIER),
-	(1/(1000.0f)), (1/(1000.0f)), (1/OPC_VOLUME_MULTIPLIER),
-	1.0f, 1.0f, 1.0f
-};
-
-OPCN3Device::OPCN3Device() : SensorDevice(OPCN3_CHAN_NUMBER),
-				lowPowerMode(false), samplingEnabled(false), curStatus(REQ_INFOSTRING), isOPCN2Unit(false), timer(0) {
+OPCN3Device::OPCN3Device() : SensorDevice(OPCN3_CHAN_NUMBER, SAMPLE_FORMAT_FLOAT),
+				lowPowerMode(false), samplingEnabled(false), curStatus(REQ_INFOSTRING), isOPCN2Unit(false), timer(0), discoveryTimer(0) {
 	memset(serialNumber, 0x00, OPCN3_SERIAL_NUMBER_MAXLENGTH);
 	strcpy(serialNumber, "NA");
  }
@@ -79,10 +65,29 @@ OPCN3Device::OPCN3Device() : SensorDevice(OPCN3_CHAN_NUMBER),
 OPCN3Device::~OPCN3Device() {
 }
 
+// Discovery is part of the loop state machine (info and serial strings request).
+// The unit is reported absent if it doesn't answer within the discovery timeout.
+void OPCN3Device::bringUp() {
+
+	if (discoveryTimer > OPCN3_DISCOVERY_TIMEOUT) {
+		curStatus = IDLE;
+		setBringUpStatus(BRINGUP_ABSENT);
+	}
+}
+
+// Request again the info and serial strings (i.e. the unit has been plugged later)
+void OPCN3Device::restartBringUp() {
+
+	discoveryTimer = 0;
+	curStatus = REQ_INFOSTRING;
+	SensorDevice::restartBringUp();
+}
+
 void OPCN3Device::onStartSampling() {
 	SensorDevice::onStartSampling();
 
-	if (!lowPowerMode) {
+	// Don't break the discovery sequence. Sampling will start at its end.
+	if (!lowPowerMode && isReady()) {
 		curStatus = SET_LASER_ON;
 	}
 	samplingEnabled = true;
@@ -90,7 +95,9 @@ void OPCN3Device::onStartSampling() {
 
 void OPCN3Device::onStopSampling() {
 
-	curStatus = SET_LASER_OFF;
+	if (isReady()) {
+		curStatus = SET_LASER_OFF;
+	}
 	samplingEnabled = false;
 }
 
@@ -122,6 +129,9 @@ void OPCN3Device::loop() {
 				if (infostring != NULL) {
 					evaluateInfoString(infostring);
 					curStatus = REQ_SERIALSTRING;
+				} else if (opcComm.ready()) {
+					// Communication dropped on timeout. Ask again.
+					curStatus = REQ_INFOSTRING;
 				}
 			}
 		}
@@ -143,7 +153,11 @@ void OPCN3Device::loop() {
 				serialstring = opcComm.getSerialString();
 				if (serialstring != NULL) {
 					evaluateSerialString(serialstring);
-					curStatus = IDLE;
+					setBringUpStatus(BRINGUP_READY);
+					curStatus = (samplingEnabled && !lowPowerMode)? SET_LASER_ON : IDLE;
+				} else if (opcComm.ready()) {
+					// Communication dropped on timeout. Ask again.
+					curStatus = REQ_SERIALSTRING;
 				}
 			}
 		}
@@ -276,30 +290,24 @@ bool OPCN3Device::evaluateSerialString(OPCN3Comm::serialstring* serialstring) {
 
 bool OPCN3Device::evaluateHistogram(OPCN3Comm::histogram* histogram) {
 
-	// Evaluate histogram
+	// Evaluate histogram. All values are stored in engineering units.
 	float airVolume = ((float)(histogram->samplingFlowRate * histogram->samplingPeriod)) / 10000.0f; /* Volume in ml */
 	for (unsigned char channel = 0; channel < OPCN3_BINS_NUMBER; channel++) {
-		float fParticles = ((float)(histogram->bins[channel])) / airVolume;	/* Counts / ml */
-		fParticles *= OPC_BINS_MULTIPLIER;
-		unsigned short particles = (unsigned short) fParticles;
-		setSample(channel, particles);
+		setFloatSample(channel, ((float)(histogram->bins[channel])) / airVolume);	/* Counts / ml */
 	}
 
 	for (unsigned char channel = 0; channel < OPCN3_PMS_NUMBER; channel++) {
-		unsigned short pmVal = (unsigned short)(opcComm.toPmValue(histogram->pmVal + channel) * OPC_PM_MULTIPLIER);
-		setSample(channel+OPCN3_BINS_NUMBER, pmVal);
+		setFloatSample(channel+OPCN3_BINS_NUMBER, opcComm.toPmValue(histogram->pmVal + channel));
 	}
 
-	double evalTemp = (((((double)histogram->temperature)/65535)*175)-45.0)*OPC_TEMP_MULTIPLIER;
-	setSample(OPCN3_TEMP, (unsigned short)evalTemp);
-	double evalHum = (((double)histogram->relHumidity)/65535)*100.0*OPC_HUM_MULTIPLIER;
-	setSample(OPCN3_HUM, (unsigned short)evalHum);
-	setSample(OPCN3_VOL, (unsigned short) (airVolume * OPC_VOLUME_MULTIPLIER));
+	setFloatSample(OPCN3_TEMP, ((((float)histogram->temperature)/65535)*175)-45.0f);
+	setFloatSample(OPCN3_HUM, (((float)histogram->relHumidity)/65535)*100.0f);
+	setFloatSample(OPCN3_VOL, airVolume);
 
 	/* These are reported for debug purposes only */
-	setSample(OPCN3_TSA, histogram->samplingPeriod);
-	setSample(OPCN3_FRT, histogram->samplingFlowRate);
-	setSample(OPCN3_LSRST, histogram->laserStatus);
+	setFloatSample(OPCN3_TSA, histogram->samplingPeriod);
+	setFloatSample(OPCN3_FRT, histogram->samplingFlowRate);
+	setFloatSample(OPCN3_LSRST, histogram->laserStatus);
 
 	return (histogram->laserStatus < LASER_CURRENT_THRESHOLD);
 }
@@ -308,6 +316,10 @@ void OPCN3Device::tick() {
 
 	opcComm.tick();
 	timer++;
+
+	if ((getBringUpStatus() == BRINGUP_PENDING) && (discoveryTimer <= OPCN3_DISCOVERY_TIMEOUT)) {
+		discoveryTimer++;
+	}
 }
 
 bool OPCN3Device::setChannelName(unsigned char channel, const char* name) {
@@ -335,7 +347,7 @@ const char* OPCN3Device::getMeasurementUnit(unsigned char channel) const {
 float OPCN3Device::evaluateMeasurement(unsigned char channel, float value) const {
 
 	if (channel < OPCN3_CHAN_NUMBER) {
-		return value* evaluationFactors[channel];
+		return value;
 	}
 
 	return 0.0f;
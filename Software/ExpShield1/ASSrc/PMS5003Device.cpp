@@ -27,7 +27,17 @@
 #include "GPIOHelper.h"
 
 
-#define PSM5003_START_FRAME	0x424d
+#define PSM5003_START_FRAME_1	0x42
+#define PSM5003_START_FRAME_2	0x4D
+#define PSM5003_LENGTH_OFFSET	2
+#define PSM5003_DATA_OFFSET		4
+
+// 0x42 0x4D, 16 bit length of the following bytes, 13 data words, 16 bit sum of all previous bytes
+const FrameParser::descriptor PMS5003Device::frameDescriptor = {
+		2, { PSM5003_START_FRAME_1, PSM5003_START_FRAME_2 },
+		FrameParser::LENGTH_FIELD16, PSM5003_LENGTH_OFFSET, 4, 0, 0,
+		FrameParser::CHECKSUM_SUM16, 0, true
+};
 
 const char* const PMS5003Device::channelNames[] = {
 		"5301CST", "5325CST", "5310CST", "5301CAT", "5325CAT", "5310CAT",
@@ -40,7 +50,7 @@ const char* const PMS5003Device::channelMeasurementUnits[] = {
 };
 
 PMS5003Device::PMS5003Device() : SensorDevice(PSM5003_NUM_CHANNELS),
-					curOffset(0), startCharacter(0), validFrame(false) {
+					frameParser(frameDescriptor) {
 
 	// Initialize the SerialC line
 	SerialC.init();
@@ -81,9 +91,8 @@ void PMS5003Device::setLowPowerMode(bool lowPower) {
 void PMS5003Device::loop() {
 
     // Handle the serial line C
-    if (SerialC.available()) {
-    		unsigned char val = SerialC.read();
-    		onDataReceived(val);
+    if (frameParser.consume(SerialC)) {
+    		evaluateFrame();
     }
 }
 
@@ -126,64 +135,9 @@ float PMS5003Device::evaluateMeasurement(unsigned char channel, float value) con
 	}
 }
 
-void PMS5003Device::onDataReceived(unsigned char pivotChar) {
-
-	if (!validFrame) {
-		startCharacter = (startCharacter << 8) + pivotChar;
-		if (startCharacter == PSM5003_START_FRAME) {
-			validFrame = true;
-			curOffset = 0;
-		}
-	} else {
-
-		*(((unsigned char*)&dataStruct)+curOffset) = pivotChar;
-		curOffset++;
-		if (curOffset == sizeof(datastruct)) {
-			evaluateFrame();
-			validFrame = false;
-		}
-	}
-}
-
-bool PMS5003Device::checkCRC() {
-
-	unsigned short sum = (PSM5003_START_FRAME & 0xFF) + ((PSM5003_START_FRAME>>8) & 0xFF);
-	for (unsigned n = 0; n < sizeof(datastruct)-2; n++) {
-		unsigned char* pVar = ((unsigned char*)&dataStruct)+n;
-		sum += *pVar;
-	}
-
-	// Swap endianess
-	sum = (sum>>8) + ((sum&0xFF)<<8);
-
-	return sum == dataStruct.check;
-}
-
-void PMS5003Device::swapEndianess() {
-
-	for (unsigned n = 0; n < (sizeof(datastruct)/2)-1; n++) {
-		unsigned short* pVar = ((unsigned short*)&dataStruct)+n;
-		*pVar = (*pVar>>8) + ((*pVar&0xFF)<<8);
-	}
-}
-
 void PMS5003Device::evaluateFrame() {
 
-	if (checkCRC()) {
-		swapEndianess();
-
-		setSample(0, dataStruct.pm1concSt);
-		setSample(1, dataStruct.pm25concSt);
-		setSample(2, dataStruct.pm10concSt);
-		setSample(3, dataStruct.pm1concAt);
-		setSample(4, dataStruct.pm25concAt);
-		setSample(5, dataStruct.pm10concAt);
-		setSample(6, dataStruct.part03);
-		setSample(7, dataStruct.part05);
-		setSample(8, dataStruct.part10);
-		setSample(9, dataStruct.part25);
-		setSample(10, dataStruct.part50);
-		setSample(11, dataStruct.part100);
+	for (unsigned char channel = 0; channel < PSM5003_NUM_CHANNELS; channel++) {
+		setSample(channel, frameParser.getWord(PSM5003_DATA_OFFSET + (channel << 1)));
 	}
 }
-
@@ -48,6 +48,20 @@
 #define RD200_DEFAULT_SAMPLERATE			24		// 25 seconds each sample
 #define RD200_DEFAULT_DECIMATIONVALUE	39		// 40 samples -> 10 minutes each result
 
+/* Result frame layout */
+#define RD200_FRAME_LENGTH_OFFSET		2
+#define RD200_FRAME_STATUS				3
+#define RD200_FRAME_MINUTES				4
+#define RD200_FRAME_UNIT				5
+#define RD200_FRAME_CENTS				6
+
+// STX, result command, data length, data, 0xFF - sum of command, length and data
+const FrameParser::descriptor RD200MDevice::frameDescriptor = {
+		2, { STX_CHAR, CMD_RD200M_RESULT_RETURN },
+		FrameParser::LENGTH_FIELD8, RD200_FRAME_LENGTH_OFFSET, 4, 0, 0,
+		FrameParser::CHECKSUM_SUM8_INV, 1, true
+};
+
 const unsigned char RD200MDevice::defaultSampleRate() {
 	return RD200_DEFAULT_SAMPLERATE;
 }
@@ -57,7 +71,7 @@ const unsigned char RD200MDevice::defaultDecimationValue() {
 }
 
 
-RD200MDevice::RD200MDevice() : SensorDevice(1), curStatus(RX_IDLE), curRxOffset(0), needsReset(true) {
+RD200MDevice::RD200MDevice() : SensorDevice(1), frameParser(frameDescriptor), needsReset(true) {
 
 	// Initialize the SerialD line
 	SerialD.init();
@@ -66,16 +80,6 @@ RD200MDevice::RD200MDevice() : SensorDevice(1), curStatus(RX_IDLE), curRxOffset(
 RD200MDevice::~RD200MDevice() {
 }
 
-unsigned char RD200MDevice::checkSum() {
-	unsigned char* data = (unsigned char*)&dataStruct;
-	unsigned char sum = 0;
-	for (unsigned char i = 0; i < sizeof(datastruct); i++) {
-		sum += data[i];
-	}
-
-	return 0xFF-sum;
-}
-
 void RD200MDevice::onStartSampling() {
 
 	SensorDevice::onStartSampling();
@@ -94,9 +98,8 @@ void RD200MDevice::setLowPowerMode(bool lowPower) {
 void RD200MDevice::loop() {
 
     // Handle the serial line D
-    if (SerialD.available()) {
-    		unsigned char val = SerialD.read();
-    		onDataReceived(val);
+    if (frameParser.consume(SerialD)) {
+    		evaluateRxBuffer();
     }
 }
 
@@ -138,73 +141,22 @@ void RD200MDevice::requestData(unsigned char command) {
 	SerialD.write(buffer, 4);
 }
 
-void RD200MDevice::onDataReceived(unsigned char pivotChar) {
-
-	switch (curStatus) {
-
-		case RX_IDLE: {
-			if (pivotChar == STX_CHAR) {
-				curStatus = RX_STARTFOUND;
-			}
-		}
-		break;
-
-		case RX_STARTFOUND: {
-			if (pivotChar == CMD_RD200M_RESULT_RETURN) {
-				dataStruct.command = pivotChar;
-				curStatus = RX_COMMANDFOUND;
-			} else  {
-				curStatus = RX_IDLE;
-			}
-		}
-		break;
-
-		case RX_COMMANDFOUND: {
-			if (pivotChar == DEFAULT_RESULT_LEN) {
-				dataStruct.dataSize = pivotChar;
-				curStatus = RX_WAITING_PARAMETERS;
-				curRxOffset = 0;
-			} else  {
-				curStatus = RX_IDLE;
-			}
-		}
-		break;
-
-		case RX_WAITING_PARAMETERS: {
-			dataStruct.data.buffer[curRxOffset] = pivotChar;
-			curRxOffset++;
-			if (curRxOffset == dataStruct.dataSize) {
-				curStatus = RX_WAITING_CRC;
-			}
-		}
-		break;
-
-		case RX_WAITING_CRC: {
-			unsigned char calcChecksum = checkSum();
-			if (calcChecksum == pivotChar) {
-				evaluateRxBuffer();
-			}
-			curStatus = RX_IDLE;
-		}
-		break;
-
-		default:
-			curStatus = RX_IDLE;
-			break;
-	}
-}
-
 void RD200MDevice::evaluateRxBuffer() {
 
-	if (dataStruct.data.decoded.status == RD200_STATUS_NORMAL) {
+	if (frameParser.getByte(RD200_FRAME_LENGTH_OFFSET) != DEFAULT_RESULT_LEN) {
+		return;
+	}
+
+	unsigned char status = frameParser.getByte(RD200_FRAME_STATUS);
+	if (status == RD200_STATUS_NORMAL) {
 
-		unsigned short sample = (dataStruct.data.decoded.unit * 100) + dataStruct.data.decoded.cents;
+		unsigned short sample = (frameParser.getByte(RD200_FRAME_UNIT) * 100) + frameParser.getByte(RD200_FRAME_CENTS);
 		setSample(0, sample);
 
-	} else if (dataStruct.data.decoded.status == RD200_STATUS_1HWAITWARNING) {
+	} else if (status == RD200_STATUS_1HWAITWARNING) {
 		setSample(0, RD200_SAMPLE_VAL_IN_WARNING);
 
-	} else if (dataStruct.data.decoded.status == RD200_STATUS_VIBRATIONS) {
+	} else if (status == RD200_STATUS_VIBRATIONS) {
 
 		// Issue a RESET (to be verified)
 		needsReset = true;
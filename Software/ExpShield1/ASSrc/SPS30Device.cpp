@@ -46,12 +46,16 @@
 #define SPS30_READ_FIRMWAREVERSION	0xD100
 
 #define SPS30_DISCOVERY_RETRY		3
+#define SPS30_DISCOVERY_PERIOD		10		/* Time between two discovery attempts (one sampletick = 0.01s) */
 #define SPS30_READ_SERIALNUMBER_BUFFERSIZE	48
 #define SPS30_READ_FIRMWAREVERSION_BUFFERSIZE	3
 
-#define SPS30_PM_MULTIPLIER				128.0f		/* Max 512 ug/m3 with 1/128 resolution */
-#define SPS30_BINS_MULTIPLIER			32.0f		/* Max 2048 count/ml with 1/32 resolution */
-#define SPS30_TYPSIZE_MULTIPLIER		32768.0f	/* Max 1.9999 typical particle size with 1/32768 resolution */
+// IEEE754 measurements are carried as native float samples
+#ifdef SPS30_USE_INTEGERS
+#define SPS30_SAMPLE_FORMAT				SAMPLE_FORMAT_UINT16
+#else
+#define SPS30_SAMPLE_FORMAT				SAMPLE_FORMAT_FLOAT
+#endif
 
 
 #define SWAP_ENDIANESS(a) ((a)>>8) + (((a)&0xFF)<<8);
@@ -66,50 +70,18 @@ const char* const SPS30Device::channelMeasurementUnits[] = {
 		"counts/ml", 	"counts/ml", 	"counts/ml", 	"counts/ml", 	"counts/ml", 	"um"
 };
 
-float const SPS30Device::multiplierFactors[] = {
-		SPS30_PM_MULTIPLIER, SPS30_PM_MULTIPLIER, SPS30_PM_MULTIPLIER, SPS30_PM_MULTIPLIER,
-		SPS30_BINS_MULTIPLIER, SPS30_BINS_MULTIPLIER, SPS30_BINS_MULTIPLIER, SPS30_BINS_MULTIPLIER, SPS30_BINS_MULTIPLIER,
-		SPS30_TYPSIZE_MULTIPLIER
-};
-
-double const SPS30Device::evaluationFactors[] = {
-		(1/SPS30_PM_MULTIPLIER), (1/SPS30_PM_MULTIPLIER), (1/SPS30_PM_MULTIPLIER), (1/SPS30_PM_MULTIPLIER),
-		(1/SPS30_BINS_MULTIPLIER), (1/SPS30_BINS_MULTIPLIER), (1/SPS30_BINS_MULTIPLIER), (1/SPS30_BINS_MULTIPLIER), (1/SPS30_BINS_MULTIPLIER),
-		(1/SPS30_TYPSIZE_MULTIPLIER)
-};
-
 const unsigned char SPS30Device::defaultSampleRate() {
 	return SPS30_DEFAULT_SAMPLERATE;
 }
 
-SPS30Device::SPS30Device() : SensorDevice(SPS30_NUM_CHANNELS), go(false), blankTimer(0), deviceReady(false), maxCheckReady(0) {
+SPS30Device::SPS30Device() : SensorDevice(SPS30_NUM_CHANNELS, SPS30_SAMPLE_FORMAT), go(false), blankTimer(0), samplingOn(false), maxCheckReady(0),
+								discoveryRetry(0), discoveryTimer(SPS30_DISCOVERY_PERIOD) {
 
 	// Select I2C communications
 	AS_GPIO.digitalWrite(SPARE1, false);
 
 	memset(serialNumber, 0x00, SPS30_SERIAL_NUMBER_MAXLENGTH);
 	strcpy(serialNumber, "NA");
-
-	for (unsigned char retry = 0; retry < SPS30_DISCOVERY_RETRY; retry++) {
-		char serial[32];
-		if (readSerialNumber(serial)) {
-			strncpy(serialNumber, serial+1, SPS30_SERIAL_NUMBER_MAXLENGTH);
-			deviceReady = true;
-			break;
-		}
-	}
-
-	// Check for the firmware version (We don't support firmware older than 2.x revisions)
-	if (deviceReady) {
-		char fwVersion[12];
-		deviceReady = readFirmwareVersion(fwVersion);
-		if (deviceReady) {
-
-			if (fwVersion[0] < 0x02) {
-				deviceReady = false;
-			}
-		}
-	}
 }
 
 SPS30Device::~SPS30Device() {
@@ -119,6 +91,12 @@ SPS30Device::~SPS30Device() {
 void SPS30Device::onStartSampling() {
 
 	SensorDevice::onStartSampling();
+	samplingOn = true;
+
+	// The measurement will be started at the end of the bring-up
+	if (!isReady()) {
+		return;
+	}
 
 	// Release from standby mode
 	startMeasurement();
@@ -129,8 +107,12 @@ void SPS30Device::onStartSampling() {
 
 void SPS30Device::onStopSampling() {
 
+	samplingOn = false;
+
 	// Set in standby mode
-	stopMeasurement();
+	if (isReady()) {
+		stopMeasurement();
+	}
 }
 
 void SPS30Device::setLowPowerMode(bool lowPower) {
@@ -138,7 +120,7 @@ void SPS30Device::setLowPowerMode(bool lowPower) {
 
 void SPS30Device::loop() {
 
-	if (deviceReady && go && (blankTimer >= SPS30_BLANK_PERIOD)) {
+	if (isReady() && go && (blankTimer >= SPS30_BLANK_PERIOD)) {
 
 		// Check for sample availability
 		if (!readDataReady()) {
@@ -179,9 +161,7 @@ void SPS30Device::loop() {
 				float measurements[SPS30_NUM_CHANNELS];
 				if (decodeMeasurements(data, measurements)) {
 					for (unsigned char n = 0; n < SPS30_NUM_CHANNELS; n++) {
-						float sample = measurements[n];
-						sample = sample * multiplierFactors[n];
-						setSample(n, (unsigned short)sample);
+						setFloatSample(n, measurements[n]);
 					}
 				}
 			}
@@ -195,6 +175,52 @@ void SPS30Device::tick() {
 	if (blankTimer < SPS30_BLANK_PERIOD) {
 		blankTimer++;
 	}
+
+	if (discoveryTimer < SPS30_DISCOVERY_PERIOD) {
+		discoveryTimer++;
+	}
+}
+
+void SPS30Device::restartBringUp() {
+
+	discoveryRetry = 0;
+	discoveryTimer = SPS30_DISCOVERY_PERIOD;
+	SensorDevice::restartBringUp();
+}
+
+void SPS30Device::bringUp() {
+
+	// One discovery attempt each SPS30_DISCOVERY_PERIOD
+	if (discoveryTimer < SPS30_DISCOVERY_PERIOD) {
+		return;
+	}
+	discoveryTimer = 0;
+
+	char serial[32];
+	if (readSerialNumber(serial)) {
+
+		// Check for the firmware version (We don't support firmware older than 2.x revisions)
+		char fwVersion[12];
+		if (!readFirmwareVersion(fwVersion) || (fwVersion[0] < 0x02)) {
+			setBringUpStatus(BRINGUP_ABSENT);
+			return;
+		}
+
+		strncpy(serialNumber, serial+1, SPS30_SERIAL_NUMBER_MAXLENGTH);
+		setBringUpStatus(BRINGUP_READY);
+
+		// Sampling was requested while still discovering the device
+		if (samplingOn) {
+			startMeasurement();
+			blankTimer = 0;
+		}
+		return;
+	}
+
+	discoveryRetry++;
+	if (discoveryRetry >= SPS30_DISCOVERY_RETRY) {
+		setBringUpStatus(BRINGUP_ABSENT);
+	}
 }
 
 const char* SPS30Device::getSerial() const  {
@@ -223,18 +249,14 @@ const char* SPS30Device::getMeasurementUnit(unsigned char channel) const {
 	return "";
 }
 
+// Both integer and float measurements are already expressed in engineering units
 float SPS30Device::evaluateMeasurement(unsigned char channel, float value) const {
 
-#ifdef SPS30_USE_INTEGERS
-	return value;
-#else
-
 	if (channel < SPS30_NUM_CHANNELS) {
-		return value* evaluationFactors[channel];
+		return value;
 	}
 
 	return 0.0f;
-#endif
 }
 
 void SPS30Device::triggerSample() {
@@ -27,15 +27,25 @@
 #include "Persistence.h"
 #include "EEPROMHelper.h"
 #include "SensorDevice.h"
+#include "ChannelFilter.h"
 #include <string.h>
 
 Sampler::Sampler(unsigned char channels, SensorDevice* _sensor)
 		: go(false), prescaler(0), timer(0), decimation(0), decimationTimer(0), numChannels(channels), sensor(_sensor) {
 
-	lastSample = new unsigned short [channels];
-	memset(lastSample, 0, channels*sizeof(unsigned short));
+	// Samples are stored in the sensor native format
+	lastSample = 0;
+	lastFloatSample = 0;
+	if (sensor->getSampleFormat() == SAMPLE_FORMAT_FLOAT) {
+		lastFloatSample = new float [channels];
+		memset(lastFloatSample, 0, channels*sizeof(float));
+	} else {
+		lastSample = new unsigned short [channels];
+		memset(lastSample, 0, channels*sizeof(unsigned short));
+	}
 	enabled = new bool[channels];
 	memset(enabled, 0xff, channels*sizeof(bool));
+	filters = new ChannelFilter[channels];
 }
 
 const unsigned char Sampler::getNumChannels() const {
@@ -65,7 +75,19 @@ unsigned short Sampler::getLastSample(unsigned char channel) {
 	if (channel >= numChannels)
 		return 0;
 
-    return lastSample[channel];
+    return (lastSample)? lastSample[channel] : 0;
+}
+
+float Sampler::getLastFloatSample(unsigned char channel) {
+
+	if (channel >= numChannels)
+		return 0.0f;
+
+	return (lastFloatSample)? lastFloatSample[channel] : (float)lastSample[channel];
+}
+
+bool Sampler::hasFloatSamples() const {
+	return (lastFloatSample != 0);
 }
 
 bool Sampler::applyDecimationFilter() {
@@ -83,7 +105,14 @@ bool Sampler::applyDecimationFilter() {
 void Sampler::onReadSample(unsigned char channel, unsigned short newSample) {
 
 	if (channel < numChannels) {
-		lastSample[channel] = newSample;
+		lastSample[channel] = filters[channel].apply(newSample);
+	}
+}
+
+void Sampler::onReadSample(unsigned char channel, float newSample) {
+
+	if (channel < numChannels) {
+		lastFloatSample[channel] = filters[channel].apply(newSample);
 	}
 }
 
@@ -97,12 +126,17 @@ bool Sampler::loadPreset(unsigned char myID) {
     setPreScaler(prescVal);
     setDecimation(decimVal);
 
-    // Load channel enable status
+    // Load channel enable status and filters
     for (int channel = 0; channel < numChannels; channel++) {
     	unsigned char read = EEPROM.read(SAMPLER_CHANNEL_ENABLED_PRESET(myID, channel));
+    	unsigned char medianLength = EEPROM.read(SAMPLER_CHANNEL_MEDIAN_PRESET(myID, channel));
+    	unsigned char iirDenom = EEPROM.read(SAMPLER_CHANNEL_IIRDENOM_PRESET(myID, channel));
 
     	// Apply
     	setEnableChannel(channel, read);
+    	if (!setChannelFilter(channel, medianLength, iirDenom)) {
+    		setChannelFilter(channel, 0, 0);
+    	}
     }
 
     return true;
@@ -117,11 +151,24 @@ bool Sampler::savePreset(unsigned char myID) {
     // Save channel enable status
     EEPROM.write(SAMPLER_CHANNEL_ENABLED_PRESET(myID, 0), (unsigned char*)enabled, numChannels);
 
+    // Save channel filters
+    unsigned char medianLengths[SAMPLER_MAX_CHANNELS];
+    unsigned char iirDenoms[SAMPLER_MAX_CHANNELS];
+    for (unsigned char channel = 0; channel < numChannels; channel++) {
+    	getChannelFilter(channel, medianLengths+channel, iirDenoms+channel);
+    }
+    EEPROM.write(SAMPLER_CHANNEL_MEDIAN_PRESET(myID, 0), medianLengths, numChannels);
+    EEPROM.write(SAMPLER_CHANNEL_IIRDENOM_PRESET(myID, 0), iirDenoms, numChannels);
+
     return true;
 }
 
 void Sampler::onStartSampling() {
 
+	for (unsigned char channel = 0; channel < numChannels; channel++) {
+		filters[channel].reset();
+	}
+
 	if (atLeastOneChannelEnabled()) {
 		sensor->onStartSampling();
 	}
@@ -155,8 +202,14 @@ bool Sampler::sampleLoop() {
     if (go && sensor->sampleAvailable()) {
     		go = false;
 
-    		for (unsigned char n = 0; n < numChannels; n++) {
-    			onReadSample(n, sensor->getSample(n));
+    		if (lastFloatSample) {
+    			for (unsigned char n = 0; n < numChannels; n++) {
+    				onReadSample(n, sensor->getFloatSample(n));
+    			}
+    		} else {
+    			for (unsigned char n = 0; n < numChannels; n++) {
+    				onReadSample(n, sensor->getSample(n));
+    			}
     		}
 
         // Apply the decimation filter
@@ -187,6 +240,28 @@ bool Sampler::getChannelIsEnabled(unsigned char channel, unsigned char* _enabled
 	return true;
 }
 
+bool Sampler::setChannelFilter(unsigned char channel, unsigned char medianLength, unsigned char iirDenom) {
+	if (channel >= numChannels)
+		return false;
+
+	if (!filters[channel].setMedianLength(medianLength))
+		return false;
+
+	filters[channel].setIIRDenom(iirDenom);
+
+	return true;
+}
+
+bool Sampler::getChannelFilter(unsigned char channel, unsigned char* medianLength, unsigned char* iirDenom) {
+	if (channel >= numChannels)
+		return false;
+
+	*medianLength = filters[channel].getMedianLength();
+	*iirDenom = filters[channel].getIIRDenom();
+
+	return true;
+}
+
 SensorDevice* Sampler::getSensor() {
 	return sensor;
 }
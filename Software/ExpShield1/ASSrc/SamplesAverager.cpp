@@ -30,12 +30,26 @@
 
 DitherTool* SamplesAverager::ditherTool = (DitherTool*)0x00;
 
-SamplesAverager::SamplesAverager(const unsigned char _channels) : channels(_channels) {
-
-	accumulators = new unsigned long[channels];
+SamplesAverager::SamplesAverager(const unsigned char _channels, const unsigned char format) : channels(_channels), sampleFormat(format),
+		accumulators(0), lastAverageSamples(0), floatDataBuffer(0), floatAccumulators(0), lastAverageFloatSamples(0) {
+
+	if (sampleFormat == SAMPLE_FORMAT_FLOAT) {
+		floatAccumulators = new float[channels];
+		lastAverageFloatSamples = new float[channels];
+	} else {
+		accumulators = new unsigned long[channels];
+		lastAverageSamples = new unsigned short[channels];
+	}
 	sampleOffsets = new unsigned char[channels];
-	lastAverageSamples = new unsigned short[channels];
+	modes = new unsigned char[channels];
+	bufferRows = new unsigned char[channels];
 
+	memset(modes, AVERAGER_MODE_AVERAGE, channels*sizeof(unsigned char));
+	for (unsigned char n = 0; n < channels; n++) {
+		bufferRows[n] = n;
+	}
+
+    dataBuffer = 0;
     reset();
 }
 
@@ -43,6 +57,15 @@ SamplesAverager::~SamplesAverager() {
     if (dataBuffer) {
         delete[] dataBuffer;
     }
+    if (floatDataBuffer) {
+        delete[] floatDataBuffer;
+    }
+    if (floatAccumulators) {
+    		delete[] floatAccumulators;
+    }
+    if (lastAverageFloatSamples) {
+    		delete[] lastAverageFloatSamples;
+    }
     if (accumulators) {
     		delete[] accumulators;
     }
@@ -52,6 +75,12 @@ SamplesAverager::~SamplesAverager() {
     if (lastAverageSamples) {
     		delete[] lastAverageSamples;
     }
+    if (modes) {
+    		delete[] modes;
+    }
+    if (bufferRows) {
+    		delete[] bufferRows;
+    }
 }
 
 // We expect accumulators and channels already allocated/valid
@@ -59,18 +88,57 @@ void SamplesAverager::reset() {
 
     timestamp = 0;    
     bufferSize = 0;
-    dataBuffer = 0;
     consolidated = false;
+    periodTerminated = false;
 
     memset(sampleOffsets, 0, channels*sizeof(unsigned char));
-    memset(lastAverageSamples, 0, channels*sizeof(unsigned short));
-    memset(accumulators, 0, channels*sizeof(unsigned long));
+    if (sampleFormat == SAMPLE_FORMAT_FLOAT) {
+    	memset(lastAverageFloatSamples, 0, channels*sizeof(float));
+    	memset(floatAccumulators, 0, channels*sizeof(float));
+    } else {
+    	memset(lastAverageSamples, 0, channels*sizeof(unsigned short));
+    	memset(accumulators, 0, channels*sizeof(unsigned long));
+    }
+}
+
+// Set how a channel is consolidated. Channels reporting only the latest
+// sample do not take any room in the data buffer.
+// Called by the board setup only: modes are fixed by the channel meaning.
+bool SamplesAverager::setChannelMode(unsigned char channel, unsigned char mode) {
+
+    if ((channel >= channels) || (mode > AVERAGER_MODE_LATEST))
+        return false;
+
+    modes[channel] = mode;
+
+    // Assign the data buffer rows to buffered channels only
+    unsigned char row = 0;
+    for (unsigned char n = 0; n < channels; n++) {
+    	if (modes[n] == AVERAGER_MODE_LATEST) {
+    		bufferRows[n] = AVERAGER_NOT_BUFFERED;
+    	} else {
+    		bufferRows[n] = row;
+    		row++;
+    	}
+    }
+
+    // Rebuild the data buffer if already allocated
+    if (bufferSize != 0) {
+    	init(getBufferSize());
+    }
+
+    return true;
 }
 
 unsigned char SamplesAverager::init(unsigned char size) {
 
     if (dataBuffer) {
         delete[] dataBuffer;
+        dataBuffer = 0;
+    }
+    if (floatDataBuffer) {
+        delete[] floatDataBuffer;
+        floatDataBuffer = 0;
     }
 
     // The buffer should be 1 byte more than what's requested.
@@ -78,13 +146,27 @@ unsigned char SamplesAverager::init(unsigned char size) {
     // need any average
     size = size+1;
 
-	unsigned short overallBufferSize = size * channels;
+    unsigned char bufferedChannels = 0;
+    for (unsigned char n = 0; n < channels; n++) {
+    	if (bufferRows[n] != AVERAGER_NOT_BUFFERED) {
+    		bufferedChannels++;
+    	}
+    }
+	unsigned short overallBufferSize = size * bufferedChannels;
 
 	reset();
-	dataBuffer = new unsigned short [overallBufferSize];
-	if (dataBuffer) {
-		bufferSize = size;
-		memset(dataBuffer, 0, overallBufferSize*sizeof(unsigned short));
+	if (sampleFormat == SAMPLE_FORMAT_FLOAT) {
+		floatDataBuffer = new float [overallBufferSize];
+		if (floatDataBuffer) {
+			bufferSize = size;
+			memset(floatDataBuffer, 0, overallBufferSize*sizeof(float));
+		}
+	} else {
+		dataBuffer = new unsigned short [overallBufferSize];
+		if (dataBuffer) {
+			bufferSize = size;
+			memset(dataBuffer, 0, overallBufferSize*sizeof(unsigned short));
+		}
 	}
     
     return bufferSize;
@@ -100,24 +182,33 @@ bool SamplesAverager::collectSample(unsigned char channel, unsigned short sample
     if (!dataBuffer)
         return false;
 
+    unsigned short* lastAverageSample = lastAverageSamples+channel;
+
+    // Not buffered channels follow the consolidation period of the buffered ones
+    if (modes[channel] == AVERAGER_MODE_LATEST) {
+    	*lastAverageSample = sample;
+    	return periodTerminated;
+    }
+
     unsigned char* sampleOffset = sampleOffsets+channel;
     unsigned long* accumulator = accumulators+channel;
-    unsigned short* lastAverageSample = lastAverageSamples+channel;
+    unsigned short* channelBuffer = dataBuffer + (bufferRows[channel]*bufferSize);
 
     // Remove the old sample from the accumulator
-    *accumulator = *accumulator - dataBuffer[(channel*bufferSize) + *sampleOffset];
+    *accumulator = *accumulator - channelBuffer[*sampleOffset];
       
     // Add the new sample to the accumulator
     *accumulator = *accumulator + sample;
     
     // Store the new sample into the buffer
-    dataBuffer[(channel*bufferSize) + *sampleOffset] = sample;
+    channelBuffer[*sampleOffset] = sample;
     (*sampleOffset)++;
     
     if (*sampleOffset == bufferSize) {
         *sampleOffset = 0;
 		timestamp = _timestamp;
 		consolidated = true;
+		periodTerminated = true;
 
         *lastAverageSample = (unsigned short)ditherTool->applyDithering(((double)(*accumulator))/bufferSize);
         return true;
@@ -132,9 +223,67 @@ bool SamplesAverager::collectSample(unsigned char channel, unsigned short sample
     if (!consolidated) {
       *lastAverageSample = sample;
       timestamp = _timestamp;
+      periodTerminated = true;
       return true;
     }
     
+    periodTerminated = false;
+    return false;
+}
+
+// Float version of the above. The accumulator is rebuilt from the buffer at each
+// buffer completion so that rounding errors do not build up over time.
+bool SamplesAverager::collectSample(unsigned char channel, float sample, unsigned long _timestamp) {
+
+    if (channel >= channels)
+        return false;
+
+    if (!floatDataBuffer)
+        return false;
+
+    float* lastAverageSample = lastAverageFloatSamples+channel;
+
+    // Not buffered channels follow the consolidation period of the buffered ones
+    if (modes[channel] == AVERAGER_MODE_LATEST) {
+    	*lastAverageSample = sample;
+    	return periodTerminated;
+    }
+
+    unsigned char* sampleOffset = sampleOffsets+channel;
+    float* accumulator = floatAccumulators+channel;
+    float* channelBuffer = floatDataBuffer + (bufferRows[channel]*bufferSize);
+
+    // Replace the old sample with the new one into the accumulator and the buffer
+    *accumulator = *accumulator - channelBuffer[*sampleOffset] + sample;
+    channelBuffer[*sampleOffset] = sample;
+    (*sampleOffset)++;
+
+    if (*sampleOffset == bufferSize) {
+        *sampleOffset = 0;
+		timestamp = _timestamp;
+		consolidated = true;
+		periodTerminated = true;
+
+		float sum = 0.0f;
+		for (unsigned char n = 0; n < bufferSize; n++) {
+			sum += channelBuffer[n];
+		}
+		*accumulator = sum;
+
+        *lastAverageSample = sum/bufferSize;
+        return true;
+    }
+
+    // We prefer to send back a set of unfiltered samples instead of zero
+    // for the very beginning of the filter's life.
+    if (!consolidated) {
+      *lastAverageSample = sample;
+      timestamp = _timestamp;
+      periodTerminated = true;
+      return true;
+    }
+
+    periodTerminated = false;
     return false;
 }
 
@@ -150,15 +299,51 @@ void SamplesAverager::setDitherTool(DitherTool* tool) {
 }
 
 unsigned short SamplesAverager::lastAveragedValue(unsigned char channel) {
+
+	if (channel >= channels)
+		return 0;
+
+	// Float samples are rounded and clamped to the unsigned short range
+	if (sampleFormat == SAMPLE_FORMAT_FLOAT) {
+		float value = lastAveragedFloatValue(channel);
+		if (value <= 0.0f) {
+			return 0;
+		}
+		if (value >= 65535.0f) {
+			return 0xFFFF;
+		}
+		return (unsigned short)(value + 0.5f);
+	}
+
+	if (modes[channel] == AVERAGER_MODE_SUM) {
+		return (unsigned short)accumulators[channel];
+	}
+
     return lastAverageSamples[channel];
 }
 
-unsigned long SamplesAverager::lastTimeStamp() {
-    return timestamp;
+float SamplesAverager::lastAveragedFloatValue(unsigned char channel) {
+
+	if (channel >= channels)
+		return 0.0f;
+
+	if (sampleFormat != SAMPLE_FORMAT_FLOAT) {
+		return lastAveragedValue(channel);
+	}
+
+	if (modes[channel] == AVERAGER_MODE_SUM) {
+		return floatAccumulators[channel];
+	}
+
+	return lastAverageFloatSamples[channel];
 }
 
-unsigned long* SamplesAverager::getAccumulators() const {
-	return accumulators;
+bool SamplesAverager::hasFloatSamples() const {
+	return (sampleFormat == SAMPLE_FORMAT_FLOAT);
+}
+
+unsigned long SamplesAverager::lastTimeStamp() {
+    return timestamp;
 }
 
 bool SamplesAverager::loadPreset(unsigned char myID) {
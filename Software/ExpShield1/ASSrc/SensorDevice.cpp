@@ -25,26 +25,66 @@
 #include "SensorDevice.h"
 #include <string.h>
 
-SensorDevice::SensorDevice(const unsigned char reqChannels) : sampleReady(false), numChannels(reqChannels) {
+SensorDevice::SensorDevice(const unsigned char reqChannels, const unsigned char format) : bringUpStatus(BRINGUP_PENDING), sampleReady(false),
+			numChannels(reqChannels), sampleFormat(format), lastSamples(0), lastFloatSamples(0) {
 
-	lastSamples = new unsigned short[reqChannels];
+	if (sampleFormat == SAMPLE_FORMAT_FLOAT) {
+		lastFloatSamples = new float[reqChannels];
+	} else {
+		lastSamples = new unsigned short[reqChannels];
+	}
 }
 
 SensorDevice::~SensorDevice() {
 
-	delete[] lastSamples;
+	if (lastSamples) {
+		delete[] lastSamples;
+	}
+	if (lastFloatSamples) {
+		delete[] lastFloatSamples;
+	}
 }
 
 void SensorDevice::onStartSampling() {
 
-	memset(lastSamples, 0x00, numChannels*sizeof(unsigned short));
+	if (lastFloatSamples) {
+		memset(lastFloatSamples, 0x00, numChannels*sizeof(float));
+	} else {
+		memset(lastSamples, 0x00, numChannels*sizeof(unsigned short));
+	}
 	sampleReady = false;
 }
 
+// Devices without a discovery protocol are ready as soon as the power supply is stable
+void SensorDevice::bringUp() {
+	setBringUpStatus(BRINGUP_READY);
+}
+
+// Start again the discovery procedure (i.e. for absent devices)
+void SensorDevice::restartBringUp() {
+	setBringUpStatus(BRINGUP_PENDING);
+}
+
+SensorDevice::bringupstatus SensorDevice::getBringUpStatus() const {
+	return bringUpStatus;
+}
+
+bool SensorDevice::isReady() const {
+	return (bringUpStatus == BRINGUP_READY);
+}
+
+void SensorDevice::setBringUpStatus(bringupstatus status) {
+	bringUpStatus = status;
+}
+
 const unsigned char SensorDevice::getNumChannels() const {
 	return numChannels;
 }
 
+unsigned char SensorDevice::getSampleFormat() const {
+	return sampleFormat;
+}
+
 void SensorDevice::triggerSample() {
 	sampleReady = false;
 }
@@ -63,16 +103,40 @@ unsigned short SensorDevice::getSample(unsigned char channel) {
 			sampleReady = false;
 		}
 
-		return lastSamples[channel];
+		return (lastSamples)? lastSamples[channel] : 0x0000;
 	}
 
 	return 0x0000;
 }
 
+float SensorDevice::getFloatSample(unsigned char channel) {
+
+	if (channel < numChannels) {
+
+		// As soon as the latest channel has been read, mark all samples as
+		// not available anymore
+		if (channel == (numChannels-1)) {
+			sampleReady = false;
+		}
+
+		return (lastFloatSamples)? lastFloatSamples[channel] : (float)lastSamples[channel];
+	}
+
+	return 0.0f;
+}
+
 void SensorDevice::setSample(unsigned char channel, unsigned short sample) {
 
-	if (channel <= numChannels) {
+	if ((channel < numChannels) && lastSamples) {
 		lastSamples[channel] = sample;
 		sampleReady = true;
 	}
 }
+
+void SensorDevice::setFloatSample(unsigned char channel, float sample) {
+
+	if ((channel < numChannels) && lastFloatSamples) {
+		lastFloatSamples[channel] = sample;
+		sampleReady = true;
+	}
+}
@@ -26,8 +26,6 @@
 #include "Sampler.h"
 #include "FixedRateSampler.h"
 #include "SamplesAverager.h"
-#include "SamplesAveragerOPCN3.h"
-#include "SamplesAveragerNextPM.h"
 #include "SensorDevice.h"
 #include "RD200MDevice.h"
 #include "PMS5003Device.h"
@@ -42,66 +40,166 @@
 
 #define GLOBAL_SAMPLE_PRESCALER_RATIO	100
 
+#define POWERUP_SETTLE_TIME		50		/* Power supply rails stabilization time before starting the devices bring-up (one sampletick = 0.01s) */
+#define REPROBE_PERIOD			1000	/* One absent device is re-probed every 10 seconds (one sampletick = 0.01s) */
+
 DitherTool SensorsArray::ditherTool = DitherTool();
 
-const SensorsArray::channeltosamplersubchannel SensorsArray::chToSamplerSubChannel[NUM_OF_TOTAL_CHANNELS] = {
-		{ SENSOR_RD200M, 0, true },
-		{ SENSOR_D300, 0 , true },
-		{ SENSOR_PMS5300, PMS5300_PM1CONC_ST, true },{ SENSOR_PMS5300, PMS5300_PM25CONC_ST, false },{ SENSOR_PMS5300, PMS5300_PM10CONC_ST, false },
-		{ SENSOR_PMS5300, PMS5300_PM1CONC_AT, false },{ SENSOR_PMS5300, PMS5300_PM25CONC_AT, false },{ SENSOR_PMS5300, PMS5300_PM10CONC_AT, false },
-		{ SENSOR_PMS5300, PMS5300_PART03, false },{ SENSOR_PMS5300, PMS5300_PART05, false },{ SENSOR_PMS5300, PMS5300_PART10, false },
-		{ SENSOR_PMS5300, PMS5300_PART25, false },{ SENSOR_PMS5300, PMS5300_PART50, false },{ SENSOR_PMS5300, PMS5300_PART100, false },
-		{ SENSOR_OPCN3, OPCN3_BIN0, true },{ SENSOR_OPCN3, OPCN3_BIN1 },{ SENSOR_OPCN3, OPCN3_BIN2, false },{ SENSOR_OPCN3, OPCN3_BIN3, false },
-		{ SENSOR_OPCN3, OPCN3_BIN4, false },{ SENSOR_OPCN3, OPCN3_BIN5, false },{ SENSOR_OPCN3, OPCN3_BIN6, false },{ SENSOR_OPCN3, OPCN3_BIN7, false },
-		{ SENSOR_OPCN3, OPCN3_BIN8, false },{ SENSOR_OPCN3, OPCN3_BIN9, false },{ SENSOR_OPCN3, OPCN3_BIN10, false },{ SENSOR_OPCN3, OPCN3_BIN11, false },
-		{ SENSOR_OPCN3, OPCN3_BIN12, false },{ SENSOR_OPCN3, OPCN3_BIN13, false },{ SENSOR_OPCN3, OPCN3_BIN14, false },{ SENSOR_OPCN3, OPCN3_BIN15, false },
-		{ SENSOR_OPCN3, OPCN3_BIN16, false },{ SENSOR_OPCN3, OPCN3_BIN17, false },{ SENSOR_OPCN3, OPCN3_BIN18, false },{ SENSOR_OPCN3, OPCN3_BIN19, false },
-		{ SENSOR_OPCN3, OPCN3_BIN20, false },{ SENSOR_OPCN3, OPCN3_BIN21, false },{ SENSOR_OPCN3, OPCN3_BIN22, false },{ SENSOR_OPCN3, OPCN3_BIN23, false },
-		{ SENSOR_OPCN3, OPCN3_PM01, false },{ SENSOR_OPCN3, OPCN3_PM25, false },{ SENSOR_OPCN3, OPCN3_PM10, false },
-		{ SENSOR_OPCN3, OPCN3_TEMP, false },{ SENSOR_OPCN3, OPCN3_HUM, false },{ SENSOR_OPCN3, OPCN3_VOL, false },
-		{ SENSOR_OPCN3, OPCN3_TSA, false },{ SENSOR_OPCN3, OPCN3_FRT, false },{ SENSOR_OPCN3, OPCN3_LSRST, false },
-		{ SENSOR_SPS30, SPS30_PM1CONC, true }, { SENSOR_SPS30, SPS30_PM25CONC, false }, { SENSOR_SPS30, SPS30_PM4CONC, false },  { SENSOR_SPS30, SPS30_PM10CONC, false },
-		{ SENSOR_SPS30, SPS30_PART05, false }, { SENSOR_SPS30, SPS30_PART10, false }, { SENSOR_SPS30, SPS30_PART25, false }, { SENSOR_SPS30, SPS30_PART40, false }, { SENSOR_SPS30, SPS30_PART100, false },
-		{ SENSOR_SPS30, SPS30_TYPSIZE, false },
-		{ SENSOR_NEXTPM, NEXTPM_PM1PCS, true }, { SENSOR_NEXTPM, NEXTPM_PM25PCS, false }, { SENSOR_NEXTPM, NEXTPM_PM10PCS, false },
-		{ SENSOR_NEXTPM, NEXTPM_PM1CONC, false },{ SENSOR_NEXTPM, NEXTPM_PM25CONC, false },{ SENSOR_NEXTPM, NEXTPM_PM10CONC, false },
-		{ SENSOR_NEXTPM, NEXTPM_TEMPERATURE, false }, { SENSOR_NEXTPM, NEXTPM_HUMIDITY, false }, { SENSOR_NEXTPM, NEXTPM_STATUS, false },
+// Board description. Devices, samplers and averagers concrete types are listed in sensor
+// order. Each sensor exports the subchannels in its set as contiguous logical channels.
+struct ExpShieldOneBoard {
+	typedef TypeList<RD200MDevice, D300Device, PMS5003Device, OPCN3Device, SPS30Device, NextPMDevice> devices;
+	typedef TypeList<FixedRateSampler, FixedRateSampler, FixedRateSampler, Sampler, FixedRateSampler, FixedRateSampler> samplers;
+	typedef TypeList<SamplesAverager, SamplesAverager, SamplesAverager, SamplesAverager, SamplesAverager, SamplesAverager> averagers;
+
+	static constexpr unsigned long long subchannels[NUM_OF_TOTAL_SENSORS] = {
+			SUBCHANNEL(0),
+			SUBCHANNEL(0),
+			SUBCHANNELS_RANGE(PSM5003_NUM_CHANNELS),
+			SUBCHANNELS_RANGE(OPCN3_CHAN_NUMBER),
+			SUBCHANNELS_RANGE(SPS30_NUM_CHANNELS),
+			SUBCHANNELS_RANGE(NEXTPM_NUM_CHANNELS)
+	};
+};
+constexpr unsigned long long ExpShieldOneBoard::subchannels[NUM_OF_TOTAL_SENSORS];
+
+// Channel map is generated from the board description, at compile time
+constexpr const channeltosamplersubchannel* const SensorsArray::chToSamplerSubChannel =
+		ChannelMap<ExpShieldOneBoard, NUM_OF_TOTAL_CHANNELS>::map;
+
+// Check if the channel is mapped to the given sensor subchannel
+constexpr bool SensorsArray::mapsTo(unsigned char channel, unsigned char sensor, unsigned char subchannel) {
+	return (channel < NUM_OF_TOTAL_CHANNELS) &&
+			(chToSamplerSubChannel[channel].sampler == sensor) &&
+			(chToSamplerSubChannel[channel].subchannel == subchannel);
+}
+
+// Hot loops operations. Each object is reached with a qualified, non virtual,
+// call bound at compile time to its concrete type (see StaticBoard.h)
+struct DeviceTick {
+	SensorDevice* const* sensors;
+
+	template <class T, unsigned char N> void visit() {
+		static_cast<T*>(sensors[N])->T::tick();
+	}
+};
+
+struct DeviceLoop {
+	SensorDevice* const* sensors;
+
+	template <class T, unsigned char N> void visit() {
+		T* device = static_cast<T*>(sensors[N]);
+		if (device->getBringUpStatus() == SensorDevice::BRINGUP_PENDING) {
+			device->T::bringUp();
+		}
+		device->T::loop();
+	}
 };
 
-SensorsArray::SensorsArray() : samplingEnabled(false), timestamp(0), globalPrescaler(0) {
+struct SamplerTick {
+	Sampler* const* samplers;
+	bool result;
+
+	template <class T, unsigned char N> void visit() {
+		result |= static_cast<T*>(samplers[N])->T::sampleTick();
+	}
+};
 
-	// Turn on power supply for external sensors
+struct SamplerLoop {
+	Sampler* const* samplers;
+	SamplesAverager* const* averagers;
+	unsigned long timestamp;
+	bool result;
+
+	template <class T, unsigned char N> void visit() {
+		typedef typename TypeAt<ExpShieldOneBoard::averagers, N>::type A;
+		T* sampler = static_cast<T*>(samplers[N]);
+		if (sampler->T::sampleLoop()) {
+			// A new set of samples are ready to be averaged (in the sensor native format)
+			A* averager = static_cast<A*>(averagers[N]);
+			if (sampler->hasFloatSamples()) {
+				for (unsigned char subChannel = 0; subChannel < sampler->T::getNumChannels(); subChannel++) {
+					result |= averager->A::collectSample(subChannel, sampler->T::getLastFloatSample(subChannel), timestamp);
+				}
+			} else {
+				for (unsigned char subChannel = 0; subChannel < sampler->T::getNumChannels(); subChannel++) {
+					result |= averager->A::collectSample(subChannel, sampler->T::getLastSample(subChannel), timestamp);
+				}
+			}
+		}
+	}
+};
+
+// Objects are placement constructed into static storage, with the types in the board description
+#define DEVICE(n, ...)		constructStatic<ExpShieldOneBoard::devices, n>(__VA_ARGS__)
+#define SAMPLER(n, ...)		constructStatic<ExpShieldOneBoard::samplers, n>(__VA_ARGS__)
+#define AVERAGER(n, ...)	constructStatic<ExpShieldOneBoard::averagers, n>(__VA_ARGS__)
+
+SensorsArray::SensorsArray() : samplingEnabled(false), timestamp(0), globalPrescaler(0), powerUpTimer(POWERUP_SETTLE_TIME),
+								reprobeTimer(0), reprobeNext(0), readyMap(0), discoveredMap(0) {
+
+	// The board description, the logical channels definitions and the generated channel map should be kept aligned
+	static_assert((TypeListSize<ExpShieldOneBoard::devices>::value == NUM_OF_TOTAL_SENSORS) &&
+				  (TypeListSize<ExpShieldOneBoard::samplers>::value == NUM_OF_TOTAL_SAMPLERS) &&
+				  (TypeListSize<ExpShieldOneBoard::averagers>::value == NUM_OF_TOTAL_AVERAGERS), "Malformed board description");
+	static_assert(countChannels(ExpShieldOneBoard::subchannels, NUM_OF_TOTAL_SENSORS) == NUM_OF_TOTAL_CHANNELS, "Channels number mismatch");
+	static_assert(mapsTo(CHANNEL_RD200M, SENSOR_RD200M, 0), "RD200M channel mismatch");
+	static_assert(mapsTo(CHANNEL_D300, SENSOR_D300, 0), "D300 channel mismatch");
+	static_assert(mapsTo(CHANNEL_PMS5300_PM1CONC_ST, SENSOR_PMS5300, PMS5300_PM1CONC_ST) &&
+				  mapsTo(CHANNEL_PMS5300_PART100, SENSOR_PMS5300, PMS5300_PART100) &&
+				  ((CHANNEL_PMS5300_PART100 - CHANNEL_PMS5300_PM1CONC_ST) == (PSM5003_NUM_CHANNELS - 1)), "PMS5003 channels mismatch");
+	static_assert(mapsTo(CHANNEL_OPCN3_FIRST, SENSOR_OPCN3, OPCN3_BIN0) &&
+				  mapsTo(CHANNEL_OPCN3_VOLUME, SENSOR_OPCN3, OPCN3_VOL) &&
+				  mapsTo(CHANNEL_OPCN3_LAST, SENSOR_OPCN3, OPCN3_LSRST), "OPCN3 channels mismatch");
+	static_assert(mapsTo(CHANNEL_SPS30_FIRST, SENSOR_SPS30, SPS30_PM1CONC) &&
+				  mapsTo(CHANNEL_SPS30_LAST, SENSOR_SPS30, SPS30_TYPSIZE), "SPS30 channels mismatch");
+	static_assert(mapsTo(CHANNEL_NEXTPM_FIRST, SENSOR_NEXTPM, NEXTPM_PM1PCS) &&
+				  mapsTo(CHANNEL_NEXTPM_LAST, SENSOR_NEXTPM, NEXTPM_STATUS), "NextPM channels mismatch");
+
+	memset(reconnectCount, 0, sizeof(reconnectCount));
+	memset(dropoutCount, 0, sizeof(dropoutCount));
+
+	// Turn on power supply for external sensors. Devices bring-up will start
+	// in the main loop when the power supply is stable.
 	powerUp5V(true);
 	powerUp12V(true);
 	powerUp3V3(true);
 
-    // Initialize the samplers and averagers array (yes, I know, this could be skipped but it's done for safety reasons)
-    memset(samplers, 0, sizeof(samplers));
-    memset(averagers, 0, sizeof(averagers));
-    
     // Initialize the sensor drivers
-    sensors[SENSOR_RD200M] = new RD200MDevice();
-    sensors[SENSOR_D300] = new D300Device();
-    sensors[SENSOR_PMS5300] = new PMS5003Device();
-    sensors[SENSOR_OPCN3] = new OPCN3Device();
-    sensors[SENSOR_SPS30] = new SPS30Device();
-    sensors[SENSOR_NEXTPM] = new NextPMDevice();
+    sensors[SENSOR_RD200M] = DEVICE(SENSOR_RD200M);
+    sensors[SENSOR_D300] = DEVICE(SENSOR_D300);
+    sensors[SENSOR_PMS5300] = DEVICE(SENSOR_PMS5300);
+    sensors[SENSOR_OPCN3] = DEVICE(SENSOR_OPCN3);
+    sensors[SENSOR_SPS30] = DEVICE(SENSOR_SPS30);
+    sensors[SENSOR_NEXTPM] = DEVICE(SENSOR_NEXTPM);
 
     // Initialize the sampler units
-    samplers[SENSOR_RD200M] = new FixedRateSampler(1, sensors[SENSOR_RD200M], RD200MDevice::defaultSampleRate(), RD200MDevice::defaultDecimationValue());
-    samplers[SENSOR_D300] = new FixedRateSampler(1, sensors[SENSOR_D300], D300Device::defaultSampleRate());
-    samplers[SENSOR_PMS5300] = new FixedRateSampler(PSM5003_NUM_CHANNELS, sensors[SENSOR_PMS5300], FixedRateSampler::DeviceDrivenSampleRate());
-    samplers[SENSOR_OPCN3] = new Sampler(OPCN3_CHAN_NUMBER, sensors[SENSOR_OPCN3]);
-    samplers[SENSOR_SPS30] = new FixedRateSampler(SPS30_NUM_CHANNELS, sensors[SENSOR_SPS30], SPS30Device::defaultSampleRate());
-    samplers[SENSOR_NEXTPM] = new FixedRateSampler(NEXTPM_NUM_CHANNELS, sensors[SENSOR_NEXTPM], NextPMDevice::defaultSampleRate());
+    samplers[SENSOR_RD200M] = SAMPLER(SENSOR_RD200M, 1, sensors[SENSOR_RD200M], RD200MDevice::defaultSampleRate(), RD200MDevice::defaultDecimationValue());
+    samplers[SENSOR_D300] = SAMPLER(SENSOR_D300, 1, sensors[SENSOR_D300], D300Device::defaultSampleRate());
+    samplers[SENSOR_PMS5300] = SAMPLER(SENSOR_PMS5300, PSM5003_NUM_CHANNELS, sensors[SENSOR_PMS5300], FixedRateSampler::DeviceDrivenSampleRate());
+    samplers[SENSOR_OPCN3] = SAMPLER(SENSOR_OPCN3, OPCN3_CHAN_NUMBER, sensors[SENSOR_OPCN3]);
+    samplers[SENSOR_SPS30] = SAMPLER(SENSOR_SPS30, SPS30_NUM_CHANNELS, sensors[SENSOR_SPS30], SPS30Device::defaultSampleRate());
+    samplers[SENSOR_NEXTPM] = SAMPLER(SENSOR_NEXTPM, NEXTPM_NUM_CHANNELS, sensors[SENSOR_NEXTPM], NextPMDevice::defaultSampleRate());
 
     // Create the averagers
-    averagers[SENSOR_RD200M] = new SamplesAverager(1);
-    averagers[SENSOR_D300] = new SamplesAverager(1);
-    averagers[SENSOR_PMS5300] = new SamplesAverager(PSM5003_NUM_CHANNELS);
-    averagers[SENSOR_OPCN3] = new SamplesAveragerOPCN3();
-    averagers[SENSOR_SPS30] = new SamplesAverager(SPS30_NUM_CHANNELS);
-    averagers[SENSOR_NEXTPM] = new SamplesAveragerNextPM();
+    averagers[SENSOR_RD200M] = AVERAGER(SENSOR_RD200M, 1);
+    averagers[SENSOR_D300] = AVERAGER(SENSOR_D300, 1);
+    averagers[SENSOR_PMS5300] = AVERAGER(SENSOR_PMS5300, PSM5003_NUM_CHANNELS);
+    averagers[SENSOR_OPCN3] = AVERAGER(SENSOR_OPCN3, OPCN3_CHAN_NUMBER, sensors[SENSOR_OPCN3]->getSampleFormat());
+    averagers[SENSOR_SPS30] = AVERAGER(SENSOR_SPS30, SPS30_NUM_CHANNELS, sensors[SENSOR_SPS30]->getSampleFormat());
+    averagers[SENSOR_NEXTPM] = AVERAGER(SENSOR_NEXTPM, NEXTPM_NUM_CHANNELS);
+
+    // Averager modes depend on what each channel measures, so they are fixed
+    // here and not configurable through the 'h'/'i' commands.
+    // OPCN3 volume is cumulated between each sample in the averager's deep.
+    // Sample time, flow rate and laser status are debug values reported as last read.
+    averagers[SENSOR_OPCN3]->setChannelMode(OPCN3_VOL, AVERAGER_MODE_SUM);
+    averagers[SENSOR_OPCN3]->setChannelMode(OPCN3_TSA, AVERAGER_MODE_LATEST);
+    averagers[SENSOR_OPCN3]->setChannelMode(OPCN3_FRT, AVERAGER_MODE_LATEST);
+    averagers[SENSOR_OPCN3]->setChannelMode(OPCN3_LSRST, AVERAGER_MODE_LATEST);
+
+    // NextPM status is reported as last read
+    averagers[SENSOR_NEXTPM]->setChannelMode(NEXTPM_STATUS, AVERAGER_MODE_LATEST);
     
     // Set the dithering tool. See the above comment.
     averagers[CHANNEL_RD200M]->setDitherTool(&ditherTool);
@@ -113,20 +211,12 @@ SensorsArray::SensorsArray() : samplingEnabled(false), timestamp(0), globalPresc
 }
 
 
+// Objects live in static storage and are only destroyed
 SensorsArray::~SensorsArray() {
-    for (unsigned char n = 0; n < NUM_OF_TOTAL_SAMPLERS; n++) {
-        if (samplers[n]) {
-            delete samplers[n];
-        }
-    }
-
     for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
-		if (sensors[n]) {
-			delete sensors[n];
-		}
-		if (averagers[n]) {
-			delete averagers[n];
-		}
+    	samplers[n]->~Sampler();
+    	averagers[n]->~SamplesAverager();
+    	sensors[n]->~SensorDevice();
     }
 }
 
@@ -135,11 +225,18 @@ bool SensorsArray::timerTick() {
     
     bool result = false;
 
-    // Propagate to all devices requiring fast rate (one sampletick = 0.01s)
-    for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
-    		if (sensors[n] != 0) {
-    			sensors[n]->tick();
-    		}
+    // Wait for power supply stabilization before running the devices
+    if (powerUpTimer != 0) {
+    		powerUpTimer--;
+    } else {
+
+		// Propagate to all devices requiring fast rate (one sampletick = 0.01s)
+		DeviceTick deviceTick = { sensors };
+		StaticForEach<ExpShieldOneBoard::devices>::apply(deviceTick);
+
+		if (reprobeTimer < REPROBE_PERIOD) {
+			reprobeTimer++;
+		}
     }
 
     // This shield does not requires fast sampling rates. A global prescaler
@@ -149,11 +246,9 @@ bool SensorsArray::timerTick() {
     		globalPrescaler = 0;
 
 		// Loop on each sensor samplers
-		for (unsigned char n = 0; n < NUM_OF_TOTAL_SAMPLERS; n++) {
-			if (samplers[n] != 0) {
-				result |= samplers[n]->sampleTick();
-			}
-		}
+		SamplerTick samplerTick = { samplers, false };
+		StaticForEach<ExpShieldOneBoard::samplers>::apply(samplerTick);
+		result = samplerTick.result;
     }
     
 
@@ -165,10 +260,18 @@ bool SensorsArray::timerTick() {
 
 bool SensorsArray::loop() {
 
-	// Call all devices loop
-	for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
-		if (sensors[n]) {
-			sensors[n]->loop();
+	// Call all devices bring-up and loop. Devices are started concurrently
+	// as soon as the power supply is stable.
+	if (powerUpTimer == 0) {
+		DeviceLoop deviceLoop = { sensors };
+		StaticForEach<ExpShieldOneBoard::devices>::apply(deviceLoop);
+
+		// Track devices connections and disconnections, then
+		// periodically try to recover missing devices
+		checkReadiness();
+		if (reprobeTimer >= REPROBE_PERIOD) {
+			reprobeTimer = 0;
+			reprobeAbsentDevice();
 		}
 	}
 
@@ -177,23 +280,14 @@ bool SensorsArray::loop() {
         return false;
     }
     
-    long currentTimestamp = timestamp;
-    bool result = false;
-    for (unsigned char n = 0; n < NUM_OF_TOTAL_SAMPLERS; n++) {
-    		if (samplers[n] && samplers[n]->sampleLoop()) {
-    			for (unsigned char subChannel = 0; subChannel < samplers[n]->getNumChannels(); subChannel++) {
-    				// A new set of samples are ready to be averaged
-    				result |= averagers[n]->collectSample(subChannel, samplers[n]->getLastSample(subChannel), currentTimestamp);
-    			}
-    		}
-    }
+    SamplerLoop samplerLoop = { samplers, averagers, timestamp, false };
+    StaticForEach<ExpShieldOneBoard::samplers>::apply(samplerLoop);
 
-    return result;
+    return samplerLoop.result;
 }
 
 void SensorsArray::powerUp5V(bool enable) {
 	AS_GPIO.digitalWrite(EN_5V, true);
-	HAL_Delay(500);
 }
 
 void SensorsArray::powerUp3V3(bool enable) {
@@ -202,7 +296,6 @@ void SensorsArray::powerUp3V3(bool enable) {
 
 void SensorsArray::powerUp12V(bool enable) {
 	AS_GPIO.digitalWrite(EN_12V, true);
-	HAL_Delay(500);
 }
 
 unsigned char SensorsArray::setSamplePrescaler(unsigned char channel, unsigned char prescaler) {
@@ -264,6 +357,82 @@ bool SensorsArray::getSampleDecimation(unsigned char channel, unsigned char* dec
     return true;
 }
 
+// Each bit represents a physical sensor (SENSOR_xxx): readyMap flags devices found and running,
+// pendingMap flags devices still under discovery
+bool SensorsArray::getSensorStatus(unsigned char sensor, unsigned short* readyMap, unsigned short* pendingMap,
+										unsigned short* reconnects, unsigned short* dropouts) {
+
+	if (sensor >= NUM_OF_TOTAL_SENSORS) {
+		return false;
+	}
+
+	*readyMap = this->readyMap;
+	*pendingMap = 0;
+	for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
+		if (sensors[n] && ((powerUpTimer != 0) || (sensors[n]->getBringUpStatus() == SensorDevice::BRINGUP_PENDING))) {
+			*pendingMap |= (1 << n);
+		}
+	}
+	*reconnects = reconnectCount[sensor];
+	*dropouts = dropoutCount[sensor];
+
+	return true;
+}
+
+// Update the ready devices map and count the devices
+// lost and found again after their first discovery.
+// Devices found again get their presets reloaded and, if sampling, restarted
+void SensorsArray::checkReadiness() {
+
+	for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
+		if (!sensors[n]) {
+			continue;
+		}
+
+		unsigned short mask = (1 << n);
+		bool ready = sensors[n]->isReady();
+		if (ready == ((readyMap & mask) != 0)) {
+			continue;
+		}
+
+		if (!ready) {
+			readyMap &= ~mask;
+			dropoutCount[n]++;
+			continue;
+		}
+
+		readyMap |= mask;
+		if (discoveredMap & mask) {
+			reconnectCount[n]++;
+			for (unsigned char channel = 0; channel < NUM_OF_TOTAL_CHANNELS; channel++) {
+				if ((chToSamplerSubChannel[channel].sampler == n) && chToSamplerSubChannel[channel].firstChannelForSampler) {
+					loadPreset(channel);
+				}
+			}
+		}
+		discoveredMap |= mask;
+
+		if (samplingEnabled) {
+			samplers[n]->onStartSampling();
+		}
+	}
+}
+
+// Restart the discovery of the next absent device, one for each call,
+// so that the buses are never starved by the discovery procedures
+void SensorsArray::reprobeAbsentDevice() {
+
+	for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
+		unsigned char sensor = reprobeNext;
+		reprobeNext = (reprobeNext + 1) % NUM_OF_TOTAL_SENSORS;
+
+		if (sensors[sensor] && (sensors[sensor]->getBringUpStatus() == SensorDevice::BRINGUP_ABSENT)) {
+			sensors[sensor]->restartBringUp();
+			return;
+		}
+	}
+}
+
 bool SensorsArray::enableSampling(bool enable) {
 
 	// Initialize samplers when start sampling
@@ -366,7 +535,7 @@ bool SensorsArray::getLastSample(unsigned char channel, float &lastSample, unsig
 			timestamp = averagers[chToSamplerSubChannel[channel].sampler]->lastTimeStamp();
 
 			// Retrieve the averaged value...
-			lastSample = averagers[chToSamplerSubChannel[channel].sampler]->lastAveragedValue(chToSamplerSubChannel[channel].subchannel);
+			lastSample = averagers[chToSamplerSubChannel[channel].sampler]->lastAveragedFloatValue(chToSamplerSubChannel[channel].subchannel);
 
 			// Evaluate it. Evaluation is done by sensor devices
 			lastSample = sensors[chToSamplerSubChannel[channel].sampler]->evaluateMeasurement(chToSamplerSubChannel[channel].subchannel, lastSample);
@@ -501,6 +670,26 @@ bool SensorsArray::getChannelIsEnabled(unsigned char channel, unsigned char *ena
 	return samplers[chToSamplerSubChannel[channel].sampler]->getChannelIsEnabled(chToSamplerSubChannel[channel].subchannel, enabled);
 }
 
+bool SensorsArray::setChannelFilter(unsigned char channel, unsigned char medianLength, unsigned char iirDenom) {
+
+	if (channel >= NUM_OF_TOTAL_CHANNELS) {
+		return false;
+	}
+
+	// Filters are handled by the sampler
+	return samplers[chToSamplerSubChannel[channel].sampler]->setChannelFilter(chToSamplerSubChannel[channel].subchannel, medianLength, iirDenom);
+}
+
+bool SensorsArray::getChannelFilter(unsigned char channel, unsigned char *medianLength, unsigned char *iirDenom) {
+
+	if (channel >= NUM_OF_TOTAL_CHANNELS) {
+		return false;
+	}
+
+	// Filters are handled by the sampler
+	return samplers[chToSamplerSubChannel[channel].sampler]->getChannelFilter(chToSamplerSubChannel[channel].subchannel, medianLength, iirDenom);
+}
+
 
 unsigned short SensorsArray::getBoardType() {
 	return BOARD_TYPE_EXP1_SENSORSHIELD;
@@ -354,6 +354,8 @@ static void MX_SPI1_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN SPI1_Init 2 */
+  HAL_NVIC_SetPriority(SPI1_IRQn, 0, 0);
+  HAL_NVIC_EnableIRQ(SPI1_IRQn);
 
   /* USER CODE END SPI1_Init 2 */
 
@@ -734,6 +736,22 @@ void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
 	}
 }
 
+void SPI1_IRQHandler(void) {
+	HAL_SPI_IRQHandler(&hspi1);
+}
+
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi) {
+	if (hspi->Instance == SPI1) {
+		spi1Interrupt();
+	}
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+	if (hspi->Instance == SPI1) {
+		spi1Error();
+	}
+}
+
 
 /* USER CODE END 4 */
 
@@ -38,9 +38,11 @@
 #define ADT7470_NUM_FAN_CHANNELS			0x03
 
 #define ADT7470_NUM_CHANNELS				(ADT7470_CHANNEL_F_AIR_CIR + 1)
+#define ADT7470_NUM_SHADOW_REGISTERS		(ADT7470_NUM_FAN_CHANNELS + 2)	/* Fan PWMs and configurations */
 #define ADT7470_SAMPLING_PERIOD				9	/* Reporting sample rate: 10 seconds */
 #define ADT7470_COMMUNICATION_PERIOD		99	/* ADT7470 refresh time: 1 second */
 #define ADT7470_COMMUNICATION_PERIOD_ON_ERR	249 /* ADT7470 refresh time on error: 2.5 seconds */
+#define ADT7470_SHADOW_REFRESH_PERIODS		60	/* Registers are written again each minute */
 
 class ADT7470Device : public SensorDevice {
 
@@ -90,6 +92,8 @@ private:
 
 	void setRegisterFlag(unsigned char address, unsigned char hexFlag);
 	void resetRegisterFlag(unsigned char address, unsigned char hexFlag);
+	void writeRegister(unsigned char address, unsigned char value);
+	signed char getShadowIndex(unsigned char address) const;
 
 private:
 	static const char* const channelNames[];
@@ -107,6 +111,11 @@ private:
 
 	// Temperature and fan setpoints in 1/100% units
 	unsigned short setpoints[ADT7470_NUM_CHANNELS];
+
+	// Local copies of the written registers. Unchanged values are not written again
+	unsigned char shadowRegisters[ADT7470_NUM_SHADOW_REGISTERS];
+	unsigned char shadowValidMap;
+	unsigned char shadowRefreshCounter;
 };
 
 #define AS_ADT7470 (*(ADT7470Device::getInstance()))
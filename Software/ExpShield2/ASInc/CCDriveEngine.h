@@ -25,17 +25,22 @@
 #ifndef CCDRIVEENGINE_H_
 #define CCDRIVEENGINE_H_
 
-#include "PIDEngine.h"
+#include <stdint.h>
 
-class CCDriveEngine : public PIDEngine {
+// The constant current loop runs in the A/D DMA interrupt, so PI(D)
+// calculations are done in fixed point (16 fractional bits)
+#define CC_FIXEDPOINT_SHIFT		16
+#define CC_TO_FIXEDPOINT(a)		((int32_t)((a) * (1L << CC_FIXEDPOINT_SHIFT) + 0.5))
+
+class CCDriveEngine {
 public:
 	virtual ~CCDriveEngine();
 
 	// Current drive setpoint and actual values are expressed in 1/100 %
 	void setCurrentSetPoint(unsigned short _cSetpoint);
 
+	// Update the PWM drive with a new current measure (from the A/D DMA interrupt)
 	void tick(unsigned short _currentMeasure);
-	void loop();
 
 	void setEnabled(bool on);
 	unsigned short getCurrentDrive();
@@ -46,10 +51,22 @@ private:
 	CCDriveEngine();
 
 private:
-	bool enabled;
-	bool go;
+	typedef struct _coefficients {
+		int32_t p;
+		int32_t i;
+		int32_t d;
+	} coefficients;
+
+private:
+	const coefficients C;
+	const int32_t integralMinVal;
+	const int32_t integralMaxVal;
+
+	volatile bool enabled;
+	volatile unsigned short setpoint;
 	unsigned short currentMeasure;
-	unsigned short currentDrive;
+	int32_t integralVal;
+	volatile unsigned short currentDrive;
 
 private:
 	static CCDriveEngine instance;
@@ -60,6 +60,14 @@
 #define COMMPROTOCOL_READ_CHANENABLE	'e'
 #define COMMPROTOCOL_WRITE_REGISTER		'f'
 #define COMMPROTOCOL_READ_REGISTER		'g'
+#define COMMPROTOCOL_READ_SENSORSTATUS	'j'
+#define COMMPROTOCOL_READ_PROFILE		'k'
+#define COMMPROTOCOL_RESET_PROFILE		'l'
+#define COMMPROTOCOL_READ_MEMSTATS		'm'
+#define COMMPROTOCOL_START_TELEMETRY		'o'
+#define COMMPROTOCOL_READ_TELEMETRY		'p'
+#define COMMPROTOCOL_SET_SAMPLETIMEBASE	'q'
+#define COMMPROTOCOL_GET_SAMPLETIMEBASE	'r'
 
 #define MAX_SERIAL_BUFLENGTH			 64							// Stack temporary buffer size
 #define MAX_INQUIRY_BUFLENGTH            MAX_SERIAL_BUFLENGTH		// Maximum preset/channel name
@@ -130,6 +138,14 @@ private:
     static bool readChannelEnable(CommProtocol* context, unsigned char cmdOffset);
     static bool writeRegister(CommProtocol* context, unsigned char cmdOffset);
     static bool readRegister(CommProtocol* context, unsigned char cmdOffset);
+    static bool setSampleTimebase(CommProtocol* context, unsigned char cmdOffset);
+    static bool getSampleTimebase(CommProtocol* context, unsigned char cmdOffset);
+    static bool readSensorStatus(CommProtocol* context, unsigned char cmdOffset);
+    static bool readProfile(CommProtocol* context, unsigned char cmdOffset);
+    static bool resetProfile(CommProtocol* context, unsigned char cmdOffset);
+    static bool readMemoryStats(CommProtocol* context, unsigned char cmdOffset);
+    static bool startTelemetry(CommProtocol* context, unsigned char cmdOffset);
+    static bool readTelemetry(CommProtocol* context, unsigned char cmdOffset);
     
 private:
     
@@ -38,6 +38,8 @@ public:
 	virtual bool init();
 	virtual void loop();
 	virtual void tick();
+	virtual bool isAvailable() const;
+	virtual void bringUp();
 
 	virtual const char* getSerial() const;
 
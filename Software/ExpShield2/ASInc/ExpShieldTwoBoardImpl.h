@@ -38,7 +38,7 @@
  	void uart3Error();
  	void uart4Error();
  	void usbRxCallback(unsigned char* buffer, long bufferLen);
- 	void adcCallback();
+ 	void adcCallback(unsigned char halfBuffer);
 	void timerInterrupt();
 	void setup_impl();
 	void loop_impl();
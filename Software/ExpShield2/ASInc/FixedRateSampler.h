@@ -35,6 +35,7 @@ public:
 
     virtual void setPreScaler(unsigned char value);
     virtual void setDecimation(unsigned char value);
+    virtual void setTimebase(unsigned short ticks);
 
     static const unsigned char DeviceDrivenSampleRate();
 
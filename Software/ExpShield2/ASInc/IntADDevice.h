@@ -34,7 +34,13 @@
 #define INTAD_CHANNEL_VREFINT		0x04
 
 #define INTAD_NUM_OF_CHANNELS		(INTAD_CHANNEL_VREFINT + 1)
-#define ADC_DMA_BUFFER_SIZE			INTAD_NUM_OF_CHANNELS
+
+// The A/D scan is triggered by TMR3 each millisecond. Each DMA buffer half
+// holds INTAD_OVERSAMPLING scans, averaged when the half is filled
+#define INTAD_SCAN_TIMER_RELOAD		47		/* TMR3 reload, 48MHz/1000/48 = 1kHz, set at startup */
+#define INTAD_OVERSAMPLING			4		/* 250Hz constant current loop rate */
+#define ADC_DMA_HALFBUFFER_SIZE		(INTAD_NUM_OF_CHANNELS * INTAD_OVERSAMPLING)
+#define ADC_DMA_BUFFER_SIZE			(2 * ADC_DMA_HALFBUFFER_SIZE)
 
 #define INTAD_SAMPLING_PERIOD		9		/* Reporting sample rate: 10 seconds */
 #define AUTOCALIBRATION_PERIOD		60000	/* 60000 tics -> 10 minutes */
@@ -60,7 +66,7 @@ public:
 
 	static const unsigned char defaultSampleRate();
 
-	unsigned short onADCScanTerminated();
+	unsigned short onADCScanTerminated(bool halfBuffer);
 
 	static IntADDevice* const getInstance();
 
@@ -74,6 +80,7 @@ private:
 	static IntADDevice* const instance;
 
 	unsigned short adcDmaBuffer[ADC_DMA_BUFFER_SIZE];
+	volatile unsigned short adcData[INTAD_NUM_OF_CHANNELS];		// Latest oversampled values
 
 	volatile unsigned short calibrationTimer;
 	volatile bool samplesAvailable;
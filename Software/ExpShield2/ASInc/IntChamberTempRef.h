@@ -34,7 +34,8 @@ public:
 		SOURCE_K96_TEMP_NTC0 = 0x02,
 		SOURCE_K96_TEMP_NTC1 = 0x03,
 		SOURCE_K96_T_RH0 = 0x04,
-		SOURCE_FIRST_INVALID = 0x05,
+		SOURCE_FUSED = 0x05,			// Estimated from all the sources above
+		SOURCE_FIRST_INVALID = 0x06,
 	} source ;
 
 public:
@@ -53,6 +54,7 @@ public:
 
 private:
 	bool checkTemperatureRange(short temperature);
+	bool updateEstimate();
 
 private:
 	typedef struct _temperatures {
@@ -60,11 +62,20 @@ private:
 		short timeout;
 	} temperatures;
 
+	typedef struct _estimator {
+		bool valid;
+		long value;						// In 1/100 C, fixed point
+		long rate;						// Unmodeled heat exchange, in 1/100 C per second, fixed point
+		long variance;					// In (1/100 C)^2
+	} estimator;
+
 private:
 	source curSource;
 	short setpoint;
 	unsigned short prescaler;
-	temperatures curTemperatures[(unsigned short)SOURCE_FIRST_INVALID];
+	temperatures curTemperatures[(unsigned short)SOURCE_FUSED];
+	volatile bool go;
+	estimator estimate;
 
 private:
 	static IntChamberTempRef instance;
@@ -27,6 +27,7 @@
 #define K96DEVICE_H_
 
 #include "SensorDevice.h"
+#include "ModBusMaster.h"
 
 #define K96_CHANNEL_LPL_PC_FLT		0x00
 #define K96_CHANNEL_SPL_PC_FLT		0x01
@@ -47,7 +48,6 @@
 
 #define K96_NUM_OF_CHANNELS	(K96_CHANNEL_MPL_UFLT_ERR+1)
 
-#define K96_RX_BUFFERLENGTH			64
 #define K96_SERIALID_BUFFERLENGTH	12
 
 class K96Device : public SensorDevice {
@@ -61,6 +61,9 @@ public:
 	virtual bool init();
 	virtual void loop();
 	virtual void tick();
+	virtual bool isAvailable() const;
+	virtual void bringUp();
+	virtual void restartBringUp();
 
 	virtual const char* getSerial() const;
 
@@ -71,34 +74,32 @@ public:
 
 	virtual bool writeGenericRegister(unsigned int address, unsigned int value, unsigned char* buffer, unsigned char buffSize);
 	virtual bool readGenericRegister(unsigned int address, unsigned char* buffer, unsigned char buffSize);
+	virtual void setChannelEnabled(unsigned char channel, bool enabled);
 
 	virtual void triggerSample();
 
 private:
 	void powerOn(bool on);
 	bool triggerCheckPresence();
-	void triggerReadInputRegister(unsigned short address, unsigned char numRegisters);
-	void triggerReadRAM(unsigned short address, unsigned char byteSize);
-	void triggerWriteRAM(unsigned short address, unsigned char value);
+	bool triggerReadInputRegister(unsigned short address, unsigned char numRegisters);
+	bool triggerReadRAM(unsigned short address, unsigned char byteSize, unsigned char retries,
+							ModBusMaster::completionhandler handler, void* context);
+	bool triggerWriteRAM(unsigned short address, unsigned char value,
+							ModBusMaster::completionhandler handler, void* context);
 
 private:
-	bool onDataReceived(unsigned char rxChar);
 	void renderUnitID(unsigned int unitID);
-	bool countCRC(unsigned char *buffer, unsigned short payloadSize, bool checkCRC);
-	unsigned short modBusCRC(const unsigned char *buffer, unsigned char bufLength);
+	void onModBusAnswer(ModBusMaster::result res, const unsigned char* payload, unsigned char payloadLen);
+	void onCommunicationFailure();
+	void abortTransactions();
+	bool waitDebugAnswer();
+	bool startAcquisitionCycle();
+	bool isUnfilteredBlockEnabled(unsigned char block) const;
 
-private:
-	typedef enum _commstates {
-		IDLE,
-		WAITING_DEVICE_ADDRESS,
-		WAITING_FUNCTION_CODE,
-		WAITING_EXEPTION_CODE,
-		WAITING_DATALENGTH,
-		WAITING_DATA,
-		WAITING_CRC0,
-		WAITING_CRC1,
-	} commstates;
+	static void modBusHandler(void* context, ModBusMaster::result res, const unsigned char* payload, unsigned char payloadLen);
+	static void modBusDebugHandler(void* context, ModBusMaster::result res, const unsigned char* payload, unsigned char payloadLen);
 
+private:
 	typedef enum _k96states {
 		UNAVAILABLE,
 		IDLE_READY,
@@ -106,82 +107,45 @@ private:
 		READ_UNIT_ID,
 		WAITING_UNIT_ID,
 
-		START_READ_ERROR,
-		WAITING_ERROR_REG,
-
-		READ_LPL_UFLT_IR,		// LPL, SPL and MPL reads needs to be sequentially defined
-		READ_SPL_UFLT_IR,
-		READ_MPL_UFLT_IR,
-
-		WAITING_LPL_UFLT_IR,	// LPL, SPL and MPL waiting needs to be sequentially defined
-		WAITING_SPL_UFLT_IR,
-		WAITING_MPL_UFLT_IR,
-
 		START_SAMPLING,
 		WAITING_SAMPLE
 
 	} k96states;
 
-	typedef struct _ramresponse {
-		unsigned char devAddress;
-		unsigned char functionCode;
-		unsigned char dataLen;
-		union __attribute__((__packed__)) {
-			unsigned char raw[K96_RX_BUFFERLENGTH-3];
-			struct __attribute__((__packed__)) {
-				short lpl_ConcPC_flt;				// IR1
-				short spl_ConcPC_flt;				// IR2
-				short mpl_ConcPC_flt;				// IR3
-				short p_Sensor0_flt;				// IR4
-				short ntc0_Temp_flt;				// IR5
-				short ntc1_Temp_flt;				// IR6
-				short reserved;						// IR7
-				short aduCDie_Temp_flt;				// IR8
-				short rh_Sensor0;					// IR9
-				short rh_T_Sensor0;					// IR10
-			} measures;
-			struct __attribute__((__packed__)) {
-				unsigned short iR_Signal;			// U16	(0x0384)
-				short dT;							// S16	(0x0386)
-				short unspecified;					// S16  (0x0388)
-				short conc;							// S16	(0x038A)
-				short concPC;						// S16	(0x038C)
-				unsigned short error;				// B16	(0x038E)
-			} xPL_uflt_ram_con_cal;
-			struct __attribute__ ((__packed__)) {
-				unsigned short errorStatus;			// IR15
-			} reg15;
-			struct __attribute__ ((__packed__)) {
-				unsigned short regValue;			// U16
-			} u16;
-		} payload;
-	} ramresponse;
+	typedef enum _k96cyclesteps {
+		STEP_MEASUREMENTS,		// Measurements and error status input registers
+		STEP_LPL_UFLT,			// LPL, SPL and MPL unfiltered blocks needs to be sequentially defined
+		STEP_SPL_UFLT,
+		STEP_MPL_UFLT,
+		NUM_OF_CYCLE_STEPS
+	} k96cyclesteps;
+
+	typedef struct _debuganswer {
+		volatile bool completed;
+		ModBusMaster::result res;
+		unsigned char value;
+	} debuganswer;
 
 private:
 
-	commstates rxStatus;							// ModBus low level FSM status
-	volatile unsigned char rxTimeoutTimer;			// ModBus low level timeout
-	volatile unsigned char cmdTimeoutTimer;			// ModBus command timeout
+	ModBusMaster modBus;							// ModBus low level transactions engine
 	volatile unsigned char powerUpTimer;			// Avoid communications after power up
 
-	unsigned char expFunctionCode;					// Expected function code in answers
-	unsigned char expByteLength;					// Expected payload length in answers
-	unsigned char currRxOffset;						// Current pointer in the rx buffer
-	unsigned char curRxPayloadBytes;				// Current byte number received
-	unsigned char lastExceptionCode;				// Exception code received from last cmd.
-
-	ramresponse rxBuffer;							// Rx buffer
-
-	unsigned char retry;							// Num of ModBus packet retry
 	unsigned short lastErrorStatus;
+	unsigned short enabledChannels;					// Enabled channels bitmask
+	unsigned short cycleSamples[K96_NUM_OF_CHANNELS];	// Samples collected in the current acquisition cycle
+	k96cyclesteps cycleSteps[NUM_OF_CYCLE_STEPS];	// Transactions queued in the current acquisition cycle
+	unsigned char cycleNumSteps;
+	unsigned char cycleCurStep;
+	debuganswer debugAnswer;						// Answer for setup and debug transactions
 
 	k96states status;								// ModBus high level FSM status
+	bool discoveryStarted;							// Unit ID request issued for the current bring-up
 
 	char serialID[K96_SERIALID_BUFFERLENGTH];		// Serial ID read from the sensor
 
 	static const char* const channelNames[];
 	static const char* const channelMeasurementUnits[];
-	static const unsigned short* crcTable;
 };
 
 #endif /* K96DEVICE_H_ */
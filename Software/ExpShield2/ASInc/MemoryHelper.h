@@ -0,0 +1,82 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *			European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#ifndef MEMORYHELPER_H_
+#define MEMORYHELPER_H_
+
+#include <stddef.h>
+
+// Heap and stack usage telemetry.
+// All dynamic allocations are routed here by the global new/delete operators.
+// Main loop and interrupt handlers share the same (main) stack on this target,
+// so a single painted watermark covers both.
+class MemoryHelper {
+public:
+	virtual ~MemoryHelper();
+
+	// Paint the unused memory between heap and stack. To be called at startup.
+	void init();
+
+	// Allocations required to succeed never return a null pointer: the installed
+	// new handler is called until it frees enough memory, or Error_Handler is reached
+	void* allocate(size_t size, bool mustSucceed);
+	void release(void* ptr);
+
+	// Free memory available to heap and stack (in bytes)
+	unsigned long getFreeMemory() const;
+
+	// Heap size (high-water mark, the heap never shrinks), bytes in use and bytes
+	// free inside the heap (possibly fragmented), largest free block: the largest
+	// free heap chunk or the gap between the heap top and the deepest stack
+	// location, never reached by heap or stack, whichever is larger
+	void getHeapStats(unsigned long* heapSize, unsigned long* heapInUse,
+							unsigned long* heapFree, unsigned long* largestFree) const;
+
+	void getAllocStats(unsigned long* allocations, unsigned long* releases, unsigned long* failures) const;
+
+	// Deepest stack usage since startup (in bytes)
+	unsigned long getStackMaxUsed() const;
+
+	static inline MemoryHelper* getInstance() { return &instance; }
+
+private:
+	MemoryHelper();
+
+	unsigned long getLargestFreeChunk() const;
+	unsigned long* getHeapTop() const;
+	unsigned long* getStackDeepest() const;
+
+private:
+	static MemoryHelper instance;
+
+	// Counters are not initialized in the constructor: allocations can happen
+	// in other static objects constructors before this one is built
+	unsigned long allocations;
+	unsigned long releases;
+	unsigned long failures;
+};
+
+#define AS_MEMORY (*(MemoryHelper::getInstance()))
+
+#endif /* MEMORYHELPER_H_ */
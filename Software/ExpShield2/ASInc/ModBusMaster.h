@@ -0,0 +1,126 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#ifndef MODBUSMASTER_H_
+#define MODBUSMASTER_H_
+
+class SerialHelper;
+
+#define MODBUS_QUEUE_LENGTH			4		/* Maximum number of pending transactions */
+#define MODBUS_MAX_REQUEST_DATA		8		/* Maximum request data bytes (address and function code excluded) */
+#define MODBUS_RX_BUFFERLENGTH		64
+
+#define MODBUS_ANY_ADDRESS			0xFE	/* Point to point "any slave" address: answers are accepted from any slave */
+#define MODBUS_REPLY_BYTECOUNT		0xFF	/* The reply data length is given by the byte count field */
+
+#define MODBUS_FC_READ_INPUTREG		0x04
+#define MODBUS_FC_EXCEPTION_FLAG	0x80
+
+/* Asynchronous ModBus RTU master.
+ * Requests are queued and sent one at a time on the serial line, respecting the
+ * inter-frame silence derived from the baud rate. Answers are parsed and CRC
+ * checked incrementally as bytes arrive; timeouts are retried, then the request
+ * completion handler is called from the loop() context.
+ * Each queued request is completed exactly once: flushed requests are
+ * completed with RESULT_ABORTED.
+ */
+class ModBusMaster {
+public:
+	typedef enum _result {
+		RESULT_OK,
+		RESULT_EXCEPTION,		// Payload holds the exception code
+		RESULT_TIMEOUT,			// No valid answer after all retries
+		RESULT_ABORTED			// Dropped by flush() before completion
+	} result;
+
+	typedef void (*completionhandler)(void* context, result res, const unsigned char* payload, unsigned char payloadLen);
+
+public:
+	ModBusMaster(SerialHelper* const serialLine, unsigned long baudRate, unsigned char responseTimeout);
+	virtual ~ModBusMaster();
+
+	void setTurnaroundDelay(unsigned char delayMs);
+
+	bool readInputRegisters(unsigned char slave, unsigned short address, unsigned char numRegisters, unsigned char retries,
+								completionhandler handler, void* context);
+	bool request(unsigned char slave, unsigned char functionCode, const unsigned char* data, unsigned char dataLen,
+								unsigned char replyDataLen, unsigned char retries, completionhandler handler, void* context);
+	void flush();
+	bool isIdle() const;
+
+	void loop();
+	void tick();
+
+	static unsigned short crcUpdate(unsigned short crc, unsigned char data);
+
+private:
+	typedef enum _rxstates {
+		RX_IDLE,
+		RX_WAITING_ADDRESS,
+		RX_WAITING_FUNCTION_CODE,
+		RX_WAITING_BYTECOUNT,
+		RX_WAITING_DATA,
+		RX_WAITING_CRC
+	} rxstates;
+
+	typedef struct _transaction {
+		unsigned char slave;
+		unsigned char functionCode;
+		unsigned char data[MODBUS_MAX_REQUEST_DATA];
+		unsigned char dataLen;
+		unsigned char replyDataLen;
+		unsigned char retries;
+		completionhandler handler;
+		void* context;
+	} transaction;
+
+private:
+	void sendRequest();
+	void onDataReceived(unsigned char rxChar);
+	void complete(result res);
+
+private:
+	SerialHelper* const serial;
+	const unsigned char responseTimeout;			// Answer timeout (in 0.01s)
+	unsigned char silenceTime;						// Minimum time between frames (in ms)
+
+	transaction queue[MODBUS_QUEUE_LENGTH];
+	unsigned char queueHead;
+	unsigned char queueCount;
+	bool waitingAnswer;								// The head transaction has been sent
+
+	rxstates rxStatus;
+	unsigned short rxCRC;							// Running CRC of the incoming frame
+	unsigned char rxOffset;
+	unsigned char rxRemaining;						// Bytes still expected in the current rx state
+	unsigned char rxBuffer[MODBUS_RX_BUFFERLENGTH];	// Answer payload
+	bool rxException;
+
+	volatile unsigned char responseTimer;
+	unsigned long lastFrameTime;					// HAL tick of the last frame end
+
+	static const unsigned short* crcTable;
+};
+
+#endif /* MODBUSMASTER_H_ */
@@ -63,7 +63,11 @@ private:
 private:
 	void applyPIDCoefficients();
 	void writePIDCoefficientsToEEPROM();
+	void applyScheduleCoefficients();
+	void writeScheduleCoefficientsToEEPROM();
 	float roundPIDCoefficient(float value);
+	int32_t toPIDCoefficient(double value);
+	void storeAutotuneCoefficients();
 
 private:
 	typedef struct pidcoeffs {
@@ -78,11 +82,27 @@ private:
 				int32_t refSource;
 			} coeff;
 		} data;
-		long crc;
+		uint32_t crc;
 	} pidcoeffs;
 
+	typedef struct pidschedule {
+		union __attribute__((__packed__)) {
+			int32_t raw[6];
+			struct __attribute__((__packed__)) {
+				int32_t coolP;
+				int32_t coolI;
+				int32_t coolD;
+				int32_t heatFF;
+				int32_t coolFF;
+				int32_t reserved;
+			} coeff;
+		} data;
+		uint32_t crc;
+	} pidschedule;
+
 private:
 	pidcoeffs pidData;
+	pidschedule scheduleData;
 
 private:
 	static const char* const channelNames[];
@@ -31,6 +31,9 @@ public:
 	virtual ~PIDEngine();
 
 	void setCoefficients(double p, double i, double d);
+
+	// Switch coefficients keeping the current integral term contribution (bumpless)
+	void changeCoefficients(double p, double i, double d);
 	void setOutMinMax(double _minVal, double _maxVal);
 	void setSetPoint(double _setpoint);
 
@@ -39,9 +42,16 @@ public:
 	double getD() const;
 	double getSetPoint() const;
 
+	// Terms and output clamping of the last calculation, for diagnostic purposes
+	void getLastTerms(double& pTerm, double& iTerm, double& dTerm) const;
+	bool isOutputClamped() const;
+
 protected:
 	double getNextDriveValue(double currentValue);
 
+	// Restart from a clean integral and derivative history
+	void resetState(double currentValue);
+
 private:
 	typedef struct _coefficients {
 		double p;
@@ -58,6 +68,8 @@ private:
 	double setpoint;
 	double lastCurrentValue;
 	double integralVal;
+	coefficients lastTerms;
+	bool outputClamped;
 };
 
 #endif /* PIDENGINE_H_ */
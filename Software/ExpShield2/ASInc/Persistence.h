@@ -67,11 +67,11 @@ extern "C" {
     
 // EEPROM memory map persistence    
     
-// 0000 - 0004 -> Sampler preset channel 0
-// 0010 - 0014 -> Sampler preset channel 1
-// 0020 - 0024 -> Sampler preset channel 2
+// 0000 - 0005 -> Sampler preset channel 0
+// 0010 - 0015 -> Sampler preset channel 1
+// 0020 - 0025 -> Sampler preset channel 2
 // ...
-// 00D0 - 00D4 -> Sampler preset channel D
+// 00D0 - 00D5 -> Sampler preset channel D
 // ...
 #define SAMPLER_PRESET_BASE(a) ((a)<<4)
 
@@ -79,6 +79,7 @@ extern "C" {
 #define SAMPLER_PRESET_DECIMATION(a)    (SAMPLER_PRESET_BASE(a) + 1)
 #define SAMPLER_PRESET_IIR1DENOM(a)     (SAMPLER_PRESET_BASE(a) + 2)
 #define SAMPLER_PRESET_IIR2DENOM(a)     (SAMPLER_PRESET_BASE(a) + 3)
+#define SAMPLER_PRESET_TIMEBASE(a)      (SAMPLER_PRESET_BASE(a) + 4)	/* 2 bytes, LSB first */
     
 // 0008 - 0008 -> Sampler averager buffer size channel 0
 // 0018 - 0018 -> Sampler averager buffer size channel 1
@@ -116,7 +117,8 @@ extern "C" {
 #define SAMPLER_CHANNEL_SETPOINT(a,b)		((0x2000 + (((unsigned short)(a))<<8)) + ((b)<<1))
 
 // Other constants to be persisted
-#define PID_COEFFICIENTS				0x7000	/* to 0x700F */
+#define PID_COEFFICIENTS				0x7000	/* to 0x701F */
+#define PID_SCHEDULE_COEFFICIENTS		0x7020	/* to 0x703F */
 
 // 7FF0 - Board serial number
 #define BOARD_SERIAL_NUMBER             0x7FF0
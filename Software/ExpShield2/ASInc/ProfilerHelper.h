@@ -0,0 +1,92 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *			European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#ifndef PROFILERHELPER_H_
+#define PROFILERHELPER_H_
+
+// Profiled stages in the main loop
+#define PROFILER_STAGE_LOOP				0x00
+#define PROFILER_STAGE_SENSORSARRAY		0x01
+#define PROFILER_STAGE_SERIALA			0x02
+#define PROFILER_STAGE_SERIALB			0x03
+#define PROFILER_STAGE_SERIALUSB		0x04
+#define PROFILER_STAGE_EEPROM			0x05
+#define PROFILER_STAGE_TCONTROL			0x06
+#define PROFILER_STAGE_CCDRIVER			0x07	/* Unused: the current loop runs in the ADC interrupt */
+
+// Profiled stages in the interrupt handlers
+#define PROFILER_STAGE_TIMER_ISR		0x08
+#define PROFILER_STAGE_ADC_ISR			0x09
+
+// Profiled stages for each sensor device (add the sensor index)
+#define PROFILER_MAX_SENSORS			0x08
+#define PROFILER_STAGE_SENSOR_LOOP		0x0A
+#define PROFILER_STAGE_SENSOR_TICK		(PROFILER_STAGE_SENSOR_LOOP + PROFILER_MAX_SENSORS)
+
+#define PROFILER_NUM_OF_STAGES			(PROFILER_STAGE_SENSOR_TICK + PROFILER_MAX_SENSORS)
+
+// Execution time statistics for the main loop and interrupt stages.
+// Times are measured in core clock cycles through the SysTick counter.
+class ProfilerHelper {
+public:
+	virtual ~ProfilerHelper();
+
+	// Take the start time for a stage
+	unsigned long begin() const;
+
+	// Time elapsed from start
+	unsigned long getElapsed(unsigned long start) const;
+
+	// Update the stage statistics with the time elapsed from start
+	void end(unsigned char stage, unsigned long start);
+
+	bool getStageStats(unsigned char stage, unsigned long* calls, unsigned long* minCycles,
+								unsigned long* avgCycles, unsigned long* maxCycles) const;
+	void reset();
+
+	static inline ProfilerHelper* getInstance() { return &instance; }
+
+private:
+	ProfilerHelper();
+
+	unsigned long now() const;
+	void clearStats();
+
+private:
+	typedef struct _stagestats {
+		unsigned long calls;
+		unsigned long minCycles;
+		unsigned long maxCycles;
+		unsigned long long totalCycles;
+	} stagestats;
+
+private:
+	static ProfilerHelper instance;
+
+	stagestats stats[PROFILER_NUM_OF_STAGES];
+};
+
+#define AS_PROFILER (*(ProfilerHelper::getInstance()))
+
+#endif /* PROFILERHELPER_H_ */
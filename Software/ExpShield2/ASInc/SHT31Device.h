@@ -30,6 +30,21 @@
 #define SHT31_CHANNEL_TEMPERATURE	0x00
 #define SHT31_CHANNEL_HUMIDITY		0x01
 
+// Generic registers (see writeGenericRegister)
+#define SHT31_REG_ACQUISITION_RATE	0x00	/* One of SHT31_RATE_xxx values */
+#define SHT31_REG_REPEATABILITY		0x01	/* One of SHT31_REPEATABILITY_xxx values */
+
+#define SHT31_RATE_SINGLESHOT		0x00	/* One measurement for each sample request */
+#define SHT31_RATE_0_5MPS			0x01	/* Periodic acquisition, 0.5 measurements per second */
+#define SHT31_RATE_1MPS				0x02	/* Periodic acquisition, 1 measurement per second */
+#define SHT31_RATE_2MPS				0x03	/* Periodic acquisition, 2 measurements per second */
+#define SHT31_RATE_4MPS				0x04	/* Periodic acquisition, 4 measurements per second */
+#define SHT31_RATE_10MPS			0x05	/* Periodic acquisition, 10 measurements per second */
+
+#define SHT31_REPEATABILITY_HIGH	0x00
+#define SHT31_REPEATABILITY_MEDIUM	0x01
+#define SHT31_REPEATABILITY_LOW		0x02
+
 class SHT31Device : public SensorDevice {
 public:
 	SHT31Device(bool internal);
@@ -49,14 +64,23 @@ public:
 	virtual const char* getMeasurementUnit(unsigned char channel) const;
 	virtual float evaluateMeasurement(unsigned char channel, float value, bool firstSample) const;
 
+	virtual bool writeGenericRegister(unsigned int address, unsigned int value);
+	virtual bool readGenericRegister(unsigned int address, unsigned int& value);
+
 	virtual void triggerSample();
 
-	inline bool isAvailable() const { return status != UNAVAILABLE; }
+	virtual bool isAvailable() const;
 
 private:
 	char sendCommand(unsigned short command) const;
 	char readData(unsigned short *temperature, unsigned short *humidity) const;
+	void onCommunicationResult(bool success);
+	void scheduleRetry();
 	bool checkPresence();
+	void onNewSample(unsigned short temperature, unsigned short humidity);
+	unsigned short getAcquisitionCommand() const;
+
+	static unsigned char crc8(const unsigned char* data, unsigned char len);
 
 private:
 	typedef enum _sht31states {
@@ -66,12 +90,26 @@ private:
 		READ_SAMPLE,
 		IDLE_READY,
 		IDLE_STOP,
+		START_PERIODIC,
+		WAIT_FOR_BREAK,
+		FETCH_SAMPLE,
+		STOP_PERIODIC,
+		WAIT_FOR_RETRY,
 	} sht31states;
 
 private:
 	unsigned char sensorAddress;
 	unsigned char ticker;
 	volatile sht31states status;
+	sht31states retryStatus;			// Status to be restored when the retry delay expires
+	unsigned char retryDelay;			// Current retry delay (in 0.01s)
+
+	unsigned char acquisitionRate;		// Single shot or periodic acquisition rate
+	unsigned char repeatability;		// Measurement repeatability
+	bool periodicRunning;				// The sensor is in periodic acquisition mode
+	unsigned char failures;				// Consecutive communication failures
+
+	static const unsigned short acquisitionCommands[][3];
 
 	static const char* const channelNames[];
 	static const char* const channelMeasurementUnits[];
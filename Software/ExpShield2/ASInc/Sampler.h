@@ -27,8 +27,13 @@
 
 class SensorDevice;
 
+#define SAMPLER_TICK_PERIOD_MS		10		/* SensorsArray timer tick period */
+#define SAMPLER_DEFAULT_TIMEBASE	100		/* Default sampler timebase: 1 second */
+#define SAMPLER_MAX_TIMEBASE		6000	/* Slowest sampler timebase: 1 minute */
+
 /* This is the base class for a sampler unit. 
-   A sampler unit implements a basic multichannel aware sampler with prescaler and decimation timing option
+   A sampler unit implements a basic multichannel aware sampler with prescaler and decimation timing option.
+   The sampleTick rate is set by the sampler timebase, expressed in SensorsArray timer ticks (10ms)
 */
 class Sampler {
     
@@ -43,6 +48,9 @@ public:
     
     virtual void setDecimation(unsigned char value);
     virtual unsigned char getDecimation();
+
+    virtual void setTimebase(unsigned short ticks);
+    virtual unsigned short getTimebase();
     
     virtual bool savePreset(unsigned char myID);
     virtual bool loadPreset(unsigned char myID);
@@ -78,6 +86,8 @@ protected:
     unsigned char  decimation;           // decimation filter length
     unsigned char  decimationTimer;      // this is the decimation counter
 
+    unsigned short timebase;             // sampleTick period in timer ticks
+
     unsigned char  numChannels;			 // Number of channels the sampler is valid to handle
     unsigned short *lastSample;          // last valid sample read buffers
     bool *enabled;						 // channels enabled/disabled status
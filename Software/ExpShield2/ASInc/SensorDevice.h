@@ -27,6 +27,14 @@
 
 // Basic sensor device, multiple channel capable
 class SensorDevice {
+public:
+	// Device bring-up (discovery) status
+	typedef enum _bringupstatus {
+		BRINGUP_PENDING,
+		BRINGUP_READY,
+		BRINGUP_ABSENT
+	} bringupstatus;
+
 public:
 	SensorDevice(const unsigned char reqChannels);
 	virtual ~SensorDevice();
@@ -37,6 +45,13 @@ public:
 	virtual bool init() = 0;
 	virtual void loop() = 0;
 	virtual void tick() = 0;
+	virtual bool isAvailable() const;
+
+	// Non blocking discovery step. It's called from the superloop until the bring-up terminates.
+	virtual void bringUp();
+	virtual void restartBringUp();
+	bringupstatus getBringUpStatus() const;
+	bool isReady() const;
 
 	virtual const char* getSerial() const = 0;
 
@@ -50,6 +65,7 @@ public:
 	virtual bool getSetpointForChannel(unsigned char channel, unsigned short& setpoint);
 	virtual bool writeGenericRegister(unsigned int address, unsigned int value);
 	virtual bool readGenericRegister(unsigned int address, unsigned int& value);
+	virtual void setChannelEnabled(unsigned char channel, bool enabled);
 
 
 	virtual void triggerSample();
@@ -58,8 +74,10 @@ public:
 
 protected:
 	void setSample(unsigned char channel, unsigned short sample);
+	void setBringUpStatus(bringupstatus status);
 
 private:
+	volatile bringupstatus bringUpStatus;
 	volatile bool sampleReady;
 	const unsigned char numChannels;
 	unsigned short *lastSamples;
@@ -27,6 +27,7 @@
 #define	SENSORSARRAY_H
 
 #include "DitherTool.h"
+#include "StaticBoard.h"
 class SamplesAverager;
 
 // Physical sensor devices
@@ -98,6 +99,8 @@ public:
     bool getSampleDecimation(unsigned char channel, unsigned char* decimation);
     bool setSampleIIRDenominators(unsigned char channel, unsigned char iirDen1, unsigned char iirDen2);
     bool getSampleIIRDenominators(unsigned char channel, unsigned char *iirDen1, unsigned char *iirDen2);
+    bool setSampleTimebase(unsigned char channel, unsigned short timebaseMs);
+    bool getSampleTimebase(unsigned char channel, unsigned short* timebaseMs);
 
     bool getLastSample(unsigned char channel, unsigned short &lastSample, unsigned long &timestamp);
     bool getLastSample(unsigned char channel, float &lastSample, unsigned long &timestamp);
@@ -125,23 +128,18 @@ public:
     unsigned short getBoardNumChannels();
 
     bool getIsFlyboardReady();
+    bool getIsMainboardReady();
+    bool getSensorStatus(unsigned char sensor, unsigned short* readyMap, unsigned short* pendingMap, unsigned short* reconnects, unsigned short* dropouts);
 
-    bool init();
+    bool isBringUpCompleted() const;
     bool timerTick();
     bool loop();
 
-private:
-    typedef struct _channeltosamplersubchannel {
-    		unsigned char sampler;
-    		unsigned char subchannel;
-    		bool firstChannelForSampler;
-    } channeltosamplersubchannel;
-
 private:
     static DitherTool ditherTool;                           		// Dithering toolset
     
-    // A suitable channel To Subchannel array to speedup access
-    static const channeltosamplersubchannel chToSamplerSubChannel[NUM_OF_TOTAL_CHANNELS];
+    // A suitable channel To Subchannel array to speedup access (generated from the board description)
+    static const channeltosamplersubchannel* const chToSamplerSubChannel;
 
     SensorDevice* const sensors[NUM_OF_TOTAL_SENSORS];			   	// Physical sensor units
     Sampler* const samplers[NUM_OF_TOTAL_SAMPLERS];               	// Sampler units for all channels
@@ -149,7 +147,24 @@ private:
     
     bool samplingEnabled;                                   		// Sampling is default disabled
     volatile unsigned long timestamp;                               // Internal timestamp timer (in 0.01s)
-    volatile unsigned char globalPrescaler;						   	// Global sampling prescaler
+    volatile unsigned short timebaseTimer[NUM_OF_TOTAL_SAMPLERS];	// Per sampler timebase counters (in 0.01s)
+    float evaluatedSamples[NUM_OF_TOTAL_CHANNELS];					// Latest averages in engineering units
+
+    volatile unsigned char powerUpTimer;							// Power supply settle time before the bring-up (in 0.01s)
+    volatile unsigned short reprobeTimer;							// Absent devices re-probe timer (in 0.01s)
+    unsigned char reprobeNext;										// Next device to be checked for re-probe
+    unsigned short availableMap;									// Currently available devices bitmap
+    unsigned short discoveredMap;									// Devices found at least once bitmap
+    unsigned short reconnectCount[NUM_OF_TOTAL_SENSORS];			// Devices reconnection events
+    unsigned short dropoutCount[NUM_OF_TOTAL_SENSORS];				// Devices disconnection events
+
+private:
+    void checkAvailability();
+    void evaluateSamples(unsigned char sampler);
+    void reprobeAbsentDevice();
+
+    // Compile time checks for the channel map consistency
+    static constexpr bool mapsTo(unsigned char channel, unsigned char sensor, unsigned char subchannel);
 };
 
 #endif	/* SENSORSARRAY_H */
@@ -29,6 +29,15 @@
 #include "PIDEngine.h"
 
 class TControlEngine : public PIDEngine {
+public:
+	typedef enum _autotunestatus {
+		AUTOTUNE_IDLE,
+		AUTOTUNE_RUNNING,
+		AUTOTUNE_DONE,
+		AUTOTUNE_FAILED,
+		AUTOTUNE_ABORTED
+	} autotunestatus;
+
 public:
 	virtual ~TControlEngine();
 
@@ -42,25 +51,109 @@ public:
 	void setCoolingStartPercentage(unsigned short _coolingMin);
 	void setHeatingStartPercentage(unsigned short _heatingMin);
 
+	// Heating and cooling have different plant gains. The PID coefficients
+	// are scheduled by operating region: heating when the setpoint is above
+	// ambient, cooling otherwise. A cooling set with P = 0 follows the heating one.
+	void setHeatingCoefficients(double p, double i, double d);
+	void setCoolingCoefficients(double p, double i, double d);
+
+	// Feedforward drive (in 1/100 %) per 1/100 C of setpoint to ambient difference
+	// for each region. The ambient temperature is taken from the external heatsink
+	// when the Peltier is not heating it (cooler and external fan stopped) and
+	// expires after a long cooling period. Without a valid ambient the feedforward
+	// is disabled and the region follows the temperature error sign.
+	void setFeedforwardCoefficients(double heating, double cooling);
+
+	bool isHeatingRegion() const;
+	bool getAmbientTemperature(short& temperature) const;
+	short getFeedforwardDrive() const;
+
 	void tick();
 	void loop(short currentTemperature);
 
 	void setEnabled(bool on);
 	short getCurrentDrive();
 
+	// Drive actually applied to the heaters (> 0) or to the cooler (< 0), in 1/100 %.
+	// It differs from the requested drive below the start thresholds, during
+	// overheat and fan lock protections and when disabled.
+	short getAppliedDrive() const;
+
+	// Relay feedback autotune. The chamber is driven heating and cooling with the given
+	// drive (in 1/100 %) around the current setpoint until the oscillation ultimate gain
+	// and period are measured, then the PID coefficients are calculated.
+	bool startAutotune(unsigned short relayDrive);
+	void abortAutotune();
+	autotunestatus getAutotuneStatus() const;
+	unsigned char getAutotuneCycles() const;
+	float getAutotuneUltimateGain() const;
+	unsigned long getAutotuneUltimatePeriod() const;
+	unsigned short getAutotuneAmplitude() const;
+
+	// Retrieve the calculated coefficients once, after the autotune is done
+	bool takeAutotuneCoefficients(double& p, double& i, double& d);
+
 	static inline TControlEngine* getInstance() { return &instance; }
 
 private:
 	TControlEngine();
 
+	short getScheduledDriveValue(short currentTemperature);
+	void updateAmbientTemperature(short extHeatsinkTemperature, bool coolerOff);
+	void applyRegionCoefficients();
+	void recordTelemetry(short currentTemperature, unsigned char flags);
+
+	short getAutotuneDrive(short currentTemperature);
+	void onAutotuneCycle(short currentTemperature);
+	void stopAutotune(autotunestatus result, short currentTemperature);
+
+private:
+	typedef struct _autotunedata {
+		autotunestatus status;
+		unsigned short relayDrive;		// In 1/100 %
+		bool relayHeating;
+		unsigned long timer;			// Seconds from start
+		unsigned long cycleStart;
+		short cycleMax;
+		short cycleMin;
+		unsigned char switches;			// Relay switches to heating
+		unsigned char measuredCycles;
+		unsigned long periodSum;		// In seconds
+		unsigned long amplitudeSum;		// In 1/100 C
+		float ultimateGain;
+		unsigned long ultimatePeriod;	// In seconds
+		unsigned short amplitude;		// In 1/100 C
+		bool resultPending;
+		double p;
+		double i;
+		double d;
+	} autotunedata;
+
+	typedef struct _gainset {
+		double p;
+		double i;
+		double d;
+		double ff;
+	} gainset;
+
 private:
 	bool enabled;
 	unsigned char prescaler;
 	unsigned char extFanBlankTimer;
 	unsigned char overheatBlankTimer;
 	short currentDrive;
+	short appliedDrive;
 	unsigned short coolingMin;
 	unsigned short heatingMin;
+	autotunedata autotune;
+
+	gainset heatingGains;
+	gainset coolingGains;
+	bool heatingRegion;
+	bool ambientValid;
+	unsigned short ambientAge;			// Seconds since the last ambient sample
+	short ambientTemperature;			// In 1/100 C
+	short feedforwardDrive;				// In 1/100 %
 
 private:
 	static TControlEngine instance;
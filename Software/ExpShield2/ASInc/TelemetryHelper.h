@@ -0,0 +1,116 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *			European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#ifndef TELEMETRYHELPER_H_
+#define TELEMETRYHELPER_H_
+
+#define TELEMETRY_RING_SIZE				64
+#define TELEMETRY_NUM_OF_VALUES			7
+
+// Recorded control loops
+#define TELEMETRY_SOURCE_TCONTROL		0x00
+#define TELEMETRY_SOURCE_CCDRIVER		0x01
+#define TELEMETRY_NUM_OF_SOURCES		(TELEMETRY_SOURCE_CCDRIVER + 1)
+
+// Record flags (common)
+#define TELEMETRY_FLAG_CLAMPED			0x01	/* PID output clamped */
+#define TELEMETRY_FLAG_ENABLED			0x02	/* Control loop enabled */
+
+// Record flags (temperature control only)
+#define TELEMETRY_FLAG_HEATING			0x04	/* Heating region gains in use */
+#define TELEMETRY_FLAG_OVERHEAT			0x08	/* Overheat temperature detected */
+#define TELEMETRY_FLAG_OVERHEAT_BLANK	0x10	/* Heater and cooler blanked after an overheat */
+#define TELEMETRY_FLAG_FAN_LOCK			0x20	/* Cooling inhibited, external fan not rotating */
+#define TELEMETRY_FLAG_EXT_FAN			0x40	/* External fan running */
+#define TELEMETRY_FLAG_AUTOTUNE			0x80	/* Relay autotune running */
+
+#define TELEMETRY_DEFAULT_TRIGGER		(TELEMETRY_FLAG_OVERHEAT | TELEMETRY_FLAG_FAN_LOCK)
+
+// Control loops flight recorder. Each control loop update is recorded in
+// a RAM ring buffer (after decimation) until a record matching the trigger
+// flags is found. Then post trigger records are taken and the capture stops,
+// waiting to be downloaded.
+class TelemetryHelper {
+public:
+	typedef enum _capturestatus {
+		CAPTURE_STOPPED,
+		CAPTURE_RUNNING,
+		CAPTURE_TRIGGERED,
+		CAPTURE_DONE
+	} capturestatus;
+
+	// Temperature control values (1/100 C and 1/100 %):
+	// temperature, error, P, I, D terms, feedforward and output drive.
+	// Constant current values (1/100 %):
+	// setpoint, measure, error, P, I, D terms and output drive.
+	typedef struct _telemetryrecord {
+		unsigned long timestamp;		// In ms
+		unsigned char source;
+		unsigned char flags;
+		short values[TELEMETRY_NUM_OF_VALUES];
+	} telemetryrecord;
+
+public:
+	virtual ~TelemetryHelper();
+
+	// Restart the capture. A zero decimation disables recording for a source,
+	// a zero trigger mask records continuously.
+	void start(const unsigned char* decimation, unsigned char triggerMask, unsigned short postTrigger);
+	void stop();
+
+	// True when the current update for the source has to be recorded
+	bool sample(unsigned char source);
+	void record(const telemetryrecord* rec);
+
+	capturestatus getStatus() const;
+	unsigned short getCount() const;
+
+	// Records are indexed from the oldest one
+	bool getRecord(unsigned short index, telemetryrecord* rec) const;
+
+	static short saturate(long value);
+
+	static inline TelemetryHelper* getInstance() { return &instance; }
+
+private:
+	TelemetryHelper();
+
+	void clear();
+
+private:
+	static TelemetryHelper instance;
+
+	telemetryrecord ring[TELEMETRY_RING_SIZE];
+	unsigned short head;								// Next record to be written
+	unsigned short count;
+	volatile capturestatus status;
+	unsigned char triggerMask;
+	unsigned short postTriggerLeft;
+	unsigned char decimation[TELEMETRY_NUM_OF_SOURCES];
+	unsigned char decimationCounter[TELEMETRY_NUM_OF_SOURCES];
+};
+
+#define AS_TELEMETRY (*(TelemetryHelper::getInstance()))
+
+#endif /* TELEMETRYHELPER_H_ */
@@ -90,6 +90,9 @@ const unsigned char ADT7470Device::defaultSampleRate() {
 ADT7470Device::ADT7470Device() : SensorDevice(ADT7470_NUM_CHANNELS),
 				go(false), error(false), communicationTimer(ADT7470_COMMUNICATION_PERIOD*3/4) {
 
+	shadowValidMap = 0;
+	shadowRefreshCounter = 0;
+
 	for (unsigned char n = 0; n < ADT7470_NUM_FAN_CHANNELS; n++) {
 		fansSpeed[n] = 0xFFFF;
 		fansLastSeenRotating[n] = MAX_LAST_SEEN_ROTATING;
@@ -116,6 +119,14 @@ void ADT7470Device::loop() {
 									   ADT7470_COMMUNICATION_PERIOD)) {
 		communicationTimer = 0;
 
+		// Periodically drop the local copies so the registers are written
+		// again, recovering from a device reset not seen as an I2C error
+		shadowRefreshCounter++;
+		if (shadowRefreshCounter >= ADT7470_SHADOW_REFRESH_PERIODS) {
+			shadowRefreshCounter = 0;
+			shadowValidMap = 0;
+		}
+
 		// Communicate here with the device. Update the error status
 		readTemperatures();
 		readFanSpeeds();
@@ -272,14 +283,15 @@ bool ADT7470Device::init() {
 		return false;
 	}
 
-	unsigned char config1 = ADT7470_STRT_FLAG | ADT7470_T05_STB;	// See datasheet, Table 31
-	error = !I2CB.write(ADT7470_I2C_ADDRESS, ADT7470_REG_CONFIGURATION1, 1, &config1, 1);
+	// The device may have been reset (re-probe): write all the registers again
+	shadowValidMap = 0;
+
+	writeRegister(ADT7470_REG_CONFIGURATION1, ADT7470_STRT_FLAG | ADT7470_T05_STB);	// See datasheet, Table 31
 	if (error) {
 		return false;
 	}
 
-	unsigned char config2 = ADT7470_22KHZ_FLAG; 	// See datasheet, Table 44
-	error = !I2CB.write(ADT7470_I2C_ADDRESS, ADT7470_REG_CONFIGURATION2, 1, &config2, 1);
+	writeRegister(ADT7470_REG_CONFIGURATION2, ADT7470_22KHZ_FLAG); 	// See datasheet, Table 44
 	if (error) {
 		return false;
 	}
@@ -316,14 +328,17 @@ void ADT7470Device::readTemperatures() {
 		return;
 	}
 
-	// Read temperature registers
+	// Read temperature registers, one transaction each: the driver does
+	// not rely on the register address auto-increment
 	for (unsigned char n = 0; n < ADT7470_NUM_TEMPERATURE_CHANNELS; n++) {
 		unsigned char temperature;
 		error = !I2CB.read(ADT7470_I2C_ADDRESS, ADT7470_REG_BASE_TEMPERATURE+n, 1, &temperature, 1);
 		if (!error) {
-
 			// Temperatures are stored in 1/100 units
 			temperatures[n] = ((char)temperature) * 100;
+		} else {
+			// The device may have been reset: write the registers again
+			shadowValidMap = 0;
 		}
 	}
 
@@ -342,7 +357,7 @@ void ADT7470Device::readFanSpeeds() {
 			fansLastSeenRotating[n]++;
 		}
 
-		// Read the fan rotation speed
+		// Read the fan rotation speed, low byte first as the device requires
 		unsigned char speedL, speedH;
 		error = !I2CB.read(ADT7470_I2C_ADDRESS, ADT7470_REG_BASE_FANTACH_R + (n<<1), 1, &speedL, 1);
 		if (!error) {
@@ -356,6 +371,11 @@ void ADT7470Device::readFanSpeeds() {
 				}
 			}
 		}
+
+		if (error) {
+			// The device may have been reset: write the registers again
+			shadowValidMap = 0;
+		}
 	}
 }
 
@@ -396,41 +416,89 @@ void ADT7470Device::setInternalFanSpeedAtSetpoint() {
 void ADT7470Device::setRegisterFlag(unsigned char address, unsigned char hexFlag) {
 
 	unsigned char regVal;
-	error = !I2CB.read(ADT7470_I2C_ADDRESS, address, 1, &regVal, 1);
-	if (error) {
-		return;
+	signed char index = getShadowIndex(address);
+	if ((index >= 0) && (shadowValidMap & (1 << index))) {
+		regVal = shadowRegisters[index];
+	} else {
+		error = !I2CB.read(ADT7470_I2C_ADDRESS, address, 1, &regVal, 1);
+		if (error) {
+			shadowValidMap = 0;
+			return;
+		}
 	}
 
 	regVal |= hexFlag;
 
-	error = !I2CB.write(ADT7470_I2C_ADDRESS, address, 1, &regVal, 1);
+	writeRegister(address, regVal);
 }
 
 // Reset a specific flag in a remote register
 void ADT7470Device::resetRegisterFlag(unsigned char address, unsigned char hexFlag) {
 
 	unsigned char regVal;
-	error = !I2CB.read(ADT7470_I2C_ADDRESS, address, 1, &regVal, 1);
+	signed char index = getShadowIndex(address);
+	if ((index >= 0) && (shadowValidMap & (1 << index))) {
+		regVal = shadowRegisters[index];
+	} else {
+		error = !I2CB.read(ADT7470_I2C_ADDRESS, address, 1, &regVal, 1);
+		if (error) {
+			shadowValidMap = 0;
+			return;
+		}
+	}
+
+	regVal &= (0xFF ^ hexFlag);
+
+	writeRegister(address, regVal);
+}
+
+// Write a register, skipping the transaction when it already holds the value.
+// Any communication error invalidates all the local copies: the device
+// may have been reset, so the next writes will be issued anyway
+void ADT7470Device::writeRegister(unsigned char address, unsigned char value) {
+
+	signed char index = getShadowIndex(address);
+	if ((index >= 0) && (shadowValidMap & (1 << index)) && (shadowRegisters[index] == value)) {
+		return;
+	}
+
+	error = !I2CB.write(ADT7470_I2C_ADDRESS, address, 1, &value, 1);
 	if (error) {
+		shadowValidMap = 0;
 		return;
 	}
 
-	regVal &= (0xFF ^ hexFlag);
+	if (index >= 0) {
+		shadowRegisters[index] = value;
+		shadowValidMap |= (1 << index);
+	}
+}
+
+// Local copy position for a register, -1 if not shadowed
+signed char ADT7470Device::getShadowIndex(unsigned char address) const {
 
-	error = !I2CB.write(ADT7470_I2C_ADDRESS, address, 1, &regVal, 1);
+	if ((address >= ADT7470_REG_FANPWM_BASE) && (address < (ADT7470_REG_FANPWM_BASE + ADT7470_NUM_FAN_CHANNELS))) {
+		return address - ADT7470_REG_FANPWM_BASE;
+	} else if (address == ADT7470_REG_CONFIGURATION1) {
+		return ADT7470_NUM_FAN_CHANNELS;
+	} else if (address == ADT7470_REG_CONFIGURATION2) {
+		return ADT7470_NUM_FAN_CHANNELS + 1;
+	}
+
+	return -1;
 }
 
 // Set a specific FAN speed in percentage (0 to 100)
 void ADT7470Device::setFanSpeed(unsigned char fanID, unsigned char percentage) {
 
 	fanID -= ADT7470_CHANNEL_F_EXT_HEATSINK;
-	if (fanID > ADT7470_NUM_FAN_CHANNELS) {
+	if (fanID >= ADT7470_NUM_FAN_CHANNELS) {
 		return;
 	}
 
 	unsigned char pwmValue = (percentage == 100)? 255 : (percentage * 2.57);
 
-	error = !I2CB.write(ADT7470_I2C_ADDRESS, ADT7470_REG_FANPWM_BASE + fanID, 1, &pwmValue, 1);
+	writeRegister(ADT7470_REG_FANPWM_BASE + fanID, pwmValue);
 }
 
 // Get the number of seconds since the last fan valid rotation seen
@@ -24,22 +24,28 @@
 
 #include "CCDriveEngine.h"
 #include "PWMHelper.h"
+#include "TelemetryHelper.h"
 
 CCDriveEngine CCDriveEngine::instance;
 
 #define CC_MIN_DRIVEVAL	0
 #define CC_MAX_DRIVEVAL	10000
 
-CCDriveEngine::CCDriveEngine() : PIDEngine(),
-								enabled(false), go(false),
-								currentMeasure(0), currentDrive(0) {
-
-	// Set PI(D) tuning coefficients
-	AS_CCDRIVER.setCoefficients(0.1, 0.02, 0.0);
-
-	// Output min and max for PID corrections are expressed
-	// in duty cycle percentage, in 1/100 units
-	setOutMinMax(-CC_MAX_DRIVEVAL, CC_MAX_DRIVEVAL);
+// PI(D) tuning coefficients, applied on each current loop update (250Hz).
+// The integral gain is the former 10Hz loop one scaled by 1/25, so the
+// integral action per second (and the loop crossover) is unchanged while
+// the faster sampling reduces the loop delay
+#define CC_COEFF_P		CC_TO_FIXEDPOINT(0.1)
+#define CC_COEFF_I		CC_TO_FIXEDPOINT(0.0008)
+#define CC_COEFF_D		CC_TO_FIXEDPOINT(0.0)
+
+// Output min and max for PID corrections are expressed
+// in duty cycle percentage, in 1/100 units
+CCDriveEngine::CCDriveEngine() : C{CC_COEFF_P, CC_COEFF_I, CC_COEFF_D},
+								integralMinVal((-CC_MAX_DRIVEVAL * (1L << CC_FIXEDPOINT_SHIFT)) / CC_COEFF_I),
+								integralMaxVal((CC_MAX_DRIVEVAL * (1L << CC_FIXEDPOINT_SHIFT)) / CC_COEFF_I),
+								enabled(false), setpoint(0),
+								currentMeasure(0), integralVal(0), currentDrive(0) {
 }
 
 CCDriveEngine::~CCDriveEngine() {
@@ -47,10 +53,10 @@ CCDriveEngine::~CCDriveEngine() {
 
 // Current drive setpoint and actual values are expressed in 1/100 %
 void CCDriveEngine::setCurrentSetPoint(unsigned short _cSetpoint) {
-	setSetPoint(_cSetpoint);
+	setpoint = _cSetpoint;
 
 	// When the setpoint is set to 0, is better to turn off the PWM
-	// istantaneously instead of delegate to the main loop
+	// istantaneously instead of waiting for the next current loop update
 	// This is because, during very high transient (more frequently when
 	// the user generates a very big temperature setpoint change)
 	// it may happens that the TControlEngine starts heating at full power
@@ -63,37 +69,71 @@ void CCDriveEngine::setCurrentSetPoint(unsigned short _cSetpoint) {
 }
 
 // Current drive setpoint and actual values are expressed in 1/100 %
-void CCDriveEngine::loop() {
+// This is called in the A/D DMA interrupt each time a new (oversampled)
+// current measure is available
+void CCDriveEngine::tick(unsigned short _currentMeasure) {
 
-	if (enabled) {
-		if (go) {
-			go = false;
+	int32_t lastMeasure = currentMeasure;
+	currentMeasure = _currentMeasure;
 
-			// Calculate the next value, so the PID coefficients will be updated
-			double nextValue = getSetPoint() + getNextDriveValue(currentMeasure);
+	if (!enabled) {
+		currentDrive = 0;
+		AS_PWM.setPeltierDutyCycle(0);
+		return;
+	}
 
-			// We don't mind (but we need to calculate anyway)
-			// about the calculated next value if the setpoint is 0
-			if (getSetPoint() == 0) {
-				nextValue = 0;
-			}
+	int32_t target = setpoint;
 
-			currentDrive = (nextValue <= CC_MIN_DRIVEVAL)? CC_MIN_DRIVEVAL : ((nextValue > CC_MAX_DRIVEVAL)? CC_MAX_DRIVEVAL : nextValue);
+	// Calculate the error
+	int32_t error = target - currentMeasure;
 
-			// Drive the constant current PWM generator
-			AS_PWM.setPeltierDutyCycle(currentDrive);
-		}
-	} else {
-		AS_PWM.setPeltierDutyCycle(0);
+	// Calculate the cumulative value
+	integralVal += error;
+	if (integralVal > integralMaxVal) {
+		integralVal = integralMaxVal;
+	} else if (integralVal < integralMinVal) {
+		integralVal = integralMinVal;
 	}
-}
-
-void CCDriveEngine::tick(unsigned short _currentMeasure) {
 
-	// Filter out measurements by averaging them
-	currentMeasure = (currentMeasure + _currentMeasure) >> 1;
+	// Sum P,I,D terms contributions
+	int32_t pTerm = C.p * error;
+	int32_t iTerm = C.i * integralVal;
+	int32_t dTerm = C.d * (lastMeasure - currentMeasure);
+	int32_t output = (pTerm + iTerm + dTerm) >> CC_FIXEDPOINT_SHIFT;
+
+	// Clamp output
+	bool clamped = true;
+	if (output > CC_MAX_DRIVEVAL) {
+		output = CC_MAX_DRIVEVAL;
+	} else if (output < -CC_MAX_DRIVEVAL) {
+		output = -CC_MAX_DRIVEVAL;
+	} else {
+		clamped = false;
+	}
 
-	go = true;
+	// We don't mind (but we need to calculate anyway)
+	// about the calculated next value if the setpoint is 0
+	int32_t nextValue = (target == 0)? 0 : (target + output);
+
+	currentDrive = (nextValue <= CC_MIN_DRIVEVAL)? CC_MIN_DRIVEVAL : ((nextValue > CC_MAX_DRIVEVAL)? CC_MAX_DRIVEVAL : nextValue);
+
+	// Drive the constant current PWM generator
+	AS_PWM.setPeltierDutyCycle(currentDrive);
+
+	// Record the loop internals in the telemetry capture ring
+	if (AS_TELEMETRY.sample(TELEMETRY_SOURCE_CCDRIVER)) {
+		TelemetryHelper::telemetryrecord rec;
+		rec.source = TELEMETRY_SOURCE_CCDRIVER;
+		rec.flags = TELEMETRY_FLAG_ENABLED | ((clamped || (nextValue != currentDrive))? TELEMETRY_FLAG_CLAMPED : 0);
+		rec.values[0] = TelemetryHelper::saturate(target);
+		rec.values[1] = TelemetryHelper::saturate(currentMeasure);
+		rec.values[2] = TelemetryHelper::saturate(error);
+		rec.values[3] = TelemetryHelper::saturate(pTerm >> CC_FIXEDPOINT_SHIFT);
+		rec.values[4] = TelemetryHelper::saturate(iTerm >> CC_FIXEDPOINT_SHIFT);
+		rec.values[5] = TelemetryHelper::saturate(dTerm >> CC_FIXEDPOINT_SHIFT);
+		rec.values[6] = currentDrive;
+		AS_TELEMETRY.record(&rec);
+	}
 }
 
 void CCDriveEngine::setEnabled(bool on) {
@@ -32,8 +32,12 @@
 #include <SerialAHelper.h>
 #include <SerialBHelper.h>
 #include <SerialUSBHelper.h>
+#include <ProfilerHelper.h>
+#include <MemoryHelper.h>
+#include <TelemetryHelper.h>
 
 #define COMMPROTOCOL_TIMEOUT  500   /* in 10ms steps -> 5seconds */
+#define TELEMETRY_RECORDS_PER_ANSWER	2	/* Each record takes 40 characters */
 
 const CommProtocol::commandinfo CommProtocol::validCommands[] = {
 
@@ -65,7 +69,15 @@ const CommProtocol::commandinfo CommProtocol::validCommands[] = {
 	{ COMMPROTOCOL_WRITE_CHANENABLE, 1, &CommProtocol::writeChannelEnable },
 	{ COMMPROTOCOL_READ_CHANENABLE, 1, &CommProtocol::readChannelEnable },
 	{ COMMPROTOCOL_WRITE_REGISTER, 3, &CommProtocol::writeRegister },
-	{ COMMPROTOCOL_READ_REGISTER, 2, &CommProtocol::readRegister }
+	{ COMMPROTOCOL_READ_REGISTER, 2, &CommProtocol::readRegister },
+	{ COMMPROTOCOL_SET_SAMPLETIMEBASE, 2, &CommProtocol::setSampleTimebase },
+	{ COMMPROTOCOL_GET_SAMPLETIMEBASE, 1, &CommProtocol::getSampleTimebase },
+	{ COMMPROTOCOL_READ_SENSORSTATUS, 1, &CommProtocol::readSensorStatus },
+	{ COMMPROTOCOL_READ_PROFILE, 1, &CommProtocol::readProfile },
+	{ COMMPROTOCOL_RESET_PROFILE, 0, &CommProtocol::resetProfile },
+	{ COMMPROTOCOL_READ_MEMSTATS, 0, &CommProtocol::readMemoryStats },
+	{ COMMPROTOCOL_START_TELEMETRY, 4, &CommProtocol::startTelemetry },
+	{ COMMPROTOCOL_READ_TELEMETRY, 1, &CommProtocol::readTelemetry }
 };
 
 const char CommProtocol::commProtocolErrorString[] = { COMMPROTOCOL_ERROR };
@@ -265,8 +277,9 @@ void CommProtocol::writeValue(unsigned long value, bool last) {
 
 void CommProtocol::writeValue(float value, bool last) {
 
-    unsigned long iValue = *((unsigned long*)&value);
-    writeValue(iValue, last);
+    uint32_t iValue;
+    memcpy(&iValue, &value, sizeof(iValue));
+    writeValue((unsigned long)iValue, last);
 }
 
 void CommProtocol::writeString(unsigned char* value, bool last) {
@@ -401,13 +414,15 @@ bool CommProtocol::getSampleDecimation(CommProtocol* context, unsigned char cmdO
 }
 
 
-// Function handler: retrieve the free RAM memory (this command is not supported by current firmware release)
+// Function handler: retrieve the free RAM memory (in bytes, saturated to 16 bits)
 bool CommProtocol::getFreeMemory(CommProtocol* context, unsigned char cmdOffset) {
 
+    unsigned long freeMemory = AS_MEMORY.getFreeMemory();
+
     context->buffer[0] = COMMPROTOCOL_HEADER;
     context->buffer[1] = validCommands[cmdOffset].commandID;
     context->buffer[2] = 0;
-    context->writeValue((unsigned short) 0x0100, true);
+    context->writeValue((unsigned short)((freeMemory > 0xFFFF)? 0xFFFF : freeMemory), true);
 
     return true;
 }
@@ -756,3 +771,167 @@ bool CommProtocol::readRegister(CommProtocol* context, unsigned char cmdOffset)
 
     return true;
 }
+
+// Function handler: set the sampler timebase (in ms, 10ms resolution)
+bool CommProtocol::setSampleTimebase(CommProtocol* context, unsigned char cmdOffset) {
+
+    unsigned char channel = context->getParameter(0);
+    unsigned short timebase = context->getShortParameter(1);
+    if (!context->sensorsArray->setSampleTimebase(channel, timebase)) {
+        return false;
+    }
+
+    return context->renderOKAnswer(cmdOffset, channel);
+}
+
+// Function handler: get the sampler timebase (in ms)
+bool CommProtocol::getSampleTimebase(CommProtocol* context, unsigned char cmdOffset) {
+
+    unsigned char channel = context->getParameter(0);
+    unsigned short timebase;
+    if (!context->sensorsArray->getSampleTimebase(channel, &timebase)) {
+        return false;
+    }
+
+    context->buffer[0] = COMMPROTOCOL_HEADER;
+    context->buffer[1] = validCommands[cmdOffset].commandID;
+    context->buffer[2] = 0;
+    context->writeValue(channel, false);
+    context->writeValue(timebase, true);
+
+    return true;
+}
+
+// Function handler: read the ready and pending devices bitmaps and the reconnection
+// and disconnection events counters for a specified physical device
+bool CommProtocol::readSensorStatus(CommProtocol* context, unsigned char cmdOffset) {
+
+    unsigned char sensor = context->getParameter(0);
+    unsigned short readyMap, pendingMap, reconnects, dropouts;
+    if (!context->sensorsArray->getSensorStatus(sensor, &readyMap, &pendingMap, &reconnects, &dropouts)) {
+        return false;
+    }
+
+    context->buffer[0] = COMMPROTOCOL_HEADER;
+    context->buffer[1] = validCommands[cmdOffset].commandID;
+    context->buffer[2] = 0;
+    context->writeValue(sensor, false);
+    context->writeValue(readyMap, false);
+    context->writeValue(pendingMap, false);
+    context->writeValue(reconnects, false);
+    context->writeValue(dropouts, true);
+
+    return true;
+}
+
+// Function handler: read the execution time statistics (in core clock cycles) for a stage
+bool CommProtocol::readProfile(CommProtocol* context, unsigned char cmdOffset) {
+
+    unsigned char stage = context->getParameter(0);
+    unsigned long calls, minCycles, avgCycles, maxCycles;
+    if (!AS_PROFILER.getStageStats(stage, &calls, &minCycles, &avgCycles, &maxCycles)) {
+        return false;
+    }
+
+    context->buffer[0] = COMMPROTOCOL_HEADER;
+    context->buffer[1] = validCommands[cmdOffset].commandID;
+    context->buffer[2] = 0;
+    context->writeValue(stage, false);
+    context->writeValue(calls, false);
+    context->writeValue(minCycles, false);
+    context->writeValue(avgCycles, false);
+    context->writeValue(maxCycles, true);
+
+    return true;
+}
+
+// Function handler: reset the execution time statistics for all stages
+bool CommProtocol::resetProfile(CommProtocol* context, unsigned char cmdOffset) {
+
+    AS_PROFILER.reset();
+
+    context->buffer[0] = COMMPROTOCOL_HEADER;
+    context->buffer[1] = validCommands[cmdOffset].commandID;
+    context->buffer[2] = 0;
+    context->writeValue((unsigned char)PROFILER_NUM_OF_STAGES, true);
+
+    return true;
+}
+
+// Function handler: read the heap and stack usage statistics
+bool CommProtocol::readMemoryStats(CommProtocol* context, unsigned char cmdOffset) {
+
+    unsigned long heapSize, heapInUse, heapFree, largestFree;
+    unsigned long allocations, releases, failures;
+    AS_MEMORY.getHeapStats(&heapSize, &heapInUse, &heapFree, &largestFree);
+    AS_MEMORY.getAllocStats(&allocations, &releases, &failures);
+
+    context->buffer[0] = COMMPROTOCOL_HEADER;
+    context->buffer[1] = validCommands[cmdOffset].commandID;
+    context->buffer[2] = 0;
+    context->writeValue(heapSize, false);
+    context->writeValue(heapInUse, false);
+    context->writeValue(heapFree, false);
+    context->writeValue(largestFree, false);
+    context->writeValue(AS_MEMORY.getStackMaxUsed(), false);
+    context->writeValue(allocations, false);
+    context->writeValue(releases, false);
+    context->writeValue(failures, true);
+
+    return true;
+}
+
+// Function handler: restart the control loops telemetry capture with the given temperature
+// control and constant current decimations, trigger flags mask and post trigger records.
+// Both decimations set to zero stop the capture.
+bool CommProtocol::startTelemetry(CommProtocol* context, unsigned char cmdOffset) {
+
+    unsigned char decimation[TELEMETRY_NUM_OF_SOURCES];
+    decimation[TELEMETRY_SOURCE_TCONTROL] = context->getParameter(0);
+    decimation[TELEMETRY_SOURCE_CCDRIVER] = context->getParameter(1);
+    unsigned char triggerMask = context->getParameter(2);
+    unsigned short postTrigger = context->getShortParameter(3);
+
+    if ((decimation[TELEMETRY_SOURCE_TCONTROL] == 0) && (decimation[TELEMETRY_SOURCE_CCDRIVER] == 0)) {
+        AS_TELEMETRY.stop();
+    } else {
+        AS_TELEMETRY.start(decimation, triggerMask, postTrigger);
+    }
+
+    return context->renderOKAnswer(cmdOffset, (unsigned char)AS_TELEMETRY.getStatus());
+}
+
+// Function handler: read the capture status, the number of captured records
+// and the records starting from the given index (0 is the oldest one)
+bool CommProtocol::readTelemetry(CommProtocol* context, unsigned char cmdOffset) {
+
+    unsigned short index = context->getShortParameter(0);
+    unsigned short count = AS_TELEMETRY.getCount();
+    unsigned char records = 0;
+    if (index < count) {
+        records = ((count - index) > TELEMETRY_RECORDS_PER_ANSWER)? TELEMETRY_RECORDS_PER_ANSWER : (count - index);
+    }
+
+    context->buffer[0] = COMMPROTOCOL_HEADER;
+    context->buffer[1] = validCommands[cmdOffset].commandID;
+    context->buffer[2] = 0;
+    context->writeValue((unsigned char)AS_TELEMETRY.getStatus(), false);
+    context->writeValue(count, false);
+    context->writeValue(index, (records == 0));
+
+    TelemetryHelper::telemetryrecord rec;
+    for (unsigned char n = 0; n < records; n++) {
+        if (!AS_TELEMETRY.getRecord(index + n, &rec)) {
+            return false;
+        }
+
+        context->writeValue(rec.timestamp, false);
+        context->writeValue(rec.source, false);
+        context->writeValue(rec.flags, false);
+        for (unsigned char v = 0; v < TELEMETRY_NUM_OF_VALUES; v++) {
+            context->writeValue((unsigned short)rec.values[v], (n == (records - 1)) && (v == (TELEMETRY_NUM_OF_VALUES - 1)));
+        }
+    }
+
+    return true;
+}
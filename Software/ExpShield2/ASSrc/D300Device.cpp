@@ -74,6 +74,18 @@ bool D300Device::init() {
 	return true;
 }
 
+// The D300 is powered only while sampling, so it can't be discovered at startup.
+// Its availability is checked by the loop after each power on.
+void D300Device::bringUp() {
+	init();
+	setBringUpStatus(BRINGUP_READY);
+}
+
+// The device availability is checked by the loop
+bool D300Device::isAvailable() const {
+	return available;
+}
+
 void D300Device::loop() {
 
 	// Check for D300 availability, if required (mainly at startup)
@@ -25,6 +25,7 @@
 #include <EEPROMHelper.h>
 #include <GlobalHalHandlers.h>
 #include <string.h>
+#include <new>
 
 
 #define MEM24AA256_ADDRESS 0xA0
@@ -104,14 +105,14 @@ void EEPROMHelper::mainLoop() {
 
 bool EEPROMHelper::pushRequest(unsigned short address, unsigned char* pData, unsigned char size) {
 
-	datapacket* newItem = new datapacket();
+	datapacket* newItem = new (std::nothrow) datapacket();
 	if (newItem == NULL) {
 		return false;
 	}
 
 	newItem->address = address;
 	newItem->size = size;
-	newItem->pData = new unsigned char[size];
+	newItem->pData = new (std::nothrow) unsigned char[size];
 	newItem->nextItem = NULL;
 	if (newItem->pData == NULL) {
 		delete newItem;
@@ -39,6 +39,8 @@
 #include "CCDriveEngine.h"
 #include "TControlEngine.h"
 #include "IntChamberTempRef.h"
+#include "ProfilerHelper.h"
+#include "MemoryHelper.h"
 
 #include "../ASInc/Persistence.h"
 #include "SensorsArray.h"
@@ -46,9 +48,12 @@
 SensorsArray* sensorBoard;
 CommProtocol* commProtocol;
 SensorBusWrapper *sensorBusProtocol;
+bool bringUpCompleted = false;
 
 void timerInterrupt() {
 
+    unsigned long profilerStart = AS_PROFILER.begin();
+
     if (sensorBoard) {
         sensorBoard->timerTick();
     }
@@ -63,6 +68,8 @@ void timerInterrupt() {
     EEPROM.tick();
     AS_INTCH_TEMPREF.tick();
     AS_TCONTROL.tick();
+
+    AS_PROFILER.end(PROFILER_STAGE_TIMER_ISR, profilerStart);
 }
 
 void uart1Interrupt(unsigned char halfBuffer) {
@@ -105,17 +112,21 @@ void usbRxCallback(unsigned char* buffer, long bufferLen) {
 	LEDs.pulse(LEDsHelper::RXDATA);
 }
 
-void adcCallback() {
+void adcCallback(unsigned char halfBuffer) {
+	unsigned long profilerStart = AS_PROFILER.begin();
+
 	// Propagate to IntADCDevice and update the constant current diver with
 	// measured DC current flowing on the Peltier cell
-	unsigned short ccCurrentDrive = IntADDevice::getInstance()->onADCScanTerminated();
+	unsigned short ccCurrentDrive = IntADDevice::getInstance()->onADCScanTerminated(halfBuffer!=0);
 	AS_CCDRIVER.tick(ccCurrentDrive);
+
+	AS_PROFILER.end(PROFILER_STAGE_ADC_ISR, profilerStart);
 }
 
 void setup_impl() {
 
-    // Wait for external peripheral hardware stabilization
-    HAL_Delay(500);
+    // Prepare the stack usage watermark
+    AS_MEMORY.init();
 
     // Initialize LEDs
 	LEDs.init();
@@ -124,7 +135,8 @@ void setup_impl() {
     SerialA.init();
     SerialB.init();
 
-    // Instantiate and initialize the main objects
+    // Instantiate and initialize the main objects. Sensor devices bring-up
+    // runs asynchronously in the main loop.
     sensorBoard = new SensorsArray();
     commProtocol = new CommProtocol(sensorBoard);
     sensorBusProtocol = new SensorBusWrapper(commProtocol);
@@ -137,74 +149,93 @@ void setup_impl() {
     // Initialize the tick timer
     HAL_TIM_Base_Start_IT(&htim7);
 
-    // Initialize the A/D converter timer
+    // Initialize the A/D converter timer. The scan rate is set here,
+    // over the generated TMR3 initialization
+    __HAL_TIM_SET_AUTORELOAD(&htim3, INTAD_SCAN_TIMER_RELOAD);
     HAL_TIM_Base_Start_IT(&htim3);
 
-    // Initialize the sensor board items
-    if (!sensorBoard->init()) {
-    	LEDs.pulse(LEDsHelper::HEARTBEAT);
-    	LEDs.pulse(LEDsHelper::TXDATA);
-    	LEDs.pulse(LEDsHelper::RXDATA);
-    }
-
-    // Signal we detected the external temperature/humidity flyboard
-    if (sensorBoard->getIsFlyboardReady()) {
-    	LEDs.pulse(LEDsHelper::HEARTBEAT);
-    }
-
-    // Enable current driver and temperature control PIDs
-    AS_CCDRIVER.setEnabled(true);
-    AS_TCONTROL.setEnabled(true);
-
     // Signal we're ready
     LEDs.pulse(LEDsHelper::TXDATA);
 }
 
 void loop_impl() {
 
+    unsigned long loopStart = AS_PROFILER.begin();
+
     // Propagate to the sensor array
+    unsigned long profilerStart = loopStart;
     bool newSample = sensorBoard->loop();
+    AS_PROFILER.end(PROFILER_STAGE_SENSORSARRAY, profilerStart);
 
     // Heartbeat led
     if (newSample) {
         LEDs.pulse(LEDsHelper::HEARTBEAT);
     }
 
+    // Start the temperature control as soon as the devices bring-up terminates
+    if (!bringUpCompleted && sensorBoard->isBringUpCompleted()) {
+    	bringUpCompleted = true;
+
+    	// Signal missing mainboard devices
+    	if (!sensorBoard->getIsMainboardReady()) {
+    		LEDs.pulse(LEDsHelper::HEARTBEAT);
+    		LEDs.pulse(LEDsHelper::TXDATA);
+    		LEDs.pulse(LEDsHelper::RXDATA);
+    	}
+
+    	// Signal we detected the external temperature/humidity flyboard
+    	if (sensorBoard->getIsFlyboardReady()) {
+    		LEDs.pulse(LEDsHelper::HEARTBEAT);
+    	}
+
+    	// Enable current driver and temperature control PIDs
+    	AS_CCDRIVER.setEnabled(true);
+    	AS_TCONTROL.setEnabled(true);
+    }
+
     // Handle the serial line A (PtP protocol)
+    profilerStart = AS_PROFILER.begin();
     if (SerialA.available()) {
         unsigned char val = SerialA.read();
         commProtocol->onDataReceived(val, CommProtocol::SOURCE_SERIAL);
     }
+    AS_PROFILER.end(PROFILER_STAGE_SERIALA, profilerStart);
 
     // Handle the serial line B (SensorBus)
+    profilerStart = AS_PROFILER.begin();
     if (SerialB.available()) {
     		unsigned char val = SerialB.read();
     		sensorBusProtocol->onDataReceived(val);
     }
+    AS_PROFILER.end(PROFILER_STAGE_SERIALB, profilerStart);
 
     // Handle the serial line through USB
+    profilerStart = AS_PROFILER.begin();
     if (SerialUSB.available()) {
     		unsigned char val = SerialUSB.read();
     		commProtocol->onDataReceived(val, CommProtocol::SOURCE_USB);
     }
+    AS_PROFILER.end(PROFILER_STAGE_SERIALUSB, profilerStart);
 
     // Handle the EEPROM delayed write operations
+    profilerStart = AS_PROFILER.begin();
     EEPROM.mainLoop();
+    AS_PROFILER.end(PROFILER_STAGE_EEPROM, profilerStart);
 
     // Retrieve current internal chamber setpoint and temperature
     short currentChamberSetpoint, currentChamberTemperature;
     AS_INTCH_TEMPREF.getChamberSetpointAndTemperature(currentChamberSetpoint, currentChamberTemperature);
 
     // Handle the Temperature controller engine
+    profilerStart = AS_PROFILER.begin();
     AS_TCONTROL.setTemperatureSetpoint(currentChamberSetpoint);
     AS_TCONTROL.loop(currentChamberTemperature);
-
-    // Handle the constant current generator engine
-    AS_CCDRIVER.loop();
+    AS_PROFILER.end(PROFILER_STAGE_TCONTROL, profilerStart);
 
     // Check for user button status
     if (AS_GPIO.digitalRead(USER_BUTTONPIN) == 0) {
     		LEDs.enable(true);
     }
-}
 
+    AS_PROFILER.end(PROFILER_STAGE_LOOP, loopStart);
+}
@@ -55,3 +55,8 @@ void FixedRateSampler::setDecimation(unsigned char value) {
 		Sampler::setDecimation(value);
 	}
 }
+
+// Avoid changing the timebase in lifetime: the fixed prescaler
+// is relative to the default timebase
+void FixedRateSampler::setTimebase(unsigned short ticks) {
+}
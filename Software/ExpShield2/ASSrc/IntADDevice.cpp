@@ -27,14 +27,20 @@
 #include "GlobalHalHandlers.h"
 
 
+// Factory calibration values in the system memory. The host simulation HAL
+// provides its own locations
+#ifndef TEMP30_CAL_ADDR
 #define TEMP30_CAL_ADDR  ((uint16_t*) ((uint32_t)0x1FFFF7B8))
+#endif
+#ifndef VREFINT_CAL
 #define VREFINT_CAL      ((uint16_t*) ((uint32_t)0x1FFFF7BA))
-#define VREFINT_DATA	 (adcDmaBuffer[INTAD_CHANNEL_VREFINT])
+#endif
+#define VREFINT_DATA	 (adcData[INTAD_CHANNEL_VREFINT])
 #define VDD_CALIB		 ((uint32_t) 3300)
 #define AVG_SLOPE		 ((uint32_t) 5336) 		/* See A.7.16 in RM0360 STM document */
 
-#define MAX_V_FOR_CC	 1.8
-#define MAX_RAWADC_FOR_CC 	(MAX_V_FOR_CC * 4095 / VDDA) // 2233
+#define MAX_DV_FOR_CC	 ((uint32_t) 18)		/* 1.8V full scale, in 1/10 V */
+#define VDD_CALIB_DV	 (VDD_CALIB / 100)
 
 #define VCHANNEL(ADC_DATA) ((VREFINT_DATA != 0)? ((3.3f * (*VREFINT_CAL) * (ADC_DATA)) / (VREFINT_DATA * 4095)) : 0.0f)
 #define VDDA 			   ((VREFINT_DATA != 0)? (3.3f * (((float)(*VREFINT_CAL)) / VREFINT_DATA)) : 0)
@@ -87,11 +93,11 @@ bool IntADDevice::init() {
 
 	// Initialize the DMA buffer with something valid, to avoid
 	// wrong measurements at the very first sample
-	adcDmaBuffer[INTAD_CHANNEL_PLT_VFBK] = 0;
-	adcDmaBuffer[INTAD_CHANNEL_PLT_CFBK] = 0;
-	adcDmaBuffer[INTAD_CHANNEL_VIN_FBK] = 0;
-	adcDmaBuffer[INTAD_CHANNEL_VREFINT] = *VREFINT_CAL;
-	adcDmaBuffer[INTAD_CHANNEL_TEMPERATURE] = *TEMP30_CAL_ADDR;
+	adcData[INTAD_CHANNEL_PLT_VFBK] = 0;
+	adcData[INTAD_CHANNEL_PLT_CFBK] = 0;
+	adcData[INTAD_CHANNEL_VIN_FBK] = 0;
+	adcData[INTAD_CHANNEL_VREFINT] = *VREFINT_CAL;
+	adcData[INTAD_CHANNEL_TEMPERATURE] = *TEMP30_CAL_ADDR;
 
 	if (HAL_ADCEx_Calibration_Start(&hadc) == HAL_OK) {
 		return (HAL_ADC_Start_DMA(&hadc, (uint32_t*)adcDmaBuffer, ADC_DMA_BUFFER_SIZE) == HAL_OK);
@@ -107,10 +113,10 @@ void IntADDevice::loop() {
 		samplesAvailable = false;
 		go = false;
 
-		setSample(INTAD_CHANNEL_PLT_VFBK, adcDmaBuffer[INTAD_CHANNEL_PLT_VFBK]);
-		setSample(INTAD_CHANNEL_PLT_CFBK, adcDmaBuffer[INTAD_CHANNEL_PLT_CFBK]);
-		setSample(INTAD_CHANNEL_VIN_FBK, adcDmaBuffer[INTAD_CHANNEL_VIN_FBK]);
-		setSample(INTAD_CHANNEL_TEMPERATURE, adcDmaBuffer[INTAD_CHANNEL_TEMPERATURE]);
+		setSample(INTAD_CHANNEL_PLT_VFBK, adcData[INTAD_CHANNEL_PLT_VFBK]);
+		setSample(INTAD_CHANNEL_PLT_CFBK, adcData[INTAD_CHANNEL_PLT_CFBK]);
+		setSample(INTAD_CHANNEL_VIN_FBK, adcData[INTAD_CHANNEL_VIN_FBK]);
+		setSample(INTAD_CHANNEL_TEMPERATURE, adcData[INTAD_CHANNEL_TEMPERATURE]);
 	}
 
 	// This is true for the very first time the loop enters after power on.
@@ -209,20 +215,39 @@ void IntADDevice::triggerSample() {
 	go = true;
 }
 
-// Called each time DMA terminates a transaction.
-// This is done 10 times each second (A/D conversion is triggered by the TMR3 timer)
+// Called each time DMA fills half of the buffer.
+// This is done 250 times each second (A/D conversion is triggered by the TMR3 timer
+// each millisecond and INTAD_OVERSAMPLING scans are averaged for each buffer half)
 // NOTE: the A/D converter sampling frequency is higher than what is shown in the
 // reporting channels. This is because we use the "DC current" feedback channel to properly
 // tune the PWM duty cycle in the constant current power supply for the Peltier cell.
 // This function returns the strength percentage (in 1/100 units) of the
 // current flowing in the constant current generator. 100% is supposed for 6A
-unsigned short IntADDevice::onADCScanTerminated() {
+// It runs in the DMA interrupt, so only integer math is used here
+unsigned short IntADDevice::onADCScanTerminated(bool halfBuffer) {
+
+	// The first half has been filled while DMA is now writing to the second one, and vice versa
+	const unsigned short* scan = adcDmaBuffer + (halfBuffer? 0 : ADC_DMA_HALFBUFFER_SIZE);
+
+	uint32_t sum[INTAD_NUM_OF_CHANNELS] = { 0 };
+	for (unsigned char n = 0; n < INTAD_OVERSAMPLING; n++) {
+		for (unsigned char channel = 0; channel < INTAD_NUM_OF_CHANNELS; channel++) {
+			sum[channel] += *scan++;
+		}
+	}
+
+	for (unsigned char channel = 0; channel < INTAD_NUM_OF_CHANNELS; channel++) {
+		adcData[channel] = sum[channel] / INTAD_OVERSAMPLING;
+	}
 
 	samplesAvailable = true;
 
-	unsigned short acRaw = adcDmaBuffer[INTAD_CHANNEL_PLT_CFBK];
-	unsigned short maxRaw = MAX_RAWADC_FOR_CC;
-	unsigned short result = ((float)acRaw / maxRaw) * 10000;
+	// Full scale raw value for the current feedback, compensated with the
+	// measured VDDA and accumulated on all the oversampled scans (about 2233 each)
+	uint32_t maxRawSum = (MAX_DV_FOR_CC * 4095 * sum[INTAD_CHANNEL_VREFINT]) / (VDD_CALIB_DV * (*VREFINT_CAL));
+	if (maxRawSum == 0) {
+		return 0;
+	}
 
-	return result;
+	return (sum[INTAD_CHANNEL_PLT_CFBK] * 10000) / maxRawSum;
 }
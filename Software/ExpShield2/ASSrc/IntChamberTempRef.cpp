@@ -24,6 +24,7 @@
 
 #include "IntChamberTempRef.h"
 #include "ADT7470Device.h"
+#include "TControlEngine.h"
 
 IntChamberTempRef IntChamberTempRef::instance;
 
@@ -32,6 +33,24 @@ IntChamberTempRef IntChamberTempRef::instance;
 #define MAX_TEMP_VALID_FOR_CHAMBER			 5500	/* In 1/100 C */
 #define INTCHAMBER_TEMPREF_ENGINE_PERIOD	 99		/* Once a second */
 
+#define ESTIMATOR_ONE						 256L	/* Fixed point unit for temperature and rate */
+#define ESTIMATOR_PROCESS_VARIANCE			 4		/* In (1/100 C)^2 per second */
+#define ESTIMATOR_MAX_VARIANCE				 30000	/* In (1/100 C)^2 */
+#define ESTIMATOR_AGE_DRIFT					 2		/* In 1/100 C per second of sample age */
+#define ESTIMATOR_RATE_DIVIDER				 8		/* Unmodeled rate learning gain (1/8) */
+#define ESTIMATOR_MAX_RATE					 50		/* In 1/100 C per second */
+#define ESTIMATOR_HEATING_RATE				 5		/* In 1/100 C per second at full heating drive */
+#define ESTIMATOR_COOLING_RATE				 3		/* In 1/100 C per second at full cooling drive */
+
+// Measurement noise variance for each source, in (1/100 C)^2
+static const long sourceVariance[IntChamberTempRef::SOURCE_FUSED] = {
+		25,		/* SHT31 internal */
+		100,	/* ADT7470 */
+		225,	/* K96 NTC0 */
+		225,	/* K96 NTC1 */
+		100		/* K96 RH sensor */
+};
+
 /*
  * This class is responsible to provide the internal temperature based
  * on the user choice (set via an external command). The default is to
@@ -44,11 +63,16 @@ IntChamberTempRef IntChamberTempRef::instance;
  * ADT7470 IC.
  */
 IntChamberTempRef::IntChamberTempRef() :
-	curSource(SOURCE_ADT7470_T_INT_CHAMBER), setpoint(2500), prescaler(0) {
+	curSource(SOURCE_ADT7470_T_INT_CHAMBER), setpoint(2500), prescaler(0), go(false) {
 
-	for (unsigned char n = 0; n < (unsigned char) SOURCE_FIRST_INVALID; n++) {
+	for (unsigned char n = 0; n < (unsigned char) SOURCE_FUSED; n++) {
 		curTemperatures[n].timeout = MAX_TIMEOUT_VALUE_FOR_CHANNEL + 1;
 	}
+
+	estimate.valid = false;
+	estimate.value = 0;
+	estimate.rate = 0;
+	estimate.variance = ESTIMATOR_MAX_VARIANCE;
 }
 
 IntChamberTempRef::~IntChamberTempRef() {
@@ -68,7 +92,7 @@ void IntChamberTempRef::setSetpoint(short _setpoint) {
  * Temperature is expressed in 1/100 C */
 void IntChamberTempRef::setReadTemperature(source _source, short temperature) {
 
-	if (_source < SOURCE_FIRST_INVALID) {
+	if (_source < SOURCE_FUSED) {
 		curTemperatures[_source].value = temperature;
 		curTemperatures[_source].timeout = 0;
 	}
@@ -85,6 +109,26 @@ void IntChamberTempRef::getChamberSetpointAndTemperature(short& _setpoint, short
 	if (curSource >= SOURCE_FIRST_INVALID) {
 		curSource = SOURCE_ADT7470_T_INT_CHAMBER;
 	}
+
+	// The fused estimate is updated each second. It falls back to the
+	// ADT7470 when no source has been updated recently
+	if (curSource == SOURCE_FUSED) {
+		if (go) {
+			go = false;
+			estimate.valid = updateEstimate();
+		}
+
+		if (estimate.valid) {
+			temperature = (short)(estimate.value / ESTIMATOR_ONE);
+		} else {
+			temperature = AS_ADT7470.getChamberTemperature();
+		}
+		return;
+	}
+
+	// The estimate restarts from the measurements when the fused source is selected again
+	estimate.valid = false;
+
 	bool fallback = (curTemperatures[curSource].timeout > MAX_TIMEOUT_VALUE_FOR_CHANNEL) &&
 						checkTemperatureRange(curTemperatures[curSource].value);
 
@@ -104,8 +148,9 @@ void IntChamberTempRef::tick() {
 	prescaler++;
 	if (prescaler > INTCHAMBER_TEMPREF_ENGINE_PERIOD) {
 		prescaler = 0;
+		go = true;
 
-		for (unsigned char n = 0; n < (unsigned char) SOURCE_FIRST_INVALID; n++) {
+		for (unsigned char n = 0; n < (unsigned char) SOURCE_FUSED; n++) {
 			if (curTemperatures[n].timeout <= MAX_TIMEOUT_VALUE_FOR_CHANNEL) {
 				curTemperatures[n].timeout++;
 			}
@@ -120,3 +165,79 @@ bool IntChamberTempRef::checkTemperatureRange(short temperature) {
 
 	return (temperature >= MIN_TEMP_VALID_FOR_CHAMBER) && (temperature <= MAX_TEMP_VALID_FOR_CHAMBER);
 }
+
+/* One second step of a scalar Kalman filter fusing all the chamber
+ * temperature sources. The temperature is predicted from the heater/cooler
+ * drive plus a learned rate for the unmodeled heat exchange (the
+ * correction applied by the measurements). Each source is weighted by its
+ * noise and by its sample age. Returns false when no valid source is available.
+ */
+bool IntChamberTempRef::updateEstimate() {
+
+	// Check for available sources and take the freshest as initial value
+	bool available = false;
+	unsigned char freshest = 0;
+	for (unsigned char n = 0; n < (unsigned char) SOURCE_FUSED; n++) {
+		if ((curTemperatures[n].timeout <= MAX_TIMEOUT_VALUE_FOR_CHANNEL) && checkTemperatureRange(curTemperatures[n].value)) {
+			if (!available || (curTemperatures[n].timeout < curTemperatures[freshest].timeout)) {
+				freshest = n;
+			}
+			available = true;
+		}
+	}
+
+	if (!available) {
+		return false;
+	}
+
+	if (!estimate.valid) {
+		estimate.value = (long)curTemperatures[freshest].value * ESTIMATOR_ONE;
+		estimate.rate = 0;
+		estimate.variance = sourceVariance[freshest];
+	}
+
+	// Predict from the drive actually applied, in 1/100 % (heating when positive)
+	long drive = AS_TCONTROL.getAppliedDrive();
+	long driveRate = (drive >= 0)? ESTIMATOR_HEATING_RATE : ESTIMATOR_COOLING_RATE;
+	long predicted = estimate.value + estimate.rate + (drive * driveRate * ESTIMATOR_ONE) / 10000;
+
+	estimate.variance += ESTIMATOR_PROCESS_VARIANCE;
+	if (estimate.variance > ESTIMATOR_MAX_VARIANCE) {
+		estimate.variance = ESTIMATOR_MAX_VARIANCE;
+	}
+
+	// Correct with each valid source
+	long value = predicted;
+	for (unsigned char n = 0; n < (unsigned char) SOURCE_FUSED; n++) {
+
+		short age = curTemperatures[n].timeout;
+		if ((age > MAX_TIMEOUT_VALUE_FOR_CHANNEL) || !checkTemperatureRange(curTemperatures[n].value)) {
+			continue;
+		}
+
+		long drift = ESTIMATOR_AGE_DRIFT * age;
+		long variance = sourceVariance[n] + drift * drift;
+
+		// Gain in 1/65536 units
+		long gain = (estimate.variance << 16) / (estimate.variance + variance);
+		long innovation = ((long)curTemperatures[n].value * ESTIMATOR_ONE) - value;
+
+		value += (long)(((long long)gain * innovation) >> 16);
+		estimate.variance = (long)(((long long)estimate.variance * (65536 - gain)) >> 16);
+		if (estimate.variance < 1) {
+			estimate.variance = 1;
+		}
+	}
+
+	// Learn the unmodeled rate from the applied correction
+	estimate.rate += (value - predicted) / ESTIMATOR_RATE_DIVIDER;
+	if (estimate.rate > (ESTIMATOR_MAX_RATE * ESTIMATOR_ONE)) {
+		estimate.rate = (ESTIMATOR_MAX_RATE * ESTIMATOR_ONE);
+	} else if (estimate.rate < -(ESTIMATOR_MAX_RATE * ESTIMATOR_ONE)) {
+		estimate.rate = -(ESTIMATOR_MAX_RATE * ESTIMATOR_ONE);
+	}
+
+	estimate.value = value;
+
+	return true;
+}
@@ -0,0 +1,193 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *			European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#include "MemoryHelper.h"
+#include "stm32f0xx_hal.h"
+#include "main.h"
+#include <stdlib.h>
+#include <malloc.h>
+#include <new>
+
+#define STACK_PAINT_PATTERN		0xA5A5A5A5
+#define STACK_PAINT_GUARD		64			/* Bytes below the current stack pointer left untouched */
+
+// Provided by the linker script and the system memory support
+extern "C" unsigned long _estack;
+extern "C" void* _sbrk(ptrdiff_t incr);
+
+// newlib-nano allocator free list (see nano-mallocr.c). Chunk sizes include
+// the size field itself, which precedes the memory returned by malloc.
+typedef struct _mallocchunk {
+	long size;
+	struct _mallocchunk* next;
+} mallocchunk;
+
+extern "C" mallocchunk* __malloc_free_list;
+
+MemoryHelper MemoryHelper::instance;
+
+// Route all dynamic allocations through the telemetry.
+// Exceptions are not available on this target, so the throwing forms never
+// return on failure; the nothrow forms can be used where a failure is handled.
+void* operator new(size_t size) {
+	return AS_MEMORY.allocate(size, true);
+}
+
+void* operator new[](size_t size) {
+	return AS_MEMORY.allocate(size, true);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+	return AS_MEMORY.allocate(size, false);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+	return AS_MEMORY.allocate(size, false);
+}
+
+void operator delete(void* ptr) noexcept {
+	AS_MEMORY.release(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+	AS_MEMORY.release(ptr);
+}
+
+MemoryHelper::MemoryHelper() {
+}
+
+MemoryHelper::~MemoryHelper() {
+}
+
+void MemoryHelper::init() {
+
+	unsigned long* bottom = getHeapTop();
+	unsigned long* top = (unsigned long*)(__get_MSP() - STACK_PAINT_GUARD);
+	while (bottom < top) {
+		*bottom++ = STACK_PAINT_PATTERN;
+	}
+}
+
+void* MemoryHelper::allocate(size_t size, bool mustSucceed) {
+
+	while (true) {
+		void* ptr = malloc((size != 0)? size : 1);
+		if (ptr) {
+			allocations++;
+			return ptr;
+		}
+
+		failures++;
+		if (!mustSucceed) {
+			return NULL;
+		}
+
+		// Give the new handler a chance to release some memory, then retry
+		std::new_handler handler = std::get_new_handler();
+		if (handler) {
+			handler();
+		} else {
+			Error_Handler();
+		}
+	}
+}
+
+void MemoryHelper::release(void* ptr) {
+
+	if (ptr) {
+		releases++;
+		free(ptr);
+	}
+}
+
+unsigned long MemoryHelper::getFreeMemory() const {
+
+	struct mallinfo info = mallinfo();
+	unsigned long* heapTop = getHeapTop();
+	unsigned long* stackPointer = (unsigned long*)__get_MSP();
+	unsigned long gap = (stackPointer > heapTop)? (unsigned long)stackPointer - (unsigned long)heapTop : 0;
+
+	return gap + info.fordblks;
+}
+
+void MemoryHelper::getHeapStats(unsigned long* heapSize, unsigned long* heapInUse,
+							unsigned long* heapFree, unsigned long* largestFree) const {
+
+	struct mallinfo info = mallinfo();
+	unsigned long* heapTop = getHeapTop();
+	unsigned long* stackDeepest = getStackDeepest();
+	unsigned long untouchedGap = (stackDeepest > heapTop)? (unsigned long)stackDeepest - (unsigned long)heapTop : 0;
+	unsigned long largestChunk = getLargestFreeChunk();
+
+	*heapSize = info.arena;
+	*heapInUse = info.uordblks;
+	*heapFree = info.fordblks;
+	*largestFree = (largestChunk > untouchedGap)? largestChunk : untouchedGap;
+}
+
+void MemoryHelper::getAllocStats(unsigned long* allocations, unsigned long* releases, unsigned long* failures) const {
+
+	*allocations = this->allocations;
+	*releases = this->releases;
+	*failures = this->failures;
+}
+
+unsigned long MemoryHelper::getStackMaxUsed() const {
+	return (unsigned long)&_estack - (unsigned long)getStackDeepest();
+}
+
+// Largest request the heap can satisfy without growing (in bytes).
+// The free list is walked with the allocator locked, as mallinfo() does
+unsigned long MemoryHelper::getLargestFreeChunk() const {
+
+	unsigned long largest = 0;
+
+	__malloc_lock(_REENT);
+	for (mallocchunk* chunk = __malloc_free_list; chunk; chunk = chunk->next) {
+		unsigned long available = (unsigned long)chunk->size - sizeof(chunk->size);
+		if (available > largest) {
+			largest = available;
+		}
+	}
+	__malloc_unlock(_REENT);
+
+	return largest;
+}
+
+// Current heap top, word aligned
+unsigned long* MemoryHelper::getHeapTop() const {
+	return (unsigned long*)(((unsigned long)_sbrk(0) + 3) & ~0x03UL);
+}
+
+// Scan the painted area from the heap top: the first overwritten word
+// is the deepest location reached by the stack
+unsigned long* MemoryHelper::getStackDeepest() const {
+
+	unsigned long* location = getHeapTop();
+	while ((location < &_estack) && (*location == STACK_PAINT_PATTERN)) {
+		location++;
+	}
+
+	return location;
+}
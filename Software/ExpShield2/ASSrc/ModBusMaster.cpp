@@ -0,0 +1,339 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#include "ModBusMaster.h"
+#include "SerialHelper.h"
+#include <string.h>
+
+#define MODBUS_CRC_INITVAL			0xFFFF
+#define MODBUS_CRC_LENGTH			2
+#define MODBUS_CHAR_BITS			11		/* Start, 8 data, parity/stop, stop */
+#define MODBUS_FIXED_SILENCE_BAUD	19200	/* Above this rate the silence is fixed */
+#define MODBUS_FIXED_SILENCE_MS		2		/* 1.75ms, rounded up */
+
+// ROM table for CRC calculation speedup
+// It was left global to avoid ROM to RAM copy at runtime by the compiler,
+// due to the heap allocation of the objects using the engine. A suitable static
+// reference pointer in the ModBusMaster class is initialized below.
+const unsigned short _modBusCrcTable[] = {
+	0x0000,	0xc0c1, 0xc181, 0x0140, 0xc301, 0x03c0, 0x0280, 0xc241,
+	0xc601, 0x06c0, 0x0780, 0xc741, 0x0500, 0xc5c1, 0xc481, 0x0440,
+	0xcc01, 0x0cc0, 0x0d80, 0xcd41, 0x0f00, 0xcfc1, 0xce81, 0x0e40,
+	0x0a00, 0xcac1, 0xcb81, 0x0b40, 0xc901, 0x09c0, 0x0880, 0xc841,
+	0xd801, 0x18c0, 0x1980, 0xd941, 0x1b00, 0xdbc1, 0xda81, 0x1a40,
+	0x1e00, 0xdec1, 0xdf81, 0x1f40, 0xdd01, 0x1dc0, 0x1c80, 0xdc41,
+	0x1400, 0xd4c1, 0xd581, 0x1540, 0xd701, 0x17c0, 0x1680, 0xd641,
+	0xd201, 0x12c0, 0x1380, 0xd341, 0x1100, 0xd1c1, 0xd081, 0x1040,
+	0xf001, 0x30c0, 0x3180, 0xf141, 0x3300, 0xf3c1, 0xf281, 0x3240,
+	0x3600, 0xf6c1, 0xf781, 0x3740, 0xf501, 0x35c0, 0x3480, 0xf441,
+	0x3c00, 0xfcc1, 0xfd81, 0x3d40, 0xff01, 0x3fc0, 0x3e80, 0xfe41,
+	0xfa01, 0x3ac0, 0x3b80, 0xfb41, 0x3900, 0xf9c1, 0xf881, 0x3840,
+	0x2800, 0xe8c1, 0xe981, 0x2940, 0xeb01, 0x2bc0, 0x2a80, 0xea41,
+	0xee01, 0x2ec0, 0x2f80, 0xef41, 0x2d00, 0xedc1, 0xec81, 0x2c40,
+	0xe401, 0x24c0, 0x2580, 0xe541, 0x2700, 0xe7c1, 0xe681, 0x2640,
+	0x2200, 0xe2c1, 0xe381, 0x2340, 0xe101, 0x21c0, 0x2080, 0xe041,
+	0xa001, 0x60c0, 0x6180, 0xa141, 0x6300, 0xa3c1, 0xa281, 0x6240,
+	0x6600, 0xa6c1, 0xa781, 0x6740, 0xa501, 0x65c0, 0x6480, 0xa441,
+	0x6c00, 0xacc1, 0xad81, 0x6d40, 0xaf01, 0x6fc0, 0x6e80, 0xae41,
+	0xaa01, 0x6ac0, 0x6b80, 0xab41, 0x6900, 0xa9c1, 0xa881, 0x6840,
+	0x7800, 0xb8c1, 0xb981, 0x7940, 0xbb01, 0x7bc0, 0x7a80, 0xba41,
+	0xbe01, 0x7ec0, 0x7f80, 0xbf41, 0x7d00, 0xbdc1, 0xbc81, 0x7c40,
+	0xb401, 0x74c0, 0x7580, 0xb541, 0x7700, 0xb7c1, 0xb681, 0x7640,
+	0x7200, 0xb2c1, 0xb381, 0x7340, 0xb101, 0x71c0, 0x7080, 0xb041,
+	0x5000, 0x90c1, 0x9181, 0x5140, 0x9301, 0x53c0, 0x5280, 0x9241,
+	0x9601, 0x56c0, 0x5780, 0x9741, 0x5500, 0x95c1, 0x9481, 0x5440,
+	0x9c01, 0x5cc0, 0x5d80, 0x9d41, 0x5f00, 0x9fc1, 0x9e81, 0x5e40,
+	0x5a00, 0x9ac1, 0x9b81, 0x5b40, 0x9901, 0x59c0, 0x5880, 0x9841,
+	0x8801, 0x48c0, 0x4980, 0x8941, 0x4b00, 0x8bc1, 0x8a81, 0x4a40,
+	0x4e00, 0x8ec1, 0x8f81, 0x4f40, 0x8d01, 0x4dc0, 0x4c80, 0x8c41,
+	0x4400, 0x84c1, 0x8581, 0x4540, 0x8701, 0x47c0, 0x4680, 0x8641,
+	0x8201, 0x42c0, 0x4380, 0x8341, 0x4100, 0x81c1, 0x8081, 0x4040
+};
+
+// This pointer is not really needed but is introduced to maintain a good C++ programming style
+const unsigned short* ModBusMaster::crcTable = _modBusCrcTable;
+
+ModBusMaster::ModBusMaster(SerialHelper* const serialLine, unsigned long baudRate, unsigned char timeout) :
+						serial(serialLine), responseTimeout(timeout),
+						queueHead(0), queueCount(0), waitingAnswer(false),
+						rxStatus(RX_IDLE), rxCRC(MODBUS_CRC_INITVAL), rxOffset(0), rxRemaining(0), rxException(false),
+						responseTimer(0), lastFrameTime(0) {
+
+	// Frames must be separated by at least 3.5 characters
+	if (baudRate > MODBUS_FIXED_SILENCE_BAUD) {
+		silenceTime = MODBUS_FIXED_SILENCE_MS;
+	} else {
+		silenceTime = ((35UL * MODBUS_CHAR_BITS * 1000UL) / (10UL * baudRate)) + 1;
+	}
+}
+
+ModBusMaster::~ModBusMaster() {
+}
+
+// Some slaves require a longer turnaround time than the standard inter-frame silence
+void ModBusMaster::setTurnaroundDelay(unsigned char delayMs) {
+	if (delayMs > silenceTime) {
+		silenceTime = delayMs;
+	}
+}
+
+bool ModBusMaster::readInputRegisters(unsigned char slave, unsigned short address, unsigned char numRegisters,
+									unsigned char retries, completionhandler handler, void* context) {
+
+	unsigned char data[] = { (unsigned char)((address>>8) & 0xFF), (unsigned char)(address & 0xFF), 0x00, numRegisters };
+
+	return request(slave, MODBUS_FC_READ_INPUTREG, data, sizeof(data), MODBUS_REPLY_BYTECOUNT, retries, handler, context);
+}
+
+// Enqueue a generic request. replyDataLen is the expected answer data length (CRC excluded),
+// or MODBUS_REPLY_BYTECOUNT if the answer carries a byte count field
+bool ModBusMaster::request(unsigned char slave, unsigned char functionCode, const unsigned char* data, unsigned char dataLen,
+							unsigned char replyDataLen, unsigned char retries, completionhandler handler, void* context) {
+
+	if ((queueCount == MODBUS_QUEUE_LENGTH) || (dataLen > MODBUS_MAX_REQUEST_DATA) ||
+			((replyDataLen != MODBUS_REPLY_BYTECOUNT) && (replyDataLen > MODBUS_RX_BUFFERLENGTH))) {
+		return false;
+	}
+
+	transaction* item = &queue[(queueHead + queueCount) % MODBUS_QUEUE_LENGTH];
+	item->slave = slave;
+	item->functionCode = functionCode;
+	memcpy(item->data, data, dataLen);
+	item->dataLen = dataLen;
+	item->replyDataLen = replyDataLen;
+	item->retries = retries;
+	item->handler = handler;
+	item->context = context;
+
+	queueCount++;
+
+	return true;
+}
+
+// Drop all pending transactions, completing them with RESULT_ABORTED.
+// Requests enqueued by the handlers while flushing are preserved
+void ModBusMaster::flush() {
+
+	// A late answer to the transaction in progress must not overlap the next request
+	if (waitingAnswer) {
+		lastFrameTime = HAL_GetTick();
+	}
+	waitingAnswer = false;
+	rxStatus = RX_IDLE;
+
+	for (unsigned char pending = queueCount; pending != 0; pending--) {
+
+		completionhandler handler = queue[queueHead].handler;
+		void* context = queue[queueHead].context;
+
+		queueHead = (queueHead + 1) % MODBUS_QUEUE_LENGTH;
+		queueCount--;
+
+		if (handler) {
+			handler(context, RESULT_ABORTED, rxBuffer, 0);
+		}
+	}
+}
+
+bool ModBusMaster::isIdle() const {
+	return (queueCount == 0);
+}
+
+void ModBusMaster::loop() {
+
+	if (waitingAnswer) {
+
+		// Consume all the incoming data available
+		if (serial->available()) {
+			while (waitingAnswer && serial->dataReady()) {
+				onDataReceived(serial->getByte());
+			}
+		}
+
+		// Answer timeout
+		if (waitingAnswer && (responseTimer > responseTimeout)) {
+			if (queue[queueHead].retries != 0) {
+				queue[queueHead].retries--;
+				waitingAnswer = false;
+				lastFrameTime = HAL_GetTick();
+			} else {
+				complete(RESULT_TIMEOUT);
+			}
+		}
+	}
+
+	// Send the next request after the inter-frame silence
+	if (!waitingAnswer && (queueCount != 0) && ((HAL_GetTick() - lastFrameTime) >= silenceTime)) {
+		sendRequest();
+	}
+}
+
+// Called externally at 0.01s period
+void ModBusMaster::tick() {
+	if (waitingAnswer) {
+		responseTimer++;
+	}
+}
+
+unsigned short ModBusMaster::crcUpdate(unsigned short crc, unsigned char data) {
+	return (crc >> 8) ^ crcTable[(crc ^ data) & 0x00FF];
+}
+
+void ModBusMaster::sendRequest() {
+
+	transaction* item = &queue[queueHead];
+	unsigned char txBuf[MODBUS_MAX_REQUEST_DATA + 4];
+	unsigned char len = 0;
+
+	txBuf[len++] = item->slave;
+	txBuf[len++] = item->functionCode;
+	memcpy(txBuf + len, item->data, item->dataLen);
+	len += item->dataLen;
+
+	unsigned short crc = MODBUS_CRC_INITVAL;
+	for (unsigned char n = 0; n < len; n++) {
+		crc = crcUpdate(crc, txBuf[n]);
+	}
+	txBuf[len++] = (crc & 0xFF);
+	txBuf[len++] = ((crc >> 8) & 0xFF);
+
+	// Discard any late data from previous transactions
+	if (serial->available()) {
+		while (serial->dataReady()) {
+			serial->getByte();
+		}
+	}
+
+	// Initialize the Rx state machine
+	rxStatus = RX_WAITING_ADDRESS;
+	rxCRC = MODBUS_CRC_INITVAL;
+	responseTimer = 0;
+	waitingAnswer = true;
+
+	serial->write((char*)txBuf, len);
+}
+
+// Handle the incoming answer. The CRC is updated on each byte: over a valid
+// frame (CRC included) it results in zero
+void ModBusMaster::onDataReceived(unsigned char rxChar) {
+
+	transaction* item = &queue[queueHead];
+	rxCRC = crcUpdate(rxCRC, rxChar);
+
+	switch (rxStatus) {
+
+		case RX_WAITING_ADDRESS: {
+			if ((rxChar == item->slave) || (item->slave == MODBUS_ANY_ADDRESS)) {
+				rxStatus = RX_WAITING_FUNCTION_CODE;
+			} else {
+				rxCRC = MODBUS_CRC_INITVAL;
+			}
+		}
+		break;
+
+		case RX_WAITING_FUNCTION_CODE: {
+			rxOffset = 0;
+			if (rxChar == item->functionCode) {
+				rxException = false;
+				if (item->replyDataLen == MODBUS_REPLY_BYTECOUNT) {
+					rxStatus = RX_WAITING_BYTECOUNT;
+				} else if (item->replyDataLen != 0) {
+					rxRemaining = item->replyDataLen;
+					rxStatus = RX_WAITING_DATA;
+				} else {
+					rxRemaining = MODBUS_CRC_LENGTH;
+					rxStatus = RX_WAITING_CRC;
+				}
+			} else if (rxChar == (item->functionCode | MODBUS_FC_EXCEPTION_FLAG)) {
+				rxException = true;
+				rxRemaining = 1;
+				rxStatus = RX_WAITING_DATA;
+			} else if ((rxChar == item->slave) || (item->slave == MODBUS_ANY_ADDRESS)) {
+
+				// Not a function code; it could be the address of a new frame
+				rxCRC = crcUpdate(MODBUS_CRC_INITVAL, rxChar);
+			} else {
+				rxCRC = MODBUS_CRC_INITVAL;
+				rxStatus = RX_WAITING_ADDRESS;
+			}
+		}
+		break;
+
+		case RX_WAITING_BYTECOUNT: {
+			if ((rxChar == 0) || (rxChar > MODBUS_RX_BUFFERLENGTH)) {
+				rxCRC = MODBUS_CRC_INITVAL;
+				rxStatus = RX_WAITING_ADDRESS;
+			} else {
+				rxRemaining = rxChar;
+				rxStatus = RX_WAITING_DATA;
+			}
+		}
+		break;
+
+		case RX_WAITING_DATA: {
+			rxBuffer[rxOffset++] = rxChar;
+			rxRemaining--;
+			if (rxRemaining == 0) {
+				rxRemaining = MODBUS_CRC_LENGTH;
+				rxStatus = RX_WAITING_CRC;
+			}
+		}
+		break;
+
+		case RX_WAITING_CRC: {
+			rxRemaining--;
+			if (rxRemaining == 0) {
+				if (rxCRC == 0) {
+					complete(rxException? RESULT_EXCEPTION : RESULT_OK);
+				} else {
+
+					// Corrupted answer. Wait for the timeout and retry
+					rxStatus = RX_IDLE;
+				}
+			}
+		}
+		break;
+
+		default:
+			break;
+	}
+}
+
+// Remove the completed transaction from the queue, then notify.
+// The handler is allowed to enqueue new requests
+void ModBusMaster::complete(result res) {
+
+	completionhandler handler = queue[queueHead].handler;
+	void* context = queue[queueHead].context;
+
+	queueHead = (queueHead + 1) % MODBUS_QUEUE_LENGTH;
+	queueCount--;
+	waitingAnswer = false;
+	rxStatus = RX_IDLE;
+	lastFrameTime = HAL_GetTick();
+
+	if (handler) {
+		handler(context, res, rxBuffer, (res == RESULT_TIMEOUT)? 0 : rxOffset);
+	}
+}
@@ -28,6 +28,7 @@
 #include "CRC32Helper.h"
 #include "EEPROMHelper.h"
 #include "Persistence.h"
+#include <string.h>
 
 // Defines the simulated registers useful to read/write PID coefficients
 // and store in the EEPROM to be persisted
@@ -40,6 +41,29 @@
 #define PID_REG_STORE_COEFFS		0x0006
 #define PID_VAL_STORE_COEFFS		0xAA
 
+// Cooling region PID coefficients and heating/cooling feedforward coefficients.
+// Same format as the above coefficients, stored with PID_REG_STORE_COEFFS.
+// A zero cooling P coefficient makes the cooling region use the heating coefficients.
+#define PID_REG_COOL_P_COEFF		0x0030
+#define PID_REG_COOL_I_COEFF		0x0031
+#define PID_REG_COOL_D_COEFF		0x0032
+#define PID_REG_HEAT_FF_COEFF		0x0033
+#define PID_REG_COOL_FF_COEFF		0x0034
+
+// Read only registers reporting the controller region and feedforward
+#define PID_REG_REGION				0x0038		/* 1 heating, 0 cooling */
+#define PID_REG_AMBIENT				0x0039		/* 1/100 C, signed. 0x7FFF if unknown */
+#define PID_REG_FEEDFORWARD			0x003A		/* 1/100 %, signed */
+
+// Relay feedback autotune. Write the relay drive (in 1/100 %) to start, 0 to abort.
+// Read returns the autotune status. Calculated coefficients are stored and applied
+// when done, and can be read back from the coefficients registers.
+#define PID_REG_AUTOTUNE			0x0020
+#define PID_REG_AUTOTUNE_CYCLES		0x0021		/* measured oscillation cycles */
+#define PID_REG_AUTOTUNE_KU			0x0022		/* ultimate gain, shared multiplier format */
+#define PID_REG_AUTOTUNE_TU			0x0023		/* ultimate period, in s */
+#define PID_REG_AUTOTUNE_AMPLITUDE	0x0024		/* oscillation amplitude, in 1/100 C */
+
 #define PID_SHARED_MULTIPLIER_BIT	(1<<16)
 #define PID_VALID_DEADZONE_MAX		10000
 
@@ -83,6 +107,20 @@ void PIDDevice::setLowPowerMode(bool lowPower) {
 // PIDs are protected by a CRC32.
 bool PIDDevice::init() {
 
+	// Read the region scheduling coefficients from EEPROM. When not valid
+	// the heating coefficients are used for both regions, without feedforward.
+	bool scheduleValid = EEPROM.read(PID_SCHEDULE_COEFFICIENTS, (unsigned char*)&scheduleData, sizeof(pidschedule)) &&
+							(CRC32.getCRC32((long*)&scheduleData, sizeof(pidschedule)-4) == scheduleData.crc);
+	if (!scheduleValid) {
+		memset(&scheduleData, 0, sizeof(pidschedule));
+		scheduleData.data.coeff.coolP = -1;
+		scheduleData.data.coeff.coolI = -1;
+		scheduleData.data.coeff.coolD = -1;
+		scheduleData.data.coeff.heatFF = -1;
+		scheduleData.data.coeff.coolFF = -1;
+	}
+	applyScheduleCoefficients();
+
 	// Read PID coefficients from EEPROM
 	if (!EEPROM.read(PID_COEFFICIENTS, (unsigned char*)&pidData, sizeof(pidcoeffs))) {
 		return false;
@@ -102,6 +140,9 @@ bool PIDDevice::init() {
 
 void PIDDevice::loop() {
 
+	// Persist the autotune results as soon as available
+	storeAutotuneCoefficients();
+
 	if (go) {
 		go = false;
 
@@ -152,6 +193,22 @@ void PIDDevice::triggerSample() {
 
 bool PIDDevice::writeGenericRegister(unsigned int address, unsigned int value){
 
+	// Start or abort the autotune
+	if (address == PID_REG_AUTOTUNE) {
+		if (value == 0) {
+			AS_TCONTROL.abortAutotune();
+			return true;
+		}
+
+		return AS_TCONTROL.startAutotune(value);
+	}
+
+	// Remember the region scheduling coefficients
+	if ((address >= PID_REG_COOL_P_COEFF) && (address <= PID_REG_COOL_FF_COEFF)) {
+		scheduleData.data.raw[address - PID_REG_COOL_P_COEFF] = value;
+		return true;
+	}
+
 	// Return an error for unhandled coefficients
 	if(address > PID_REG_STORE_COEFFS) {
 		return false;
@@ -165,6 +222,8 @@ bool PIDDevice::writeGenericRegister(unsigned int address, unsigned int value){
 			// Apply then write to EEPROM
 			applyPIDCoefficients();
 			writePIDCoefficientsToEEPROM();
+			applyScheduleCoefficients();
+			writeScheduleCoefficientsToEEPROM();
 
 			// Return an OK result
 			return true;
@@ -183,6 +242,41 @@ bool PIDDevice::writeGenericRegister(unsigned int address, unsigned int value){
 
 bool PIDDevice::readGenericRegister(unsigned int address, unsigned int& value) {
 
+	// Temperature control status
+	switch (address) {
+		case PID_REG_REGION:
+			value = AS_TCONTROL.isHeatingRegion()? 1 : 0;
+			return true;
+		case PID_REG_AMBIENT: {
+			short ambient;
+			value = AS_TCONTROL.getAmbientTemperature(ambient)? (int)ambient : 0x7FFF;
+			return true;
+		}
+		case PID_REG_FEEDFORWARD:
+			value = (int)AS_TCONTROL.getFeedforwardDrive();
+			return true;
+		case PID_REG_AUTOTUNE:
+			value = AS_TCONTROL.getAutotuneStatus();
+			return true;
+		case PID_REG_AUTOTUNE_CYCLES:
+			value = AS_TCONTROL.getAutotuneCycles();
+			return true;
+		case PID_REG_AUTOTUNE_KU:
+			value = toPIDCoefficient(AS_TCONTROL.getAutotuneUltimateGain());
+			return true;
+		case PID_REG_AUTOTUNE_TU:
+			value = AS_TCONTROL.getAutotuneUltimatePeriod();
+			return true;
+		case PID_REG_AUTOTUNE_AMPLITUDE:
+			value = AS_TCONTROL.getAutotuneAmplitude();
+			return true;
+	}
+
+	if ((address >= PID_REG_COOL_P_COEFF) && (address <= PID_REG_COOL_FF_COEFF)) {
+		value = scheduleData.data.raw[address - PID_REG_COOL_P_COEFF];
+		return true;
+	}
+
 	// Return an error for unhandled coefficients
 	if(address >= PID_REG_STORE_COEFFS) {
 		return false;
@@ -204,8 +298,7 @@ void PIDDevice::applyPIDCoefficients() {
 	float I = roundPIDCoefficient((float)pidData.data.coeff.I);
 	float D = roundPIDCoefficient((float)pidData.data.coeff.D);
 
-	AS_TCONTROL.setCoefficients(P, I, D);
-	AS_TCONTROL.setOutMinMax(-10000, 10000);
+	AS_TCONTROL.setHeatingCoefficients(P, I, D);
 
 	// Apply min threshold for dead-zone cooling
 	float dzCool = (float)pidData.data.coeff.dzCool;
@@ -225,6 +318,26 @@ void PIDDevice::applyPIDCoefficients() {
 	}
 }
 
+// Apply local region scheduling coefficients to the PID engine
+void PIDDevice::applyScheduleCoefficients() {
+
+	float coolP = roundPIDCoefficient((float)scheduleData.data.coeff.coolP);
+	float coolI = roundPIDCoefficient((float)scheduleData.data.coeff.coolI);
+	float coolD = roundPIDCoefficient((float)scheduleData.data.coeff.coolD);
+	float heatFF = roundPIDCoefficient((float)scheduleData.data.coeff.heatFF);
+	float coolFF = roundPIDCoefficient((float)scheduleData.data.coeff.coolFF);
+
+	AS_TCONTROL.setCoolingCoefficients(coolP, coolI, coolD);
+	AS_TCONTROL.setFeedforwardCoefficients(heatFF, coolFF);
+}
+
+// Write local region scheduling coefficients to EEPROM
+void PIDDevice::writeScheduleCoefficientsToEEPROM() {
+
+	scheduleData.crc = CRC32.getCRC32((long*)&scheduleData, sizeof(pidschedule)-4);
+	EEPROM.write(PID_SCHEDULE_COEFFICIENTS, (unsigned char*)&scheduleData, sizeof(pidschedule));
+}
+
 // Write local PID coefficients to EEPROM
 void PIDDevice::writePIDCoefficientsToEEPROM() {
 
@@ -244,3 +357,35 @@ float PIDDevice::roundPIDCoefficient(float value) {
 
 	return result;
 }
+
+// Convert a coefficient to the shared multiplier format used by the registers.
+// This is the reverse of roundPIDCoefficient. Values out of the 16.16 range
+// saturate instead of overflowing.
+int32_t PIDDevice::toPIDCoefficient(double value) {
+
+	double scaled = (value * PID_SHARED_MULTIPLIER_BIT) + 0.5;
+	if (scaled >= (double)INT32_MAX) {
+		return INT32_MAX;
+	}
+	if (scaled <= (double)INT32_MIN + 1) {
+		return INT32_MIN;
+	}
+
+	return (int32_t)scaled - 1;
+}
+
+// Apply and write to EEPROM the coefficients calculated by the autotune
+void PIDDevice::storeAutotuneCoefficients() {
+
+	double P, I, D;
+	if (!AS_TCONTROL.takeAutotuneCoefficients(P, I, D)) {
+		return;
+	}
+
+	pidData.data.coeff.P = toPIDCoefficient(P);
+	pidData.data.coeff.I = toPIDCoefficient(I);
+	pidData.data.coeff.D = toPIDCoefficient(D);
+
+	applyPIDCoefficients();
+	writePIDCoefficientsToEEPROM();
+}
@@ -27,7 +27,8 @@
 PIDEngine::PIDEngine() : C{0.0, 0.0, 0.0},
 						minVal(0.0), maxVal(0), integralMinVal(0.0),
 						integralMaxVal(0.0), setpoint(0.0),
-						lastCurrentValue(0.0), integralVal(0.0) {
+						lastCurrentValue(0.0), integralVal(0.0),
+						lastTerms{0.0, 0.0, 0.0}, outputClamped(false) {
 
 }
 
@@ -40,6 +41,18 @@ void PIDEngine::setCoefficients(double p, double i, double d) {
 	C.d = d;
 }
 
+void PIDEngine::changeCoefficients(double p, double i, double d) {
+
+	if ((i != 0.0) && (C.i != 0.0)) {
+		integralVal = (integralVal * C.i) / i;
+	}
+
+	setCoefficients(p, i, d);
+
+	integralMinVal = minVal / C.i;
+	integralMaxVal = maxVal / C.i;
+}
+
 double PIDEngine::getP() const {
 	return C.p;
 }
@@ -60,6 +73,16 @@ double PIDEngine::getSetPoint() const  {
 	return setpoint;
 }
 
+void PIDEngine::getLastTerms(double& pTerm, double& iTerm, double& dTerm) const {
+	pTerm = lastTerms.p;
+	iTerm = lastTerms.i;
+	dTerm = lastTerms.d;
+}
+
+bool PIDEngine::isOutputClamped() const {
+	return outputClamped;
+}
+
 void PIDEngine::setOutMinMax(double _minVal, double _maxVal) {
 	minVal = _minVal;
 	maxVal = _maxVal;
@@ -68,6 +91,11 @@ void PIDEngine::setOutMinMax(double _minVal, double _maxVal) {
 	integralMaxVal = maxVal / C.i;
 }
 
+void PIDEngine::resetState(double currentValue) {
+	lastCurrentValue = currentValue;
+	integralVal = 0.0;
+}
+
 double PIDEngine::getNextDriveValue(double currentValue) {
 
 	// Calculate the error
@@ -93,12 +121,18 @@ double PIDEngine::getNextDriveValue(double currentValue) {
 
 	// Sum P,I,D terms contributions
 	double output = pTerm + iTerm + dTerm;
+	lastTerms.p = pTerm;
+	lastTerms.i = iTerm;
+	lastTerms.d = dTerm;
 
 	// Clamp output
+	outputClamped = true;
 	if (output > maxVal) {
 		output = maxVal;
 	} else if (output < minVal) {
 		output = minVal;
+	} else {
+		outputClamped = false;
 	}
 
 	return output;
@@ -0,0 +1,124 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *			European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#include "ProfilerHelper.h"
+#include "stm32f0xx_hal.h"
+#include <string.h>
+
+ProfilerHelper ProfilerHelper::instance;
+
+ProfilerHelper::ProfilerHelper() {
+	clearStats();
+}
+
+ProfilerHelper::~ProfilerHelper() {
+}
+
+// Current time in core clock cycles. It wraps after 2^32 cycles
+// but differences between two readings are still valid.
+unsigned long ProfilerHelper::now() const {
+
+	unsigned long ms, val;
+	do {
+		ms = HAL_GetTick();
+		val = SysTick->VAL;
+	} while (ms != HAL_GetTick());
+
+	// SysTick reloaded but its interrupt has not been served yet
+	// (we're running from a higher priority interrupt)
+	unsigned long load = SysTick->LOAD;
+	if ((SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) && (val > (load >> 1))) {
+		ms++;
+	}
+
+	return (ms * (load + 1)) + (load - val);
+}
+
+unsigned long ProfilerHelper::begin() const {
+	return now();
+}
+
+unsigned long ProfilerHelper::getElapsed(unsigned long start) const {
+	return now() - start;
+}
+
+void ProfilerHelper::end(unsigned char stage, unsigned long start) {
+
+	if (stage >= PROFILER_NUM_OF_STAGES) {
+		return;
+	}
+
+	unsigned long elapsed = getElapsed(start);
+	stagestats* stat = &stats[stage];
+
+	// Keep the average meaningful on long runs
+	if (stat->calls == 0xFFFFFFFF) {
+		stat->calls >>= 1;
+		stat->totalCycles >>= 1;
+	}
+
+	stat->calls++;
+	stat->totalCycles += elapsed;
+	if (elapsed < stat->minCycles) {
+		stat->minCycles = elapsed;
+	}
+	if (elapsed > stat->maxCycles) {
+		stat->maxCycles = elapsed;
+	}
+}
+
+bool ProfilerHelper::getStageStats(unsigned char stage, unsigned long* calls, unsigned long* minCycles,
+								unsigned long* avgCycles, unsigned long* maxCycles) const {
+
+	if (stage >= PROFILER_NUM_OF_STAGES) {
+		return false;
+	}
+
+	// Interrupt stages are updated asynchronously
+	__disable_irq();
+	stagestats stat = stats[stage];
+	__enable_irq();
+
+	*calls = stat.calls;
+	*minCycles = (stat.calls != 0)? stat.minCycles : 0;
+	*avgCycles = (stat.calls != 0)? (unsigned long)(stat.totalCycles / stat.calls) : 0;
+	*maxCycles = stat.maxCycles;
+
+	return true;
+}
+
+void ProfilerHelper::reset() {
+
+	__disable_irq();
+	clearStats();
+	__enable_irq();
+}
+
+void ProfilerHelper::clearStats() {
+
+	memset(stats, 0, sizeof(stats));
+	for (unsigned char n = 0; n < PROFILER_NUM_OF_STAGES; n++) {
+		stats[n].minCycles = 0xFFFFFFFF;
+	}
+}
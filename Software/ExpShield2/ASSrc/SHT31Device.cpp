@@ -34,12 +34,38 @@
 #define SHT31_CMD_START_MEDREP          0x240B
 #define SHT31_CMD_START_LOWREP          0x2416
 
+#define SHT31_CMD_FETCH_DATA            0xE000
+#define SHT31_CMD_BREAK                 0x3093
+
 #define SHT31_CMD_READ_STATUS           0xF32D
 #define SHT31_CMD_CLEAR_STATUS          0x3041
 
 #define SHT31_NUM_OF_CHANNELS			(SHT31_CHANNEL_HUMIDITY + 1)
 
+#define SHT31_CRC8_POLYNOMIAL			0x31
+#define SHT31_CRC8_INIT					0xFF
+
+// Twice the default 1s sampler timebase: the sensor and board clocks are not
+// synchronized, and at the same nominal rate a fetch periodically finds no new
+// measurement (and the following one a measurement almost one period old)
+#define SHT31_DEFAULT_RATE				SHT31_RATE_2MPS
+#define SHT31_DEFAULT_REPEATABILITY		SHT31_REPEATABILITY_LOW
+
 #define TICKER_WAIT_FOR_SAMPLE			4
+#define TICKER_WAIT_FOR_BREAK			1		/* At least 1ms after a break command */
+#define SHT31_MAX_FAILURES				5		/* Consecutive failures before declaring the sensor unavailable */
+#define TICKER_RETRY_BASE				5		/* First retry after 50ms, doubled at each failure (750ms in total) */
+
+// Acquisition commands indexed by [rate][repeatability]. Single shot commands
+// have clock stretching disabled
+const unsigned short SHT31Device::acquisitionCommands[][3] = {
+		{ SHT31_CMD_START_HIGHREP, SHT31_CMD_START_MEDREP, SHT31_CMD_START_LOWREP },
+		{ 0x2032, 0x2024, 0x202F },
+		{ 0x2130, 0x2126, 0x212D },
+		{ 0x2236, 0x2220, 0x222B },
+		{ 0x2334, 0x2322, 0x2329 },
+		{ 0x2737, 0x2721, 0x272A }
+};
 
 const char* const SHT31Device::channelNames[] {
 		"SHT31TI", "SHT31HI", "SHT31TE", "SHT31HE"
@@ -49,7 +75,8 @@ const char* const SHT31Device::channelMeasurementUnits[] = {
 		"C", "% RH"
 };
 
-SHT31Device::SHT31Device(bool internal) : SensorDevice(SHT31_NUM_OF_CHANNELS), ticker(0) {
+SHT31Device::SHT31Device(bool internal) : SensorDevice(SHT31_NUM_OF_CHANNELS), ticker(0),
+		retryStatus(UNAVAILABLE), retryDelay(TICKER_RETRY_BASE), acquisitionRate(SHT31_DEFAULT_RATE), repeatability(SHT31_DEFAULT_REPEATABILITY), periodicRunning(false), failures(0) {
 
 	sensorAddress = internal? SHT31ONBOARDADDRESS: SHT32OFFBOARDADDRESS;
 
@@ -65,14 +92,14 @@ void SHT31Device::onStartSampling() {
 
 	status = UNAVAILABLE;
 	if (checkPresence()) {
-		status = IDLE_READY;
+		status = (acquisitionRate != SHT31_RATE_SINGLESHOT)? START_PERIODIC : IDLE_READY;
 	}
 }
 
 void SHT31Device::onStopSampling() {
 
 	if (status != UNAVAILABLE) {
-		status = IDLE_STOP;
+		status = periodicRunning? STOP_PERIODIC : IDLE_STOP;
 	}
 }
 
@@ -84,12 +111,18 @@ bool SHT31Device::init() {
 	// Check if the device is present on the I2C bus
 	// then move it to STOP mode
 	status = UNAVAILABLE;
+	periodicRunning = false;
+	failures = 0;
 	if (checkPresence()) {
 		status = IDLE_STOP;
 	}
 	return true;
 }
 
+bool SHT31Device::isAvailable() const {
+	return status != UNAVAILABLE;
+}
+
 void SHT31Device::loop() {
 
 	switch (status) {
@@ -97,33 +130,72 @@ void SHT31Device::loop() {
 		// Nothing to do
 		case UNAVAILABLE:
 		case WAIT_FOR_SAMPLE:
+		case WAIT_FOR_BREAK:
+		case WAIT_FOR_RETRY:
 		case IDLE_READY:
 		case IDLE_STOP:
 			return;
 
 		// Send a start sampling command
 		case START_SAMPLING: {
-			if (sendCommand(SHT31_CMD_START_LOWREP)) {
+			bool result = sendCommand(getAcquisitionCommand());
+			if (result) {
 				status = WAIT_FOR_SAMPLE;
 			}
-
+			onCommunicationResult(result);
+			if (!result) {
+				scheduleRetry();
+			}
 		}
 			break;
 
 		case READ_SAMPLE: {
 			unsigned short temperature, humidity;
-			if (readData(&temperature, &humidity)) {
-				setSample(SHT31_CHANNEL_TEMPERATURE, temperature);
-				setSample(SHT31_CHANNEL_HUMIDITY, humidity);
-
-				// Propagate the internal chamber temperature to the temperature
-				// reference control helper
-				if (sensorAddress == SHT31ONBOARDADDRESS) {
-					double dTemp = evaluateMeasurement(SHT31_CHANNEL_TEMPERATURE, temperature, false) * 100;
-					AS_INTCH_TEMPREF.setReadTemperature(IntChamberTempRef::SOURCE_TEMPERATURE_I, (short) dTemp);
-				}
+			bool result = readData(&temperature, &humidity);
+			if (result) {
+				onNewSample(temperature, humidity);
+			}
+			status = IDLE_READY;
+			onCommunicationResult(result);
+		}
+			break;
+
+		// A running periodic acquisition must be stopped before changing mode
+		case START_PERIODIC: {
+			if (periodicRunning) {
+				sendCommand(SHT31_CMD_BREAK);
+				periodicRunning = false;
+				ticker = 0;
+				status = WAIT_FOR_BREAK;
+			} else if (sendCommand(getAcquisitionCommand())) {
+				periodicRunning = true;
+				status = IDLE_READY;
+				onCommunicationResult(true);
+			} else {
+				onCommunicationResult(false);
+				scheduleRetry();
+			}
+		}
+			break;
+
+		// Read the latest measurement from the sensor. If no new measurement
+		// is available the sensor NACKs the read and the sample is skipped
+		case FETCH_SAMPLE: {
+			// A NACK on the fetch command (not on the data read) means the sensor is missing
+			unsigned short temperature, humidity;
+			bool result = sendCommand(SHT31_CMD_FETCH_DATA);
+			if (result && readData(&temperature, &humidity)) {
+				onNewSample(temperature, humidity);
 			}
 			status = IDLE_READY;
+			onCommunicationResult(result);
+		}
+			break;
+
+		case STOP_PERIODIC: {
+			sendCommand(SHT31_CMD_BREAK);
+			periodicRunning = false;
+			status = IDLE_STOP;
 		}
 			break;
 	}
@@ -138,6 +210,16 @@ void SHT31Device::tick() {
 		if (ticker >= TICKER_WAIT_FOR_SAMPLE) {
 			status = READ_SAMPLE;
 		}
+	} else if (status == WAIT_FOR_BREAK) {
+		ticker++;
+		if (ticker >= TICKER_WAIT_FOR_BREAK) {
+			status = START_PERIODIC;
+		}
+	} else if (status == WAIT_FOR_RETRY) {
+		ticker++;
+		if (ticker >= retryDelay) {
+			status = retryStatus;
+		}
 	}
 }
 
@@ -185,10 +267,88 @@ void SHT31Device::triggerSample() {
 
 	if (status == IDLE_READY) {
 		ticker = 0;
-		status = START_SAMPLING;
+		status = periodicRunning? FETCH_SAMPLE : START_SAMPLING;
 	}
 }
 
+// Acquisition mode changes are applied at the next sampling start
+bool SHT31Device::writeGenericRegister(unsigned int address, unsigned int value) {
+
+	if ((address == SHT31_REG_ACQUISITION_RATE) && (value <= SHT31_RATE_10MPS)) {
+		acquisitionRate = value;
+		return true;
+	}
+
+	if ((address == SHT31_REG_REPEATABILITY) && (value <= SHT31_REPEATABILITY_LOW)) {
+		repeatability = value;
+		return true;
+	}
+
+	return false;
+}
+
+bool SHT31Device::readGenericRegister(unsigned int address, unsigned int& value) {
+
+	if (address == SHT31_REG_ACQUISITION_RATE) {
+		value = acquisitionRate;
+		return true;
+	}
+
+	if (address == SHT31_REG_REPEATABILITY) {
+		value = repeatability;
+		return true;
+	}
+
+	return false;
+}
+
+unsigned short SHT31Device::getAcquisitionCommand() const {
+	return acquisitionCommands[acquisitionRate][repeatability];
+}
+
+void SHT31Device::onNewSample(unsigned short temperature, unsigned short humidity) {
+
+	setSample(SHT31_CHANNEL_TEMPERATURE, temperature);
+	setSample(SHT31_CHANNEL_HUMIDITY, humidity);
+
+	// Propagate the internal chamber temperature (in 0.01C) to the temperature
+	// reference control helper. T = -45 + 175 * raw / 65535
+	if (sensorAddress == SHT31ONBOARDADDRESS) {
+		long centiTemp = ((17500L * temperature) / 65535L) - 4500L;
+		AS_INTCH_TEMPREF.setReadTemperature(IntChamberTempRef::SOURCE_TEMPERATURE_I, (short) centiTemp);
+	}
+}
+
+// Declare the sensor unavailable after too many consecutive failures.
+// It will be recovered by the SensorsArray re-probe scheduler.
+void SHT31Device::onCommunicationResult(bool success) {
+
+	if (success) {
+		failures = 0;
+		return;
+	}
+
+	failures++;
+	if (failures >= SHT31_MAX_FAILURES) {
+		periodicRunning = false;
+		status = UNAVAILABLE;
+	}
+}
+
+// Retry the failed command after an exponential back-off, so that the consecutive
+// failures limit spans a meaningful time and not a few superloop passes
+void SHT31Device::scheduleRetry() {
+
+	if (status == UNAVAILABLE) {
+		return;
+	}
+
+	retryStatus = status;
+	retryDelay = TICKER_RETRY_BASE << (failures - 1);
+	ticker = 0;
+	status = WAIT_FOR_RETRY;
+}
+
 char SHT31Device::sendCommand(unsigned short command) const {
 
 	unsigned char buffer[] = { (unsigned char)(command >> 8), (unsigned char)(command & 0xFF) };
@@ -202,6 +362,9 @@ char SHT31Device::readData(unsigned short *temperature, unsigned short *humidity
   unsigned char data[6];
   bool result = I2CB.read(sensorAddress, data, 0x06);
 
+  // Each word is followed by its CRC
+  result = result && (crc8(data, 2) == data[2]) && (crc8(data + 3, 2) == data[5]);
+
   // convert to unsigned short
   *temperature = ((unsigned short)data[0] << 8) | data[1];
   *humidity = ((unsigned short)data[3] << 8) | data[4];
@@ -209,6 +372,20 @@ char SHT31Device::readData(unsigned short *temperature, unsigned short *humidity
   return (result)?1:0;
 }
 
+// CRC-8, polynomial 0x31, init 0xFF (see SHT3x datasheet)
+unsigned char SHT31Device::crc8(const unsigned char* data, unsigned char len) {
+
+	unsigned char crc = SHT31_CRC8_INIT;
+	for (unsigned char n = 0; n < len; n++) {
+		crc ^= data[n];
+		for (unsigned char bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x80)? ((crc << 1) ^ SHT31_CRC8_POLYNOMIAL) : (crc << 1);
+		}
+	}
+
+	return crc;
+}
+
 bool SHT31Device::checkPresence() {
 
 	unsigned char checkNumber = 0;
@@ -30,7 +30,7 @@
 #include <string.h>
 
 Sampler::Sampler(SensorDevice* const _sensor)
-		: go(false), prescaler(0), timer(0), decimation(0), decimationTimer(0), numChannels(_sensor->getNumChannels()), sensor(_sensor) {
+		: go(false), prescaler(0), timer(0), decimation(0), decimationTimer(0), timebase(SAMPLER_DEFAULT_TIMEBASE), numChannels(_sensor->getNumChannels()), sensor(_sensor) {
 
 	lastSample = new unsigned short [numChannels];
 	memset(lastSample, 0, numChannels*sizeof(unsigned short));
@@ -60,6 +60,19 @@ unsigned char Sampler::getDecimation() {
     return decimation;
 }
 
+void Sampler::setTimebase(unsigned short ticks) {
+
+	// Invalid (or not initialized) values fall back to the default timebase
+	if ((ticks == 0) || (ticks > SAMPLER_MAX_TIMEBASE)) {
+		ticks = SAMPLER_DEFAULT_TIMEBASE;
+	}
+	timebase = ticks;
+}
+
+unsigned short Sampler::getTimebase() {
+	return timebase;
+}
+
 unsigned short Sampler::getLastSample(unsigned char channel) {
 
 	if (channel >= numChannels)
@@ -92,10 +105,13 @@ bool Sampler::loadPreset(unsigned char myID) {
     // Load prescaler and decimation
     unsigned char prescVal = EEPROM.read(SAMPLER_PRESET_PRESCALER(myID));
     unsigned char decimVal = EEPROM.read(SAMPLER_PRESET_DECIMATION(myID));
+    unsigned char timebaseLSB = EEPROM.read(SAMPLER_PRESET_TIMEBASE(myID));
+    unsigned char timebaseMSB = EEPROM.read(SAMPLER_PRESET_TIMEBASE(myID)+1);
 
     // Apply
     setPreScaler(prescVal);
     setDecimation(decimVal);
+    setTimebase(((timebaseMSB<<8)&0xFF00) | timebaseLSB);
 
     // Load channel enable status and setpoint
     for (int channel = 0; channel < numChannels; channel++) {
@@ -117,6 +133,8 @@ bool Sampler::savePreset(unsigned char myID) {
     // Get values and store them
     EEPROM.write(SAMPLER_PRESET_PRESCALER(myID), getPrescaler());
     EEPROM.write(SAMPLER_PRESET_DECIMATION(myID), getDecimation());
+    unsigned short timebaseVal = getTimebase();
+    EEPROM.write(SAMPLER_PRESET_TIMEBASE(myID), (unsigned char*)&timebaseVal, sizeof(unsigned short));
     
     // Save channel enable status for each channel
     EEPROM.write(SAMPLER_CHANNEL_ENABLED_PRESET(myID, 0), (unsigned char*)enabled, numChannels);
@@ -207,6 +225,7 @@ bool Sampler::setEnableChannel(unsigned char channel, unsigned char _enabled) {
 		return false;
 
 	enabled[channel] = (_enabled != 0);
+	sensor->setChannelEnabled(channel, enabled[channel]);
 
 	return true;
 }
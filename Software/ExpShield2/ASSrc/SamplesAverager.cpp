@@ -27,6 +27,7 @@
 #include "DitherTool.h"
 #include "EEPROMHelper.h"
 #include <string.h>
+#include <new>
 
 DitherTool* SamplesAverager::ditherTool = (DitherTool*)0x00;
 
@@ -86,7 +87,7 @@ unsigned char SamplesAverager::init(unsigned char size) {
 	unsigned short overallBufferSize = size * channels;
 
 	reset();
-	dataBuffer = new unsigned short [overallBufferSize];
+	dataBuffer = new (std::nothrow) unsigned short [overallBufferSize];
 	if (dataBuffer) {
 		bufferSize = size;
 		memset(dataBuffer, 0, overallBufferSize*sizeof(unsigned short));
@@ -25,7 +25,7 @@
 #include "SensorDevice.h"
 #include <string.h>
 
-SensorDevice::SensorDevice(const unsigned char reqChannels) : sampleReady(false), numChannels(reqChannels) {
+SensorDevice::SensorDevice(const unsigned char reqChannels) : bringUpStatus(BRINGUP_PENDING), sampleReady(false), numChannels(reqChannels) {
 
 	lastSamples = new unsigned short[reqChannels];
 }
@@ -60,11 +60,42 @@ bool SensorDevice::writeGenericRegister(unsigned int address, unsigned int value
 	return false;
 }
 
+// To be overridden only by devices able to detect their presence
+bool SensorDevice::isAvailable() const {
+	return true;
+}
+
+// Devices are initialized in a single step and are ready if they answered
+void SensorDevice::bringUp() {
+	setBringUpStatus((init() && isAvailable())? BRINGUP_READY : BRINGUP_ABSENT);
+}
+
+// Start again the discovery procedure (i.e. for absent devices)
+void SensorDevice::restartBringUp() {
+	setBringUpStatus(BRINGUP_PENDING);
+}
+
+SensorDevice::bringupstatus SensorDevice::getBringUpStatus() const {
+	return bringUpStatus;
+}
+
+bool SensorDevice::isReady() const {
+	return (bringUpStatus == BRINGUP_READY);
+}
+
+void SensorDevice::setBringUpStatus(bringupstatus status) {
+	bringUpStatus = status;
+}
+
 // To be overridden only by devices allowing for reading a generic register/address
 bool SensorDevice::readGenericRegister(unsigned int address, unsigned int& value) {
 	return false;
 }
 
+// To be overridden only by devices able to skip the acquisition of disabled channels
+void SensorDevice::setChannelEnabled(unsigned char channel, bool enabled) {
+}
+
 void SensorDevice::triggerSample() {
 	sampleReady = false;
 }
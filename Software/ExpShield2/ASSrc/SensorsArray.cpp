@@ -37,131 +37,231 @@
 #include "Persistence.h"
 #include "EEPROMHelper.h"
 #include "GPIOHelper.h"
+#include "ProfilerHelper.h"
 #include <string.h>
 
 
 #define BOARD_TYPE_EXP2_SENSORSHIELD		0x05
 
-#define GLOBAL_SAMPLE_PRESCALER_RATIO		100		/* 1 second */
+#define POWERUP_SETTLE_TIME	50		/* Power supply rails stabilization time before starting the devices bring-up (one sampletick = 0.01s) */
+#define REPROBE_PERIOD		1000	/* One absent device is re-probed every 10 seconds (one sampletick = 0.01s) */
 
 DitherTool SensorsArray::ditherTool = DitherTool();
 
-const SensorsArray::channeltosamplersubchannel SensorsArray::chToSamplerSubChannel[NUM_OF_TOTAL_CHANNELS] = {
-		{ SENSOR_SHT31_I, SHT31_CHANNEL_TEMPERATURE, true },
-		{ SENSOR_SHT31_I, SHT31_CHANNEL_HUMIDITY, false },
-		{ SENSOR_SHT31_E, SHT31_CHANNEL_TEMPERATURE, true },
-		{ SENSOR_SHT31_E, SHT31_CHANNEL_HUMIDITY, false },
-		{ SENSOR_INTAD, INTAD_CHANNEL_PLT_VFBK, true },
-		{ SENSOR_INTAD, INTAD_CHANNEL_PLT_CFBK, false },
-		{ SENSOR_INTAD, INTAD_CHANNEL_VIN_FBK, false },
-		{ SENSOR_INTAD, INTAD_CHANNEL_TEMPERATURE, false },
-		{ SENSOR_PID, PIDDEV_CHANNEL_PID_HEATER, true },
-		{ SENSOR_PID, PIDDEV_CHANNEL_PID_COOLER, false },
-		{ SENSOR_ADT7470, ADT7470_CHANNEL_T_INT_CHAMBER, true },
-		{ SENSOR_ADT7470, ADT7470_CHANNEL_T_EXT_HEATSINK, false },
-		{ SENSOR_ADT7470, ADT7470_CHANNEL_T_INT_HEATSINK, false },
-		{ SENSOR_ADT7470, ADT7470_CHANNEL_F_EXT_HEATSINK, false },
-		{ SENSOR_ADT7470, ADT7470_CHANNEL_F_INT_HEATSINK, false },
-		{ SENSOR_ADT7470, ADT7470_CHANNEL_F_AIR_CIR, false },
-		{ SENSOR_D300, 0 , true },
-		{ SENSOR_K96, K96_CHANNEL_LPL_PC_FLT, true },
-		{ SENSOR_K96, K96_CHANNEL_SPL_PC_FLT, false },
-		{ SENSOR_K96, K96_CHANNEL_MPL_PC_FLT, false },
-		{ SENSOR_K96, K96_CHANNEL_PRESS0, false },
-		{ SENSOR_K96, K96_CHANNEL_TEMP_NTC0, false },
-		{ SENSOR_K96, K96_CHANNEL_TEMP_NTC1, false },
-		{ SENSOR_K96, K96_CHANNEL_TEMP_UCDIE, false },
-		{ SENSOR_K96, K96_CHANNEL_RH0, false },
-		{ SENSOR_K96, K96_CHANNEL_T_RH0, false },
-		{ SENSOR_K96, K96_CHANNEL_LPL_UFLT_IR, false },
-		{ SENSOR_K96, K96_CHANNEL_SPL_UFLT_IR, false },
-		{ SENSOR_K96, K96_CHANNEL_MPL_UFLT_IR, false },
-		{ SENSOR_K96, K96_CHANNEL_ERRORSTATUS, false },
-		{ SENSOR_K96, K96_CHANNEL_LPL_UFLT_ERR, false },
-		{ SENSOR_K96, K96_CHANNEL_SPL_UFLT_ERR, false },
-		{ SENSOR_K96, K96_CHANNEL_MPL_UFLT_ERR, false },
+// Board description. Devices, samplers and averagers concrete types are listed in sensor
+// order. Each sensor exports the subchannels in its set as contiguous logical channels.
+struct ExpShieldTwoBoard {
+	typedef TypeList<SHT31Device, SHT31Device, IntADDevice, PIDDevice, ADT7470Device, D300Device, K96Device> devices;
+	typedef TypeList<Sampler, Sampler, FixedRateSampler, FixedRateSampler, FixedRateSampler, FixedRateSampler, Sampler> samplers;
+	typedef TypeList<SamplesAverager, SamplesAverager, SamplesAverager, SamplesAverager,
+						SamplesAverager, SamplesAverager, K96SamplesAverager> averagers;
+
+	static constexpr unsigned long long subchannels[NUM_OF_TOTAL_SENSORS] = {
+			SUBCHANNEL(SHT31_CHANNEL_TEMPERATURE) | SUBCHANNEL(SHT31_CHANNEL_HUMIDITY),
+			SUBCHANNEL(SHT31_CHANNEL_TEMPERATURE) | SUBCHANNEL(SHT31_CHANNEL_HUMIDITY),
+			SUBCHANNEL(INTAD_CHANNEL_PLT_VFBK) | SUBCHANNEL(INTAD_CHANNEL_PLT_CFBK) |
+					SUBCHANNEL(INTAD_CHANNEL_VIN_FBK) | SUBCHANNEL(INTAD_CHANNEL_TEMPERATURE),	// VREFINT is internal only
+			SUBCHANNELS_RANGE(PIDDEV_NUM_OF_CHANNELS),
+			SUBCHANNELS_RANGE(ADT7470_NUM_CHANNELS),
+			SUBCHANNEL(0),
+			SUBCHANNELS_RANGE(K96_NUM_OF_CHANNELS)
+	};
 };
+constexpr unsigned long long ExpShieldTwoBoard::subchannels[NUM_OF_TOTAL_SENSORS];
+
+// Channel map is generated from the board description, at compile time
+constexpr const channeltosamplersubchannel* const SensorsArray::chToSamplerSubChannel =
+		ChannelMap<ExpShieldTwoBoard, NUM_OF_TOTAL_CHANNELS>::map;
+
+// Check if the channel is mapped to the given sensor subchannel
+constexpr bool SensorsArray::mapsTo(unsigned char channel, unsigned char sensor, unsigned char subchannel) {
+	return (channel < NUM_OF_TOTAL_CHANNELS) &&
+			(chToSamplerSubChannel[channel].sampler == sensor) &&
+			(chToSamplerSubChannel[channel].subchannel == subchannel);
+}
+
+// Hot loops operations. Each object is reached with a qualified, non virtual,
+// call bound at compile time to its concrete type (see StaticBoard.h)
+struct DeviceTick {
+	SensorDevice* const* sensors;
+
+	template <class T, unsigned char N> void visit() {
+		unsigned long profilerStart = AS_PROFILER.begin();
+		static_cast<T*>(sensors[N])->T::tick();
+		AS_PROFILER.end(PROFILER_STAGE_SENSOR_TICK + N, profilerStart);
+	}
+};
+
+struct DeviceLoop {
+	SensorDevice* const* sensors;
+
+	template <class T, unsigned char N> void visit() {
+		T* device = static_cast<T*>(sensors[N]);
+		unsigned long profilerStart = AS_PROFILER.begin();
+		if (device->getBringUpStatus() == SensorDevice::BRINGUP_PENDING) {
+			device->T::bringUp();
+		}
+		device->T::loop();
+		AS_PROFILER.end(PROFILER_STAGE_SENSOR_LOOP + N, profilerStart);
+	}
+};
+
+struct SamplerTick {
+	Sampler* const* samplers;
+	volatile unsigned short* timebaseTimer;
+	bool result;
+
+	template <class T, unsigned char N> void visit() {
+		T* sampler = static_cast<T*>(samplers[N]);
+		timebaseTimer[N]++;
+		if (timebaseTimer[N] >= sampler->T::getTimebase()) {
+			timebaseTimer[N] = 0;
+			result |= sampler->T::sampleTick();
+		}
+	}
+};
+
+struct SamplerLoop {
+	Sampler* const* samplers;
+	SamplesAverager* const* averagers;
+	unsigned long timestamp;
+	unsigned short newAverages;			// Samplers with a new average bitmap
+
+	template <class T, unsigned char N> void visit() {
+		typedef typename TypeAt<ExpShieldTwoBoard::averagers, N>::type A;
+		T* sampler = static_cast<T*>(samplers[N]);
+		if (sampler->T::sampleLoop()) {
+			A* averager = static_cast<A*>(averagers[N]);
+			bool newAverage = false;
+			for (unsigned char subChannel = 0; subChannel < sampler->T::getNumChannels(); subChannel++) {
+				// A new set of samples are ready to be averaged
+				newAverage |= averager->A::collectSample(subChannel, sampler->T::getLastSample(subChannel), timestamp);
+			}
+			if (newAverage) {
+				newAverages |= (1 << N);
+			}
+		}
+	}
+};
+
+// Objects are placement constructed into static storage, with the types in the board description
+#define DEVICE(n, ...)		constructStatic<ExpShieldTwoBoard::devices, n>(__VA_ARGS__)
+#define SAMPLER(n, ...)		constructStatic<ExpShieldTwoBoard::samplers, n>(__VA_ARGS__)
+#define AVERAGER(n)			constructStatic<ExpShieldTwoBoard::averagers, n>(sensors[n]->getNumChannels())
 
 SensorsArray::SensorsArray() :
-		sensors{ new SHT31Device(true),
-				 new SHT31Device(false),
+		sensors{ DEVICE(SENSOR_SHT31_I, true),
+				 DEVICE(SENSOR_SHT31_E, false),
 				 IntADDevice::getInstance(),
 				 PIDDevice::getInstance(),
 				 ADT7470Device::getInstance(),
-				 new D300Device(),
-				 new K96Device()
+				 DEVICE(SENSOR_D300),
+				 DEVICE(SENSOR_K96)
 		},
-		samplers{ new Sampler(sensors[SENSOR_SHT31_I]),
-				  new Sampler(sensors[SENSOR_SHT31_E]),
-				  new FixedRateSampler(sensors[SENSOR_INTAD], IntADDevice::defaultSampleRate()),
-				  new FixedRateSampler(sensors[SENSOR_PID], PIDDevice::defaultSampleRate()),
-				  new FixedRateSampler(sensors[SENSOR_ADT7470], ADT7470Device::defaultSampleRate()),
-				  new FixedRateSampler(sensors[SENSOR_D300], D300Device::defaultSampleRate()),
-				  new Sampler(sensors[SENSOR_K96])
+		samplers{ SAMPLER(SENSOR_SHT31_I, sensors[SENSOR_SHT31_I]),
+				  SAMPLER(SENSOR_SHT31_E, sensors[SENSOR_SHT31_E]),
+				  SAMPLER(SENSOR_INTAD, sensors[SENSOR_INTAD], IntADDevice::defaultSampleRate()),
+				  SAMPLER(SENSOR_PID, sensors[SENSOR_PID], PIDDevice::defaultSampleRate()),
+				  SAMPLER(SENSOR_ADT7470, sensors[SENSOR_ADT7470], ADT7470Device::defaultSampleRate()),
+				  SAMPLER(SENSOR_D300, sensors[SENSOR_D300], D300Device::defaultSampleRate()),
+				  SAMPLER(SENSOR_K96, sensors[SENSOR_K96])
 		},
 		averagers{
-				new SamplesAverager(sensors[SENSOR_SHT31_I]->getNumChannels()),
-				new SamplesAverager(sensors[SENSOR_SHT31_E]->getNumChannels()),
-				new SamplesAverager(sensors[SENSOR_INTAD]->getNumChannels()),
-				new SamplesAverager(sensors[SENSOR_PID]->getNumChannels()),
-				new SamplesAverager(sensors[SENSOR_ADT7470]->getNumChannels()),
-				new SamplesAverager(sensors[SENSOR_D300]->getNumChannels()),
-				new K96SamplesAverager(sensors[SENSOR_K96]->getNumChannels())
+				AVERAGER(SENSOR_SHT31_I),
+				AVERAGER(SENSOR_SHT31_E),
+				AVERAGER(SENSOR_INTAD),
+				AVERAGER(SENSOR_PID),
+				AVERAGER(SENSOR_ADT7470),
+				AVERAGER(SENSOR_D300),
+				AVERAGER(SENSOR_K96)
 		},
-		samplingEnabled(false), timestamp(0), globalPrescaler(0)
+		samplingEnabled(false), timestamp(0), powerUpTimer(POWERUP_SETTLE_TIME), reprobeTimer(0), reprobeNext(0), availableMap(0), discoveredMap(0)
 	{
 
+	// The board description, the logical channels definitions and the generated channel map should be kept aligned
+	static_assert((TypeListSize<ExpShieldTwoBoard::devices>::value == NUM_OF_TOTAL_SENSORS) &&
+				  (TypeListSize<ExpShieldTwoBoard::samplers>::value == NUM_OF_TOTAL_SAMPLERS) &&
+				  (TypeListSize<ExpShieldTwoBoard::averagers>::value == NUM_OF_TOTAL_AVERAGERS), "Malformed board description");
+	static_assert(countChannels(ExpShieldTwoBoard::subchannels, NUM_OF_TOTAL_SENSORS) == NUM_OF_TOTAL_CHANNELS, "Channels number mismatch");
+	static_assert(NUM_OF_TOTAL_SENSORS <= PROFILER_MAX_SENSORS, "Not enough profiler stages for sensors");
+	static_assert(mapsTo(CHANNEL_TEMPERATURE_I, SENSOR_SHT31_I, SHT31_CHANNEL_TEMPERATURE) &&
+				  mapsTo(CHANNEL_HUMIDIDY_I, SENSOR_SHT31_I, SHT31_CHANNEL_HUMIDITY) &&
+				  mapsTo(CHANNEL_TEMPERATURE_E, SENSOR_SHT31_E, SHT31_CHANNEL_TEMPERATURE) &&
+				  mapsTo(CHANNEL_HUMIDIDY_E, SENSOR_SHT31_E, SHT31_CHANNEL_HUMIDITY), "SHT31 channels mismatch");
+	static_assert(mapsTo(CHANNEL_PELTIER_V, SENSOR_INTAD, INTAD_CHANNEL_PLT_VFBK) &&
+				  mapsTo(CHANNEL_PELTIER_C, SENSOR_INTAD, INTAD_CHANNEL_PLT_CFBK) &&
+				  mapsTo(CHANNEL_VIN_FBK, SENSOR_INTAD, INTAD_CHANNEL_VIN_FBK) &&
+				  mapsTo(CHANNEL_UCDIE_TEMPERATURE, SENSOR_INTAD, INTAD_CHANNEL_TEMPERATURE), "IntAD channels mismatch");
+	static_assert(mapsTo(CHANNEL_PID_HEATER, SENSOR_PID, PIDDEV_CHANNEL_PID_HEATER) &&
+				  mapsTo(CHANNEL_PID_COOLER, SENSOR_PID, PIDDEV_CHANNEL_PID_COOLER), "PID channels mismatch");
+	static_assert(mapsTo(CHANNEL_ADT7470_T_INT_CHAMBER, SENSOR_ADT7470, ADT7470_CHANNEL_T_INT_CHAMBER) &&
+				  mapsTo(CHANNEL_ADT7470_F_AIR_CIR, SENSOR_ADT7470, ADT7470_CHANNEL_F_AIR_CIR) &&
+				  ((CHANNEL_ADT7470_F_AIR_CIR - CHANNEL_ADT7470_T_INT_CHAMBER) == (ADT7470_NUM_CHANNELS - 1)), "ADT7470 channels mismatch");
+	static_assert(mapsTo(CHANNEL_D300, SENSOR_D300, 0), "D300 channel mismatch");
+	static_assert(mapsTo(CHANNEL_K96_LPL_PC_FLT, SENSOR_K96, K96_CHANNEL_LPL_PC_FLT) &&
+				  mapsTo(CHANNEL_K96_ERRORSTATUS, SENSOR_K96, K96_CHANNEL_ERRORSTATUS) &&
+				  mapsTo(CHANNEL_K96_MPL_UFLT_ERR, SENSOR_K96, K96_CHANNEL_MPL_UFLT_ERR) &&
+				  ((CHANNEL_K96_MPL_UFLT_ERR - CHANNEL_K96_LPL_PC_FLT) == (K96_NUM_OF_CHANNELS - 1)), "K96 channels mismatch");
+
+    memset((void*)timebaseTimer, 0, sizeof(timebaseTimer));
+    memset(reconnectCount, 0, sizeof(reconnectCount));
+    memset(dropoutCount, 0, sizeof(dropoutCount));
+
     // Set the dithering tool. See the above comment.
     averagers[SENSOR_SHT31_I]->setDitherTool(&ditherTool);
     
-    // Initialize by reading the preset stored into the EEPROM
+    // Initialize by reading the preset stored into the EEPROM.
+    // This initializes the evaluated values cache too.
     for (unsigned char n = 0; n < NUM_OF_TOTAL_CHANNELS; n++) {
         loadPreset(n);
     }
 }
 
 
+// Objects live in static storage and are only destroyed.
+// Singleton devices are owned by their own class.
 SensorsArray::~SensorsArray() {
     for (unsigned char n = 0; n < NUM_OF_TOTAL_SAMPLERS; n++) {
-        if (samplers[n]) {
-            delete samplers[n];
-        }
+    	samplers[n]->~Sampler();
+    	averagers[n]->~SamplesAverager();
     }
 
-    for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
-		if (sensors[n]) {
-			delete sensors[n];
-		}
-		if (averagers[n]) {
-			delete averagers[n];
-		}
-    }
+    sensors[SENSOR_SHT31_I]->~SensorDevice();
+    sensors[SENSOR_SHT31_E]->~SensorDevice();
+    sensors[SENSOR_D300]->~SensorDevice();
+    sensors[SENSOR_K96]->~SensorDevice();
 }
 
-bool SensorsArray::init() {
+// True when all the devices terminated their bring-up (found or not)
+bool SensorsArray::isBringUpCompleted() const {
 
-	bool result = true;
+	if (powerUpTimer != 0) {
+		return false;
+	}
 
-	// Propagate to all devices so that they may be initialized
-	// with full access to working hardware resources
-    for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
-		if (sensors[n] != 0) {
-			result &= sensors[n]->init();
+	for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
+		if (sensors[n] && (sensors[n]->getBringUpStatus() == SensorDevice::BRINGUP_PENDING)) {
+			return false;
 		}
-    }
+	}
 
-    return result;
+	return true;
 }
 
 bool SensorsArray::timerTick() {
-    
-    bool result = false;
 
-    // Propagate to all devices requiring fast rate (one sampletick = 0.01s)
-    for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
-    		if (sensors[n] != 0) {
-    			sensors[n]->tick();
-    		}
+    // Wait for power supply stabilization before running the devices
+    if (powerUpTimer != 0) {
+    		powerUpTimer--;
+    } else {
+
+		// Propagate to all devices requiring fast rate (one sampletick = 0.01s)
+		DeviceTick deviceTick = { sensors };
+		StaticForEach<ExpShieldTwoBoard::devices>::apply(deviceTick);
+
+		if (reprobeTimer < REPROBE_PERIOD) {
+			reprobeTimer++;
+		}
     }
 
     // Increase the internal timestamp (in 0.01s)
@@ -172,29 +272,28 @@ bool SensorsArray::timerTick() {
         return false;
     }
 
-    // This shield does not requires fast sampling rates. A global prescaler
-    // is used to reduce the sampling rate to a reasonable value (one sampletick = 1s)
-    globalPrescaler++;
-    if (globalPrescaler >= GLOBAL_SAMPLE_PRESCALER_RATIO) {
-    		globalPrescaler = 0;
-
-		// Loop on each sensor samplers
-		for (unsigned char n = 0; n < NUM_OF_TOTAL_SAMPLERS; n++) {
-			if (samplers[n] != 0) {
-				result |= samplers[n]->sampleTick();
-			}
-		}
-    }
+    // Each sampler runs on its own timebase (multiple of 0.01s) so fast channels
+    // get sub-second sampletick while slow ones only cost a counter update
+    SamplerTick samplerTick = { samplers, timebaseTimer, false };
+    StaticForEach<ExpShieldTwoBoard::samplers>::apply(samplerTick);
     
-    return result;
+    return samplerTick.result;
 }
 
 bool SensorsArray::loop() {
 
-	// Call all devices loop
-	for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
-		if (sensors[n]) {
-			sensors[n]->loop();
+	// Call all devices bring-up and loop. Devices are started concurrently
+	// as soon as the power supply is stable.
+	if (powerUpTimer == 0) {
+		DeviceLoop deviceLoop = { sensors };
+		StaticForEach<ExpShieldTwoBoard::devices>::apply(deviceLoop);
+
+		// Track devices connections and disconnections, then
+		// periodically try to recover missing devices
+		checkAvailability();
+		if (reprobeTimer >= REPROBE_PERIOD) {
+			reprobeTimer = 0;
+			reprobeAbsentDevice();
 		}
 	}
 
@@ -203,18 +302,17 @@ bool SensorsArray::loop() {
         return false;
     }
     
-    long currentTimestamp = timestamp;
-    bool result = false;
+    SamplerLoop samplerLoop = { samplers, averagers, timestamp, 0 };
+    StaticForEach<ExpShieldTwoBoard::samplers>::apply(samplerLoop);
+
+    // Evaluate once the new averages. Polls will read the cached values.
     for (unsigned char n = 0; n < NUM_OF_TOTAL_SAMPLERS; n++) {
-    		if (samplers[n] && samplers[n]->sampleLoop()) {
-    			for (unsigned char subChannel = 0; subChannel < samplers[n]->getNumChannels(); subChannel++) {
-    				// A new set of samples are ready to be averaged
-    				result |= averagers[n]->collectSample(subChannel, samplers[n]->getLastSample(subChannel), currentTimestamp);
-    			}
+    		if (samplerLoop.newAverages & (1 << n)) {
+    			evaluateSamples(n);
     		}
     }
 
-    return result;
+    return (samplerLoop.newAverages != 0);
 }
 
 unsigned char SensorsArray::setSamplePrescaler(unsigned char channel, unsigned char prescaler) {
@@ -242,7 +340,12 @@ unsigned char SensorsArray::setSamplePostscaler(unsigned char channel, unsigned
     if (channel >= NUM_OF_TOTAL_CHANNELS)
         return 0;
     
-    return (averagers[chToSamplerSubChannel[channel].sampler]->init(postscaler) != 0) ;
+    // The averager is reset: the cached evaluated values should follow
+    unsigned char sampler = chToSamplerSubChannel[channel].sampler;
+    unsigned char result = (averagers[sampler]->init(postscaler) != 0);
+    evaluateSamples(sampler);
+
+    return result;
 }
 
 bool SensorsArray::getSamplePostscaler(unsigned char channel, unsigned char* postscaler) {
@@ -276,13 +379,41 @@ bool SensorsArray::getSampleDecimation(unsigned char channel, unsigned char* dec
     return true;
 }
 
+bool SensorsArray::setSampleTimebase(unsigned char channel, unsigned short timebaseMs) {
+
+    if ((channel >= NUM_OF_TOTAL_CHANNELS) || (timebaseMs < SAMPLER_TICK_PERIOD_MS) ||
+    		(timebaseMs > (SAMPLER_MAX_TIMEBASE * SAMPLER_TICK_PERIOD_MS))) {
+        return false;
+    }
+
+    unsigned char sampler = chToSamplerSubChannel[channel].sampler;
+    unsigned short timebase = timebaseMs / SAMPLER_TICK_PERIOD_MS;
+    samplers[sampler]->setTimebase(timebase);
+    timebaseTimer[sampler] = 0;
+
+    // Fixed rate samplers don't accept a different timebase
+    return (samplers[sampler]->getTimebase() == timebase);
+}
+
+bool SensorsArray::getSampleTimebase(unsigned char channel, unsigned short* timebaseMs) {
+
+    if ((channel >= NUM_OF_TOTAL_CHANNELS) || (timebaseMs == 0)) {
+        return false;
+    }
+
+    *timebaseMs = samplers[chToSamplerSubChannel[channel].sampler]->getTimebase() * SAMPLER_TICK_PERIOD_MS;
+
+    return true;
+}
+
 bool SensorsArray::enableSampling(bool enable) {
 
 	// Initialize samplers when start sampling
 	if (enable && !samplingEnabled) {
-		globalPrescaler = 0;
 		for (unsigned char n = 0; n < NUM_OF_TOTAL_SAMPLERS; n++) {
+			timebaseTimer[n] = 0;
 			samplers[n]->onStartSampling();
+			evaluateSamples(n);
 		}
 	}
 
@@ -340,6 +471,9 @@ bool SensorsArray::loadPreset(unsigned char channel) {
     
     // Read averager preset
     result &= averagers[chToSamplerSubChannel[channel].sampler]->loadPreset(chToSamplerSubChannel[channel].sampler);
+
+    // The averager has been reset: refresh the cached evaluated values
+    evaluateSamples(chToSamplerSubChannel[channel].sampler);
     
     return result;
 }
@@ -374,14 +508,9 @@ bool SensorsArray::getLastSample(unsigned char channel, float &lastSample, unsig
     	samplers[chToSamplerSubChannel[channel].sampler]->getChannelIsEnabled(chToSamplerSubChannel[channel].subchannel, &enabled);
 
     	if (enabled != 0) {
-			// Retrieve the timestamp
+			// Retrieve the timestamp and the value evaluated at the latest average consolidation
 			timestamp = averagers[chToSamplerSubChannel[channel].sampler]->lastTimeStamp();
-
-			// Retrieve the averaged value...
-			lastSample = averagers[chToSamplerSubChannel[channel].sampler]->lastAveragedFloatValue(chToSamplerSubChannel[channel].subchannel);
-
-			// Evaluate it. Evaluation is done by sensor devices
-			lastSample = sensors[chToSamplerSubChannel[channel].sampler]->evaluateMeasurement(chToSamplerSubChannel[channel].subchannel, lastSample, timestamp == 0);
+			lastSample = evaluatedSamples[channel];
     	}
 
 		return true;
@@ -393,8 +522,15 @@ bool SensorsArray::getLastSample(unsigned char channel, float &lastSample, unsig
 
 bool SensorsArray::setSetpoint(unsigned char channel, unsigned short setPointVal) {
 
-	return ((channel < NUM_OF_TOTAL_CHANNELS) &&
-			samplers[chToSamplerSubChannel[channel].sampler]->setSetpointForChannel(chToSamplerSubChannel[channel].subchannel, setPointVal));
+	if ((channel >= NUM_OF_TOTAL_CHANNELS) ||
+			!samplers[chToSamplerSubChannel[channel].sampler]->setSetpointForChannel(chToSamplerSubChannel[channel].subchannel, setPointVal)) {
+		return false;
+	}
+
+	// Evaluation may depend on the setpoint
+	evaluateSamples(chToSamplerSubChannel[channel].sampler);
+
+	return true;
 }
 
 
@@ -485,11 +621,13 @@ bool SensorsArray::readChannelSamplePeriod(unsigned char channel, unsigned long
 		return false;
 	}
 
-    unsigned char samplerPrescaler = samplers[chToSamplerSubChannel[channel].sampler]->getPrescaler() + 1;
-    unsigned char samplerDecimation = samplers[chToSamplerSubChannel[channel].sampler]->getDecimation() + 1;
-    unsigned char averagerBufferSize = averagers[chToSamplerSubChannel[channel].sampler]->getBufferSize() + 1;
+    // Sample period is returned in milliseconds
+    unsigned long samplerTimebase = samplers[chToSamplerSubChannel[channel].sampler]->getTimebase() * SAMPLER_TICK_PERIOD_MS;
+    unsigned long samplerPrescaler = samplers[chToSamplerSubChannel[channel].sampler]->getPrescaler() + 1;
+    unsigned long samplerDecimation = samplers[chToSamplerSubChannel[channel].sampler]->getDecimation() + 1;
+    unsigned long averagerBufferSize = averagers[chToSamplerSubChannel[channel].sampler]->getBufferSize() + 1;
 
-	*samplePeriod = samplerPrescaler * samplerDecimation * averagerBufferSize * 1000;
+	*samplePeriod = samplerTimebase * samplerPrescaler * samplerDecimation * averagerBufferSize;
 
 	return true;
 }
@@ -533,7 +671,14 @@ bool SensorsArray::writeGenericRegisterChannel(unsigned char channel, unsigned i
 		return false;
 	}
 
-	return sensors[chToSamplerSubChannel[channel].sampler]->writeGenericRegister(address, value);
+	if (!sensors[chToSamplerSubChannel[channel].sampler]->writeGenericRegister(address, value)) {
+		return false;
+	}
+
+	// Evaluation may depend on the device registers (i.e. calibration and coefficients)
+	evaluateSamples(chToSamplerSubChannel[channel].sampler);
+
+	return true;
 }
 
 bool SensorsArray::readGenericRegisterChannel(unsigned char channel, unsigned int address, unsigned int& value) {
@@ -554,6 +699,96 @@ unsigned short SensorsArray::getBoardNumChannels() {
 	return NUM_OF_TOTAL_CHANNELS;
 }
 
+// Evaluate the latest averaged values for all channels associated to a sampler.
+// Evaluation is done by sensor devices.
+void SensorsArray::evaluateSamples(unsigned char sampler) {
+
+	bool firstSample = (averagers[sampler]->lastTimeStamp() == 0);
+	for (unsigned char channel = 0; channel < NUM_OF_TOTAL_CHANNELS; channel++) {
+		if (chToSamplerSubChannel[channel].sampler == sampler) {
+			unsigned char subChannel = chToSamplerSubChannel[channel].subchannel;
+			float value = averagers[sampler]->lastAveragedFloatValue(subChannel);
+			evaluatedSamples[channel] = sensors[sampler]->evaluateMeasurement(subChannel, value, firstSample);
+		}
+	}
+}
+
 bool SensorsArray::getIsFlyboardReady() {
-	return ((SHT31Device*)sensors[SENSOR_SHT31_E])->isAvailable();
+	return sensors[SENSOR_SHT31_E]->isReady() && sensors[SENSOR_SHT31_E]->isAvailable();
+}
+
+// Devices mounted on the board and required by the temperature control
+bool SensorsArray::getIsMainboardReady() {
+	return sensors[SENSOR_INTAD]->isReady() && sensors[SENSOR_PID]->isReady() && sensors[SENSOR_ADT7470]->isReady();
+}
+
+bool SensorsArray::getSensorStatus(unsigned char sensor, unsigned short* readyMap, unsigned short* pendingMap,
+										unsigned short* reconnects, unsigned short* dropouts) {
+
+	if (sensor >= NUM_OF_TOTAL_SENSORS) {
+		return false;
+	}
+
+	*readyMap = availableMap;
+	*pendingMap = 0;
+	for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
+		if (sensors[n] && ((powerUpTimer != 0) || (sensors[n]->getBringUpStatus() == SensorDevice::BRINGUP_PENDING))) {
+			*pendingMap |= (1 << n);
+		}
+	}
+	*reconnects = reconnectCount[sensor];
+	*dropouts = dropoutCount[sensor];
+
+	return true;
+}
+
+// Update the available devices map. A device coming back after a dropout
+// gets its preset reloaded and, if required, is restarted sampling
+void SensorsArray::checkAvailability() {
+
+	for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
+		unsigned short mask = (1 << n);
+		bool available = sensors[n]->isReady() && sensors[n]->isAvailable();
+		if (available == ((availableMap & mask) != 0)) {
+			continue;
+		}
+
+		if (!available) {
+			availableMap &= ~mask;
+			dropoutCount[n]++;
+			continue;
+		}
+
+		availableMap |= mask;
+		if (discoveredMap & mask) {
+			reconnectCount[n]++;
+			for (unsigned char channel = 0; channel < NUM_OF_TOTAL_CHANNELS; channel++) {
+				if ((chToSamplerSubChannel[channel].sampler == n) && chToSamplerSubChannel[channel].firstChannelForSampler) {
+					loadPreset(channel);
+				}
+			}
+		}
+		discoveredMap |= mask;
+
+		if (samplingEnabled) {
+			timebaseTimer[n] = 0;
+			samplers[n]->onStartSampling();
+		}
+	}
+}
+
+// Restart the discovery of the next absent device, one for each call,
+// so that the buses are never starved by the discovery procedures
+void SensorsArray::reprobeAbsentDevice() {
+
+	for (unsigned char n = 0; n < NUM_OF_TOTAL_SENSORS; n++) {
+		unsigned char sensor = reprobeNext;
+		reprobeNext = (reprobeNext + 1) % NUM_OF_TOTAL_SENSORS;
+
+		if ((sensors[sensor]->getBringUpStatus() != SensorDevice::BRINGUP_PENDING) &&
+				!(sensors[sensor]->isReady() && sensors[sensor]->isAvailable())) {
+			sensors[sensor]->restartBringUp();
+			return;
+		}
+	}
 }
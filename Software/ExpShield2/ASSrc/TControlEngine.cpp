@@ -27,6 +27,8 @@
 #include "PWMHelper.h"
 #include "CCDriveEngine.h"
 #include "ADT7470Device.h"
+#include "TelemetryHelper.h"
+#include <string.h>
 
 #define TCONTROL_ENGINE_PERIOD				99		/* Once a second */
 #define EXT_FAN_BLANK_TIMEOUT				60		/* 60 seconds of consecutive heating */
@@ -37,14 +39,28 @@
 #define MAX_T_EXT_H							MAX_T_INT_C + 2000
 #define MAX_T_INT_H							MAX_T_INT_C + 3000
 
+#define REGION_HYSTERESIS					50		/* in 1/100C, setpoint to ambient band for heating/cooling region switch */
+#define AMBIENT_FILTER_SHIFT				4		/* Ambient temperature IIR filter (1/16) */
+#define AMBIENT_MAX_AGE						900		/* 15 minutes without samples before the ambient is unknown */
+
+#define AUTOTUNE_HYSTERESIS					10		/* in 1/100C, relay switching band around the setpoint */
+#define AUTOTUNE_SKIPPED_CYCLES				1		/* Oscillation cycles discarded while settling */
+#define AUTOTUNE_MEASURED_CYCLES			3		/* Oscillation cycles averaged for results */
+#define AUTOTUNE_MIN_AMPLITUDE				2		/* in 1/100C, smaller oscillations are noise */
+#define AUTOTUNE_TIMEOUT					14400	/* 4 hours */
+#define AUTOTUNE_PI							3.14159265
+#define AUTOTUNE_MAX_COEFFICIENT			32767.0	/* Largest coefficient held by the 16.16 PID registers */
+
 TControlEngine TControlEngine::instance;
 
 TControlEngine::TControlEngine() : PIDEngine(), enabled(false), prescaler(TCONTROL_ENGINE_PERIOD/3),
-									extFanBlankTimer(EXT_FAN_BLANK_TIMEOUT), overheatBlankTimer(OVERHEAT_BLANK_TIMEOUT), currentDrive(0) {
+									extFanBlankTimer(EXT_FAN_BLANK_TIMEOUT), overheatBlankTimer(OVERHEAT_BLANK_TIMEOUT), currentDrive(0), appliedDrive(0),
+									heatingGains{0.1, 0.02, 0.0, 0.0}, coolingGains{0.0, 0.0, 0.0, 0.0},
+									heatingRegion(true), ambientValid(false), ambientAge(0), ambientTemperature(0), feedforwardDrive(0) {
 
 	// Initial PID coefficients are set as default
 	// but may be overridden by external calls
-    setCoefficients(0.1, 0.02, 0.0);
+    setCoefficients(heatingGains.p, heatingGains.i, heatingGains.d);
 
 	// Output min and max are expressed
 	// in duty cycle percentage, in 1/100 units
@@ -56,6 +72,9 @@ TControlEngine::TControlEngine() : PIDEngine(), enabled(false), prescaler(TCONTR
 	// that can be overridden by external calls
 	setCoolingStartPercentage(100);	// 1% in 1/100 units
 	setHeatingStartPercentage(100);	// 1% in 1/100 units
+
+	memset(&autotune, 0, sizeof(autotune));
+	autotune.status = AUTOTUNE_IDLE;
 }
 
 TControlEngine::~TControlEngine() {
@@ -63,6 +82,10 @@ TControlEngine::~TControlEngine() {
 
 // Temperature setpoint is expressed in 1/100 C
 void TControlEngine::setTemperatureSetpoint(short tSetpoint) {
+	// Autotune results are valid only around a fixed setpoint
+	if ((tSetpoint != (short)getSetPoint()) && (autotune.status == AUTOTUNE_RUNNING)) {
+		autotune.status = AUTOTUNE_ABORTED;
+	}
 	setSetPoint(tSetpoint);
 }
 
@@ -99,24 +122,43 @@ void TControlEngine::loop(short currentTemperature) {
 			AS_ADT7470.setInternalFanSpeedAtSetpoint();
 			AS_ADT7470.setCirculationFanSpeedAtSetpoint();
 
-			// Calculate the next drive value
-			currentDrive = (short int) getNextDriveValue(currentTemperature);
+			// Track the ambient temperature for the feedforward
+			short extHT = AS_ADT7470.getTemperatureForChannel(ADT7470_CHANNEL_T_EXT_HEATSINK);
+			updateAmbientTemperature(extHT, (extFanBlankTimer == 0));
+
+			// Calculate the next drive value (from the relay, when autotuning)
+			unsigned char telemetryFlags = TELEMETRY_FLAG_ENABLED;
+			if (autotune.status == AUTOTUNE_RUNNING) {
+				telemetryFlags |= TELEMETRY_FLAG_AUTOTUNE;
+				currentDrive = getAutotuneDrive(currentTemperature);
+			} else {
+				currentDrive = getScheduledDriveValue(currentTemperature);
+				if (isOutputClamped()) {
+					telemetryFlags |= TELEMETRY_FLAG_CLAMPED;
+				}
+			}
+			if (heatingRegion) {
+				telemetryFlags |= TELEMETRY_FLAG_HEATING;
+			}
 
 			// A drive value greater than zero identifies heating requests.
 			bool heating = (currentDrive >= 0);
+			unsigned short heatingDrive = 0;
+			unsigned short coolingDrive = 0;
 
 			// Check if we don't have some unsafe conditions, like temperatures too high
 			// internally and/or externally
 			short intCT = AS_ADT7470.getTemperatureForChannel(ADT7470_CHANNEL_T_INT_CHAMBER);
-			short extHT = AS_ADT7470.getTemperatureForChannel(ADT7470_CHANNEL_T_EXT_HEATSINK);
 			short intHT = AS_ADT7470.getTemperatureForChannel(ADT7470_CHANNEL_T_INT_HEATSINK);
 			bool overheat = (intCT > MAX_T_INT_C) || (extHT > MAX_T_EXT_H) || (intHT > MAX_T_INT_H);
 			if (overheat) {
 				overheatBlankTimer = OVERHEAT_BLANK_TIMEOUT;
+				telemetryFlags |= TELEMETRY_FLAG_OVERHEAT;
 			} else {
 				if (overheatBlankTimer != 0) {
 					overheatBlankTimer--;
 					overheat = true;
+					telemetryFlags |= TELEMETRY_FLAG_OVERHEAT_BLANK;
 				}
 			}
 
@@ -131,8 +173,9 @@ void TControlEngine::loop(short currentTemperature) {
 				// and not in overheating status
 				if (!overheat && (currentDrive >= heatingMin)) {
 
-					AS_PWM.setHeater1DutyCycle(currentDrive);
-					AS_PWM.setHeater2DutyCycle(currentDrive);
+					heatingDrive = currentDrive;
+					AS_PWM.setHeater1DutyCycle(heatingDrive);
+					AS_PWM.setHeater2DutyCycle(heatingDrive);
 
 				} else {
 
@@ -148,7 +191,7 @@ void TControlEngine::loop(short currentTemperature) {
 				AS_PWM.setHeater2DutyCycle(0);
 
 				// Drive the constant current engine appropriately, if over the minimum threshold
-				unsigned short coolingDrive = -currentDrive;
+				coolingDrive = -currentDrive;
 				if (coolingDrive >= coolingMin) {
 
 					// Drive the external fan appropriately
@@ -168,7 +211,11 @@ void TControlEngine::loop(short currentTemperature) {
 					// Avoid to turn on the cooling if in overheating or if the external fan is not properly
 					// rotating in the last two minutes. This avoid to self-destroy the
 					// peltier cell in case of external fan lock and/or damaged fan
-					if (overheat || (AS_ADT7470.getFanLastSeenRotating(ADT7470_CHANNEL_F_EXT_HEATSINK) > MAX_EXT_FAN_NOT_ROTATING_PERIOD)) {
+					bool fanLock = (AS_ADT7470.getFanLastSeenRotating(ADT7470_CHANNEL_F_EXT_HEATSINK) > MAX_EXT_FAN_NOT_ROTATING_PERIOD);
+					if (fanLock) {
+						telemetryFlags |= TELEMETRY_FLAG_FAN_LOCK;
+					}
+					if (overheat || fanLock) {
 						coolingDrive = 0;
 					}
 
@@ -177,17 +224,24 @@ void TControlEngine::loop(short currentTemperature) {
 				} else {
 
 					// Below the minimum threshold. Turn off the cooler.
+					coolingDrive = 0;
 					AS_CCDRIVER.setCurrentSetPoint(0);
 				}
 			}
 
+			appliedDrive = (heatingDrive != 0)? (short)heatingDrive : -(short)coolingDrive;
+
 			// Shut down the external fan when the blank timer has expired
 			if (extFanBlankTimer > 0) {
 				extFanBlankTimer--;
+				telemetryFlags |= TELEMETRY_FLAG_EXT_FAN;
 			} else {
 				AS_ADT7470.setExternalFanSpeed(0);
 			}
 
+			if (AS_TELEMETRY.sample(TELEMETRY_SOURCE_TCONTROL)) {
+				recordTelemetry(currentTemperature, telemetryFlags);
+			}
 		}
 	} else {
 
@@ -200,6 +254,7 @@ void TControlEngine::loop(short currentTemperature) {
 		AS_PWM.setHeater1DutyCycle(0);
 		AS_PWM.setHeater2DutyCycle(0);
 		AS_CCDRIVER.setCurrentSetPoint(0);
+		appliedDrive = 0;
 	}
 }
 
@@ -209,8 +264,281 @@ void TControlEngine::tick() {
 
 void TControlEngine::setEnabled(bool on) {
 	enabled = on;
+
+	if (!enabled && (autotune.status == AUTOTUNE_RUNNING)) {
+		autotune.status = AUTOTUNE_ABORTED;
+	}
 }
 
 short TControlEngine::getCurrentDrive() {
 	return currentDrive;
 }
+
+short TControlEngine::getAppliedDrive() const {
+	return appliedDrive;
+}
+
+void TControlEngine::setHeatingCoefficients(double p, double i, double d) {
+	heatingGains.p = p;
+	heatingGains.i = i;
+	heatingGains.d = d;
+	applyRegionCoefficients();
+}
+
+void TControlEngine::setCoolingCoefficients(double p, double i, double d) {
+	coolingGains.p = p;
+	coolingGains.i = i;
+	coolingGains.d = d;
+	applyRegionCoefficients();
+}
+
+void TControlEngine::setFeedforwardCoefficients(double heating, double cooling) {
+	heatingGains.ff = heating;
+	coolingGains.ff = cooling;
+}
+
+bool TControlEngine::isHeatingRegion() const {
+	return heatingRegion;
+}
+
+bool TControlEngine::getAmbientTemperature(short& temperature) const {
+	temperature = ambientTemperature;
+	return ambientValid;
+}
+
+short TControlEngine::getFeedforwardDrive() const {
+	return feedforwardDrive;
+}
+
+// Low pass filtered external heatsink temperature, sampled only when
+// it's not heated by the Peltier cell. Called once a second.
+// The value expires when not sampled for a long period (i.e. while cooling).
+void TControlEngine::updateAmbientTemperature(short extHeatsinkTemperature, bool coolerOff) {
+
+	if (!coolerOff) {
+		if (ambientValid) {
+			ambientAge++;
+			if (ambientAge > AMBIENT_MAX_AGE) {
+				ambientValid = false;
+			}
+		}
+		return;
+	}
+
+	ambientAge = 0;
+	if (!ambientValid) {
+		ambientTemperature = extHeatsinkTemperature;
+		ambientValid = true;
+	} else {
+		ambientTemperature += (extHeatsinkTemperature - ambientTemperature) >> AMBIENT_FILTER_SHIFT;
+	}
+}
+
+// Apply the PID coefficients for the current region
+void TControlEngine::applyRegionCoefficients() {
+
+	const gainset* gains = (heatingRegion || (coolingGains.p == 0.0))? &heatingGains : &coolingGains;
+	changeCoefficients(gains->p, gains->i, gains->d);
+}
+
+// PID with coefficients scheduled by region plus the ambient feedforward
+short TControlEngine::getScheduledDriveValue(short currentTemperature) {
+
+	short setpoint = (short)getSetPoint();
+
+	// Select the operating region, with some hysteresis.
+	// Without an ambient reference follow the error sign.
+	short reference = (ambientValid)? ambientTemperature : currentTemperature;
+	bool heating = heatingRegion;
+	if (setpoint > (reference + REGION_HYSTERESIS)) {
+		heating = true;
+	} else if (setpoint < (reference - REGION_HYSTERESIS)) {
+		heating = false;
+	}
+
+	if (heating != heatingRegion) {
+		heatingRegion = heating;
+		applyRegionCoefficients();
+	}
+
+	// Feedforward compensates for the heat exchanged with the outside.
+	// It's disabled while the ambient is unknown or stale.
+	double ff = 0.0;
+	if (ambientValid) {
+		ff = ((heatingRegion)? heatingGains.ff : coolingGains.ff) * (setpoint - ambientTemperature);
+		if (ff > 10000) {
+			ff = 10000;
+		} else if (ff < -10000) {
+			ff = -10000;
+		}
+	}
+	feedforwardDrive = (short)ff;
+
+	// The PID works on the remaining range so the integral term does not wind up
+	setOutMinMax(-10000 - ff, 10000 - ff);
+
+	return (short)(ff + getNextDriveValue(currentTemperature));
+}
+
+// Record the loop internals in the telemetry capture ring
+void TControlEngine::recordTelemetry(short currentTemperature, unsigned char flags) {
+
+	double pTerm, iTerm, dTerm;
+	getLastTerms(pTerm, iTerm, dTerm);
+
+	TelemetryHelper::telemetryrecord rec;
+	rec.source = TELEMETRY_SOURCE_TCONTROL;
+	rec.flags = flags;
+	rec.values[0] = currentTemperature;
+	rec.values[1] = TelemetryHelper::saturate((long)getSetPoint() - currentTemperature);
+	rec.values[2] = TelemetryHelper::saturate((long)pTerm);
+	rec.values[3] = TelemetryHelper::saturate((long)iTerm);
+	rec.values[4] = TelemetryHelper::saturate((long)dTerm);
+	rec.values[5] = feedforwardDrive;
+	rec.values[6] = currentDrive;
+
+	AS_TELEMETRY.record(&rec);
+}
+
+bool TControlEngine::startAutotune(unsigned short relayDrive) {
+
+	if (!enabled || (relayDrive == 0) || (relayDrive > 10000)) {
+		return false;
+	}
+
+	memset(&autotune, 0, sizeof(autotune));
+	autotune.relayDrive = relayDrive;
+	autotune.status = AUTOTUNE_RUNNING;
+
+	return true;
+}
+
+void TControlEngine::abortAutotune() {
+	if (autotune.status == AUTOTUNE_RUNNING) {
+		autotune.status = AUTOTUNE_ABORTED;
+	}
+}
+
+TControlEngine::autotunestatus TControlEngine::getAutotuneStatus() const {
+	return autotune.status;
+}
+
+unsigned char TControlEngine::getAutotuneCycles() const {
+	return autotune.measuredCycles;
+}
+
+float TControlEngine::getAutotuneUltimateGain() const {
+	return autotune.ultimateGain;
+}
+
+unsigned long TControlEngine::getAutotuneUltimatePeriod() const {
+	return autotune.ultimatePeriod;
+}
+
+unsigned short TControlEngine::getAutotuneAmplitude() const {
+	return autotune.amplitude;
+}
+
+bool TControlEngine::takeAutotuneCoefficients(double& p, double& i, double& d) {
+
+	if (!autotune.resultPending) {
+		return false;
+	}
+	autotune.resultPending = false;
+
+	p = autotune.p;
+	i = autotune.i;
+	d = autotune.d;
+
+	return true;
+}
+
+// Relay with hysteresis around the setpoint. Called once a second.
+short TControlEngine::getAutotuneDrive(short currentTemperature) {
+
+	short error = (short)getSetPoint() - currentTemperature;
+
+	autotune.timer++;
+	if (autotune.timer > AUTOTUNE_TIMEOUT) {
+		stopAutotune(AUTOTUNE_FAILED, currentTemperature);
+		return 0;
+	}
+
+	// Track the oscillation peaks
+	if (currentTemperature > autotune.cycleMax) {
+		autotune.cycleMax = currentTemperature;
+	}
+	if (currentTemperature < autotune.cycleMin) {
+		autotune.cycleMin = currentTemperature;
+	}
+
+	// Each switch to heating starts a new oscillation cycle
+	if (!autotune.relayHeating && (error > AUTOTUNE_HYSTERESIS)) {
+		autotune.relayHeating = true;
+		onAutotuneCycle(currentTemperature);
+		if (autotune.status != AUTOTUNE_RUNNING) {
+			return 0;
+		}
+	} else if (autotune.relayHeating && (error < -AUTOTUNE_HYSTERESIS)) {
+		autotune.relayHeating = false;
+	}
+
+	return (autotune.relayHeating)? autotune.relayDrive : -autotune.relayDrive;
+}
+
+void TControlEngine::onAutotuneCycle(short currentTemperature) {
+
+	// Collect the cycle just terminated, skipping the first ones
+	if (autotune.switches > AUTOTUNE_SKIPPED_CYCLES) {
+		autotune.periodSum += autotune.timer - autotune.cycleStart;
+		autotune.amplitudeSum += (autotune.cycleMax - autotune.cycleMin) / 2;
+		autotune.measuredCycles++;
+	}
+
+	autotune.switches++;
+	autotune.cycleStart = autotune.timer;
+	autotune.cycleMax = currentTemperature;
+	autotune.cycleMin = currentTemperature;
+
+	if (autotune.measuredCycles < AUTOTUNE_MEASURED_CYCLES) {
+		return;
+	}
+
+	autotune.amplitude = autotune.amplitudeSum / autotune.measuredCycles;
+	autotune.ultimatePeriod = autotune.periodSum / autotune.measuredCycles;
+	if ((autotune.amplitude < AUTOTUNE_MIN_AMPLITUDE) || (autotune.ultimatePeriod == 0)) {
+		stopAutotune(AUTOTUNE_FAILED, currentTemperature);
+		return;
+	}
+
+	// Ultimate gain from the relay describing function
+	double ku = (4.0 * autotune.relayDrive) / (AUTOTUNE_PI * autotune.amplitude);
+	double tu = autotune.ultimatePeriod;
+	autotune.ultimateGain = ku;
+
+	// Tyreus-Luyben tuning: less aggressive and better damped than Ziegler-Nichols.
+	// The PID runs once a second so integral and derivative times are in steps.
+	double ti = 2.2 * tu;
+	double td = tu / 6.3;
+	autotune.p = ku / 2.2;
+	autotune.i = autotune.p / ti;
+	autotune.d = autotune.p * td;
+
+	// Results that do not fit the PID registers must not be stored
+	if ((autotune.p > AUTOTUNE_MAX_COEFFICIENT) || (autotune.i > AUTOTUNE_MAX_COEFFICIENT) ||
+			(autotune.d > AUTOTUNE_MAX_COEFFICIENT)) {
+		stopAutotune(AUTOTUNE_FAILED, currentTemperature);
+		return;
+	}
+	autotune.resultPending = true;
+
+	stopAutotune(AUTOTUNE_DONE, currentTemperature);
+}
+
+void TControlEngine::stopAutotune(autotunestatus result, short currentTemperature) {
+
+	autotune.status = result;
+
+	// Resume the PID without the history collected before the autotune
+	resetState(currentTemperature);
+}
@@ -0,0 +1,142 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *			European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#include "TelemetryHelper.h"
+#include "stm32f0xx_hal.h"
+#include <string.h>
+
+TelemetryHelper TelemetryHelper::instance;
+
+// Capture starts at power on, recording the temperature control only,
+// so the last minute before an overheat or a fan lock is always available
+TelemetryHelper::TelemetryHelper() : head(0), count(0), status(CAPTURE_RUNNING),
+									triggerMask(TELEMETRY_DEFAULT_TRIGGER),
+									postTriggerLeft(TELEMETRY_RING_SIZE/2) {
+
+	clear();
+	decimation[TELEMETRY_SOURCE_TCONTROL] = 1;
+	decimation[TELEMETRY_SOURCE_CCDRIVER] = 0;
+}
+
+TelemetryHelper::~TelemetryHelper() {
+}
+
+void TelemetryHelper::start(const unsigned char* _decimation, unsigned char _triggerMask, unsigned short postTrigger) {
+
+	// Records are taken from the ADC interrupt too
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	clear();
+	memcpy(decimation, _decimation, sizeof(decimation));
+	triggerMask = _triggerMask;
+	postTriggerLeft = (postTrigger > TELEMETRY_RING_SIZE)? TELEMETRY_RING_SIZE : postTrigger;
+	status = CAPTURE_RUNNING;
+
+	__set_PRIMASK(primask);
+}
+
+void TelemetryHelper::stop() {
+	status = CAPTURE_STOPPED;
+}
+
+bool TelemetryHelper::sample(unsigned char source) {
+
+	if ((source >= TELEMETRY_NUM_OF_SOURCES) || (decimation[source] == 0) ||
+			((status != CAPTURE_RUNNING) && (status != CAPTURE_TRIGGERED))) {
+		return false;
+	}
+
+	decimationCounter[source]++;
+	if (decimationCounter[source] < decimation[source]) {
+		return false;
+	}
+
+	decimationCounter[source] = 0;
+	return true;
+}
+
+void TelemetryHelper::record(const telemetryrecord* rec) {
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if ((status == CAPTURE_RUNNING) || (status == CAPTURE_TRIGGERED)) {
+
+		ring[head] = *rec;
+		ring[head].timestamp = HAL_GetTick();
+		head = (head + 1) % TELEMETRY_RING_SIZE;
+		if (count < TELEMETRY_RING_SIZE) {
+			count++;
+		}
+
+		if ((status == CAPTURE_RUNNING) && ((rec->flags & triggerMask) != 0)) {
+			status = CAPTURE_TRIGGERED;
+		}
+
+		if (status == CAPTURE_TRIGGERED) {
+			if (postTriggerLeft == 0) {
+				status = CAPTURE_DONE;
+			} else {
+				postTriggerLeft--;
+			}
+		}
+	}
+
+	__set_PRIMASK(primask);
+}
+
+TelemetryHelper::capturestatus TelemetryHelper::getStatus() const {
+	return status;
+}
+
+unsigned short TelemetryHelper::getCount() const {
+	return count;
+}
+
+bool TelemetryHelper::getRecord(unsigned short index, telemetryrecord* rec) const {
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	bool valid = (index < count);
+	if (valid) {
+		*rec = ring[(head + TELEMETRY_RING_SIZE - count + index) % TELEMETRY_RING_SIZE];
+	}
+
+	__set_PRIMASK(primask);
+
+	return valid;
+}
+
+short TelemetryHelper::saturate(long value) {
+	return (value > 32767)? 32767 : ((value < -32768)? -32768 : (short)value);
+}
+
+void TelemetryHelper::clear() {
+
+	head = 0;
+	count = 0;
+	memset(decimationCounter, 0, sizeof(decimationCounter));
+}
@@ -0,0 +1,90 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#ifndef BENCHMARKHELPER_H_
+#define BENCHMARKHELPER_H_
+
+// Host micro benchmarks for the platform independent firmware kernels.
+// Each kernel is timed in ns per call on the host. The Cortex-M0 cost is
+// estimated by scaling the host time with the ratio measured on a reference
+// loop of the same arithmetic class, whose cost on the target is known:
+// integer code runs at about one cycle per instruction there, while float and
+// double operations are library calls. The estimate is coarse (within a
+// factor of two or so); it tracks regressions, it does not replace target
+// measurements.
+class BenchmarkHelper {
+public:
+	typedef void (*benchmarkkernel)(void* context);
+
+	// Dominant arithmetic of a kernel, selects the estimate ratio
+	typedef enum _arithmetic {
+		ARITHMETIC_INTEGER,
+		ARITHMETIC_FLOAT,
+		ARITHMETIC_DOUBLE,
+		ARITHMETIC_NUM
+	} arithmetic;
+
+	typedef struct _benchmarkresult {
+		unsigned long iterations;
+		double minNs;				// Best batch average, ns per call
+		double avgNs;				// Overall average, ns per call
+		double m0Cycles;			// Estimated Cortex-M0 cycles per call
+	} benchmarkresult;
+
+public:
+	virtual ~BenchmarkHelper();
+
+	void setIterations(unsigned long value);
+
+	// Measure the reference loops. Called once, before the first measure
+	void calibrate();
+
+	// Time a kernel and estimate its cost on the target
+	void measure(benchmarkkernel kernel, void* context, arithmetic type, benchmarkresult* result);
+
+	// Measure and print a report line
+	void run(const char* name, benchmarkkernel kernel, void* context, arithmetic type);
+
+	// Parse the common command line options (--iterations <n>)
+	bool parseOptions(int argc, char** argv);
+
+	static inline BenchmarkHelper* getInstance() { return &instance; }
+
+private:
+	BenchmarkHelper();
+
+	double timeBatches(benchmarkkernel kernel, void* context, unsigned long iterations, double* minNs);
+
+private:
+	static BenchmarkHelper instance;
+
+	unsigned long iterations;
+	bool calibrated;
+	double cyclesPerNs[ARITHMETIC_NUM];
+};
+
+#define AS_BENCHMARK (*(BenchmarkHelper::getInstance()))
+
+#endif /* BENCHMARKHELPER_H_ */
@@ -0,0 +1,193 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include "BenchmarkHelper.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCHMARK_DEFAULT_ITERATIONS	200000
+#define BENCHMARK_BATCH_SIZE			100
+#define BENCHMARK_CORE_CLOCK_MHZ		48.0
+
+// Reference loops: steps per kernel call and Cortex-M0 cycles per step.
+// Integer: muls, adds, lsrs, adds, subs, bne (taken, 3 cycles).
+// Float and double: one multiply and one add through the libgcc soft-float
+// routines, including the calls (about 110 and 200 cycles).
+#define REFERENCE_STEPS					64
+#define REFERENCE_INTEGER_STEP_CYCLES	8.0
+#define REFERENCE_FLOAT_STEP_CYCLES		110.0
+#define REFERENCE_DOUBLE_STEP_CYCLES	200.0
+
+typedef struct _referencecontext {
+	unsigned long integer;
+	float single;
+	double dual;
+} referencecontext;
+
+static void integerReference(void* context) {
+
+	referencecontext* ctx = (referencecontext*)context;
+	unsigned long x = ctx->integer;
+	unsigned long acc = 0;
+	for (unsigned char n = 0; n < REFERENCE_STEPS; n++) {
+		x = x * 1664525UL + 1013904223UL;
+		acc += x >> 16;
+	}
+	ctx->integer = x ^ acc;
+}
+
+static void floatReference(void* context) {
+
+	referencecontext* ctx = (referencecontext*)context;
+	float value = ctx->single;
+	for (unsigned char n = 0; n < REFERENCE_STEPS; n++) {
+		value = value * 0.999f + 0.5f;
+	}
+	ctx->single = value;
+}
+
+static void doubleReference(void* context) {
+
+	referencecontext* ctx = (referencecontext*)context;
+	double value = ctx->dual;
+	for (unsigned char n = 0; n < REFERENCE_STEPS; n++) {
+		value = value * 0.999 + 0.5;
+	}
+	ctx->dual = value;
+}
+
+static double getNs() {
+
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+BenchmarkHelper BenchmarkHelper::instance;
+
+BenchmarkHelper::BenchmarkHelper() : iterations(BENCHMARK_DEFAULT_ITERATIONS), calibrated(false) {
+
+	for (unsigned char n = 0; n < ARITHMETIC_NUM; n++) {
+		cyclesPerNs[n] = 0.0;
+	}
+}
+
+BenchmarkHelper::~BenchmarkHelper() {
+}
+
+void BenchmarkHelper::setIterations(unsigned long value) {
+	iterations = (value < BENCHMARK_BATCH_SIZE)? BENCHMARK_BATCH_SIZE : value;
+}
+
+bool BenchmarkHelper::parseOptions(int argc, char** argv) {
+
+	for (int n = 1; n < argc; n++) {
+		if (!strcmp(argv[n], "--iterations") && ((n + 1) < argc)) {
+			setIterations(strtoul(argv[++n], NULL, 10));
+		} else {
+			fprintf(stderr, "Usage: %s [--iterations <n>]\n", argv[0]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Kernels are called in batches so the clock reading cost is spread.
+// Returns the average ns per call; minNs is the best batch average, the
+// least disturbed by the host scheduler.
+double BenchmarkHelper::timeBatches(benchmarkkernel kernel, void* context, unsigned long count, double* minNs) {
+
+	unsigned long batches = count / BENCHMARK_BATCH_SIZE;
+	double best = 1e30;
+	double total = 0.0;
+
+	// Warm up caches and branch predictors
+	for (unsigned short n = 0; n < BENCHMARK_BATCH_SIZE; n++) {
+		kernel(context);
+	}
+
+	for (unsigned long batch = 0; batch < batches; batch++) {
+		double start = getNs();
+		for (unsigned short n = 0; n < BENCHMARK_BATCH_SIZE; n++) {
+			kernel(context);
+		}
+		double elapsed = (getNs() - start) / BENCHMARK_BATCH_SIZE;
+
+		total += elapsed;
+		if (elapsed < best) {
+			best = elapsed;
+		}
+	}
+
+	*minNs = best;
+	return total / batches;
+}
+
+void BenchmarkHelper::calibrate() {
+
+	static const benchmarkkernel references[ARITHMETIC_NUM] = {
+			&integerReference, &floatReference, &doubleReference
+	};
+	static const double stepCycles[ARITHMETIC_NUM] = {
+			REFERENCE_INTEGER_STEP_CYCLES, REFERENCE_FLOAT_STEP_CYCLES, REFERENCE_DOUBLE_STEP_CYCLES
+	};
+
+	referencecontext ctx = { 1, 1.0f, 1.0 };
+	for (unsigned char n = 0; n < ARITHMETIC_NUM; n++) {
+		double minNs;
+		timeBatches(references[n], &ctx, iterations / 10, &minNs);
+		cyclesPerNs[n] = (stepCycles[n] * REFERENCE_STEPS) / minNs;
+	}
+
+	calibrated = true;
+
+	printf("Reference M0 cycles per host ns: integer %.2f, float %.2f, double %.2f\n",
+			cyclesPerNs[ARITHMETIC_INTEGER], cyclesPerNs[ARITHMETIC_FLOAT], cyclesPerNs[ARITHMETIC_DOUBLE]);
+	printf("%-40s %10s %10s %12s %10s\n", "Kernel", "min ns/op", "avg ns/op", "M0 cycles", "M0 us");
+}
+
+void BenchmarkHelper::measure(benchmarkkernel kernel, void* context, arithmetic type, benchmarkresult* result) {
+
+	if (!calibrated) {
+		calibrate();
+	}
+
+	result->iterations = iterations;
+	result->avgNs = timeBatches(kernel, context, iterations, &result->minNs);
+	result->m0Cycles = result->minNs * cyclesPerNs[(type < ARITHMETIC_NUM)? type : ARITHMETIC_INTEGER];
+}
+
+void BenchmarkHelper::run(const char* name, benchmarkkernel kernel, void* context, arithmetic type) {
+
+	benchmarkresult result;
+	measure(kernel, context, type, &result);
+
+	printf("%-40s %10.1f %10.1f %12.0f %10.2f\n", name, result.minNs, result.avgNs,
+			result.m0Cycles, result.m0Cycles / BENCHMARK_CORE_CLOCK_MHZ);
+}
@@ -16,44 +16,21 @@
  * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
  *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
  *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
- *			European Commission - Joint Research Centre,
+ *      European Commission - Joint Research Centre,
  * - Marco Signorini, marco.signorini@liberaintentio.com
  *
  * ===========================================================================
  */
 
-#include <SamplesAveragerNextPM.h>
-#include "NextPMDevice.h"
 
-SamplesAveragerNextPM::SamplesAveragerNextPM()
-: SamplesAverager (NEXTPM_NUM_CHANNELS-1), sampleTime(0), sensorStatus(0), periodTerminated(0) {
-}
+#ifndef BOARDHAL_H_
+#define BOARDHAL_H_
 
-SamplesAveragerNextPM::~SamplesAveragerNextPM() {
-}
+// ChemShield2 peripheral handles and HAL callbacks on the simulated HAL, as
+// provided on the target by the CubeMX generated main.c.
+// Shared by the board check and the host benchmarks.
 
-bool SamplesAveragerNextPM::collectSample(unsigned char channel, unsigned short sample, unsigned long _timestamp) {
+// Initialize the peripherals like the MX_xxx_Init() functions do
+void simBoardInit();
 
-	if (channel < NEXTPM_STATUS) {
-		periodTerminated = SamplesAverager::collectSample(channel, sample, _timestamp);
-		return periodTerminated;
-	}
-
-	if (channel == NEXTPM_STATUS) {
-		sensorStatus = sample;
-		return periodTerminated;
-	}
-
-	return false;
-}
-
-unsigned short SamplesAveragerNextPM::lastAveragedValue(unsigned char channel) {
-
-	if (channel < NEXTPM_STATUS) {
-		return SamplesAverager::lastAveragedValue(channel);
-	} else if (channel == NEXTPM_STATUS) {
-		return sensorStatus;
-	}
-
-	return 0;
-}
+#endif /* BOARDHAL_H_ */
@@ -0,0 +1,85 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#ifndef __MAIN_H
+#define __MAIN_H
+
+// Host replacement of the CubeMX generated main.h, not shipped with the
+// ChemShield2 sources. Ports follow the MX_GPIO_Init() in Src/main.c;
+// pin numbers only need to be distinct for the host build.
+
+#include "stm32f0xx_hal.h"
+
+#define DAC1_GAIN_Pin GPIO_PIN_0
+#define DAC1_GAIN_GPIO_Port GPIOC
+#define DAC2_GAIN_Pin GPIO_PIN_1
+#define DAC2_GAIN_GPIO_Port GPIOC
+#define DAC3_GAIN_Pin GPIO_PIN_2
+#define DAC3_GAIN_GPIO_Port GPIOC
+#define DAC4_GAIN_Pin GPIO_PIN_3
+#define DAC4_GAIN_GPIO_Port GPIOC
+#define ADDR2_Pin GPIO_PIN_5
+#define ADDR2_GPIO_Port GPIOC
+#define DBG1_Pin GPIO_PIN_6
+#define DBG1_GPIO_Port GPIOC
+#define AFE1_MENB_Pin GPIO_PIN_7
+#define AFE1_MENB_GPIO_Port GPIOC
+#define AFE2_MENB_Pin GPIO_PIN_8
+#define AFE2_MENB_GPIO_Port GPIOC
+#define AFE3_MENB_Pin GPIO_PIN_9
+#define AFE3_MENB_GPIO_Port GPIOC
+#define AFE4_MENB_Pin GPIO_PIN_10
+#define AFE4_MENB_GPIO_Port GPIOC
+#define TX_LED_Pin GPIO_PIN_11
+#define TX_LED_GPIO_Port GPIOC
+#define RX_LED_Pin GPIO_PIN_12
+#define RX_LED_GPIO_Port GPIOC
+#define ADDR3_Pin GPIO_PIN_13
+#define ADDR3_GPIO_Port GPIOC
+#define USER_BUTTON_Pin GPIO_PIN_15
+#define USER_BUTTON_GPIO_Port GPIOC
+
+#define ADC1_CS_Pin GPIO_PIN_2
+#define ADC1_CS_GPIO_Port GPIOA
+#define ADC2_CS_Pin GPIO_PIN_3
+#define ADC2_CS_GPIO_Port GPIOA
+#define ADC3_CS_Pin GPIO_PIN_4
+#define ADC3_CS_GPIO_Port GPIOA
+#define ADC4_CS_Pin GPIO_PIN_8
+#define ADC4_CS_GPIO_Port GPIOA
+
+#define HB_LED_Pin GPIO_PIN_2
+#define HB_LED_GPIO_Port GPIOB
+#define ADDR0_Pin GPIO_PIN_3
+#define ADDR0_GPIO_Port GPIOB
+#define ADDR1_Pin GPIO_PIN_4
+#define ADDR1_GPIO_Port GPIOB
+#define SBUS_FAULT_TXE_Pin GPIO_PIN_5
+#define SBUS_FAULT_TXE_GPIO_Port GPIOB
+#define BUS_CS_LWAKE_Pin GPIO_PIN_12
+#define BUS_CS_LWAKE_GPIO_Port GPIOB
+#define VUSB_Pin GPIO_PIN_15
+#define VUSB_GPIO_Port GPIOB
+
+#endif /* __MAIN_H */
@@ -0,0 +1,86 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include <stdio.h>
+#include "GlobalHalHandlers.h"
+#include "BenchmarkHelper.h"
+#include "DitherTool.h"
+#include "Sampler.h"
+
+// Host micro benchmarks of the ChemShield2 firmware kernels.
+// See BenchmarkHelper.h for how the Cortex-M0 estimates are obtained.
+
+#define BENCHMARK_IIR1_DENOMINATOR		16
+#define BENCHMARK_IIR2_DENOMINATOR		8
+
+// Give access to the filtering chain
+class BenchmarkSampler : public Sampler {
+public:
+	virtual bool sampleTick() { return false; }
+	virtual bool sampleLoop() { return false; }
+	virtual const char* getMeasurementUnit() const { return ""; }
+	virtual double evaluateMeasurement(unsigned short lastSample) const { return lastSample; }
+
+	void filter(unsigned short sample, unsigned char stages) {
+		onReadSample(sample);
+		for (unsigned char n = 0; n < stages; n++) {
+			applyIIRFilter(n);
+		}
+	}
+};
+
+typedef struct _iircontext {
+	BenchmarkSampler* sampler;
+	unsigned short sample;
+	unsigned char stages;
+} iircontext;
+
+static void iirKernel(void* context) {
+
+	iircontext* ctx = (iircontext*)context;
+	ctx->sampler->filter(ctx->sample, ctx->stages);
+	ctx->sample += 257;
+}
+
+int main(int argc, char** argv) {
+
+	if (!AS_BENCHMARK.parseOptions(argc, argv)) {
+		return 1;
+	}
+
+	DitherTool tool;
+	BenchmarkSampler sampler;
+	sampler.setDitherTool(&tool);
+	sampler.setIIRDenom(0, BENCHMARK_IIR1_DENOMINATOR);
+	sampler.setIIRDenom(1, BENCHMARK_IIR2_DENOMINATOR);
+
+	iircontext ctx = { &sampler, 1000, 1 };
+	AS_BENCHMARK.run("Sampler::applyIIRFilter (IIR1)", &iirKernel, &ctx, BenchmarkHelper::ARITHMETIC_DOUBLE);
+
+	ctx.stages = 2;
+	AS_BENCHMARK.run("Sampler::applyIIRFilter (IIR1+IIR2)", &iirKernel, &ctx, BenchmarkHelper::ARITHMETIC_DOUBLE);
+
+	return 0;
+}
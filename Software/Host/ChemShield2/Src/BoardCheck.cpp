@@ -0,0 +1,129 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#include "ChemSensorBoardImpl.h"
+#include "SensorsArray.h"
+#include "StaticBoard.h"
+#include "SimKernel.h"
+#include "BoardHal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ChemShield2 board check. The unchanged firmware is brought up on the
+// simulated HAL and samples for a while; the chemical channels must be
+// averaged, which requires each ChemSensorSampler to read the SensorsArray
+// ADCScanner (and not a copy of it, see StaticBoard.h).
+// No device model is attached: buses NACK and ADCs read zero.
+
+#define BOARDCHECK_DEFAULT_DURATION		30		/* Seconds */
+#define BOARDCHECK_PRESCALER			9		/* One sample each second */
+#define BOARDCHECK_DECIMATION			0
+#define BOARDCHECK_POSTSCALER			4		/* Averaged over 5 samples */
+#define BOARDCHECK_LOOP_COST_NS			100000ULL
+
+// Board array created by setup_impl()
+extern SensorsArray* sensorBoard;
+
+// Constructors taking references must bind to the caller's objects
+struct ProbeDevice {
+	unsigned char id;
+};
+
+struct ProbeConstSampler {
+	const ProbeDevice& device;
+	ProbeConstSampler(const ProbeDevice& _device) : device(_device) {}
+};
+
+struct ProbeSampler {
+	ProbeDevice& device;
+	unsigned char channel;
+	ProbeSampler(ProbeDevice& _device, unsigned char _channel) : device(_device), channel(_channel) {}
+};
+
+typedef TypeList<ProbeConstSampler, ProbeSampler> ProbeBoard;
+
+static bool checkStaticConstruction() {
+
+	static ProbeDevice device = { 0x5A };
+	ProbeConstSampler* constSampler = constructStatic<ProbeBoard, 0>(device);
+	ProbeSampler* sampler = constructStatic<ProbeBoard, 1>(device, 3);
+
+	bool result = (&constSampler->device == &device) && (&sampler->device == &device) && (sampler->channel == 3);
+	printf("Static construction references: %s\n", result? "ok" : "FAILED");
+
+	return result;
+}
+
+static bool checkChemSampling(unsigned long duration) {
+
+	simBoardInit();
+	setup_impl();
+
+	// The EEPROM is blank (not attached): configure the chemical channels
+	// like the host does through the protocol
+	for (unsigned char channel = CHEMSENSOR_1; channel <= CHEMSENSOR_4; channel++) {
+		sensorBoard->setSamplePrescaler(channel, BOARDCHECK_PRESCALER);
+		sensorBoard->setSampleDecimation(channel, BOARDCHECK_DECIMATION);
+		sensorBoard->setSamplePostscaler(channel, BOARDCHECK_POSTSCALER);
+	}
+	sensorBoard->enableSampling(true);
+
+	unsigned long long end = SIM_KERNEL.now() + (duration * SIM_NS_PER_S);
+	while (SIM_KERNEL.now() < end) {
+		loop_impl();
+		SIM_KERNEL.advance(BOARDCHECK_LOOP_COST_NS);
+	}
+
+	bool result = true;
+	for (unsigned char channel = CHEMSENSOR_1; channel <= CHEMSENSOR_4; channel++) {
+		unsigned short sample;
+		unsigned long timestamp;
+		sensorBoard->getLastSample(channel, sample, timestamp);
+
+		printf("Chemical channel %d: sample %u at %lu\n", channel, sample, timestamp);
+		result &= (timestamp != 0);
+	}
+	printf("Chemical sampling: %s\n", result? "ok" : "FAILED");
+
+	return result;
+}
+
+int main(int argc, char** argv) {
+
+	unsigned long duration = BOARDCHECK_DEFAULT_DURATION;
+	for (int n = 1; n < argc; n++) {
+		if ((strcmp(argv[n], "--duration") == 0) && ((n + 1) < argc)) {
+			duration = strtoul(argv[++n], NULL, 10);
+		} else {
+			fprintf(stderr, "Usage: %s [--duration seconds]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	bool result = checkStaticConstruction();
+	result &= checkChemSampling(duration);
+
+	return result? 0 : 1;
+}
@@ -0,0 +1,115 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#include "BoardHal.h"
+#include "GlobalHalHandlers.h"
+#include "ChemSensorBoardImpl.h"
+#include "SimKernel.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Peripheral handles, as declared by the CubeMX generated main.c
+CRC_HandleTypeDef hcrc;
+I2C_HandleTypeDef hi2c1;
+I2C_HandleTypeDef hi2c2;
+SPI_HandleTypeDef hspi1;
+TIM_HandleTypeDef htim17;
+UART_HandleTypeDef huart1;
+UART_HandleTypeDef huart2;
+
+// Peripherals initialization, mirrors the CubeMX MX_xxx_Init() functions
+void simBoardInit() {
+
+	hcrc.Instance = CRC;
+
+	hi2c1.Instance = I2C1;
+	hi2c2.Instance = I2C2;
+
+	hspi1.Instance = SPI1;
+	hspi1.Init.DataSize = SPI_DATASIZE_16BIT;
+	hspi1.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_32;
+
+	htim17.Instance = TIM17;
+	htim17.Init.Prescaler = 999;
+	htim17.Init.Period = 479;
+	HAL_TIM_Base_Init(&htim17);
+	HAL_NVIC_EnableIRQ(TIM17_IRQn);
+
+	huart1.Instance = USART1;
+	huart1.Init.BaudRate = 9600;
+	HAL_UART_Init(&huart1);
+
+	huart2.Instance = USART2;
+	huart2.Init.BaudRate = 38400;
+	HAL_UART_Init(&huart2);
+}
+
+extern "C" void _Error_Handler(char* file, int line) {
+
+	fprintf(stderr, "_Error_Handler reached at %s:%d\n", file, line);
+	abort();
+}
+
+/* HAL callbacks, as in main.c USER CODE 4 and in the TIM17 interrupt handler */
+extern "C" void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart) {
+	if (huart->Instance == USART1) {
+		uart1Interrupt(1);
+	} else if (huart->Instance == USART2) {
+		uart2Interrupt(1);
+	}
+}
+
+extern "C" void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
+	if (huart->Instance == USART1) {
+		uart1Interrupt(0);
+	} else if (huart->Instance == USART2) {
+		uart2Interrupt(0);
+	}
+}
+
+extern "C" void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+	if (huart->Instance == USART1) {
+		uart1Error();
+	} else if (huart->Instance == USART2) {
+		uart2Error();
+	}
+}
+
+extern "C" void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi) {
+	if (hspi->Instance == SPI1) {
+		spi1Interrupt();
+	}
+}
+
+extern "C" void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+	if (hspi->Instance == SPI1) {
+		spi1Error();
+	}
+}
+
+extern "C" void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim) {
+	if (htim->Instance == TIM17) {
+		timerInterrupt();
+	}
+}
@@ -0,0 +1,57 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#ifndef ADT7470MODEL_H_
+#define ADT7470MODEL_H_
+
+#include "BoardPlant.h"
+
+// ADT7470 temperature sensors hub and fan controller: register file with
+// auto-incrementing address pointer. Temperature registers follow the plant
+// while monitoring is running (STRT set, T05_STB set); PWM registers drive the
+// plant fans and the tach registers report the resulting speed.
+class ADT7470Model : public SimI2CDevice {
+public:
+	ADT7470Model(BoardPlant* plant);
+	virtual ~ADT7470Model();
+
+	virtual bool write(const unsigned char* data, unsigned short length);
+	virtual bool read(unsigned char* data, unsigned short length);
+
+	unsigned long getNumTransactions() const { return numTransactions; }
+
+private:
+	void writeRegister(unsigned char address, unsigned char value);
+	unsigned char readRegister(unsigned char address);
+	void updateMeasurements();
+
+private:
+	BoardPlant* plant;
+	unsigned char registers[256];
+	unsigned char pointer;
+	unsigned long numTransactions;
+};
+
+#endif /* ADT7470MODEL_H_ */
@@ -0,0 +1,100 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#ifndef BOARDPLANT_H_
+#define BOARDPLANT_H_
+
+#include "SimKernel.h"
+
+#define PLANT_NUM_FANS				3
+#define PLANT_FAN_EXT_HEATSINK		0
+#define PLANT_FAN_INT_HEATSINK		1
+#define PLANT_FAN_AIR_CIRCULATION	2
+
+// Physical side of the ExpShield2 board: supply, Peltier cell power stage,
+// heaters and fans as seen from the timers and the ADT7470, and the analog
+// feedbacks converted by the internal ADC (PELTV, PELTC, PSINV, TUCBRD, VREFINT).
+// The enclosure is a lumped thermal model with three nodes: the chamber air,
+// the internal heatsink (heaters and Peltier cold side) and the external
+// heatsink (Peltier hot side). Fans airflow sets the heatsinks and walls
+// conductances. The chamber holds the ambient absolute humidity.
+class BoardPlant : public SimAnalogSource {
+public:
+	BoardPlant();
+	virtual ~BoardPlant();
+
+	// The ambient may be changed at any time; the initial temperature
+	// applies to all the thermal nodes
+	void setAmbient(float temperature, float humidity);
+	void setInitialTemperature(float temperature);
+
+	// Temperatures in C, humidity in %
+	float getChamberTemperature();
+	float getInternalHeatsinkTemperature();
+	float getExternalHeatsinkTemperature();
+	float getAmbientTemperature();
+	float getChamberHumidity();
+	float getAmbientHumidity();
+
+	// Peltier cell current (A) and voltage (V)
+	float getPeltierCurrent();
+	float getPeltierVoltage();
+
+	// Electrical energy drawn by the heaters and the Peltier cell, in J
+	double getHeaterEnergy();
+	double getPeltierEnergy();
+
+	// Fans duty cycle (0 to 1), driven by the ADT7470
+	void setFanDuty(unsigned char fan, float duty);
+	float getFanDuty(unsigned char fan) const;
+
+	// Heaters and Peltier power stage duty cycles (0 to 1), from the PWM timers
+	float getHeaterDuty(unsigned char heater) const;
+	float getPeltierDuty() const;
+
+	virtual unsigned char getNumChannels() const;
+	virtual void convert(unsigned short* scan);
+
+protected:
+	// Bring the state to the current simulated time
+	void update();
+	void step(float dt);
+
+protected:
+	unsigned long long lastUpdate;
+
+	float ambientTemperature;
+	float ambientHumidity;
+	float chamberTemperature;
+	float intHeatsinkTemperature;
+	float extHeatsinkTemperature;
+	float peltierCurrent;
+	float fanDuty[PLANT_NUM_FANS];
+
+	double heaterEnergy;
+	double peltierEnergy;
+};
+
+#endif /* BOARDPLANT_H_ */
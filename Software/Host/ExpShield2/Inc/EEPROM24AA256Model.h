@@ -0,0 +1,60 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#ifndef EEPROM24AA256MODEL_H_
+#define EEPROM24AA256MODEL_H_
+
+#include "SimKernel.h"
+
+#define EEPROM24AA256_SIZE			32768
+#define EEPROM24AA256_PAGE_SIZE		64
+
+// 24AA256 serial EEPROM: 16 bits address pointer, 64 bytes pages (writes wrap
+// inside the page) and 5ms write cycle during which the device does not
+// acknowledge. The content can be loaded from and saved to a file.
+class EEPROM24AA256Model : public SimI2CDevice {
+public:
+	EEPROM24AA256Model();
+	virtual ~EEPROM24AA256Model();
+
+	bool load(const char* fileName);
+	bool save(const char* fileName) const;
+
+	virtual bool write(const unsigned char* data, unsigned short length);
+	virtual bool read(unsigned char* data, unsigned short length);
+
+	unsigned long getNumWriteCycles() const { return numWriteCycles; }
+
+private:
+	bool isBusy() const;
+
+private:
+	unsigned char memory[EEPROM24AA256_SIZE];
+	unsigned short pointer;
+	unsigned long long busyUntil;
+	unsigned long numWriteCycles;
+};
+
+#endif /* EEPROM24AA256MODEL_H_ */
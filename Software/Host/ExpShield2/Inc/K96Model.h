@@ -0,0 +1,70 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#ifndef K96MODEL_H_
+#define K96MODEL_H_
+
+#include "BoardPlant.h"
+#include <vector>
+
+// Senseair K96 ModBus slave on the SerialC line, powered through K96_EN.
+// Answers the input registers reads (0x04), RAM/EEPROM reads (0x44/0x46) and
+// RAM writes (0x41) after a short processing delay. Requests received while
+// the sensor is off or still booting are ignored.
+class K96Model : public SimSerialEndpoint, public SimGPIOListener {
+public:
+	K96Model(BoardPlant* plant);
+	virtual ~K96Model();
+
+	virtual void onTransmit(const unsigned char* data, unsigned short length);
+	virtual void onPinWritten(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state);
+
+	unsigned long getNumRequests() const { return numRequests; }
+
+private:
+	void process();
+	void readInputRegisters(unsigned short address, unsigned short count);
+	void readMemory(unsigned char functionCode, unsigned short address, unsigned char count);
+	void writeMemory(unsigned short address, unsigned char count, const unsigned char* data);
+	void sendException(unsigned char functionCode, unsigned char code);
+	void send();
+	unsigned short getInputRegister(unsigned short address);
+	unsigned char getMemory(unsigned short address);
+
+	static void onReply(void* context);
+	static unsigned short crc16(const unsigned char* data, unsigned short length);
+
+private:
+	BoardPlant* plant;
+	bool powered;
+	unsigned long long readyTime;
+	unsigned long numRequests;
+
+	std::vector<unsigned char> request;
+	std::vector<unsigned char> reply;
+	std::vector<unsigned char> ram;
+};
+
+#endif /* K96MODEL_H_ */
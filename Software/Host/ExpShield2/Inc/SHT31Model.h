@@ -0,0 +1,60 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#ifndef SHT31MODEL_H_
+#define SHT31MODEL_H_
+
+#include "BoardPlant.h"
+
+// SHT31 temperature and humidity sensor: single shot and periodic acquisitions
+// (no clock stretching), FETCH readout, BREAK and status clear commands.
+// Reads are NACKed while no new measurement is available.
+class SHT31Model : public SimI2CDevice {
+public:
+	SHT31Model(BoardPlant* plant, bool internal);
+	virtual ~SHT31Model();
+
+	virtual bool write(const unsigned char* data, unsigned short length);
+	virtual bool read(unsigned char* data, unsigned short length);
+
+private:
+	void measure();
+	unsigned long long getMeasurementTime(unsigned char repeatability) const;
+	static unsigned char crc8(const unsigned char* data, unsigned char length);
+
+private:
+	BoardPlant* plant;
+	bool internal;
+
+	bool periodic;
+	unsigned long long period;
+	unsigned long long measurementTime;
+	unsigned long long nextMeasurement;
+	bool dataReady;
+	bool fetched;
+	unsigned char data[6];
+};
+
+#endif /* SHT31MODEL_H_ */
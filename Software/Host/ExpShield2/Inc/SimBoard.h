@@ -16,30 +16,38 @@
  * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
  *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
  *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
- *			European Commission - Joint Research Centre,
+ *      European Commission - Joint Research Centre,
  * - Marco Signorini, marco.signorini@liberaintentio.com
  *
  * ===========================================================================
  */
 
-#ifndef SAMPLESAVERAGEROPCN3_H_
-#define SAMPLESAVERAGEROPCN3_H_
 
-#include "SamplesAverager.h"
+#ifndef SIMBOARD_H_
+#define SIMBOARD_H_
 
-class SamplesAveragerOPCN3 : public SamplesAverager {
+#include "BoardPlant.h"
+#include "SHT31Model.h"
+#include "ADT7470Model.h"
+#include "EEPROM24AA256Model.h"
+#include "K96Model.h"
+
+// The ExpShield2 on board devices models, wired to the simulated HAL
+// handles the firmware uses (after simBoardInit).
+class SimBoard {
 public:
-	SamplesAveragerOPCN3();
-	virtual ~SamplesAveragerOPCN3();
+	SimBoard();
+	virtual ~SimBoard();
 
-	virtual bool collectSample(unsigned char channel, unsigned short sample, unsigned long _timestamp);
-	virtual unsigned short lastAveragedValue(unsigned char channel);
+	void attach();
 
-private:
-	unsigned short sampleTime;
-	unsigned short sampleFlowRate;
-	unsigned short laserStatus;
-	bool periodTerminated;
+public:
+	BoardPlant plant;
+	SHT31Model internalSHT31;
+	SHT31Model externalSHT31;
+	ADT7470Model adt7470;
+	EEPROM24AA256Model eeprom;
+	K96Model k96;
 };
 
-#endif /* SAMPLESAVERAGEROPCN3_H_ */
+#endif /* SIMBOARD_H_ */
@@ -0,0 +1,140 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include "ADT7470Model.h"
+
+#define ADT7470_REG_BASE_TEMPERATURE	0x20
+#define ADT7470_REG_BASE_FANTACH		0x2A
+#define ADT7470_REG_FANPWM_BASE			0x32
+#define ADT7470_REG_DEVICEID			0x3D
+#define ADT7470_REG_COMPANYID			0x3E
+#define ADT7470_REG_REVISIONNUMBER		0x3F
+#define ADT7470_REG_CONFIGURATION1		0x40
+
+#define ADT7470_STRT_FLAG				0x01
+#define ADT7470_T05_STB					0x80
+
+#define ADT7470_NUM_TEMPERATURES		3
+#define ADT7470_NUM_FANS				3
+
+#define ADT7470_TACH_CLOCK				5400000.0f	/* 90kHz x 60, see datasheet page 24 */
+#define ADT7470_FAN_MIN_RPM				1500.0f		/* Speed at the lowest PWM able to spin the fans */
+#define ADT7470_FAN_MAX_RPM				6000.0f
+
+ADT7470Model::ADT7470Model(BoardPlant* _plant) : plant(_plant), pointer(0), numTransactions(0) {
+
+	for (unsigned short n = 0; n < sizeof(registers); n++) {
+		registers[n] = 0x00;
+	}
+
+	registers[ADT7470_REG_DEVICEID] = 0x70;
+	registers[ADT7470_REG_COMPANYID] = 0x41;
+	registers[ADT7470_REG_REVISIONNUMBER] = 0x02;
+	for (unsigned char n = 0; n < (ADT7470_NUM_FANS << 1); n++) {
+		registers[ADT7470_REG_BASE_FANTACH + n] = 0xFF;
+	}
+}
+
+ADT7470Model::~ADT7470Model() {
+}
+
+bool ADT7470Model::write(const unsigned char* data, unsigned short length) {
+
+	numTransactions++;
+	if (length == 0) {
+		return true;
+	}
+
+	pointer = data[0];
+	for (unsigned short n = 1; n < length; n++) {
+		writeRegister(pointer++, data[n]);
+	}
+
+	return true;
+}
+
+bool ADT7470Model::read(unsigned char* data, unsigned short length) {
+
+	numTransactions++;
+	updateMeasurements();
+	for (unsigned short n = 0; n < length; n++) {
+		data[n] = readRegister(pointer++);
+	}
+
+	return true;
+}
+
+void ADT7470Model::writeRegister(unsigned char address, unsigned char value) {
+
+	// Read only registers
+	if (((address >= ADT7470_REG_BASE_TEMPERATURE) && (address < ADT7470_REG_FANPWM_BASE)) ||
+		((address >= ADT7470_REG_DEVICEID) && (address <= ADT7470_REG_REVISIONNUMBER))) {
+		return;
+	}
+
+	registers[address] = value;
+
+	if ((address >= ADT7470_REG_FANPWM_BASE) && (address < (ADT7470_REG_FANPWM_BASE + ADT7470_NUM_FANS))) {
+		plant->setFanDuty(address - ADT7470_REG_FANPWM_BASE, value / 255.0f);
+	}
+}
+
+unsigned char ADT7470Model::readRegister(unsigned char address) {
+	return registers[address];
+}
+
+// Refresh the measurement registers from the plant
+void ADT7470Model::updateMeasurements() {
+
+	unsigned char config = registers[ADT7470_REG_CONFIGURATION1];
+	if (!(config & ADT7470_STRT_FLAG)) {
+		return;
+	}
+
+	// Temperatures are frozen while the TMP05 measurements are stopped
+	if (config & ADT7470_T05_STB) {
+		float temperatures[ADT7470_NUM_TEMPERATURES] = {
+				plant->getChamberTemperature(),
+				plant->getExternalHeatsinkTemperature(),
+				plant->getInternalHeatsinkTemperature()
+		};
+		for (unsigned char n = 0; n < ADT7470_NUM_TEMPERATURES; n++) {
+			float value = temperatures[n];
+			value = (value < -128.0f)? -128.0f : ((value > 127.0f)? 127.0f : value);
+			registers[ADT7470_REG_BASE_TEMPERATURE + n] = (unsigned char)(signed char)value;
+		}
+	}
+
+	for (unsigned char n = 0; n < ADT7470_NUM_FANS; n++) {
+		float duty = plant->getFanDuty(n);
+		unsigned short count = 0xFFFF;
+		if (duty > 0.0f) {
+			float rpm = ADT7470_FAN_MIN_RPM + (ADT7470_FAN_MAX_RPM - ADT7470_FAN_MIN_RPM) * duty;
+			count = (unsigned short)(ADT7470_TACH_CLOCK / rpm);
+		}
+		registers[ADT7470_REG_BASE_FANTACH + (n << 1)] = count & 0xFF;
+		registers[ADT7470_REG_BASE_FANTACH + (n << 1) + 1] = count >> 8;
+	}
+}
@@ -0,0 +1,152 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include "BoardHal.h"
+#include "BenchmarkHelper.h"
+#include "ModBusMaster.h"
+#include "SamplesAverager.h"
+#include "DitherTool.h"
+#include "PIDEngine.h"
+#include "SensorsArray.h"
+#include "CommProtocol.h"
+
+// Host micro benchmarks of the ExpShield2 firmware kernels.
+// See BenchmarkHelper.h for how the Cortex-M0 estimates are obtained.
+
+#define BENCHMARK_FRAME_LENGTH		(MODBUS_RX_BUFFERLENGTH + 4)
+#define BENCHMARK_AVERAGER_SIZE		60
+
+// Give access to the PID step function
+class BenchmarkPIDEngine : public PIDEngine {
+public:
+	double step(double currentValue) { return getNextDriveValue(currentValue); }
+};
+
+typedef struct _averagercontext {
+	SamplesAverager* averager;
+	unsigned short sample;
+	unsigned long timestamp;
+} averagercontext;
+
+typedef struct _pidcontext {
+	BenchmarkPIDEngine* engine;
+	double value;
+} pidcontext;
+
+typedef struct _commandcontext {
+	CommProtocol* protocol;
+	const char* command;
+} commandcontext;
+
+static void modBusCRCKernel(void* context) {
+
+	unsigned char* frame = (unsigned char*)context;
+	unsigned short crc = 0xFFFF;
+	for (unsigned char n = 0; n < BENCHMARK_FRAME_LENGTH; n++) {
+		crc = ModBusMaster::crcUpdate(crc, frame[n]);
+	}
+	frame[0] = (unsigned char)crc;
+}
+
+static void averagerKernel(void* context) {
+
+	averagercontext* ctx = (averagercontext*)context;
+	ctx->averager->collectSample(0, ctx->sample, ctx->timestamp);
+	ctx->sample += 37;
+	ctx->timestamp++;
+}
+
+static void ditherKernel(void* context) {
+
+	DitherTool* tool = (DitherTool*)context;
+	tool->applyDithering(123.4);
+}
+
+static void pidKernel(void* context) {
+
+	pidcontext* ctx = (pidcontext*)context;
+	ctx->value += ctx->engine->step(ctx->value) * 0.01;
+}
+
+// A full command frame, from the header to the rendered answer.
+// SOURCE_NONE skips the answer transmission.
+static void commandKernel(void* context) {
+
+	commandcontext* ctx = (commandcontext*)context;
+	for (const char* pivot = ctx->command; *pivot; pivot++) {
+		ctx->protocol->onDataReceived(*pivot, CommProtocol::SOURCE_NONE);
+	}
+}
+
+int main(int argc, char** argv) {
+
+	if (!AS_BENCHMARK.parseOptions(argc, argv)) {
+		return 1;
+	}
+
+	simBoardInit();
+
+	unsigned char frame[BENCHMARK_FRAME_LENGTH];
+	for (unsigned char n = 0; n < BENCHMARK_FRAME_LENGTH; n++) {
+		frame[n] = n;
+	}
+	AS_BENCHMARK.run("ModBus CRC (68 bytes)", &modBusCRCKernel, frame, BenchmarkHelper::ARITHMETIC_INTEGER);
+
+	DitherTool tool;
+	SamplesAverager averager(1);
+	averager.setDitherTool(&tool);
+	if (averager.init(BENCHMARK_AVERAGER_SIZE) == 0) {
+		fprintf(stderr, "Averager initialization failed\n");
+		return 1;
+	}
+	averagercontext averagerCtx = { &averager, 1000, 1 };
+	AS_BENCHMARK.run("SamplesAverager::collectSample", &averagerKernel, &averagerCtx, BenchmarkHelper::ARITHMETIC_INTEGER);
+
+	AS_BENCHMARK.run("DitherTool::applyDithering", &ditherKernel, &tool, BenchmarkHelper::ARITHMETIC_DOUBLE);
+
+	BenchmarkPIDEngine engine;
+	engine.setCoefficients(0.1, 0.02, 0.0);
+	engine.setOutMinMax(-100.0, 100.0);
+	engine.setSetPoint(25.0);
+	pidcontext pidCtx = { &engine, 20.0 };
+	AS_BENCHMARK.run("PIDEngine step", &pidKernel, &pidCtx, BenchmarkHelper::ARITHMETIC_DOUBLE);
+
+	SensorsArray sensors;
+	CommProtocol protocol(&sensors);
+	static const char* const commands[][2] = {
+			{ "CommProtocol parse {E}", "{E}" },
+			{ "CommProtocol parse {G14}", "{G14}" },
+			{ "CommProtocol parse {Y14}", "{Y14}" },
+			{ "CommProtocol parse {Z00}", "{Z00}" },
+	};
+	for (unsigned char n = 0; n < sizeof(commands)/sizeof(commands[0]); n++) {
+		commandcontext commandCtx = { &protocol, commands[n][1] };
+		AS_BENCHMARK.run(commands[n][0], &commandKernel, &commandCtx, BenchmarkHelper::ARITHMETIC_INTEGER);
+	}
+
+	return 0;
+}
@@ -0,0 +1,166 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include "BoardHal.h"
+#include "GlobalHalHandlers.h"
+#include "ExpShieldTwoBoardImpl.h"
+#include "SimKernel.h"
+#include "main.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Peripheral handles, as declared by the CubeMX generated main.c
+ADC_HandleTypeDef hadc;
+CRC_HandleTypeDef hcrc;
+I2C_HandleTypeDef hi2c1;
+I2C_HandleTypeDef hi2c2;
+SPI_HandleTypeDef hspi1;
+TIM_HandleTypeDef htim3;
+TIM_HandleTypeDef htim7;
+TIM_HandleTypeDef htim14;
+TIM_HandleTypeDef htim15;
+TIM_HandleTypeDef htim16;
+TIM_HandleTypeDef htim17;
+UART_HandleTypeDef huart1;
+UART_HandleTypeDef huart2;
+UART_HandleTypeDef huart3;
+UART_HandleTypeDef huart4;
+
+// Peripherals initialization, mirrors the CubeMX MX_xxx_Init() functions
+void simBoardInit() {
+
+	hadc.Instance = ADC1;
+	hadc.Init.ExternalTrigConv = TIM3;		/* ADC_EXTERNALTRIGCONV_T3_TRGO */
+
+	hcrc.Instance = CRC;
+
+	hi2c1.Instance = I2C1;
+	hi2c2.Instance = I2C2;
+	hi2c2.Init.Timing = 0x10805E82;
+
+	hspi1.Instance = SPI1;
+	hspi1.Init.DataSize = SPI_DATASIZE_8BIT;
+	hspi1.Init.BaudRatePrescaler = SPI_BAUDRATEPRESCALER_128;
+
+	htim3.Instance = TIM3;
+	htim3.Init.Prescaler = 999;
+	htim3.Init.Period = 4799;
+	HAL_TIM_Base_Init(&htim3);
+
+	htim7.Instance = TIM7;
+	htim7.Init.Prescaler = 999;
+	htim7.Init.Period = 479;
+	HAL_TIM_Base_Init(&htim7);
+	HAL_NVIC_EnableIRQ(TIM7_IRQn);
+
+	htim14.Instance = TIM14;
+	htim14.Init.Prescaler = 4000;
+	htim14.Init.Period = 60000;
+	HAL_TIM_Base_Init(&htim14);
+
+	htim15.Instance = TIM15;
+	htim15.Init.Prescaler = 0;
+	htim15.Init.Period = 65535;
+	HAL_TIM_Base_Init(&htim15);
+
+	htim16.Instance = TIM16;
+	htim16.Init.Prescaler = 4000;
+	htim16.Init.Period = 60000;
+	HAL_TIM_Base_Init(&htim16);
+
+	htim17.Instance = TIM17;
+	htim17.Init.Prescaler = 0;
+	htim17.Init.Period = 1199;
+	HAL_TIM_Base_Init(&htim17);
+
+	huart1.Instance = USART1;
+	huart1.Init.BaudRate = 9600;
+	HAL_UART_Init(&huart1);
+
+	huart2.Instance = USART2;
+	huart2.Init.BaudRate = 38400;
+	HAL_UART_Init(&huart2);
+
+	huart3.Instance = USART3;
+	huart3.Init.BaudRate = 115200;
+	HAL_UART_Init(&huart3);
+
+	huart4.Instance = USART4;
+	huart4.Init.BaudRate = 9600;
+	HAL_UART_Init(&huart4);
+}
+
+extern "C" void Error_Handler(void) {
+
+	fprintf(stderr, "Error_Handler reached at %.6fs\n", (double)SIM_KERNEL.now() / SIM_NS_PER_S);
+	abort();
+}
+
+/* HAL callbacks, as in main.c USER CODE 4 and in the TIM7 interrupt handler */
+extern "C" void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart) {
+	if (huart->Instance == USART1) {
+		uart1Interrupt(1);
+	} else if (huart->Instance == USART2) {
+		uart2Interrupt(1);
+	}
+}
+
+extern "C" void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
+	if (huart->Instance == USART1) {
+		uart1Interrupt(0);
+	} else if (huart->Instance == USART2) {
+		uart2Interrupt(0);
+	} else if (huart->Instance == USART3) {
+		uart3Interrupt(0);
+	} else if (huart->Instance == USART4) {
+		uart4Interrupt(0);
+	}
+}
+
+extern "C" void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+	if (huart->Instance == USART1) {
+		uart1Error();
+	} else if (huart->Instance == USART2) {
+		uart2Error();
+	} else if (huart->Instance == USART3) {
+		uart3Error();
+	} else if (huart->Instance == USART4) {
+		uart4Error();
+	}
+}
+
+extern "C" void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc) {
+	adcCallback(1);
+}
+
+extern "C" void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc) {
+	adcCallback(0);
+}
+
+extern "C" void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim) {
+	if (htim->Instance == TIM7) {
+		timerInterrupt();
+	}
+}
@@ -0,0 +1,235 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include "BoardPlant.h"
+#include <math.h>
+
+#define SUPPLY_VOLTAGE			12.0f	/* PSINV */
+#define PELTIER_RESISTANCE		2.0f	/* Ohm */
+#define PELTIER_SEEBECK			0.05f	/* V/K, 127 couples module */
+#define PELTIER_CONDUCTANCE		0.4f	/* W/K, hot to cold side leakage */
+#define PELTIER_TAU				0.005f	/* Power stage and cell current response, in seconds */
+#define HEATER_POWER			10.0f	/* W, each heater at full duty */
+#define CURRENT_SENSE_GAIN		0.3f	/* V/A: 3mOhm shunt, 100x amplifier */
+#define VOLTAGE_DIVIDER			(3.6f / 13.6f)
+#define VDDA					3.3f
+#define ADC_FULL_SCALE			4095.0f
+#define MCU_TEMPERATURE			35.0f
+#define MCU_TEMP_SLOPE			5.336f	/* ADC counts per C, at 3.3V */
+#define KELVIN_OFFSET			273.15f
+
+// Thermal capacities (J/K) and conductances (W/K, still air plus full fan airflow)
+#define CHAMBER_CAPACITY		800.0f
+#define INT_HEATSINK_CAPACITY	200.0f
+#define EXT_HEATSINK_CAPACITY	400.0f
+#define WALLS_CONDUCTANCE		0.4f
+#define WALLS_FAN_CONDUCTANCE	0.2f
+#define INT_HEATSINK_CONDUCTANCE		0.6f
+#define INT_HEATSINK_FAN_CONDUCTANCE	3.0f
+#define EXT_HEATSINK_CONDUCTANCE		1.0f
+#define EXT_HEATSINK_FAN_CONDUCTANCE	6.0f
+#define THERMAL_MAX_STEP		0.1f	/* Integration step, in seconds */
+
+// Water vapor saturation pressure (Magnus formula), in hPa
+static float saturationPressure(float temperature) {
+	return 6.112f * expf((17.62f * temperature) / (243.12f + temperature));
+}
+
+BoardPlant::BoardPlant() : lastUpdate(0), ambientTemperature(20.0f), ambientHumidity(50.0f),
+							chamberTemperature(20.0f), intHeatsinkTemperature(20.0f), extHeatsinkTemperature(20.0f),
+							peltierCurrent(0.0f), heaterEnergy(0.0), peltierEnergy(0.0) {
+
+	for (unsigned char n = 0; n < PLANT_NUM_FANS; n++) {
+		fanDuty[n] = 0.0f;
+	}
+}
+
+BoardPlant::~BoardPlant() {
+}
+
+void BoardPlant::setAmbient(float temperature, float humidity) {
+	update();
+	ambientTemperature = temperature;
+	ambientHumidity = humidity;
+}
+
+void BoardPlant::setInitialTemperature(float temperature) {
+	update();
+	chamberTemperature = temperature;
+	intHeatsinkTemperature = temperature;
+	extHeatsinkTemperature = temperature;
+}
+
+float BoardPlant::getChamberTemperature() {
+	update();
+	return chamberTemperature;
+}
+
+float BoardPlant::getInternalHeatsinkTemperature() {
+	update();
+	return intHeatsinkTemperature;
+}
+
+float BoardPlant::getExternalHeatsinkTemperature() {
+	update();
+	return extHeatsinkTemperature;
+}
+
+float BoardPlant::getAmbientTemperature() {
+	return ambientTemperature;
+}
+
+float BoardPlant::getChamberHumidity() {
+	update();
+
+	float humidity = ambientHumidity * saturationPressure(ambientTemperature) / saturationPressure(chamberTemperature);
+	return (humidity > 100.0f)? 100.0f : humidity;
+}
+
+float BoardPlant::getAmbientHumidity() {
+	return ambientHumidity;
+}
+
+float BoardPlant::getPeltierCurrent() {
+	update();
+	return peltierCurrent;
+}
+
+// Ohmic drop plus the Seebeck voltage across the cell
+float BoardPlant::getPeltierVoltage() {
+	update();
+	return peltierCurrent * PELTIER_RESISTANCE + PELTIER_SEEBECK * (extHeatsinkTemperature - intHeatsinkTemperature);
+}
+
+double BoardPlant::getHeaterEnergy() {
+	update();
+	return heaterEnergy;
+}
+
+double BoardPlant::getPeltierEnergy() {
+	update();
+	return peltierEnergy;
+}
+
+void BoardPlant::setFanDuty(unsigned char fan, float duty) {
+	if (fan < PLANT_NUM_FANS) {
+		update();
+		fanDuty[fan] = (duty < 0.0f)? 0.0f : ((duty > 1.0f)? 1.0f : duty);
+	}
+}
+
+float BoardPlant::getFanDuty(unsigned char fan) const {
+	return (fan < PLANT_NUM_FANS)? fanDuty[fan] : 0.0f;
+}
+
+// Heater 1 is driven by TIM14, heater 2 by TIM16 with an inverted output
+float BoardPlant::getHeaterDuty(unsigned char heater) const {
+
+	const TIM_TypeDef* tim = (heater == 0)? TIM14 : TIM16;
+	if (tim->ARR == 0) {
+		return 0.0f;
+	}
+
+	float duty = (float)tim->CCR1 / tim->ARR;
+	duty = (duty > 1.0f)? 1.0f : duty;
+
+	return (heater == 0)? duty : (1.0f - duty);
+}
+
+// The constant current generator PWM (TIM17) sets the power stage output voltage
+float BoardPlant::getPeltierDuty() const {
+
+	if (TIM17->ARR == 0) {
+		return 0.0f;
+	}
+
+	float duty = (float)TIM17->CCR1 / TIM17->ARR;
+	return (duty > 1.0f)? 1.0f : duty;
+}
+
+void BoardPlant::update() {
+
+	unsigned long long now = SIM_KERNEL.now();
+	float dt = (now - lastUpdate) / (float)SIM_NS_PER_S;
+	lastUpdate = now;
+
+	while (dt > 0.0f) {
+		float h = (dt > THERMAL_MAX_STEP)? THERMAL_MAX_STEP : dt;
+		step(h);
+		dt -= h;
+	}
+}
+
+// Explicit integration step. The drives are held constant over the step.
+void BoardPlant::step(float dt) {
+
+	// The power stage is off at zero duty and does not reverse the current
+	float deltaT = extHeatsinkTemperature - intHeatsinkTemperature;
+	float duty = getPeltierDuty();
+	float target = (duty > 0.0f)? ((duty * SUPPLY_VOLTAGE - PELTIER_SEEBECK * deltaT) / PELTIER_RESISTANCE) : 0.0f;
+	target = (target < 0.0f)? 0.0f : target;
+	peltierCurrent = target + (peltierCurrent - target) * expf(-dt / PELTIER_TAU);
+
+	// Peltier heat pumped from the cold side and released on the hot side
+	float joule = peltierCurrent * peltierCurrent * PELTIER_RESISTANCE;
+	float leakage = PELTIER_CONDUCTANCE * deltaT;
+	float coldQ = PELTIER_SEEBECK * (intHeatsinkTemperature + KELVIN_OFFSET) * peltierCurrent - 0.5f * joule - leakage;
+	float hotQ = PELTIER_SEEBECK * (extHeatsinkTemperature + KELVIN_OFFSET) * peltierCurrent + 0.5f * joule - leakage;
+
+	float heaterQ = (getHeaterDuty(0) + getHeaterDuty(1)) * HEATER_POWER;
+
+	float intExchange = (INT_HEATSINK_CONDUCTANCE + INT_HEATSINK_FAN_CONDUCTANCE * fanDuty[PLANT_FAN_INT_HEATSINK]) *
+						(intHeatsinkTemperature - chamberTemperature);
+	float extExchange = (EXT_HEATSINK_CONDUCTANCE + EXT_HEATSINK_FAN_CONDUCTANCE * fanDuty[PLANT_FAN_EXT_HEATSINK]) *
+						(extHeatsinkTemperature - ambientTemperature);
+	float wallsExchange = (WALLS_CONDUCTANCE + WALLS_FAN_CONDUCTANCE * fanDuty[PLANT_FAN_AIR_CIRCULATION]) *
+						(chamberTemperature - ambientTemperature);
+
+	intHeatsinkTemperature += ((heaterQ - coldQ - intExchange) / INT_HEATSINK_CAPACITY) * dt;
+	extHeatsinkTemperature += ((hotQ - extExchange) / EXT_HEATSINK_CAPACITY) * dt;
+	chamberTemperature += ((intExchange - wallsExchange) / CHAMBER_CAPACITY) * dt;
+
+	heaterEnergy += heaterQ * dt;
+	peltierEnergy += (hotQ - coldQ) * dt;
+}
+
+unsigned char BoardPlant::getNumChannels() const {
+	return 5;
+}
+
+// Scan order: PELTV, PELTC, PSINV, TUCBRD, VREFINT (see IntADDevice)
+void BoardPlant::convert(unsigned short* scan) {
+
+	update();
+
+	float counts = ADC_FULL_SCALE / VDDA;
+	float temperatureRaw = *TEMP30_CAL_ADDR - ((MCU_TEMPERATURE - 30.0f) * MCU_TEMP_SLOPE);
+
+	scan[0] = (unsigned short)(getPeltierVoltage() * VOLTAGE_DIVIDER * counts + 0.5f);
+	scan[1] = (unsigned short)(peltierCurrent * CURRENT_SENSE_GAIN * counts + 0.5f);
+	scan[2] = (unsigned short)(SUPPLY_VOLTAGE * VOLTAGE_DIVIDER * counts + 0.5f);
+	scan[3] = (unsigned short)(temperatureRaw + 0.5f);
+	scan[4] = *VREFINT_CAL;
+}
@@ -0,0 +1,112 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include "EEPROM24AA256Model.h"
+#include <stdio.h>
+#include <string.h>
+
+#define EEPROM24AA256_WRITE_CYCLE		(5 * SIM_NS_PER_MS)
+
+EEPROM24AA256Model::EEPROM24AA256Model() : pointer(0), busyUntil(0), numWriteCycles(0) {
+	memset(memory, 0xFF, sizeof(memory));
+}
+
+EEPROM24AA256Model::~EEPROM24AA256Model() {
+}
+
+// A missing file leaves the memory blank
+bool EEPROM24AA256Model::load(const char* fileName) {
+
+	FILE* file = fopen(fileName, "rb");
+	if (file == NULL) {
+		return false;
+	}
+
+	size_t size = fread(memory, 1, sizeof(memory), file);
+	fclose(file);
+
+	return (size == sizeof(memory));
+}
+
+bool EEPROM24AA256Model::save(const char* fileName) const {
+
+	FILE* file = fopen(fileName, "wb");
+	if (file == NULL) {
+		return false;
+	}
+
+	size_t size = fwrite(memory, 1, sizeof(memory), file);
+	fclose(file);
+
+	return (size == sizeof(memory));
+}
+
+bool EEPROM24AA256Model::isBusy() const {
+	return (SIM_KERNEL.now() < busyUntil);
+}
+
+bool EEPROM24AA256Model::write(const unsigned char* data, unsigned short length) {
+
+	if (isBusy()) {
+		return false;
+	}
+	if (length < 2) {
+		return (length == 0);
+	}
+
+	pointer = ((data[0] << 8) | data[1]) & (EEPROM24AA256_SIZE - 1);
+	if (length == 2) {
+		return true;
+	}
+
+	// Page write: the address rolls over inside the current page
+	unsigned short page = pointer & ~(EEPROM24AA256_PAGE_SIZE - 1);
+	unsigned short offset = pointer & (EEPROM24AA256_PAGE_SIZE - 1);
+	for (unsigned short n = 2; n < length; n++) {
+		memory[page + offset] = data[n];
+		offset = (offset + 1) & (EEPROM24AA256_PAGE_SIZE - 1);
+	}
+	pointer = page + offset;
+
+	busyUntil = SIM_KERNEL.now() + EEPROM24AA256_WRITE_CYCLE;
+	numWriteCycles++;
+
+	return true;
+}
+
+// Sequential read: the address rolls over the whole array
+bool EEPROM24AA256Model::read(unsigned char* data, unsigned short length) {
+
+	if (isBusy()) {
+		return false;
+	}
+
+	for (unsigned short n = 0; n < length; n++) {
+		data[n] = memory[pointer];
+		pointer = (pointer + 1) & (EEPROM24AA256_SIZE - 1);
+	}
+
+	return true;
+}
@@ -0,0 +1,245 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include "K96Model.h"
+#include "main.h"
+
+#define K96_SLAVE_ADDRESS			0x68
+#define K96_ANY_ADDRESS				0xFE
+
+#define K96_FC_READ_INPUTREG		0x04
+#define K96_FC_WRITE_TORAM			0x41
+#define K96_FC_READ_FROMRAM			0x44
+#define K96_FC_READ_FROMEEPROM		0x46
+#define K96_FC_EXCEPTION_FLAG		0x80
+
+#define K96_EXCEPTION_ILLEGAL_FUNCTION	0x01
+#define K96_EXCEPTION_ILLEGAL_ADDRESS	0x02
+
+#define K96_NUM_INPUT_REGISTERS		0x20
+#define K96_RAM_SIZE				0x0800
+#define K96_RAM_METERID				0x0028
+#define K96_RAM_UFLT_BLOCKS			{ 0x0384, 0x0424, 0x0484 }
+#define K96_UFLT_BLOCK_SIZE			12
+
+#define K96_BOOT_TIME				(300 * SIM_NS_PER_MS)
+#define K96_ANSWER_DELAY			(5 * SIM_NS_PER_MS)
+
+#define K96_CONCPC					420			/* Gas concentration, ppm */
+#define K96_PRESSURE				10132		/* 1/10 hPa */
+#define K96_IR_SIGNAL				30000
+
+K96Model::K96Model(BoardPlant* _plant) : plant(_plant), powered(false), readyTime(0), numRequests(0),
+					ram(K96_RAM_SIZE, 0x00) {
+
+	// Meter ID, big endian
+	ram[K96_RAM_METERID] = 0x12;
+	ram[K96_RAM_METERID + 1] = 0x34;
+	ram[K96_RAM_METERID + 2] = 0x56;
+	ram[K96_RAM_METERID + 3] = 0x78;
+
+	// Unfiltered IR signals, no error
+	const unsigned short uflt[] = K96_RAM_UFLT_BLOCKS;
+	for (unsigned char n = 0; n < sizeof(uflt)/sizeof(unsigned short); n++) {
+		ram[uflt[n]] = K96_IR_SIGNAL >> 8;
+		ram[uflt[n] + 1] = K96_IR_SIGNAL & 0xFF;
+	}
+}
+
+K96Model::~K96Model() {
+}
+
+void K96Model::onPinWritten(GPIO_TypeDef* gpio, uint16_t pin, GPIO_PinState state) {
+
+	if ((gpio != K96_EN_GPIO_Port) || (pin != K96_EN_Pin)) {
+		return;
+	}
+
+	bool on = (state == GPIO_PIN_SET);
+	if (on && !powered) {
+		readyTime = SIM_KERNEL.now() + K96_BOOT_TIME;
+	}
+	powered = on;
+	request.clear();
+}
+
+// Requests are collected until a valid frame is found
+void K96Model::onTransmit(const unsigned char* data, unsigned short length) {
+
+	if (!powered || (SIM_KERNEL.now() < readyTime)) {
+		return;
+	}
+
+	request.insert(request.end(), data, data + length);
+	process();
+}
+
+void K96Model::process() {
+
+	while (request.size() >= 4) {
+
+		unsigned char functionCode = request[1];
+		unsigned short expected = 0;
+		if ((functionCode == K96_FC_READ_INPUTREG) || (functionCode == K96_FC_WRITE_TORAM)) {
+			expected = 8;
+		} else if ((functionCode == K96_FC_READ_FROMRAM) || (functionCode == K96_FC_READ_FROMEEPROM)) {
+			expected = 7;
+		} else {
+			request.erase(request.begin());
+			continue;
+		}
+
+		if (request.size() < expected) {
+			return;
+		}
+
+		bool valid = ((request[0] == K96_SLAVE_ADDRESS) || (request[0] == K96_ANY_ADDRESS)) &&
+						(crc16(request.data(), expected) == 0);
+		if (!valid) {
+			request.erase(request.begin());
+			continue;
+		}
+
+		numRequests++;
+		reply.clear();
+		reply.push_back(K96_SLAVE_ADDRESS);
+
+		unsigned short address = (request[2] << 8) | request[3];
+		if (functionCode == K96_FC_READ_INPUTREG) {
+			readInputRegisters(address, (request[4] << 8) | request[5]);
+		} else if (functionCode == K96_FC_WRITE_TORAM) {
+			writeMemory(address, request[4], request.data() + 5);
+		} else {
+			readMemory(functionCode, address, request[4]);
+		}
+
+		request.erase(request.begin(), request.begin() + expected);
+		SIM_KERNEL.schedule(SIM_KERNEL.now() + K96_ANSWER_DELAY, &onReply, this);
+	}
+}
+
+void K96Model::readInputRegisters(unsigned short address, unsigned short count) {
+
+	if ((count == 0) || ((address + count) > K96_NUM_INPUT_REGISTERS)) {
+		sendException(K96_FC_READ_INPUTREG, K96_EXCEPTION_ILLEGAL_ADDRESS);
+		return;
+	}
+
+	reply.push_back(K96_FC_READ_INPUTREG);
+	reply.push_back(count << 1);
+	for (unsigned short n = 0; n < count; n++) {
+		unsigned short value = getInputRegister(address + n);
+		reply.push_back(value >> 8);
+		reply.push_back(value & 0xFF);
+	}
+}
+
+void K96Model::readMemory(unsigned char functionCode, unsigned short address, unsigned char count) {
+
+	if ((count == 0) || ((address + count) > K96_RAM_SIZE)) {
+		sendException(functionCode, K96_EXCEPTION_ILLEGAL_ADDRESS);
+		return;
+	}
+
+	reply.push_back(functionCode);
+	reply.push_back(count);
+	for (unsigned char n = 0; n < count; n++) {
+		reply.push_back(getMemory(address + n));
+	}
+}
+
+void K96Model::writeMemory(unsigned short address, unsigned char count, const unsigned char* data) {
+
+	if ((count != 1) || (address >= K96_RAM_SIZE)) {
+		sendException(K96_FC_WRITE_TORAM, K96_EXCEPTION_ILLEGAL_ADDRESS);
+		return;
+	}
+
+	ram[address] = data[0];
+	reply.push_back(K96_FC_WRITE_TORAM);
+}
+
+void K96Model::sendException(unsigned char functionCode, unsigned char code) {
+	reply.push_back(functionCode | K96_FC_EXCEPTION_FLAG);
+	reply.push_back(code);
+}
+
+void K96Model::onReply(void* context) {
+	((K96Model*)context)->send();
+}
+
+void K96Model::send() {
+
+	if (!powered || reply.empty() || (port == NULL)) {
+		return;
+	}
+
+	unsigned short crc = crc16(reply.data(), reply.size());
+	reply.push_back(crc & 0xFF);
+	reply.push_back(crc >> 8);
+
+	port->inject(reply.data(), reply.size());
+	reply.clear();
+}
+
+unsigned short K96Model::getInputRegister(unsigned short address) {
+
+	switch (address) {
+		case 0x00:
+		case 0x01:
+		case 0x02:
+			return K96_CONCPC;
+		case 0x03:
+			return K96_PRESSURE;
+		case 0x04:
+		case 0x05:
+		case 0x07:
+		case 0x09:
+			return (unsigned short)(short)(plant->getChamberTemperature() * 100);
+		case 0x08:
+			return (unsigned short)(plant->getChamberHumidity() * 100);
+		default:
+			return 0x0000;
+	}
+}
+
+unsigned char K96Model::getMemory(unsigned short address) {
+	return ram[address];
+}
+
+// ModBus CRC16 (polynomial 0xA001 reflected, init 0xFFFF). Zero over a frame
+// that includes its own CRC
+unsigned short K96Model::crc16(const unsigned char* data, unsigned short length) {
+
+	unsigned short crc = 0xFFFF;
+	for (unsigned short n = 0; n < length; n++) {
+		crc ^= data[n];
+		for (unsigned char bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x0001)? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+		}
+	}
+
+	return crc;
+}
@@ -0,0 +1,110 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include "MemoryHelper.h"
+#include "stm32f0xx_hal.h"
+#include "main.h"
+#include <stdlib.h>
+#include <malloc.h>
+#include <new>
+
+// Host replacement of the target memory telemetry. The global new/delete
+// operators are left to the C++ runtime, since the simulator itself allocates
+// from the same heap; heap figures come from the C library and the stack
+// figures and the largest free block, meaningless on the host, are reported
+// as zero.
+MemoryHelper MemoryHelper::instance;
+
+MemoryHelper::MemoryHelper() {
+}
+
+MemoryHelper::~MemoryHelper() {
+}
+
+void MemoryHelper::init() {
+}
+
+void* MemoryHelper::allocate(size_t size, bool mustSucceed) {
+
+	void* ptr = malloc((size != 0)? size : 1);
+	if (ptr) {
+		allocations++;
+		return ptr;
+	}
+
+	failures++;
+	if (mustSucceed) {
+		Error_Handler();
+	}
+
+	return NULL;
+}
+
+void MemoryHelper::release(void* ptr) {
+
+	if (ptr) {
+		releases++;
+		free(ptr);
+	}
+}
+
+unsigned long MemoryHelper::getFreeMemory() const {
+	return mallinfo2().fordblks;
+}
+
+void MemoryHelper::getHeapStats(unsigned long* heapSize, unsigned long* heapInUse,
+							unsigned long* heapFree, unsigned long* largestFree) const {
+
+	struct mallinfo2 info = mallinfo2();
+
+	*heapSize = info.arena;
+	*heapInUse = info.uordblks;
+	*heapFree = info.fordblks;
+	*largestFree = getLargestFreeChunk();
+}
+
+void MemoryHelper::getAllocStats(unsigned long* allocations, unsigned long* releases, unsigned long* failures) const {
+
+	*allocations = this->allocations;
+	*releases = this->releases;
+	*failures = this->failures;
+}
+
+unsigned long MemoryHelper::getStackMaxUsed() const {
+	return 0;
+}
+
+// The C library does not expose its free lists
+unsigned long MemoryHelper::getLargestFreeChunk() const {
+	return 0;
+}
+
+unsigned long* MemoryHelper::getHeapTop() const {
+	return NULL;
+}
+
+unsigned long* MemoryHelper::getStackDeepest() const {
+	return NULL;
+}
@@ -0,0 +1,189 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include "SHT31Model.h"
+
+#define SHT31_CMD_SINGLESHOT		0x24
+#define SHT31_CMD_FETCH_DATA		0xE000
+#define SHT31_CMD_BREAK				0x3093
+#define SHT31_CMD_CLEAR_STATUS		0x3041
+
+// Periodic acquisition commands (MSB selects the rate, LSB the repeatability)
+typedef struct _periodiccommand {
+	unsigned char msb;
+	unsigned long long period;
+	unsigned char lsb[3];
+} periodiccommand;
+
+static const periodiccommand periodicCommands[] = {
+	{ 0x20, 2000 * SIM_NS_PER_MS, { 0x32, 0x24, 0x2F } },
+	{ 0x21, 1000 * SIM_NS_PER_MS, { 0x30, 0x26, 0x2D } },
+	{ 0x22, 500 * SIM_NS_PER_MS, { 0x36, 0x20, 0x2B } },
+	{ 0x23, 250 * SIM_NS_PER_MS, { 0x34, 0x22, 0x29 } },
+	{ 0x27, 100 * SIM_NS_PER_MS, { 0x37, 0x21, 0x2A } }
+};
+
+static const unsigned char singleShotRepeatability[] = { 0x00, 0x0B, 0x16 };
+
+SHT31Model::SHT31Model(BoardPlant* _plant, bool _internal) : plant(_plant), internal(_internal),
+				periodic(false), period(0), measurementTime(0), nextMeasurement(0),
+				dataReady(false), fetched(false) {
+}
+
+SHT31Model::~SHT31Model() {
+}
+
+// Max measurement duration for high, medium and low repeatability (datasheet Table 4)
+unsigned long long SHT31Model::getMeasurementTime(unsigned char repeatability) const {
+	static const unsigned long long durations[] = { 15500000ULL, 6500000ULL, 4500000ULL };
+	return durations[(repeatability < 3)? repeatability : 0];
+}
+
+bool SHT31Model::write(const unsigned char* data, unsigned short length) {
+
+	if (length != 2) {
+		return (length == 0);
+	}
+
+	unsigned short command = (data[0] << 8) | data[1];
+	unsigned long long now = SIM_KERNEL.now();
+
+	if (command == SHT31_CMD_BREAK) {
+		periodic = false;
+		dataReady = false;
+		return true;
+	}
+
+	if (command == SHT31_CMD_CLEAR_STATUS) {
+		return true;
+	}
+
+	if (command == SHT31_CMD_FETCH_DATA) {
+		if (!periodic) {
+			return false;
+		}
+		fetched = true;
+		return true;
+	}
+
+	// Other commands are not accepted while a periodic acquisition is running
+	if (periodic) {
+		return false;
+	}
+
+	if (data[0] == SHT31_CMD_SINGLESHOT) {
+		for (unsigned char n = 0; n < sizeof(singleShotRepeatability); n++) {
+			if (data[1] == singleShotRepeatability[n]) {
+				measurementTime = now + getMeasurementTime(n);
+				dataReady = false;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	for (unsigned char n = 0; n < sizeof(periodicCommands)/sizeof(periodiccommand); n++) {
+		if (data[0] != periodicCommands[n].msb) {
+			continue;
+		}
+		for (unsigned char m = 0; m < 3; m++) {
+			if (data[1] == periodicCommands[n].lsb[m]) {
+				periodic = true;
+				period = periodicCommands[n].period;
+				nextMeasurement = now + getMeasurementTime(m);
+				dataReady = false;
+				fetched = false;
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool SHT31Model::read(unsigned char* buffer, unsigned short length) {
+
+	unsigned long long now = SIM_KERNEL.now();
+
+	if (periodic) {
+
+		// Latest completed measurement, available once per FETCH
+		if (now >= nextMeasurement) {
+			measure();
+			while (nextMeasurement <= now) {
+				nextMeasurement += period;
+			}
+		}
+		if (!fetched || !dataReady) {
+			return false;
+		}
+		fetched = false;
+	} else {
+		if ((measurementTime == 0) || (now < measurementTime)) {
+			return false;
+		}
+		measure();
+		measurementTime = 0;
+	}
+
+	dataReady = false;
+	for (unsigned short n = 0; n < length; n++) {
+		buffer[n] = (n < sizeof(data))? data[n] : 0xFF;
+	}
+
+	return true;
+}
+
+void SHT31Model::measure() {
+
+	float temperature = internal? plant->getChamberTemperature() : plant->getAmbientTemperature();
+	float humidity = internal? plant->getChamberHumidity() : plant->getAmbientHumidity();
+
+	float rawT = ((temperature + 45.0f) * 65535.0f) / 175.0f;
+	float rawRH = (humidity * 65535.0f) / 100.0f;
+	unsigned short t = (rawT < 0)? 0 : ((rawT > 65535.0f)? 65535 : (unsigned short)rawT);
+	unsigned short rh = (rawRH < 0)? 0 : ((rawRH > 65535.0f)? 65535 : (unsigned short)rawRH);
+
+	data[0] = t >> 8;
+	data[1] = t & 0xFF;
+	data[2] = crc8(data, 2);
+	data[3] = rh >> 8;
+	data[4] = rh & 0xFF;
+	data[5] = crc8(data + 3, 2);
+	dataReady = true;
+}
+
+unsigned char SHT31Model::crc8(const unsigned char* data, unsigned char length) {
+
+	unsigned char crc = 0xFF;
+	for (unsigned char n = 0; n < length; n++) {
+		crc ^= data[n];
+		for (unsigned char bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x80)? ((crc << 1) ^ 0x31) : (crc << 1);
+		}
+	}
+
+	return crc;
+}
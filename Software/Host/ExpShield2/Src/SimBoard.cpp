@@ -16,29 +16,30 @@
  * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
  *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
  *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
- *			European Commission - Joint Research Centre,
+ *      European Commission - Joint Research Centre,
  * - Marco Signorini, marco.signorini@liberaintentio.com
  *
  * ===========================================================================
  */
 
-#ifndef SAMPLEAVERAGERNEXTPM_H_
-#define SAMPLEAVERAGERNEXTPM_H_
 
-#include "SamplesAverager.h"
+#include "SimBoard.h"
+#include "GlobalHalHandlers.h"
 
-class SamplesAveragerNextPM : public SamplesAverager {
-public:
-	SamplesAveragerNextPM();
-	virtual ~SamplesAveragerNextPM();
+SimBoard::SimBoard() : internalSHT31(&plant, true), externalSHT31(&plant, false),
+						adt7470(&plant), k96(&plant) {
+}
 
-	virtual bool collectSample(unsigned char channel, unsigned short sample, unsigned long _timestamp);
-	virtual unsigned short lastAveragedValue(unsigned char channel);
+SimBoard::~SimBoard() {
+}
 
-private:
-	unsigned short sampleTime;
-	unsigned short sensorStatus;
-	bool periodTerminated;
-};
+void SimBoard::attach() {
 
-#endif /* SAMPLEAVERAGERNEXTPM_H_ */
+	simI2CAttach(&hi2c2, 0x44 << 1, &internalSHT31);
+	simI2CAttach(&hi2c2, 0x45 << 1, &externalSHT31);
+	simI2CAttach(&hi2c2, 0x2C << 1, &adt7470);
+	simI2CAttach(&hi2c2, 0x50 << 1, &eeprom);
+	simADCConnect(&hadc, &plant);
+	simUARTConnect(&huart3, &k96);
+	simGPIOAddListener(&k96);
+}
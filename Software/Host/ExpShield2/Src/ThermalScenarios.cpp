@@ -0,0 +1,310 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include "ExpShieldTwoBoardImpl.h"
+#include "SimKernel.h"
+#include "BoardHal.h"
+#include "SimBoard.h"
+#include "TControlEngine.h"
+#include "IntChamberTempRef.h"
+#include "ADT7470Device.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// Closed loop temperature control scenarios. The unchanged firmware (the
+// TControlEngine, PIDEngine, CCDriveEngine and IntChamberTempRef included)
+// drives the lumped thermal model of the enclosure in accelerated time.
+// Each scenario runs in its own process, so it starts from a freshly
+// initialized firmware, and reports the chamber response to the setpoint:
+// settling time, overshoot, steady state error and electrical energy.
+
+#define THERMAL_DEFAULT_LOOP_COST_US	1000	/* Coarse main loop, the control runs once a second */
+#define THERMAL_DEFAULT_BAND			0.5f	/* Settling band, in C */
+#define THERMAL_STEADY_STATE_FRACTION	0.2f	/* Final part of the run averaged for the steady state error */
+#define THERMAL_SAMPLE_PERIOD			SIM_NS_PER_S
+
+typedef struct _scenario {
+	const char* name;
+	float ambient;					// Initial ambient and enclosure temperature, in C
+	float setpoint;					// Chamber setpoint, in C
+	float duration;					// In seconds
+	float disturbanceTime;			// Ambient step time, in seconds (0 for none)
+	float disturbanceAmbient;		// Ambient after the step, in C
+} scenario;
+
+static const scenario scenarios[] = {
+		{ "heat",			22.0f,	30.0f,	7200.0f,	0.0f,		0.0f },
+		{ "cool",			30.0f,	22.0f,	7200.0f,	0.0f,		0.0f },
+		{ "heat-cold",		 5.0f,	20.0f,	7200.0f,	0.0f,		0.0f },
+		{ "cool-hot",		35.0f,	25.0f,	7200.0f,	0.0f,		0.0f },
+		{ "ambient-step",	20.0f,	25.0f,	7200.0f,	3600.0f,	30.0f },
+};
+
+#define NUM_OF_SCENARIOS	(sizeof(scenarios)/sizeof(scenario))
+
+typedef struct _thermaloptions {
+	const char* scenarioName;
+	unsigned long loopCost;
+	float band;
+	float durationScale;
+	bool gainsSet;
+	double p, i, d;
+	bool feedforwardSet;
+	double heatFF, coolFF;
+	unsigned long trace;
+} thermaloptions;
+
+typedef struct _scenarioresult {
+	float settlingTime;				// In seconds, negative when not settled
+	float overshoot;				// In C
+	float steadyStateError;			// In C
+	double heaterEnergy;			// In Wh
+	double peltierEnergy;			// In Wh
+} scenarioresult;
+
+// Set by the board main loop when the devices bring-up is done and the
+// temperature control has been enabled
+extern bool bringUpCompleted;
+
+static void usage(const char* name) {
+
+	fprintf(stderr,
+		"Usage: %s [options]\n"
+		"  --scenario <name>       Run a single scenario (default: all)\n"
+		"  --duration-scale <r>    Scale the scenarios duration (default: 1)\n"
+		"  --gains <P> <I> <D>     Heating (and cooling) PID coefficients\n"
+		"  --feedforward <H> <C>   Heating and cooling feedforward coefficients\n"
+		"  --band <C>              Settling band (default: %.2f)\n"
+		"  --loop-cost <us>        Main loop iteration cost (default: %u)\n"
+		"  --trace <s>             Print the plant state with the given period\n"
+		"Scenarios:",
+		name, THERMAL_DEFAULT_BAND, THERMAL_DEFAULT_LOOP_COST_US);
+	for (unsigned char n = 0; n < NUM_OF_SCENARIOS; n++) {
+		fprintf(stderr, " %s", scenarios[n].name);
+	}
+	fprintf(stderr, "\n");
+}
+
+static bool parseOptions(int argc, char** argv, thermaloptions* options) {
+
+	options->scenarioName = NULL;
+	options->loopCost = THERMAL_DEFAULT_LOOP_COST_US;
+	options->band = THERMAL_DEFAULT_BAND;
+	options->durationScale = 1.0f;
+	options->gainsSet = false;
+	options->feedforwardSet = false;
+	options->trace = 0;
+
+	for (int n = 1; n < argc; n++) {
+		bool hasValue = (n + 1) < argc;
+		if (!strcmp(argv[n], "--scenario") && hasValue) {
+			options->scenarioName = argv[++n];
+		} else if (!strcmp(argv[n], "--duration-scale") && hasValue) {
+			options->durationScale = atof(argv[++n]);
+		} else if (!strcmp(argv[n], "--gains") && ((n + 3) < argc)) {
+			options->p = atof(argv[++n]);
+			options->i = atof(argv[++n]);
+			options->d = atof(argv[++n]);
+			options->gainsSet = true;
+		} else if (!strcmp(argv[n], "--feedforward") && ((n + 2) < argc)) {
+			options->heatFF = atof(argv[++n]);
+			options->coolFF = atof(argv[++n]);
+			options->feedforwardSet = true;
+		} else if (!strcmp(argv[n], "--band") && hasValue) {
+			options->band = atof(argv[++n]);
+		} else if (!strcmp(argv[n], "--loop-cost") && hasValue) {
+			options->loopCost = atol(argv[++n]);
+		} else if (!strcmp(argv[n], "--trace") && hasValue) {
+			options->trace = atol(argv[++n]);
+		} else {
+			return false;
+		}
+	}
+
+	return (options->durationScale > 0.0f) && (options->band > 0.0f);
+}
+
+// Override the setpoint and coefficients loaded by the firmware at bring-up.
+// The setpoint follows the same path as the host setpoint register writes.
+static void configureFirmware(const scenario* sc, const thermaloptions* options) {
+
+	AS_ADT7470.setSetpointForChannel(ADT7470_CHANNEL_T_INT_CHAMBER, (unsigned short)(sc->setpoint * 100));
+
+	if (options->gainsSet) {
+		AS_TCONTROL.setHeatingCoefficients(options->p, options->i, options->d);
+		AS_TCONTROL.setCoolingCoefficients(0.0, 0.0, 0.0);
+	}
+	if (options->feedforwardSet) {
+		AS_TCONTROL.setFeedforwardCoefficients(options->heatFF, options->coolFF);
+	}
+}
+
+static void runScenario(const scenario* sc, const thermaloptions* options, scenarioresult* result) {
+
+	simBoardInit();
+
+	SimBoard board;
+	board.plant.setAmbient(sc->ambient, 50.0f);
+	board.plant.setInitialTemperature(sc->ambient);
+	board.attach();
+
+	float duration = sc->duration * options->durationScale;
+	float disturbanceTime = sc->disturbanceTime * options->durationScale;
+	float steadyStateStart = duration * (1.0f - THERMAL_STEADY_STATE_FRACTION);
+	float direction = (sc->setpoint >= sc->ambient)? 1.0f : -1.0f;
+
+	unsigned long long end = (unsigned long long)(duration * SIM_NS_PER_S);
+	unsigned long long loopCost = options->loopCost * 1000ULL;
+	unsigned long long nextSample = 0;
+	unsigned long seconds = 0;
+	bool configured = false;
+	bool disturbed = (disturbanceTime <= 0.0f);
+
+	float lastOutside = 0.0f;
+	float overshoot = 0.0f;
+	double errorSum = 0.0;
+	unsigned long errorCount = 0;
+	float error = 0.0f;
+
+	setup_impl();
+
+	while (SIM_KERNEL.now() < end) {
+		loop_impl();
+		SIM_KERNEL.advance(loopCost);
+
+		if (!configured && bringUpCompleted) {
+			configured = true;
+			configureFirmware(sc, options);
+		}
+
+		if (SIM_KERNEL.now() < nextSample) {
+			continue;
+		}
+		nextSample += THERMAL_SAMPLE_PERIOD;
+
+		float t = (float)seconds++;
+		if (!disturbed && (t >= disturbanceTime)) {
+			disturbed = true;
+			board.plant.setAmbient(sc->disturbanceAmbient, 50.0f);
+		}
+
+		// Figures of merit on the true chamber temperature
+		float chamber = board.plant.getChamberTemperature();
+		error = chamber - sc->setpoint;
+		if ((error > options->band) || (error < -options->band)) {
+			lastOutside = t;
+		}
+		if ((error * direction) > overshoot) {
+			overshoot = error * direction;
+		}
+		if (t >= steadyStateStart) {
+			errorSum += error;
+			errorCount++;
+		}
+
+		if ((options->trace != 0) && ((seconds - 1) % options->trace) == 0) {
+			short refSetpoint, refTemperature;
+			AS_INTCH_TEMPREF.getChamberSetpointAndTemperature(refSetpoint, refTemperature);
+			printf("  %s %6.0fs chamber %6.2fC (ref %6.2fC) int %6.2fC ext %6.2fC ambient %5.1fC drive %6d peltier %5.2fA\n",
+					sc->name, t, chamber, refTemperature / 100.0f, board.plant.getInternalHeatsinkTemperature(),
+					board.plant.getExternalHeatsinkTemperature(), board.plant.getAmbientTemperature(),
+					AS_TCONTROL.getCurrentDrive(), board.plant.getPeltierCurrent());
+		}
+	}
+
+	// Settled when the last samples are inside the band
+	bool settled = (error <= options->band) && (error >= -options->band);
+
+	result->settlingTime = settled? lastOutside : -1.0f;
+	result->overshoot = overshoot;
+	result->steadyStateError = (errorCount != 0)? (float)(errorSum / errorCount) : 0.0f;
+	result->heaterEnergy = board.plant.getHeaterEnergy() / 3600.0;
+	result->peltierEnergy = board.plant.getPeltierEnergy() / 3600.0;
+}
+
+int main(int argc, char** argv) {
+
+	thermaloptions options;
+	if (!parseOptions(argc, argv, &options)) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	printf("%-14s %7s %7s %9s %10s %9s %9s %11s\n", "Scenario", "Tamb", "Tset", "Settling",
+			"Overshoot", "SS error", "Heater", "Peltier");
+	printf("%-14s %7s %7s %9s %10s %9s %9s %11s\n", "", "C", "C", "s", "C", "C", "Wh", "Wh");
+	fflush(stdout);
+
+	bool found = false;
+	bool failed = false;
+	for (unsigned char n = 0; n < NUM_OF_SCENARIOS; n++) {
+
+		const scenario* sc = scenarios + n;
+		if (options.scenarioName && strcmp(options.scenarioName, sc->name)) {
+			continue;
+		}
+		found = true;
+
+		// The firmware state lives in static singletons: run each scenario
+		// in a child process
+		pid_t child = fork();
+		if (child < 0) {
+			perror("fork");
+			return 1;
+		}
+
+		if (child == 0) {
+			scenarioresult result;
+			runScenario(sc, &options, &result);
+
+			char settling[16];
+			if (result.settlingTime < 0.0f) {
+				strcpy(settling, "-");
+			} else {
+				snprintf(settling, sizeof(settling), "%.0f", result.settlingTime);
+			}
+			printf("%-14s %7.1f %7.1f %9s %10.2f %9.2f %9.2f %11.2f\n", sc->name, sc->ambient, sc->setpoint,
+					settling, result.overshoot, result.steadyStateError, result.heaterEnergy, result.peltierEnergy);
+			fflush(stdout);
+			_exit(0);
+		}
+
+		int status;
+		if ((waitpid(child, &status, 0) < 0) || !WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+			fprintf(stderr, "Scenario %s failed\n", sc->name);
+			failed = true;
+		}
+	}
+
+	if (!found) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	return failed? 1 : 0;
+}
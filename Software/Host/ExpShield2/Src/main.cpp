@@ -0,0 +1,193 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+#include "ExpShieldTwoBoardImpl.h"
+#include "SimKernel.h"
+#include "SimEndpoints.h"
+#include "BoardHal.h"
+#include "GlobalHalHandlers.h"
+#include "SimBoard.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Host simulation of the ExpShield2 board: the firmware (setup_impl/loop_impl
+// and all the ASSrc modules) runs unchanged on the simulated HAL, with the
+// on board devices replaced by their models.
+#define SIM_DEFAULT_LOOP_COST_US	50		/* Main loop iteration cost when idle */
+#define SIM_DEFAULT_AMBIENT_T		22.0f
+#define SIM_DEFAULT_AMBIENT_RH		50.0f
+
+typedef struct _simoptions {
+	const char* serialA;
+	const char* serialB;
+	const char* serialD;
+	const char* usb;
+	const char* eeprom;
+	double duration;
+	double speed;
+	bool speedSet;
+	unsigned long loopCost;
+	float ambientT;
+	float ambientRH;
+} simoptions;
+
+static void usage(const char* name) {
+
+	fprintf(stderr,
+		"Usage: %s [options]\n"
+		"  --serial-a <endpoint>   Host link on USART1 (default: pty)\n"
+		"  --serial-b <endpoint>   SensorBus on USART2 (default: null)\n"
+		"  --serial-d <endpoint>   USART4 (default: null)\n"
+		"  --usb <endpoint>        USB CDC link (default: null)\n"
+		"  --duration <s>          Simulated time to run, 0 for forever (default: 0)\n"
+		"  --speed <ratio>         Simulated/wall clock ratio, 0 for unthrottled\n"
+		"                          (default: 1 with a pseudo-terminal, 0 otherwise)\n"
+		"  --loop-cost <us>        Main loop iteration cost (default: %u)\n"
+		"  --ambient <C> <RH%%>     Ambient conditions (default: %.1f %.1f)\n"
+		"  --eeprom <file>         Load and save the 24AA256 content\n"
+		"Endpoints: null, log, stdio, pty[:link], script:<file>\n",
+		name, SIM_DEFAULT_LOOP_COST_US, SIM_DEFAULT_AMBIENT_T, SIM_DEFAULT_AMBIENT_RH);
+}
+
+static bool parseOptions(int argc, char** argv, simoptions* options) {
+
+	options->serialA = "pty";
+	options->serialB = "null";
+	options->serialD = "null";
+	options->usb = "null";
+	options->eeprom = NULL;
+	options->duration = 0;
+	options->speed = 0;
+	options->speedSet = false;
+	options->loopCost = SIM_DEFAULT_LOOP_COST_US;
+	options->ambientT = SIM_DEFAULT_AMBIENT_T;
+	options->ambientRH = SIM_DEFAULT_AMBIENT_RH;
+
+	for (int n = 1; n < argc; n++) {
+		bool hasValue = (n + 1) < argc;
+		if (!strcmp(argv[n], "--serial-a") && hasValue) {
+			options->serialA = argv[++n];
+		} else if (!strcmp(argv[n], "--serial-b") && hasValue) {
+			options->serialB = argv[++n];
+		} else if (!strcmp(argv[n], "--serial-d") && hasValue) {
+			options->serialD = argv[++n];
+		} else if (!strcmp(argv[n], "--usb") && hasValue) {
+			options->usb = argv[++n];
+		} else if (!strcmp(argv[n], "--eeprom") && hasValue) {
+			options->eeprom = argv[++n];
+		} else if (!strcmp(argv[n], "--duration") && hasValue) {
+			options->duration = atof(argv[++n]);
+		} else if (!strcmp(argv[n], "--speed") && hasValue) {
+			options->speed = atof(argv[++n]);
+			options->speedSet = true;
+		} else if (!strcmp(argv[n], "--loop-cost") && hasValue) {
+			options->loopCost = atol(argv[++n]);
+		} else if (!strcmp(argv[n], "--ambient") && ((n + 2) < argc)) {
+			options->ambientT = atof(argv[++n]);
+			options->ambientRH = atof(argv[++n]);
+		} else {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static double getWallSeconds() {
+
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char** argv) {
+
+	simoptions options;
+	if (!parseOptions(argc, argv, &options)) {
+		usage(argv[0]);
+		return 2;
+	}
+
+	simBoardInit();
+
+	// Board models
+	SimBoard board;
+	board.plant.setAmbient(options.ambientT, options.ambientRH);
+	board.plant.setInitialTemperature(options.ambientT);
+
+	if (options.eeprom) {
+		board.eeprom.load(options.eeprom);
+	}
+
+	board.attach();
+
+	// Outside world links
+	SimSerialEndpoint* serialA = simCreateEndpoint(options.serialA, "A");
+	SimSerialEndpoint* serialB = simCreateEndpoint(options.serialB, "B");
+	SimSerialEndpoint* serialD = simCreateEndpoint(options.serialD, "D");
+	SimSerialEndpoint* usb = simCreateEndpoint(options.usb, "U");
+	if (!serialA || !serialB || !serialD || !usb) {
+		usage(argv[0]);
+		return 2;
+	}
+	simUARTConnect(&huart1, serialA);
+	simUARTConnect(&huart2, serialB);
+	simUARTConnect(&huart4, serialD);
+	simUSBConnect(usb, &usbRxCallback);
+
+	if (!options.speedSet) {
+		options.speed = simEndpointsInteractive()? 1.0 : 0.0;
+	}
+	simStartEndpointsService(options.speed);
+
+	double wallStart = getWallSeconds();
+	unsigned long long end = (unsigned long long)(options.duration * SIM_NS_PER_S);
+	unsigned long long loopCost = options.loopCost * 1000ULL;
+	unsigned long long loops = 0;
+
+	setup_impl();
+
+	while ((end == 0) || (SIM_KERNEL.now() < end)) {
+		loop_impl();
+		SIM_KERNEL.advance(loopCost);
+		loops++;
+	}
+
+	double wallTime = getWallSeconds() - wallStart;
+	double simTime = (double)SIM_KERNEL.now() / SIM_NS_PER_S;
+	fprintf(stderr, "Simulated %.3fs in %.3fs (x%.1f): %llu loops, %lu interrupts, "
+					"%lu K96 requests, %lu ADT7470 transactions, %lu EEPROM writes\n",
+					simTime, wallTime, (wallTime > 0)? simTime/wallTime : 0.0, loops,
+					SIM_KERNEL.getServedInterrupts(), board.k96.getNumRequests(),
+					board.adt7470.getNumTransactions(), board.eeprom.getNumWriteCycles());
+
+	if (options.eeprom) {
+		board.eeprom.save(options.eeprom);
+	}
+
+	return simCloseEndpoints()? 0 : 1;
+}
@@ -0,0 +1,54 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#ifndef SIMENDPOINTS_H_
+#define SIMENDPOINTS_H_
+
+#include "SimKernel.h"
+
+// Serial line endpoints, selected by a textual specification:
+//   null				discard the transmitted data, never send anything
+//   log				print the transmitted data on stdout
+//   stdio				pipe: read from stdin, write to stdout
+//   pty[:link]			pseudo-terminal, optionally symlinked to "link"
+//   script:file		timed "send" and "expect" lines read from file, see below
+//
+// Script lines are "<seconds> send <text>" or "<seconds> expect <text>", where
+// text may contain \r, \n and \xHH escapes. An expect succeeds when text has
+// been transmitted by the firmware since the previous matched expect.
+SimSerialEndpoint* simCreateEndpoint(const char* spec, const char* label);
+
+// Poll the endpoints each simulated millisecond. With speed != 0 the simulated
+// time is kept at most speed times faster than the wall clock.
+void simStartEndpointsService(double speed);
+
+// True if at least one endpoint needs a human (i.e. a pseudo-terminal)
+bool simEndpointsInteractive();
+
+// Release the endpoints. Returns false if any scripted expectation failed
+// or was left unchecked
+bool simCloseEndpoints();
+
+#endif /* SIMENDPOINTS_H_ */
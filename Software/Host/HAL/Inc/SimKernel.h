@@ -0,0 +1,163 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#ifndef SIMKERNEL_H_
+#define SIMKERNEL_H_
+
+#include "stm32f0xx_hal.h"
+#include <map>
+#include <deque>
+#include <vector>
+
+#define SIM_NS_PER_MS			1000000ULL
+#define SIM_NS_PER_S			1000000000ULL
+
+// Simulated time base and interrupt controller.
+// Hardware events (byte arrivals, timer updates, end of conversions) run when
+// their time is reached; the interrupts they raise are served in order as soon
+// as they are not masked and no other handler is running, like on a single
+// priority Cortex-M0. Time never runs by itself: it advances when the firmware
+// code waits for it or when the main loop completes an iteration.
+class SimKernel {
+public:
+	typedef void (*eventhandler)(void* context);
+
+public:
+	virtual ~SimKernel();
+
+	// Current time in nanoseconds since reset
+	unsigned long long now() const { return time; }
+
+	// Move the time forward, running due events and serving pending interrupts
+	void advance(unsigned long long ns);
+
+	// Hardware event at an absolute time
+	void schedule(unsigned long long at, eventhandler handler, void* context);
+
+	// Pend an interrupt handler (i.e. an ISR with the related HAL callbacks)
+	void raiseInterrupt(eventhandler handler, void* context);
+
+	void setInterruptsMasked(bool masked);
+	bool getInterruptsMasked() const { return masked; }
+	bool isHandlerRunning() const { return handlerRunning; }
+
+	void setIrqEnabled(IRQn_Type irq, bool enabled);
+	bool isIrqEnabled(IRQn_Type irq) const;
+
+	// Cost of a HAL_GetTick() poll; busy wait loops progress by this amount
+	void setPollCost(unsigned long long ns) { pollCost = ns; }
+	unsigned long long getPollCost() const { return pollCost; }
+
+	unsigned long getServedInterrupts() const { return servedInterrupts; }
+
+	static inline SimKernel* getInstance() { return &instance; }
+
+private:
+	SimKernel();
+
+	void runDueEvents(unsigned long long until);
+	void serveInterrupts();
+
+private:
+	typedef struct _pendingevent {
+		eventhandler handler;
+		void* context;
+	} pendingevent;
+
+	static SimKernel instance;
+
+	unsigned long long time;
+	unsigned long long pollCost;
+	bool masked;
+	bool handlerRunning;
+	bool irqEnabled[SIM_NUM_IRQn];
+	unsigned long servedInterrupts;
+
+	std::multimap<unsigned long long, pendingevent> events;
+	std::deque<pendingevent> interrupts;
+};
+
+#define SIM_KERNEL (*(SimKernel::getInstance()))
+
+// Serial line seen from the outside world: data are injected toward the firmware.
+class SimSerialPort {
+public:
+	virtual ~SimSerialPort() {}
+	virtual void inject(const unsigned char* data, unsigned short length) = 0;
+};
+
+// Something connected to a serial line: it receives the firmware transmissions
+// and pushes data into the attached port
+class SimSerialEndpoint {
+public:
+	SimSerialEndpoint() : port(NULL) {}
+	virtual ~SimSerialEndpoint() {}
+
+	virtual void attach(SimSerialPort* serialPort) { port = serialPort; }
+	virtual void onTransmit(const unsigned char* data, unsigned short length) = 0;
+
+	// Called each simulated millisecond to collect data from the outside world
+	virtual void poll() {}
+
+protected:
+	SimSerialPort* port;
+};
+
+// Device on an I2C bus. A transaction is split in a write phase (address
+// pointer and data) and a read phase; each phase returns false on NACK
+class SimI2CDevice {
+public:
+	virtual ~SimI2CDevice() {}
+	virtual bool write(const unsigned char* data, unsigned short length) = 0;
+	virtual bool read(unsigned char* data, unsigned short length) = 0;
+};
+
+// Analog front end feeding the ADC: converts a full scan
+class SimAnalogSource {
+public:
+	virtual ~SimAnalogSource() {}
+	virtual unsigned char getNumChannels() const = 0;
+	virtual void convert(unsigned short* scan) = 0;
+};
+
+// Pin writes observer (i.e. power enables)
+class SimGPIOListener {
+public:
+	virtual ~SimGPIOListener() {}
+	virtual void onPinWritten(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state) = 0;
+};
+
+// Peripherals wiring
+void simUARTConnect(UART_HandleTypeDef* huart, SimSerialEndpoint* endpoint);
+void simI2CAttach(I2C_HandleTypeDef* hi2c, unsigned char address, SimI2CDevice* device);
+void simADCConnect(ADC_HandleTypeDef* hadc, SimAnalogSource* source);
+void simGPIOAddListener(SimGPIOListener* listener);
+void simGPIOSetInput(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state);
+
+// USB CDC device: received packets are passed to the handler in the USB interrupt
+typedef void (*simusbrxhandler)(unsigned char* buffer, long length);
+void simUSBConnect(SimSerialEndpoint* endpoint, simusbrxhandler handler);
+
+#endif /* SIMKERNEL_H_ */
@@ -0,0 +1,358 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#ifndef __STM32F0xx_HAL_H
+#define __STM32F0xx_HAL_H
+
+/* Host simulation of the STM32F0 HAL subset used by the shields firmware.
+   Handles, register blocks and functions keep the ST names and semantics so
+   the ASSrc sources build unchanged. Peripherals are backed by the SimKernel
+   models: time only advances when the firmware waits (HAL_GetTick polling,
+   blocking I2C and SPI transfers) or between main loop iterations. */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIM_CORE_CLOCK_HZ		48000000UL
+
+typedef enum {
+	HAL_OK       = 0x00U,
+	HAL_ERROR    = 0x01U,
+	HAL_BUSY     = 0x02U,
+	HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum {
+	DISABLE = 0U,
+	ENABLE = !DISABLE
+} FunctionalState;
+
+#ifndef UNUSED
+#define UNUSED(X) (void)X
+#endif
+
+/* Core ---------------------------------------------------------------------*/
+typedef struct {
+	volatile uint32_t CTRL;
+	volatile uint32_t LOAD;
+	volatile uint32_t VAL;
+	volatile uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct {
+	volatile uint32_t CPUID;
+	volatile uint32_t ICSR;
+} SCB_Type;
+
+extern SysTick_Type simSysTick;
+extern SCB_Type simSCB;
+
+#define SysTick					(&simSysTick)
+#define SCB						(&simSCB)
+#define SCB_ICSR_PENDSTSET_Msk	(1UL << 26U)
+
+typedef enum {
+	TIM3_IRQn = 16,
+	TIM6_DAC_IRQn = 17,
+	TIM7_IRQn = 18,
+	TIM14_IRQn = 19,
+	TIM15_IRQn = 20,
+	TIM16_IRQn = 21,
+	TIM17_IRQn = 22,
+	SIM_NUM_IRQn = 32
+} IRQn_Type;
+
+void __disable_irq(void);
+void __enable_irq(void);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t priMask);
+uint32_t __get_MSP(void);
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+void HAL_NVIC_DisableIRQ(IRQn_Type IRQn);
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+
+/* Factory calibration values (system memory on the target) */
+extern uint16_t simTemp30Cal;
+extern uint16_t simVrefIntCal;
+
+#define TEMP30_CAL_ADDR			(&simTemp30Cal)
+#define VREFINT_CAL				(&simVrefIntCal)
+
+/* GPIO ---------------------------------------------------------------------*/
+typedef struct {
+	volatile uint32_t IDR;
+	volatile uint32_t ODR;
+} GPIO_TypeDef;
+
+extern GPIO_TypeDef simGPIOA;
+extern GPIO_TypeDef simGPIOB;
+extern GPIO_TypeDef simGPIOC;
+extern GPIO_TypeDef simGPIOD;
+extern GPIO_TypeDef simGPIOF;
+
+#define GPIOA					(&simGPIOA)
+#define GPIOB					(&simGPIOB)
+#define GPIOC					(&simGPIOC)
+#define GPIOD					(&simGPIOD)
+#define GPIOF					(&simGPIOF)
+
+#define GPIO_PIN_0				((uint16_t)0x0001U)
+#define GPIO_PIN_1				((uint16_t)0x0002U)
+#define GPIO_PIN_2				((uint16_t)0x0004U)
+#define GPIO_PIN_3				((uint16_t)0x0008U)
+#define GPIO_PIN_4				((uint16_t)0x0010U)
+#define GPIO_PIN_5				((uint16_t)0x0020U)
+#define GPIO_PIN_6				((uint16_t)0x0040U)
+#define GPIO_PIN_7				((uint16_t)0x0080U)
+#define GPIO_PIN_8				((uint16_t)0x0100U)
+#define GPIO_PIN_9				((uint16_t)0x0200U)
+#define GPIO_PIN_10				((uint16_t)0x0400U)
+#define GPIO_PIN_11				((uint16_t)0x0800U)
+#define GPIO_PIN_12				((uint16_t)0x1000U)
+#define GPIO_PIN_13				((uint16_t)0x2000U)
+#define GPIO_PIN_14				((uint16_t)0x4000U)
+#define GPIO_PIN_15				((uint16_t)0x8000U)
+
+typedef enum {
+	GPIO_PIN_RESET = 0U,
+	GPIO_PIN_SET
+} GPIO_PinState;
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+void HAL_GPIO_TogglePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin);
+
+/* Peripheral instances -----------------------------------------------------*/
+typedef struct { uint32_t id; } USART_TypeDef;
+typedef struct { uint32_t id; } I2C_TypeDef;
+typedef struct { uint32_t id; } SPI_TypeDef;
+typedef struct { uint32_t id; } ADC_TypeDef;
+typedef struct { uint32_t id; } CRC_TypeDef;
+
+typedef struct {
+	IRQn_Type irq;
+	volatile uint32_t CR1;
+	volatile uint32_t PSC;
+	volatile uint32_t ARR;
+	volatile uint32_t CCR1;
+	volatile uint32_t CCR2;
+	volatile uint32_t CCR3;
+	volatile uint32_t CCR4;
+} TIM_TypeDef;
+
+extern USART_TypeDef simUSART1, simUSART2, simUSART3, simUSART4;
+extern I2C_TypeDef simI2C1, simI2C2;
+extern SPI_TypeDef simSPI1;
+extern ADC_TypeDef simADC1;
+extern CRC_TypeDef simCRC;
+extern TIM_TypeDef simTIM3, simTIM7, simTIM14, simTIM15, simTIM16, simTIM17;
+
+#define USART1					(&simUSART1)
+#define USART2					(&simUSART2)
+#define USART3					(&simUSART3)
+#define USART4					(&simUSART4)
+#define I2C1					(&simI2C1)
+#define I2C2					(&simI2C2)
+#define SPI1					(&simSPI1)
+#define ADC1					(&simADC1)
+#define CRC						(&simCRC)
+#define TIM3					(&simTIM3)
+#define TIM7					(&simTIM7)
+#define TIM14					(&simTIM14)
+#define TIM15					(&simTIM15)
+#define TIM16					(&simTIM16)
+#define TIM17					(&simTIM17)
+
+/* TIM ----------------------------------------------------------------------*/
+typedef struct {
+	uint32_t Prescaler;
+	uint32_t Period;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+	TIM_TypeDef* Instance;
+	TIM_Base_InitTypeDef Init;
+	uint32_t Running;
+} TIM_HandleTypeDef;
+
+#define TIM_CHANNEL_1			0x00000000U
+#define TIM_CHANNEL_2			0x00000004U
+#define TIM_CHANNEL_3			0x00000008U
+#define TIM_CHANNEL_4			0x0000000CU
+
+#define __HAL_TIM_SET_AUTORELOAD(__HANDLE__, __AUTORELOAD__) \
+	do { \
+		(__HANDLE__)->Instance->ARR = (__AUTORELOAD__); \
+		(__HANDLE__)->Init.Period = (__AUTORELOAD__); \
+	} while(0)
+
+#define __HAL_TIM_GET_AUTORELOAD(__HANDLE__)	((__HANDLE__)->Instance->ARR)
+
+#define __HAL_TIM_SET_COMPARE(__HANDLE__, __CHANNEL__, __COMPARE__) \
+	(((__CHANNEL__) == TIM_CHANNEL_1) ? ((__HANDLE__)->Instance->CCR1 = (__COMPARE__)) : \
+	 ((__CHANNEL__) == TIM_CHANNEL_2) ? ((__HANDLE__)->Instance->CCR2 = (__COMPARE__)) : \
+	 ((__CHANNEL__) == TIM_CHANNEL_3) ? ((__HANDLE__)->Instance->CCR3 = (__COMPARE__)) : \
+	 ((__HANDLE__)->Instance->CCR4 = (__COMPARE__)))
+
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef* htim);
+HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef* htim, uint32_t Channel);
+HAL_StatusTypeDef HAL_TIMEx_PWMN_Start(TIM_HandleTypeDef* htim, uint32_t Channel);
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim);
+
+/* UART ---------------------------------------------------------------------*/
+typedef enum {
+	HAL_UART_STATE_RESET = 0x00U,
+	HAL_UART_STATE_READY = 0x20U,
+	HAL_UART_STATE_BUSY = 0x24U,
+	HAL_UART_STATE_BUSY_TX = 0x21U,
+	HAL_UART_STATE_BUSY_RX = 0x22U
+} HAL_UART_StateTypeDef;
+
+#define HAL_UART_ERROR_NONE		0x00000000U
+#define HAL_UART_ERROR_ORE		0x00000008U
+
+typedef struct {
+	uint32_t BaudRate;
+} UART_InitTypeDef;
+
+typedef struct {
+	USART_TypeDef* Instance;
+	UART_InitTypeDef Init;
+	uint8_t* pRxBuffPtr;
+	uint16_t RxXferSize;
+	volatile uint16_t RxXferCount;
+	uint32_t RxCircular;
+	volatile uint32_t gState;
+	volatile uint32_t RxState;
+	volatile uint32_t ErrorCode;
+} UART_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef* huart);
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart);
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef* huart);
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart);
+
+/* I2C ----------------------------------------------------------------------*/
+#define I2C_MEMADD_SIZE_8BIT	0x00000001U
+#define I2C_MEMADD_SIZE_16BIT	0x00000002U
+
+typedef struct {
+	uint32_t Timing;
+} I2C_InitTypeDef;
+
+typedef struct {
+	I2C_TypeDef* Instance;
+	I2C_InitTypeDef Init;
+} I2C_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+
+/* SPI ----------------------------------------------------------------------*/
+#define SPI_DATASIZE_8BIT			0x00000700U
+#define SPI_DATASIZE_16BIT			0x00000F00U
+
+#define SPI_BAUDRATEPRESCALER_2		0x00000000U
+#define SPI_BAUDRATEPRESCALER_4		0x00000008U
+#define SPI_BAUDRATEPRESCALER_8		0x00000010U
+#define SPI_BAUDRATEPRESCALER_16	0x00000018U
+#define SPI_BAUDRATEPRESCALER_32	0x00000020U
+#define SPI_BAUDRATEPRESCALER_64	0x00000028U
+#define SPI_BAUDRATEPRESCALER_128	0x00000030U
+#define SPI_BAUDRATEPRESCALER_256	0x00000038U
+
+typedef enum {
+	HAL_SPI_STATE_RESET = 0x00U,
+	HAL_SPI_STATE_READY = 0x01U,
+	HAL_SPI_STATE_BUSY_TX_RX = 0x05U
+} HAL_SPI_StateTypeDef;
+
+typedef struct {
+	uint32_t DataSize;
+	uint32_t BaudRatePrescaler;
+} SPI_InitTypeDef;
+
+typedef struct {
+	SPI_TypeDef* Instance;
+	SPI_InitTypeDef Init;
+	volatile uint32_t State;
+	uint32_t XferId;			/* Current interrupt transfer, stale completions are dropped */
+} SPI_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive_IT(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_Abort(SPI_HandleTypeDef* hspi);
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef* hspi);
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef* hspi);
+
+/* ADC ----------------------------------------------------------------------*/
+typedef struct {
+	TIM_TypeDef* ExternalTrigConv;		/* Timer whose update event (TRGO) starts a scan */
+} ADC_InitTypeDef;
+
+typedef struct {
+	ADC_TypeDef* Instance;
+	ADC_InitTypeDef Init;
+	uint16_t* pDmaBuffer;
+	uint32_t DmaLength;
+	volatile uint32_t DmaOffset;
+	volatile uint32_t Running;
+} ADC_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef* hadc);
+HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef* hadc, uint32_t* pData, uint32_t Length);
+HAL_StatusTypeDef HAL_ADC_Stop_DMA(ADC_HandleTypeDef* hadc);
+uint32_t HAL_ADC_GetValue(ADC_HandleTypeDef* hadc);
+void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc);
+void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc);
+
+/* CRC ----------------------------------------------------------------------*/
+typedef struct {
+	CRC_TypeDef* Instance;
+} CRC_HandleTypeDef;
+
+uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef* hcrc, uint32_t pBuffer[], uint32_t BufferLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STM32F0xx_HAL_H */
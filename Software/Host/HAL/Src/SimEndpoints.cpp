@@ -0,0 +1,349 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include "SimEndpoints.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <time.h>
+
+#define ENDPOINT_POLL_PERIOD	SIM_NS_PER_MS
+#define ENDPOINT_RX_CHUNK		256
+
+static std::vector<SimSerialEndpoint*> endpoints;
+static bool interactive = false;
+static bool passed = true;
+static double speedFactor = 0;
+static unsigned long long wallStart = 0;
+
+static unsigned long long getWallTime() {
+
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((unsigned long long)ts.tv_sec * SIM_NS_PER_S) + ts.tv_nsec;
+}
+
+// Print a transmitted chunk, escaping the non printable characters
+static void logData(const char* label, const char* direction, const unsigned char* data, unsigned short length) {
+
+	printf("[%12.6f] %s%s ", SIM_KERNEL.now() / (double)SIM_NS_PER_S, label, direction);
+	for (unsigned short n = 0; n < length; n++) {
+		if ((data[n] >= 0x20) && (data[n] < 0x7F)) {
+			putchar(data[n]);
+		} else if (data[n] == '\r') {
+			fputs("\\r", stdout);
+		} else if (data[n] == '\n') {
+			fputs("\\n", stdout);
+		} else {
+			printf("\\x%02X", data[n]);
+		}
+	}
+	putchar('\n');
+}
+
+class NullEndpoint : public SimSerialEndpoint {
+public:
+	virtual void onTransmit(const unsigned char* data, unsigned short length) {}
+};
+
+class LogEndpoint : public SimSerialEndpoint {
+public:
+	LogEndpoint(const char* _label) : label(_label) {}
+
+	virtual void onTransmit(const unsigned char* data, unsigned short length) {
+		logData(label.c_str(), ">", data, length);
+	}
+
+protected:
+	std::string label;
+};
+
+// Pipe endpoint: data are forwarded as they are
+class StdioEndpoint : public SimSerialEndpoint {
+public:
+	StdioEndpoint() {
+		fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+	}
+
+	virtual void onTransmit(const unsigned char* data, unsigned short length) {
+		fwrite(data, 1, length, stdout);
+		fflush(stdout);
+	}
+
+	virtual void poll() {
+		unsigned char buffer[ENDPOINT_RX_CHUNK];
+		ssize_t length = read(STDIN_FILENO, buffer, sizeof(buffer));
+		if ((length > 0) && port) {
+			port->inject(buffer, length);
+		}
+	}
+};
+
+// Pseudo-terminal. The slave side is kept open so that clients can come and go
+class PtyEndpoint : public SimSerialEndpoint {
+public:
+	PtyEndpoint(const char* label, const char* _link) : master(-1), slave(-1), link(_link) {
+
+		master = posix_openpt(O_RDWR | O_NOCTTY);
+		if ((master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0)) {
+			fprintf(stderr, "%s: unable to create a pseudo-terminal\n", label);
+			exit(EXIT_FAILURE);
+		}
+
+		const char* name = ptsname(master);
+		slave = open(name, O_RDWR | O_NOCTTY);
+		if (slave >= 0) {
+			struct termios attributes;
+			tcgetattr(slave, &attributes);
+			cfmakeraw(&attributes);
+			tcsetattr(slave, TCSANOW, &attributes);
+		}
+		fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+		if (link) {
+			unlink(link);
+			if (symlink(name, link) != 0) {
+				fprintf(stderr, "%s: unable to link %s\n", label, link);
+			}
+		}
+
+		fprintf(stderr, "%s on %s\n", label, (link != NULL)? link : name);
+	}
+
+	virtual ~PtyEndpoint() {
+		close(slave);
+		close(master);
+		if (link) {
+			unlink(link);
+		}
+	}
+
+	// Data are dropped when nobody reads them
+	virtual void onTransmit(const unsigned char* data, unsigned short length) {
+		ssize_t written = write(master, data, length);
+		(void)written;
+	}
+
+	virtual void poll() {
+		unsigned char buffer[ENDPOINT_RX_CHUNK];
+		ssize_t length = read(master, buffer, sizeof(buffer));
+		if ((length > 0) && port) {
+			port->inject(buffer, length);
+		}
+	}
+
+private:
+	int master;
+	int slave;
+	const char* link;
+};
+
+// Timed stimuli and expectations, the traffic is logged on stdout
+class ScriptEndpoint : public LogEndpoint {
+public:
+	ScriptEndpoint(const char* label, const char* fileName) : LogEndpoint(label), nextStep(0) {
+
+		FILE* file = fopen(fileName, "r");
+		if (!file) {
+			fprintf(stderr, "%s: unable to open %s\n", label, fileName);
+			exit(EXIT_FAILURE);
+		}
+
+		char line[512];
+		unsigned int lineNumber = 0;
+		while (fgets(line, sizeof(line), file)) {
+			lineNumber++;
+			line[strcspn(line, "\r\n")] = '\0';
+
+			double seconds;
+			char action[16];
+			int offset = 0;
+			if ((line[0] == '#') || (sscanf(line, " %lf %15s %n", &seconds, action, &offset) < 2)) {
+				continue;
+			}
+
+			step item;
+			item.time = (unsigned long long)(seconds * SIM_NS_PER_S);
+			item.expect = (strcmp(action, "expect") == 0);
+			item.text = unescape(line + offset);
+			if (!item.expect && (strcmp(action, "send") != 0)) {
+				fprintf(stderr, "%s:%u: unknown action %s\n", fileName, lineNumber, action);
+				exit(EXIT_FAILURE);
+			}
+			steps.push_back(item);
+		}
+		fclose(file);
+
+		if (!steps.empty()) {
+			SIM_KERNEL.schedule(steps[0].time, &onStep, this);
+		}
+	}
+
+	virtual ~ScriptEndpoint() {
+
+		// Expectations never reached by the simulation
+		for (size_t n = nextStep; n < steps.size(); n++) {
+			if (steps[n].expect) {
+				fprintf(stderr, "%s: expectation \"%s\" not checked\n", label.c_str(), steps[n].text.c_str());
+				passed = false;
+			}
+		}
+	}
+
+	virtual void onTransmit(const unsigned char* data, unsigned short length) {
+		LogEndpoint::onTransmit(data, length);
+		received.append((const char*)data, length);
+	}
+
+private:
+	typedef struct _step {
+		unsigned long long time;
+		bool expect;
+		std::string text;
+	} step;
+
+	static std::string unescape(const char* text) {
+
+		std::string result;
+		while (*text) {
+			if ((text[0] == '\\') && (text[1] == 'r')) {
+				result += '\r';
+				text += 2;
+			} else if ((text[0] == '\\') && (text[1] == 'n')) {
+				result += '\n';
+				text += 2;
+			} else if ((text[0] == '\\') && (text[1] == 'x') && text[2] && text[3]) {
+				char hex[3] = { text[2], text[3], '\0' };
+				result += (char)strtoul(hex, NULL, 16);
+				text += 4;
+			} else {
+				result += *text++;
+			}
+		}
+
+		return result;
+	}
+
+	static void onStep(void* context) {
+
+		ScriptEndpoint* script = (ScriptEndpoint*)context;
+		step& item = script->steps[script->nextStep++];
+
+		if (item.expect) {
+			size_t position = script->received.find(item.text);
+			if (position == std::string::npos) {
+				fprintf(stderr, "[%12.6f] %s: expected \"%s\" not received\n",
+						SIM_KERNEL.now() / (double)SIM_NS_PER_S, script->label.c_str(), item.text.c_str());
+				passed = false;
+			} else {
+				script->received.erase(0, position + item.text.size());
+			}
+		} else if (script->port) {
+			logData(script->label.c_str(), "<", (const unsigned char*)item.text.data(), item.text.size());
+			script->port->inject((const unsigned char*)item.text.data(), item.text.size());
+		}
+
+		if (script->nextStep < script->steps.size()) {
+			SIM_KERNEL.schedule(script->steps[script->nextStep].time, &onStep, script);
+		}
+	}
+
+private:
+	std::vector<step> steps;
+	size_t nextStep;
+	std::string received;
+};
+
+SimSerialEndpoint* simCreateEndpoint(const char* spec, const char* label) {
+
+	SimSerialEndpoint* endpoint = NULL;
+	if (strcmp(spec, "null") == 0) {
+		endpoint = new NullEndpoint();
+	} else if (strcmp(spec, "log") == 0) {
+		endpoint = new LogEndpoint(label);
+	} else if (strcmp(spec, "stdio") == 0) {
+		endpoint = new StdioEndpoint();
+	} else if (strcmp(spec, "pty") == 0) {
+		endpoint = new PtyEndpoint(label, NULL);
+		interactive = true;
+	} else if (strncmp(spec, "pty:", 4) == 0) {
+		endpoint = new PtyEndpoint(label, spec + 4);
+		interactive = true;
+	} else if (strncmp(spec, "script:", 7) == 0) {
+		endpoint = new ScriptEndpoint(label, spec + 7);
+	}
+
+	if (endpoint) {
+		endpoints.push_back(endpoint);
+	}
+
+	return endpoint;
+}
+
+static void onPoll(void* context) {
+
+	for (size_t n = 0; n < endpoints.size(); n++) {
+		endpoints[n]->poll();
+	}
+
+	// Throttle to the requested speed
+	if (speedFactor > 0) {
+		unsigned long long target = wallStart + (unsigned long long)(SIM_KERNEL.now() / speedFactor);
+		unsigned long long wall = getWallTime();
+		if (target > wall) {
+			struct timespec delay;
+			delay.tv_sec = (target - wall) / SIM_NS_PER_S;
+			delay.tv_nsec = (target - wall) % SIM_NS_PER_S;
+			nanosleep(&delay, NULL);
+		}
+	}
+
+	SIM_KERNEL.schedule(SIM_KERNEL.now() + ENDPOINT_POLL_PERIOD, &onPoll, context);
+}
+
+void simStartEndpointsService(double speed) {
+
+	speedFactor = speed;
+	wallStart = getWallTime() - (unsigned long long)((speed > 0)? (SIM_KERNEL.now() / speed) : 0);
+	SIM_KERNEL.schedule(SIM_KERNEL.now() + ENDPOINT_POLL_PERIOD, &onPoll, NULL);
+}
+
+bool simEndpointsInteractive() {
+	return interactive;
+}
+
+bool simCloseEndpoints() {
+
+	for (size_t n = 0; n < endpoints.size(); n++) {
+		delete endpoints[n];
+	}
+	endpoints.clear();
+
+	return passed;
+}
@@ -0,0 +1,747 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include "SimKernel.h"
+#include <string.h>
+
+#define SIM_UART_CHAR_BITS		10			/* Start, 8 data, stop */
+#define SIM_I2C_BIT_NS			10000ULL	/* 100kHz, see I2C2 timing */
+#define SIM_I2C_BYTE_BITS		9			/* 8 data, ack */
+#define SIM_ADC_SCAN_NS			35000ULL	/* Scan time for the configured channels */
+#define SIM_ADC_CALIBRATION		0x48		/* Typical calibration factor */
+#define SIM_CRC_POLY			0x04C11DB7UL
+#define SIM_SYSTICK_LOAD		((SIM_CORE_CLOCK_HZ / 1000) - 1)
+
+// Core registers and calibration values
+SysTick_Type simSysTick = { 0, SIM_SYSTICK_LOAD, SIM_SYSTICK_LOAD, 0 };
+SCB_Type simSCB = { 0, 0 };
+uint16_t simTemp30Cal = 1750;		/* Typical values at 3.3V */
+uint16_t simVrefIntCal = 1525;
+
+// Peripherals
+GPIO_TypeDef simGPIOA = { 0xFFFF, 0 };
+GPIO_TypeDef simGPIOB = { 0xFFFF, 0 };
+GPIO_TypeDef simGPIOC = { 0xFFFF, 0 };
+GPIO_TypeDef simGPIOD = { 0xFFFF, 0 };
+GPIO_TypeDef simGPIOF = { 0xFFFF, 0 };
+
+USART_TypeDef simUSART1 = { 1 }, simUSART2 = { 2 }, simUSART3 = { 3 }, simUSART4 = { 4 };
+I2C_TypeDef simI2C1 = { 1 }, simI2C2 = { 2 };
+SPI_TypeDef simSPI1 = { 1 };
+ADC_TypeDef simADC1 = { 1 };
+CRC_TypeDef simCRC = { 1 };
+TIM_TypeDef simTIM3 = { TIM3_IRQn, 0, 0, 0, 0, 0, 0, 0 };
+TIM_TypeDef simTIM7 = { TIM7_IRQn, 0, 0, 0, 0, 0, 0, 0 };
+TIM_TypeDef simTIM14 = { TIM14_IRQn, 0, 0, 0, 0, 0, 0, 0 };
+TIM_TypeDef simTIM15 = { TIM15_IRQn, 0, 0, 0, 0, 0, 0, 0 };
+TIM_TypeDef simTIM16 = { TIM16_IRQn, 0, 0, 0, 0, 0, 0, 0 };
+TIM_TypeDef simTIM17 = { TIM17_IRQn, 0, 0, 0, 0, 0, 0, 0 };
+
+// Serial line model: baud rate paced, IT (one shot) and circular DMA reception
+class SimUART : public SimSerialPort {
+public:
+	SimUART(UART_HandleTypeDef* _huart) : huart(_huart), endpoint(NULL),
+							arrivalScheduled(false), rdrFull(false), rdr(0) {}
+
+	virtual void inject(const unsigned char* data, unsigned short length) {
+
+		rxFifo.insert(rxFifo.end(), data, data + length);
+		if (!arrivalScheduled && !rxFifo.empty()) {
+			arrivalScheduled = true;
+			SIM_KERNEL.schedule(SIM_KERNEL.now() + getCharTime(), &onArrival, this);
+		}
+	}
+
+	unsigned long long getCharTime() const {
+		unsigned long baud = (huart->Init.BaudRate != 0)? huart->Init.BaudRate : 9600;
+		return (SIM_UART_CHAR_BITS * SIM_NS_PER_S) / baud;
+	}
+
+	HAL_StatusTypeDef transmit(const uint8_t* data, uint16_t size) {
+
+		if (huart->gState != HAL_UART_STATE_READY) {
+			return HAL_BUSY;
+		}
+		if ((data == NULL) || (size == 0)) {
+			return HAL_ERROR;
+		}
+
+		huart->gState = HAL_UART_STATE_BUSY_TX;
+		txData.assign(data, data + size);
+		SIM_KERNEL.schedule(SIM_KERNEL.now() + (size * getCharTime()), &onTransmitted, this);
+
+		return HAL_OK;
+	}
+
+	HAL_StatusTypeDef receive(uint8_t* data, uint16_t size, bool circular) {
+
+		if (huart->RxState != HAL_UART_STATE_READY) {
+			return HAL_BUSY;
+		}
+		if ((data == NULL) || (size == 0)) {
+			return HAL_ERROR;
+		}
+
+		huart->pRxBuffPtr = data;
+		huart->RxXferSize = size;
+		huart->RxXferCount = 0;
+		huart->RxCircular = circular;
+		huart->ErrorCode = HAL_UART_ERROR_NONE;
+		huart->RxState = HAL_UART_STATE_BUSY_RX;
+
+		// A character received while disarmed is still in the data register
+		if (rdrFull) {
+			if (circular) {
+				rdrFull = false;
+				store(rdr);
+			} else {
+				SIM_KERNEL.raiseInterrupt(&onRxNotEmpty, this);
+			}
+		}
+
+		return HAL_OK;
+	}
+
+	void connect(SimSerialEndpoint* _endpoint) {
+		endpoint = _endpoint;
+		endpoint->attach(this);
+	}
+
+private:
+	// DMA transfer to memory
+	void store(unsigned char data) {
+
+		huart->pRxBuffPtr[huart->RxXferCount++] = data;
+		if (huart->RxXferCount == (huart->RxXferSize >> 1)) {
+			SIM_KERNEL.raiseInterrupt(&onRxHalfComplete, this);
+		}
+		if (huart->RxXferCount == huart->RxXferSize) {
+			huart->RxXferCount = 0;
+			SIM_KERNEL.raiseInterrupt(&onRxComplete, this);
+		}
+	}
+
+	static void onArrival(void* context) {
+
+		SimUART* uart = (SimUART*)context;
+		unsigned char data = uart->rxFifo.front();
+		uart->rxFifo.pop_front();
+
+		if ((uart->huart->RxState == HAL_UART_STATE_BUSY_RX) && uart->huart->RxCircular) {
+			uart->store(data);
+		} else if (uart->rdrFull) {
+
+			// Overrun: the new character is lost. It's signaled only when receiving
+			uart->huart->ErrorCode |= HAL_UART_ERROR_ORE;
+			if (uart->huart->RxState == HAL_UART_STATE_BUSY_RX) {
+				SIM_KERNEL.raiseInterrupt(&onRxError, uart);
+			}
+		} else {
+			uart->rdr = data;
+			uart->rdrFull = true;
+			if (uart->huart->RxState == HAL_UART_STATE_BUSY_RX) {
+				SIM_KERNEL.raiseInterrupt(&onRxNotEmpty, uart);
+			}
+		}
+
+		if (!uart->rxFifo.empty()) {
+			SIM_KERNEL.schedule(SIM_KERNEL.now() + uart->getCharTime(), &onArrival, uart);
+		} else {
+			uart->arrivalScheduled = false;
+		}
+	}
+
+	static void onTransmitted(void* context) {
+
+		SimUART* uart = (SimUART*)context;
+		if (uart->endpoint) {
+			uart->endpoint->onTransmit(uart->txData.data(), uart->txData.size());
+		}
+		SIM_KERNEL.raiseInterrupt(&onTxComplete, uart);
+	}
+
+	// Interrupt handlers
+	static void onTxComplete(void* context) {
+
+		SimUART* uart = (SimUART*)context;
+		uart->huart->gState = HAL_UART_STATE_READY;
+		HAL_UART_TxCpltCallback(uart->huart);
+	}
+
+	static void onRxNotEmpty(void* context) {
+
+		SimUART* uart = (SimUART*)context;
+		UART_HandleTypeDef* huart = uart->huart;
+		if ((huart->RxState != HAL_UART_STATE_BUSY_RX) || !uart->rdrFull) {
+			return;
+		}
+		if (huart->ErrorCode & HAL_UART_ERROR_ORE) {
+			onRxError(context);
+			return;
+		}
+
+		uart->rdrFull = false;
+		huart->pRxBuffPtr[huart->RxXferCount++] = uart->rdr;
+		if (huart->RxXferCount == huart->RxXferSize) {
+			huart->RxState = HAL_UART_STATE_READY;
+			HAL_UART_RxCpltCallback(huart);
+		}
+	}
+
+	static void onRxHalfComplete(void* context) {
+		HAL_UART_RxHalfCpltCallback(((SimUART*)context)->huart);
+	}
+
+	static void onRxComplete(void* context) {
+		HAL_UART_RxCpltCallback(((SimUART*)context)->huart);
+	}
+
+	// Blocking errors abort the reception
+	static void onRxError(void* context) {
+
+		SimUART* uart = (SimUART*)context;
+		uart->rdrFull = false;
+		uart->huart->RxState = HAL_UART_STATE_READY;
+		HAL_UART_ErrorCallback(uart->huart);
+		uart->huart->ErrorCode = HAL_UART_ERROR_NONE;
+	}
+
+private:
+	UART_HandleTypeDef* huart;
+	SimSerialEndpoint* endpoint;
+	std::deque<unsigned char> rxFifo;
+	std::vector<unsigned char> txData;
+	bool arrivalScheduled;
+	bool rdrFull;
+	unsigned char rdr;
+};
+
+// Wiring tables
+static std::map<USART_TypeDef*, SimUART*> uarts;
+static std::map<I2C_TypeDef*, std::map<unsigned char, SimI2CDevice*> > i2cBuses;
+static std::map<ADC_TypeDef*, SimAnalogSource*> analogSources;
+static std::vector<ADC_HandleTypeDef*> adcs;
+static std::vector<SimGPIOListener*> gpioListeners;
+static uint32_t adcLastValue = 0;
+
+static SimUART* getUART(UART_HandleTypeDef* huart) {
+
+	std::map<USART_TypeDef*, SimUART*>::iterator it = uarts.find(huart->Instance);
+	if (it != uarts.end()) {
+		return it->second;
+	}
+
+	SimUART* uart = new SimUART(huart);
+	uarts[huart->Instance] = uart;
+	return uart;
+}
+
+void simUARTConnect(UART_HandleTypeDef* huart, SimSerialEndpoint* endpoint) {
+	getUART(huart)->connect(endpoint);
+}
+
+void simI2CAttach(I2C_HandleTypeDef* hi2c, unsigned char address, SimI2CDevice* device) {
+	i2cBuses[hi2c->Instance][address & 0xFE] = device;
+}
+
+void simADCConnect(ADC_HandleTypeDef* hadc, SimAnalogSource* source) {
+	analogSources[hadc->Instance] = source;
+	adcs.push_back(hadc);
+}
+
+void simGPIOAddListener(SimGPIOListener* listener) {
+	gpioListeners.push_back(listener);
+}
+
+void simGPIOSetInput(GPIO_TypeDef* port, uint16_t pin, GPIO_PinState state) {
+	if (state == GPIO_PIN_SET) {
+		port->IDR |= pin;
+	} else {
+		port->IDR &= ~(uint32_t)pin;
+	}
+}
+
+/* Core ---------------------------------------------------------------------*/
+extern "C" void __disable_irq(void) {
+	SIM_KERNEL.setInterruptsMasked(true);
+}
+
+extern "C" void __enable_irq(void) {
+	SIM_KERNEL.setInterruptsMasked(false);
+}
+
+extern "C" uint32_t __get_PRIMASK(void) {
+	return SIM_KERNEL.getInterruptsMasked()? 1 : 0;
+}
+
+extern "C" void __set_PRIMASK(uint32_t priMask) {
+	SIM_KERNEL.setInterruptsMasked((priMask & 1) != 0);
+}
+
+extern "C" uint32_t __get_MSP(void) {
+	volatile uint32_t marker = 0;
+	return (uint32_t)(uintptr_t)&marker;
+}
+
+extern "C" void HAL_NVIC_EnableIRQ(IRQn_Type IRQn) {
+	SIM_KERNEL.setIrqEnabled(IRQn, true);
+}
+
+extern "C" void HAL_NVIC_DisableIRQ(IRQn_Type IRQn) {
+	SIM_KERNEL.setIrqEnabled(IRQn, false);
+}
+
+// Each poll costs some time: busy waits on the tick progress
+extern "C" uint32_t HAL_GetTick(void) {
+
+	SIM_KERNEL.advance(SIM_KERNEL.getPollCost());
+
+	unsigned long long now = SIM_KERNEL.now();
+	simSysTick.VAL = SIM_SYSTICK_LOAD - (uint32_t)(((now % SIM_NS_PER_MS) * (SIM_SYSTICK_LOAD + 1)) / SIM_NS_PER_MS);
+
+	return (uint32_t)(now / SIM_NS_PER_MS);
+}
+
+extern "C" void HAL_Delay(uint32_t Delay) {
+
+	uint32_t start = HAL_GetTick();
+	while ((HAL_GetTick() - start) < (Delay + 1)) {
+		SIM_KERNEL.advance(SIM_NS_PER_MS >> 2);
+	}
+}
+
+/* GPIO ---------------------------------------------------------------------*/
+extern "C" GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin) {
+	return (GPIOx->IDR & GPIO_Pin)? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+// Outputs are read back on the input register
+extern "C" void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+
+	if (PinState == GPIO_PIN_SET) {
+		GPIOx->ODR |= GPIO_Pin;
+	} else {
+		GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+	}
+	simGPIOSetInput(GPIOx, GPIO_Pin, PinState);
+
+	for (size_t n = 0; n < gpioListeners.size(); n++) {
+		gpioListeners[n]->onPinWritten(GPIOx, GPIO_Pin, PinState);
+	}
+}
+
+extern "C" void HAL_GPIO_TogglePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin) {
+	HAL_GPIO_WritePin(GPIOx, GPIO_Pin, (GPIOx->ODR & GPIO_Pin)? GPIO_PIN_RESET : GPIO_PIN_SET);
+}
+
+/* TIM ----------------------------------------------------------------------*/
+static void onTimerInterrupt(void* context) {
+	HAL_TIM_PeriodElapsedCallback((TIM_HandleTypeDef*)context);
+}
+
+static void onADCHalfComplete(void* context) {
+	HAL_ADC_ConvHalfCpltCallback((ADC_HandleTypeDef*)context);
+}
+
+static void onADCComplete(void* context) {
+	HAL_ADC_ConvCpltCallback((ADC_HandleTypeDef*)context);
+}
+
+static unsigned long long getTimerPeriod(const TIM_TypeDef* tim) {
+	return (((unsigned long long)tim->PSC + 1) * ((unsigned long long)tim->ARR + 1) * SIM_NS_PER_S) / SIM_CORE_CLOCK_HZ;
+}
+
+static void onScanCompleted(void* context) {
+
+	ADC_HandleTypeDef* hadc = (ADC_HandleTypeDef*)context;
+	if (!hadc->Running) {
+		return;
+	}
+
+	SimAnalogSource* source = analogSources[hadc->Instance];
+	unsigned char numChannels = source->getNumChannels();
+	if ((hadc->DmaOffset + numChannels) > hadc->DmaLength) {
+		hadc->DmaOffset = 0;
+	}
+
+	unsigned short* scan = hadc->pDmaBuffer + hadc->DmaOffset;
+	source->convert(scan);
+	adcLastValue = scan[numChannels - 1];
+	hadc->DmaOffset += numChannels;
+
+	if (hadc->DmaOffset == (hadc->DmaLength >> 1)) {
+		SIM_KERNEL.raiseInterrupt(&onADCHalfComplete, hadc);
+	}
+	if (hadc->DmaOffset == hadc->DmaLength) {
+		hadc->DmaOffset = 0;
+		SIM_KERNEL.raiseInterrupt(&onADCComplete, hadc);
+	}
+}
+
+// The update event raises the timer interrupt, if enabled, and triggers
+// the ADC scans of the converters using it as external trigger
+static void onTimerUpdate(void* context) {
+
+	TIM_HandleTypeDef* htim = (TIM_HandleTypeDef*)context;
+	if (!htim->Running) {
+		return;
+	}
+
+	if (SIM_KERNEL.isIrqEnabled(htim->Instance->irq)) {
+		SIM_KERNEL.raiseInterrupt(&onTimerInterrupt, htim);
+	}
+
+	for (size_t n = 0; n < adcs.size(); n++) {
+		if (adcs[n]->Running && (adcs[n]->Init.ExternalTrigConv == htim->Instance)) {
+			SIM_KERNEL.schedule(SIM_KERNEL.now() + SIM_ADC_SCAN_NS, &onScanCompleted, adcs[n]);
+		}
+	}
+
+	SIM_KERNEL.schedule(SIM_KERNEL.now() + getTimerPeriod(htim->Instance), &onTimerUpdate, htim);
+}
+
+// Only timers with an observer get events, PWM only timers
+// (tens of kHz) would just slow down the simulation
+static bool isTimerObserved(TIM_HandleTypeDef* htim) {
+
+	if (SIM_KERNEL.isIrqEnabled(htim->Instance->irq)) {
+		return true;
+	}
+
+	for (size_t n = 0; n < adcs.size(); n++) {
+		if (adcs[n]->Init.ExternalTrigConv == htim->Instance) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef* htim) {
+
+	htim->Instance->PSC = htim->Init.Prescaler;
+	htim->Instance->ARR = htim->Init.Period;
+	htim->Running = 0;
+
+	return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef* htim) {
+
+	if (htim->Running) {
+		return HAL_OK;
+	}
+
+	htim->Running = 1;
+	if (isTimerObserved(htim)) {
+		SIM_KERNEL.schedule(SIM_KERNEL.now() + getTimerPeriod(htim->Instance), &onTimerUpdate, htim);
+	}
+
+	return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef* htim) {
+	htim->Running = 0;
+	return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIM_PWM_Start(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_TIMEx_PWMN_Start(TIM_HandleTypeDef* htim, uint32_t Channel) {
+	return HAL_OK;
+}
+
+/* UART ---------------------------------------------------------------------*/
+extern "C" HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef* huart) {
+
+	huart->gState = HAL_UART_STATE_READY;
+	huart->RxState = HAL_UART_STATE_READY;
+	huart->ErrorCode = HAL_UART_ERROR_NONE;
+	getUART(huart);
+
+	return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size) {
+	return getUART(huart)->transmit(pData, Size);
+}
+
+extern "C" HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size) {
+	return getUART(huart)->transmit(pData, Size);
+}
+
+extern "C" HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size) {
+	return getUART(huart)->receive(pData, Size, false);
+}
+
+// Reception DMA channels are configured in circular mode
+extern "C" HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size) {
+	return getUART(huart)->receive(pData, Size, true);
+}
+
+/* I2C ----------------------------------------------------------------------*/
+static SimI2CDevice* getI2CDevice(I2C_HandleTypeDef* hi2c, uint16_t DevAddress) {
+
+	std::map<unsigned char, SimI2CDevice*>& bus = i2cBuses[hi2c->Instance];
+	std::map<unsigned char, SimI2CDevice*>::iterator it = bus.find(DevAddress & 0xFE);
+
+	return (it != bus.end())? it->second : NULL;
+}
+
+// Bus time for a transaction. Blocking transfers let the interrupts run
+static void i2cTransferTime(unsigned long numBytes) {
+	SIM_KERNEL.advance((2 + (numBytes * SIM_I2C_BYTE_BITS)) * SIM_I2C_BIT_NS);
+}
+
+static unsigned char i2cMemAddress(uint16_t MemAddress, uint16_t MemAddSize, unsigned char* buffer) {
+
+	if (MemAddSize == I2C_MEMADD_SIZE_16BIT) {
+		buffer[0] = (MemAddress >> 8) & 0xFF;
+		buffer[1] = MemAddress & 0xFF;
+		return 2;
+	}
+
+	buffer[0] = MemAddress & 0xFF;
+	return 1;
+}
+
+extern "C" HAL_StatusTypeDef HAL_I2C_Master_Transmit(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+
+	SimI2CDevice* device = getI2CDevice(hi2c, DevAddress);
+	bool ack = (device != NULL) && device->write(pData, Size);
+	i2cTransferTime(ack? (Size + 1) : 1);
+
+	return ack? HAL_OK : HAL_ERROR;
+}
+
+extern "C" HAL_StatusTypeDef HAL_I2C_Master_Receive(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+
+	SimI2CDevice* device = getI2CDevice(hi2c, DevAddress);
+	bool ack = (device != NULL) && device->read(pData, Size);
+	i2cTransferTime(ack? (Size + 1) : 1);
+
+	return ack? HAL_OK : HAL_ERROR;
+}
+
+extern "C" HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+
+	std::vector<unsigned char> frame(2 + Size);
+	unsigned char addressLength = i2cMemAddress(MemAddress, MemAddSize, frame.data());
+	memcpy(frame.data() + addressLength, pData, Size);
+
+	SimI2CDevice* device = getI2CDevice(hi2c, DevAddress);
+	bool ack = (device != NULL) && device->write(frame.data(), addressLength + Size);
+	i2cTransferTime(ack? (1 + addressLength + Size) : 1);
+
+	return ack? HAL_OK : HAL_ERROR;
+}
+
+// Address pointer write, then repeated start and read
+extern "C" HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t* pData, uint16_t Size, uint32_t Timeout) {
+
+	unsigned char address[2];
+	unsigned char addressLength = i2cMemAddress(MemAddress, MemAddSize, address);
+
+	SimI2CDevice* device = getI2CDevice(hi2c, DevAddress);
+	bool ack = (device != NULL) && device->write(address, addressLength) && device->read(pData, Size);
+	i2cTransferTime(ack? (2 + addressLength + Size) : 1);
+
+	return ack? HAL_OK : HAL_ERROR;
+}
+
+/* SPI ----------------------------------------------------------------------*/
+// No device model is attached: MISO reads as zeros. Transfers take bus time
+// according to the frame size and the baud rate prescaler.
+static unsigned long long spiTransferTime(const SPI_HandleTypeDef* hspi, uint16_t Size) {
+
+	unsigned long long frameBits = (hspi->Init.DataSize == SPI_DATASIZE_16BIT)? 16 : 8;
+	unsigned long long divider = 2ULL << (hspi->Init.BaudRatePrescaler >> 3);
+
+	return (Size * frameBits * divider * SIM_NS_PER_S) / SIM_CORE_CLOCK_HZ;
+}
+
+static uint16_t spiFrameBytes(const SPI_HandleTypeDef* hspi) {
+	return (hspi->Init.DataSize == SPI_DATASIZE_16BIT)? 2 : 1;
+}
+
+typedef struct _spitransfer {
+	SPI_HandleTypeDef* hspi;
+	uint32_t xferId;
+} spitransfer;
+
+static void onSPIInterrupt(void* context) {
+	HAL_SPI_TxRxCpltCallback((SPI_HandleTypeDef*)context);
+}
+
+static void onSPITransferred(void* context) {
+
+	spitransfer* transfer = (spitransfer*)context;
+	SPI_HandleTypeDef* hspi = transfer->hspi;
+	bool current = (transfer->xferId == hspi->XferId);
+	delete transfer;
+
+	// Aborted or superseded transfer
+	if (!current || (hspi->State != HAL_SPI_STATE_BUSY_TX_RX)) {
+		return;
+	}
+
+	hspi->State = HAL_SPI_STATE_READY;
+	SIM_KERNEL.raiseInterrupt(&onSPIInterrupt, hspi);
+}
+
+extern "C" HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData, uint16_t Size, uint32_t Timeout) {
+
+	if (hspi->State == HAL_SPI_STATE_BUSY_TX_RX) {
+		return HAL_BUSY;
+	}
+	if ((pTxData == NULL) || (pRxData == NULL) || (Size == 0)) {
+		return HAL_ERROR;
+	}
+
+	memset(pRxData, 0, Size * spiFrameBytes(hspi));
+	SIM_KERNEL.advance(spiTransferTime(hspi, Size));
+
+	return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_SPI_TransmitReceive_IT(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData, uint16_t Size) {
+
+	if (hspi->State == HAL_SPI_STATE_BUSY_TX_RX) {
+		return HAL_BUSY;
+	}
+	if ((pTxData == NULL) || (pRxData == NULL) || (Size == 0)) {
+		return HAL_ERROR;
+	}
+
+	memset(pRxData, 0, Size * spiFrameBytes(hspi));
+	hspi->State = HAL_SPI_STATE_BUSY_TX_RX;
+	hspi->XferId++;
+
+	spitransfer* transfer = new spitransfer;
+	transfer->hspi = hspi;
+	transfer->xferId = hspi->XferId;
+	SIM_KERNEL.schedule(SIM_KERNEL.now() + spiTransferTime(hspi, Size), &onSPITransferred, transfer);
+
+	return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_SPI_Abort(SPI_HandleTypeDef* hspi) {
+	hspi->State = HAL_SPI_STATE_READY;
+	return HAL_OK;
+}
+
+/* ADC ----------------------------------------------------------------------*/
+extern "C" HAL_StatusTypeDef HAL_ADCEx_Calibration_Start(ADC_HandleTypeDef* hadc) {
+
+	// Calibration requires the converter to be disabled
+	if (hadc->Running) {
+		return HAL_ERROR;
+	}
+
+	adcLastValue = SIM_ADC_CALIBRATION;
+	return HAL_OK;
+}
+
+// The buffer is filled by halfwords, in circular mode
+extern "C" HAL_StatusTypeDef HAL_ADC_Start_DMA(ADC_HandleTypeDef* hadc, uint32_t* pData, uint32_t Length) {
+
+	if (hadc->Running) {
+		return HAL_BUSY;
+	}
+	if (analogSources.find(hadc->Instance) == analogSources.end()) {
+		return HAL_ERROR;
+	}
+
+	hadc->pDmaBuffer = (uint16_t*)pData;
+	hadc->DmaLength = Length;
+	hadc->DmaOffset = 0;
+	hadc->Running = 1;
+
+	return HAL_OK;
+}
+
+extern "C" HAL_StatusTypeDef HAL_ADC_Stop_DMA(ADC_HandleTypeDef* hadc) {
+	hadc->Running = 0;
+	return HAL_OK;
+}
+
+extern "C" uint32_t HAL_ADC_GetValue(ADC_HandleTypeDef* hadc) {
+	return adcLastValue;
+}
+
+/* CRC ----------------------------------------------------------------------*/
+// Default polynomial and init value, byte input, no reversal
+extern "C" uint32_t HAL_CRC_Calculate(CRC_HandleTypeDef* hcrc, uint32_t pBuffer[], uint32_t BufferLength) {
+
+	const unsigned char* data = (const unsigned char*)pBuffer;
+	uint32_t crc = 0xFFFFFFFFUL;
+	for (uint32_t n = 0; n < BufferLength; n++) {
+		crc ^= ((uint32_t)data[n]) << 24;
+		for (unsigned char bit = 0; bit < 8; bit++) {
+			crc = (crc & 0x80000000UL)? ((crc << 1) ^ SIM_CRC_POLY) : (crc << 1);
+		}
+	}
+
+	return crc;
+}
+
+/* Default callbacks, overridden by the application -------------------------*/
+extern "C" __attribute__((weak)) void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef* htim) {
+	UNUSED(htim);
+}
+
+extern "C" __attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart) {
+	UNUSED(huart);
+}
+
+extern "C" __attribute__((weak)) void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef* huart) {
+	UNUSED(huart);
+}
+
+extern "C" __attribute__((weak)) void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart) {
+	UNUSED(huart);
+}
+
+extern "C" __attribute__((weak)) void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart) {
+	UNUSED(huart);
+}
+
+extern "C" __attribute__((weak)) void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef* hspi) {
+	UNUSED(hspi);
+}
+
+extern "C" __attribute__((weak)) void HAL_SPI_ErrorCallback(SPI_HandleTypeDef* hspi) {
+	UNUSED(hspi);
+}
+
+extern "C" __attribute__((weak)) void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef* hadc) {
+	UNUSED(hadc);
+}
+
+extern "C" __attribute__((weak)) void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef* hadc) {
+	UNUSED(hadc);
+}
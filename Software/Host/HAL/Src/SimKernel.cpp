@@ -0,0 +1,111 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include "SimKernel.h"
+#include <string.h>
+
+SimKernel SimKernel::instance;
+
+SimKernel::SimKernel() : time(0), pollCost(250), masked(false), handlerRunning(false), servedInterrupts(0) {
+	memset(irqEnabled, 0, sizeof(irqEnabled));
+}
+
+SimKernel::~SimKernel() {
+}
+
+void SimKernel::advance(unsigned long long ns) {
+
+	runDueEvents(time + ns);
+	serveInterrupts();
+}
+
+void SimKernel::schedule(unsigned long long at, eventhandler handler, void* context) {
+
+	pendingevent event = { handler, context };
+	events.insert(std::make_pair((at < time)? time : at, event));
+}
+
+void SimKernel::raiseInterrupt(eventhandler handler, void* context) {
+
+	pendingevent event = { handler, context };
+	interrupts.push_back(event);
+}
+
+void SimKernel::setInterruptsMasked(bool _masked) {
+
+	masked = _masked;
+	if (!masked) {
+		serveInterrupts();
+	}
+}
+
+void SimKernel::setIrqEnabled(IRQn_Type irq, bool enabled) {
+	if ((unsigned)irq < SIM_NUM_IRQn) {
+		irqEnabled[irq] = enabled;
+	}
+}
+
+bool SimKernel::isIrqEnabled(IRQn_Type irq) const {
+	return ((unsigned)irq < SIM_NUM_IRQn) && irqEnabled[irq];
+}
+
+// Hardware keeps running while an handler runs or interrupts are masked:
+// events are always processed, in time order
+void SimKernel::runDueEvents(unsigned long long until) {
+
+	while (!events.empty() && (events.begin()->first <= until)) {
+		std::multimap<unsigned long long, pendingevent>::iterator first = events.begin();
+		pendingevent event = first->second;
+		if (first->first > time) {
+			time = first->first;
+		}
+		events.erase(first);
+
+		event.handler(event.context);
+	}
+
+	if (until > time) {
+		time = until;
+	}
+}
+
+// Handlers are not nested. Time spent inside an handler (polls, I2C transfers)
+// may make other events due: they are served at the end, in order
+void SimKernel::serveInterrupts() {
+
+	if (handlerRunning) {
+		return;
+	}
+
+	while (!masked && !interrupts.empty()) {
+		pendingevent event = interrupts.front();
+		interrupts.pop_front();
+
+		handlerRunning = true;
+		event.handler(event.context);
+		handlerRunning = false;
+		servedInterrupts++;
+	}
+}
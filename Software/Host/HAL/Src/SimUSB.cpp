@@ -0,0 +1,109 @@
+/* ===========================================================================
+ * Copyright 2015 EUROPEAN UNION
+ *
+ * Licensed under the EUPL, Version 1.1 or subsequent versions of the
+ * EUPL (the "License"); You may not use this work except in compliance
+ * with the License. You may obtain a copy of the License at
+ * http://ec.europa.eu/idabc/eupl
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" basis,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * Date: 02/04/2015
+ * Authors:
+ * - Michel Gerboles, michel.gerboles@jrc.ec.europa.eu,
+ *   Laurent Spinelle, laurent.spinelle@jrc.ec.europa.eu and
+ *   Alexander Kotsev, alexander.kotsev@jrc.ec.europa.eu:
+ *      European Commission - Joint Research Centre,
+ * - Marco Signorini, marco.signorini@liberaintentio.com
+ *
+ * ===========================================================================
+ */
+
+
+#include "SimKernel.h"
+#include <string.h>
+
+#define USB_FS_PACKET_SIZE		64
+#define USB_FS_FRAME_NS			SIM_NS_PER_MS
+
+// Virtual COM port: one bulk packet per frame in each direction
+class SimUSBCdc : public SimSerialPort {
+public:
+	SimUSBCdc() : endpoint(NULL), handler(NULL), frameScheduled(false) {}
+
+	virtual void inject(const unsigned char* data, unsigned short length) {
+
+		while (length != 0) {
+			unsigned short size = (length > USB_FS_PACKET_SIZE)? USB_FS_PACKET_SIZE : length;
+			packets.push_back(std::vector<unsigned char>(data, data + size));
+			data += size;
+			length -= size;
+		}
+
+		if (!frameScheduled) {
+			frameScheduled = true;
+			SIM_KERNEL.schedule(SIM_KERNEL.now() + USB_FS_FRAME_NS, &onFrame, this);
+		}
+	}
+
+	void connect(SimSerialEndpoint* _endpoint, simusbrxhandler _handler) {
+		endpoint = _endpoint;
+		handler = _handler;
+		endpoint->attach(this);
+	}
+
+	void transmit(const unsigned char* data, unsigned short length) {
+		if (endpoint) {
+			endpoint->onTransmit(data, length);
+		}
+	}
+
+private:
+	static void onFrame(void* context) {
+
+		SimUSBCdc* usb = (SimUSBCdc*)context;
+		SIM_KERNEL.raiseInterrupt(&onPacketReceived, usb);
+
+		if (usb->packets.size() > 1) {
+			SIM_KERNEL.schedule(SIM_KERNEL.now() + USB_FS_FRAME_NS, &onFrame, usb);
+		} else {
+			usb->frameScheduled = false;
+		}
+	}
+
+	static void onPacketReceived(void* context) {
+
+		SimUSBCdc* usb = (SimUSBCdc*)context;
+		if (usb->packets.empty()) {
+			return;
+		}
+
+		std::vector<unsigned char> packet = usb->packets.front();
+		usb->packets.pop_front();
+		if (usb->handler) {
+			usb->handler(packet.data(), packet.size());
+		}
+	}
+
+private:
+	SimSerialEndpoint* endpoint;
+	simusbrxhandler handler;
+	std::deque<std::vector<unsigned char> > packets;
+	bool frameScheduled;
+};
+
+static SimUSBCdc usbCdc;
+
+void simUSBConnect(SimSerialEndpoint* endpoint, simusbrxhandler handler) {
+	usbCdc.connect(endpoint, handler);
+}
+
+// USB device CDC interface, see usbd_cdc_if.c on the target
+extern "C" uint8_t CDC_Transmit_FS(uint8_t* Buf, uint16_t Len) {
+
+	usbCdc.transmit(Buf, Len);
+	return 0;
+}